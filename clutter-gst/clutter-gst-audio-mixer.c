@@ -0,0 +1,279 @@
+/*
+ * Clutter-GStreamer.
+ *
+ * GStreamer integration library for Clutter.
+ *
+ * clutter-gst-audio-mixer.c - Mixes the audio of the players into a
+ *                             single output.
+ *
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * The players using the shared audio output get an interaudiosink as audio
+ * sink, each on a channel of its own. A pipeline, shared by the whole
+ * process, reads every channel with an interaudiosrc, mixes them with
+ * audiomixer and plays the result with a single audio sink:
+ *
+ *   interaudiosrc ! audioconvert ! audioresample ! \
+ *   interaudiosrc ! audioconvert ! audioresample ! audiomixer ! ... ! sink
+ *
+ * The input of a channel lives as long as the interaudiosink of the
+ * channel, and the mixer pipeline only runs while it has inputs.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "clutter-gst-debug.h"
+#include "clutter-gst-audio-mixer.h"
+
+typedef struct _ClutterGstMixerInput
+{
+  gchar *channel;
+  GstElement *bin;
+  GstPad *mixer_pad;
+  guint n_sinks;
+} ClutterGstMixerInput;
+
+G_LOCK_DEFINE_STATIC (audio_mixer);
+
+static GstElement *output = NULL;
+static GstElement *pipeline = NULL;
+static GstElement *mixer = NULL;
+/* channel name -> ClutterGstMixerInput */
+static GHashTable *inputs = NULL;
+
+static gboolean
+audio_mixer_create_unlocked (void)
+{
+  GstElement *convert, *resample, *sink;
+
+  mixer = gst_element_factory_make ("audiomixer", NULL);
+  convert = gst_element_factory_make ("audioconvert", NULL);
+  resample = gst_element_factory_make ("audioresample", NULL);
+
+  if (output)
+    sink = gst_object_ref (output);
+  else
+    sink = gst_element_factory_make ("autoaudiosink", NULL);
+
+  if (!mixer || !convert || !resample || !sink)
+    {
+      g_warning ("Could not create the shared audio output");
+
+      if (mixer)
+        gst_object_unref (mixer);
+      if (convert)
+        gst_object_unref (convert);
+      if (resample)
+        gst_object_unref (resample);
+      if (sink)
+        gst_object_unref (sink);
+      mixer = NULL;
+
+      return FALSE;
+    }
+
+  CLUTTER_GST_NOTE (AUDIO_STREAM, "creating the shared audio output");
+
+  pipeline = gst_pipeline_new ("clutter-gst-audio-mixer");
+  gst_bin_add_many (GST_BIN (pipeline), mixer, convert, resample, sink, NULL);
+  gst_element_link_many (mixer, convert, resample, sink, NULL);
+
+  inputs = g_hash_table_new (g_str_hash, g_str_equal);
+
+  return TRUE;
+}
+
+static ClutterGstMixerInput *
+audio_mixer_add_input_unlocked (const gchar *channel)
+{
+  ClutterGstMixerInput *input;
+  GstElement *src, *convert, *resample;
+  GstPad *pad;
+
+  src = gst_element_factory_make ("interaudiosrc", NULL);
+  convert = gst_element_factory_make ("audioconvert", NULL);
+  resample = gst_element_factory_make ("audioresample", NULL);
+
+  if (!src || !convert || !resample)
+    {
+      g_warning ("Could not create an input of the shared audio output");
+
+      if (src)
+        gst_object_unref (src);
+      if (convert)
+        gst_object_unref (convert);
+      if (resample)
+        gst_object_unref (resample);
+
+      return NULL;
+    }
+
+  CLUTTER_GST_NOTE (AUDIO_STREAM, "mixing channel %s", channel);
+
+  g_object_set (src, "channel", channel, NULL);
+
+  input = g_slice_new0 (ClutterGstMixerInput);
+  input->channel = g_strdup (channel);
+  input->bin = gst_bin_new (NULL);
+
+  gst_bin_add_many (GST_BIN (input->bin), src, convert, resample, NULL);
+  gst_element_link_many (src, convert, resample, NULL);
+
+  pad = gst_element_get_static_pad (resample, "src");
+  gst_element_add_pad (input->bin, gst_ghost_pad_new ("src", pad));
+  gst_object_unref (pad);
+
+  gst_bin_add (GST_BIN (pipeline), input->bin);
+
+  input->mixer_pad = gst_element_get_request_pad (mixer, "sink_%u");
+  pad = gst_element_get_static_pad (input->bin, "src");
+  gst_pad_link (pad, input->mixer_pad);
+  gst_object_unref (pad);
+
+  g_hash_table_insert (inputs, input->channel, input);
+
+  /* the first input starts the output */
+  if (g_hash_table_size (inputs) == 1)
+    gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  else
+    gst_element_sync_state_with_parent (input->bin);
+
+  return input;
+}
+
+static void
+audio_mixer_remove_input_unlocked (ClutterGstMixerInput *input)
+{
+  CLUTTER_GST_NOTE (AUDIO_STREAM, "not mixing channel %s anymore",
+                    input->channel);
+
+  g_hash_table_remove (inputs, input->channel);
+
+  /* the last input stops the output, and releases the audio device */
+  if (g_hash_table_size (inputs) == 0)
+    gst_element_set_state (pipeline, GST_STATE_NULL);
+
+  gst_element_set_state (input->bin, GST_STATE_NULL);
+  gst_element_release_request_pad (mixer, input->mixer_pad);
+  gst_object_unref (input->mixer_pad);
+  gst_bin_remove (GST_BIN (pipeline), input->bin);
+
+  g_free (input->channel);
+  g_slice_free (ClutterGstMixerInput, input);
+}
+
+/* Called when an interaudiosink is disposed of, possibly from a streaming
+ * thread */
+static void
+audio_mixer_sink_gone (gpointer  data,
+                       GObject  *where_the_sink_was)
+{
+  ClutterGstMixerInput *input = data;
+
+  G_LOCK (audio_mixer);
+
+  if (--input->n_sinks == 0)
+    audio_mixer_remove_input_unlocked (input);
+
+  G_UNLOCK (audio_mixer);
+}
+
+gboolean
+_clutter_gst_audio_mixer_has_output (void)
+{
+  gboolean has_output;
+
+  G_LOCK (audio_mixer);
+  has_output = output != NULL || pipeline != NULL;
+  G_UNLOCK (audio_mixer);
+
+  return has_output;
+}
+
+/* Sets the sink playing the mixed audio. It can only be changed until the
+ * shared output is first used */
+void
+_clutter_gst_audio_mixer_set_output (GstElement *sink)
+{
+  G_LOCK (audio_mixer);
+
+  if (pipeline)
+    {
+      g_warning ("The shared audio output is already in use");
+
+      if (sink)
+        gst_object_unref (gst_object_ref_sink (sink));
+    }
+  else
+    {
+      if (output)
+        gst_object_unref (output);
+
+      output = sink ? gst_object_ref_sink (sink) : NULL;
+    }
+
+  G_UNLOCK (audio_mixer);
+}
+
+/* Creates an audio sink feeding the mixer through @channel, or NULL if the
+ * shared output can't be used */
+GstElement *
+_clutter_gst_audio_mixer_create_sink (const gchar *channel)
+{
+  ClutterGstMixerInput *input = NULL;
+  GstElement *sink;
+
+  sink = gst_element_factory_make ("interaudiosink", NULL);
+  if (sink == NULL)
+    {
+      g_warning ("Could not create an interaudiosink, the shared audio "
+                 "output is not available");
+      return NULL;
+    }
+
+  g_object_set (sink, "channel", channel, NULL);
+
+  G_LOCK (audio_mixer);
+
+  if (pipeline || audio_mixer_create_unlocked ())
+    {
+      input = g_hash_table_lookup (inputs, channel);
+      if (input == NULL)
+        input = audio_mixer_add_input_unlocked (channel);
+    }
+
+  if (input)
+    {
+      input->n_sinks++;
+      g_object_weak_ref (G_OBJECT (sink), audio_mixer_sink_gone, input);
+    }
+
+  G_UNLOCK (audio_mixer);
+
+  if (input == NULL)
+    {
+      gst_object_unref (sink);
+      return NULL;
+    }
+
+  return sink;
+}
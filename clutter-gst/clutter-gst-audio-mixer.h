@@ -0,0 +1,41 @@
+/*
+ * Clutter-GStreamer.
+ *
+ * GStreamer integration library for Clutter.
+ *
+ * clutter-gst-audio-mixer.h - Mixes the audio of the players into a
+ *                             single output.
+ *
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __CLUTTER_GST_AUDIO_MIXER_H__
+#define __CLUTTER_GST_AUDIO_MIXER_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+gboolean      _clutter_gst_audio_mixer_has_output  (void);
+void          _clutter_gst_audio_mixer_set_output  (GstElement  *sink);
+
+GstElement *  _clutter_gst_audio_mixer_create_sink (const gchar *channel);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_GST_AUDIO_MIXER_H__ */
@@ -48,7 +48,12 @@ enum
 {
   PROP_0,
   PROP_TEXTURE,
-  PROP_TS_OFFSET
+  PROP_TS_OFFSET,
+  PROP_ADAPT_TO_ALLOCATION,
+  PROP_THROTTLE_HIDDEN,
+  PROP_MAX_FPS,
+  PROP_LAZY_UPLOAD,
+  PROP_BATCH_UPLOAD
 };
 
 #define DEFAULT_TS_OFFSET           0
@@ -365,6 +370,25 @@ clutter_gst_auto_video_sink_reconfigure (ClutterGstAutoVideoSink * bin,
   bin->child = gst_object_ref (sink);
   g_object_set (G_OBJECT (bin->child), "texture", bin->texture,
       "ts-offset", bin->ts_offset, NULL);
+  if (g_object_class_find_property (G_OBJECT_GET_CLASS (bin->child),
+          "adapt-to-allocation"))
+    g_object_set (G_OBJECT (bin->child), "adapt-to-allocation",
+        bin->adapt_to_allocation, NULL);
+  if (g_object_class_find_property (G_OBJECT_GET_CLASS (bin->child),
+          "throttle-hidden"))
+    g_object_set (G_OBJECT (bin->child), "throttle-hidden",
+        bin->throttle_hidden, NULL);
+  if (g_object_class_find_property (G_OBJECT_GET_CLASS (bin->child),
+          "max-fps"))
+    g_object_set (G_OBJECT (bin->child), "max-fps", bin->max_fps, NULL);
+  if (g_object_class_find_property (G_OBJECT_GET_CLASS (bin->child),
+          "lazy-upload"))
+    g_object_set (G_OBJECT (bin->child), "lazy-upload", bin->lazy_upload,
+        NULL);
+  if (g_object_class_find_property (G_OBJECT_GET_CLASS (bin->child),
+          "batch-upload"))
+    g_object_set (G_OBJECT (bin->child), "batch-upload", bin->batch_upload,
+        NULL);
 
   GST_DEBUG_OBJECT (bin, "going to add %" GST_PTR_FORMAT, bin->child);
   /* Add our child */
@@ -694,6 +718,51 @@ clutter_gst_auto_video_sink_set_property (GObject * object,
             value);
       }
       break;
+    case PROP_ADAPT_TO_ALLOCATION:
+      bin->adapt_to_allocation = g_value_get_boolean (value);
+      if (bin->child &&
+          g_object_class_find_property (G_OBJECT_GET_CLASS (bin->child),
+              pspec->name)) {
+        g_object_set_property (G_OBJECT (bin->child), pspec->name,
+            value);
+      }
+      break;
+    case PROP_THROTTLE_HIDDEN:
+      bin->throttle_hidden = g_value_get_boolean (value);
+      if (bin->child &&
+          g_object_class_find_property (G_OBJECT_GET_CLASS (bin->child),
+              pspec->name)) {
+        g_object_set_property (G_OBJECT (bin->child), pspec->name,
+            value);
+      }
+      break;
+    case PROP_MAX_FPS:
+      bin->max_fps = g_value_get_double (value);
+      if (bin->child &&
+          g_object_class_find_property (G_OBJECT_GET_CLASS (bin->child),
+              pspec->name)) {
+        g_object_set_property (G_OBJECT (bin->child), pspec->name,
+            value);
+      }
+      break;
+    case PROP_LAZY_UPLOAD:
+      bin->lazy_upload = g_value_get_boolean (value);
+      if (bin->child &&
+          g_object_class_find_property (G_OBJECT_GET_CLASS (bin->child),
+              pspec->name)) {
+        g_object_set_property (G_OBJECT (bin->child), pspec->name,
+            value);
+      }
+      break;
+    case PROP_BATCH_UPLOAD:
+      bin->batch_upload = g_value_get_boolean (value);
+      if (bin->child &&
+          g_object_class_find_property (G_OBJECT_GET_CLASS (bin->child),
+              pspec->name)) {
+        g_object_set_property (G_OBJECT (bin->child), pspec->name,
+            value);
+      }
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -713,6 +782,21 @@ clutter_gst_auto_video_sink_get_property (GObject * object,
     case PROP_TS_OFFSET:
       g_value_set_int64 (value, bin->ts_offset);
       break;
+    case PROP_ADAPT_TO_ALLOCATION:
+      g_value_set_boolean (value, bin->adapt_to_allocation);
+      break;
+    case PROP_THROTTLE_HIDDEN:
+      g_value_set_boolean (value, bin->throttle_hidden);
+      break;
+    case PROP_MAX_FPS:
+      g_value_set_double (value, bin->max_fps);
+      break;
+    case PROP_LAZY_UPLOAD:
+      g_value_set_boolean (value, bin->lazy_upload);
+      break;
+    case PROP_BATCH_UPLOAD:
+      g_value_set_boolean (value, bin->batch_upload);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -761,6 +845,87 @@ clutter_gst_auto_video_sink_class_init (ClutterGstAutoVideoSinkClass * klass)
           "Timestamp offset in nanoseconds", G_MININT64, G_MAXINT64,
           DEFAULT_TS_OFFSET, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+    * ClutterGstAutoVideoSink:adapt-to-allocation:
+    *
+    * Whether to ask upstream for frames no larger than the texture on the
+    * stage, see #ClutterGstVideoSink:adapt-to-allocation. Only used when
+    * the selected sink supports it.
+    *
+    * Since: 2.2
+    */
+  pspec = g_param_spec_boolean ("adapt-to-allocation",
+      "Adapt to allocation",
+      "Whether to ask for frames no larger than the texture on the stage",
+      FALSE, CLUTTER_GST_PARAM_READWRITE);
+
+  g_object_class_install_property (oclass, PROP_ADAPT_TO_ALLOCATION, pspec);
+
+  /**
+    * ClutterGstAutoVideoSink:throttle-hidden:
+    *
+    * Whether to skip frames while the texture is hidden, see
+    * #ClutterGstVideoSink:throttle-hidden. Only used when the selected
+    * sink supports it.
+    *
+    * Since: 2.2
+    */
+  pspec = g_param_spec_boolean ("throttle-hidden",
+      "Throttle hidden",
+      "Whether to skip frames while the texture is hidden",
+      FALSE, CLUTTER_GST_PARAM_READWRITE);
+
+  g_object_class_install_property (oclass, PROP_THROTTLE_HIDDEN, pspec);
+
+  /**
+    * ClutterGstAutoVideoSink:max-fps:
+    *
+    * The highest number of frames per second to render, see
+    * #ClutterGstVideoSink:max-fps. Only used when the selected sink
+    * supports it.
+    *
+    * Since: 2.2
+    */
+  pspec = g_param_spec_double ("max-fps",
+      "Maximum frame rate",
+      "The highest number of frames per second to render (0 = unlimited)",
+      0.0, G_MAXDOUBLE, 0.0, CLUTTER_GST_PARAM_READWRITE);
+
+  g_object_class_install_property (oclass, PROP_MAX_FPS, pspec);
+
+  /**
+    * ClutterGstAutoVideoSink:lazy-upload:
+    *
+    * Whether to upload frames only when the texture is painted, see
+    * #ClutterGstVideoSink:lazy-upload. Only used when the selected sink
+    * supports it.
+    *
+    * Since: 2.2
+    */
+  pspec = g_param_spec_boolean ("lazy-upload",
+      "Lazy upload",
+      "Whether to upload frames only when the texture is painted",
+      FALSE, CLUTTER_GST_PARAM_READWRITE);
+
+  g_object_class_install_property (oclass, PROP_LAZY_UPLOAD, pspec);
+
+  /**
+    * ClutterGstAutoVideoSink:batch-upload:
+    *
+    * Whether to upload frames together with the other sinks, see
+    * #ClutterGstVideoSink:batch-upload. Only used when the selected sink
+    * supports it.
+    *
+    * Since: 2.2
+    */
+  pspec = g_param_spec_boolean ("batch-upload",
+      "Batch upload",
+      "Whether to upload frames together with the other sinks, right "
+      "before the stage is painted",
+      FALSE, CLUTTER_GST_PARAM_READWRITE);
+
+  g_object_class_install_property (oclass, PROP_BATCH_UPLOAD, pspec);
+
   gstelement_class->change_state =
       GST_DEBUG_FUNCPTR (clutter_gst_auto_video_sink_change_state);
 
@@ -780,6 +945,11 @@ clutter_gst_auto_video_sink_init (ClutterGstAutoVideoSink * bin)
   bin->setup = FALSE;
   bin->texture = NULL;
   bin->ts_offset = DEFAULT_TS_OFFSET;
+  bin->adapt_to_allocation = FALSE;
+  bin->throttle_hidden = FALSE;
+  bin->max_fps = 0.0;
+  bin->lazy_upload = FALSE;
+  bin->batch_upload = FALSE;
 
   /* Create a ghost pad with no target at first */
   template = gst_static_pad_template_get (&sink_template_factory);
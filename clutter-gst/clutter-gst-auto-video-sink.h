@@ -100,6 +100,11 @@ struct _ClutterGstAutoVideoSink
 
   ClutterTexture *texture;
   GstClockTimeDiff ts_offset;
+  gboolean adapt_to_allocation;
+  gboolean throttle_hidden;
+  gdouble max_fps;
+  gboolean lazy_upload;
+  gboolean batch_upload;
 
   GMutex lock;
 };
@@ -0,0 +1,165 @@
+/*
+ * Clutter-GStreamer.
+ *
+ * GStreamer integration library for Clutter.
+ *
+ * clutter-gst-bus-dispatcher.c - Dispatches the messages of many
+ *                                buses from a single main loop source.
+ *
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * gst_bus_add_signal_watch() adds a GSource, and a file descriptor to poll,
+ * per bus to the main context. With many players, every main loop iteration
+ * goes through all of them. Instead, a bus can have its messages handed,
+ * from its sync handler, to _clutter_gst_bus_dispatcher_post(). They are
+ * queued and a single source, attached to the default main context, emits
+ * them from the main thread as a signal watch would, with the "message"
+ * signal of their bus.
+ *
+ * The source lives as long as there are users, see
+ * _clutter_gst_bus_dispatcher_ref().
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "clutter-gst-debug.h"
+#include "clutter-gst-bus-dispatcher.h"
+
+typedef struct _ClutterGstBusMessage
+{
+  GstBus *bus;
+  GstMessage *message;
+} ClutterGstBusMessage;
+
+static GAsyncQueue *messages = NULL;
+static GSource *dispatcher = NULL;
+static guint dispatcher_users = 0;
+
+static void
+bus_message_free (ClutterGstBusMessage *item)
+{
+  gst_message_unref (item->message);
+  gst_object_unref (item->bus);
+  g_slice_free (ClutterGstBusMessage, item);
+}
+
+static gboolean
+dispatcher_prepare (GSource *source,
+                    gint    *timeout)
+{
+  *timeout = -1;
+
+  return g_async_queue_length (messages) > 0;
+}
+
+static gboolean
+dispatcher_check (GSource *source)
+{
+  return g_async_queue_length (messages) > 0;
+}
+
+static gboolean
+dispatcher_dispatch (GSource     *source,
+                     GSourceFunc  callback,
+                     gpointer     user_data)
+{
+  ClutterGstBusMessage *item;
+  gint n;
+
+  /* only what's queued now, so that a busy bus can't starve the main
+   * loop */
+  for (n = g_async_queue_length (messages); n > 0; n--)
+    {
+      item = g_async_queue_try_pop (messages);
+      if (item == NULL)
+        break;
+
+      gst_bus_async_signal_func (item->bus, item->message, NULL);
+      bus_message_free (item);
+    }
+
+  return TRUE;
+}
+
+static GSourceFuncs dispatcher_funcs =
+{
+  dispatcher_prepare,
+  dispatcher_check,
+  dispatcher_dispatch,
+  NULL
+};
+
+/* Called from the main thread by each user of the dispatcher */
+void
+_clutter_gst_bus_dispatcher_ref (void)
+{
+  if (dispatcher_users++ > 0)
+    return;
+
+  CLUTTER_GST_NOTE (MEDIA, "starting the shared bus dispatcher");
+
+  if (messages == NULL)
+    messages =
+      g_async_queue_new_full ((GDestroyNotify) bus_message_free);
+
+  dispatcher = g_source_new (&dispatcher_funcs, sizeof (GSource));
+  g_source_set_priority (dispatcher, G_PRIORITY_DEFAULT);
+  g_source_attach (dispatcher, NULL);
+}
+
+void
+_clutter_gst_bus_dispatcher_unref (void)
+{
+  ClutterGstBusMessage *item;
+
+  g_return_if_fail (dispatcher_users > 0);
+
+  if (--dispatcher_users > 0)
+    return;
+
+  CLUTTER_GST_NOTE (MEDIA, "stopping the shared bus dispatcher");
+
+  g_source_destroy (dispatcher);
+  g_source_unref (dispatcher);
+  dispatcher = NULL;
+
+  /* nobody is left to handle them */
+  while ((item = g_async_queue_try_pop (messages)))
+    bus_message_free (item);
+}
+
+/* Queues @message, posted on @bus, for the dispatcher. Takes ownership of
+ * @message. Can be called from any thread */
+void
+_clutter_gst_bus_dispatcher_post (GstBus     *bus,
+                                  GstMessage *message)
+{
+  ClutterGstBusMessage *item;
+
+  item = g_slice_new (ClutterGstBusMessage);
+  item->bus = gst_object_ref (bus);
+  item->message = message;
+
+  g_async_queue_push (messages, item);
+
+  g_main_context_wakeup (NULL);
+}
@@ -0,0 +1,42 @@
+/*
+ * Clutter-GStreamer.
+ *
+ * GStreamer integration library for Clutter.
+ *
+ * clutter-gst-bus-dispatcher.h - Dispatches the messages of many
+ *                                buses from a single main loop source.
+ *
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __CLUTTER_GST_BUS_DISPATCHER_H__
+#define __CLUTTER_GST_BUS_DISPATCHER_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+void          _clutter_gst_bus_dispatcher_ref   (void);
+void          _clutter_gst_bus_dispatcher_unref (void);
+
+void          _clutter_gst_bus_dispatcher_post  (GstBus     *bus,
+                                                 GstMessage *message);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_GST_BUS_DISPATCHER_H__ */
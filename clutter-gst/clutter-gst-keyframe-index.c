@@ -0,0 +1,480 @@
+/*
+ * Clutter-GStreamer.
+ *
+ * GStreamer integration library for Clutter.
+ *
+ * clutter-gst-keyframe-index.c - An index of the key frames of local
+ *                                media, built in the background.
+ *
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * The key frames of a video are found by playing the media without decoding
+ * it: decodebin is asked to expose the streams instead of plugging
+ * decoders, and the buffers of the video stream not flagged as delta units
+ * are the key frames. Demuxing is cheap enough to go through a whole movie
+ * in a few seconds.
+ *
+ * Indexes are kept in the user cache directory, one file per media named
+ * after the SHA1 of its URI and of its modification time, holding a magic
+ * number, the number of key frames and their stream times, as little endian
+ * integers.
+ *
+ * Only one index is built at a time, in a worker thread.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include "clutter-gst-debug.h"
+#include "clutter-gst-keyframe-index.h"
+
+#define INDEX_MAGIC             0x494b4743      /* "CGKI" */
+
+/* Elements don't expose header files */
+typedef enum {
+  GST_AUTOPLUG_SELECT_TRY,
+  GST_AUTOPLUG_SELECT_EXPOSE,
+  GST_AUTOPLUG_SELECT_SKIP
+} GstAutoplugSelectResult;
+
+typedef struct
+{
+  GstElement *pipeline;
+  GstPad *video_pad;
+  GArray *keyframes;
+} KeyframeScan;
+
+G_LOCK_DEFINE_STATIC (worker);
+static GThreadPool *worker = NULL;
+
+void
+_clutter_gst_keyframe_index_free (ClutterGstKeyframeIndex *index)
+{
+  g_free (index->uri);
+  g_array_free (index->keyframes, TRUE);
+  g_slice_free (ClutterGstKeyframeIndex, index);
+}
+
+/* Returns the key frame at or before @position, or GST_CLOCK_TIME_NONE */
+GstClockTime
+_clutter_gst_keyframe_index_lookup (ClutterGstKeyframeIndex *index,
+                                    GstClockTime             position)
+{
+  GArray *keyframes = index->keyframes;
+  guint low = 0, high = keyframes->len;
+
+  /* the first key frame after position */
+  while (low < high)
+    {
+      guint middle = (low + high) / 2;
+
+      if (g_array_index (keyframes, GstClockTime, middle) <= position)
+        low = middle + 1;
+      else
+        high = middle;
+    }
+
+  if (low == 0)
+    return GST_CLOCK_TIME_NONE;
+
+  return g_array_index (keyframes, GstClockTime, low - 1);
+}
+
+/* Cache */
+
+static gchar *
+index_get_path (const gchar *uri)
+{
+  GFileInfo *file_info;
+  GFile *file;
+  guint64 mtime = 0;
+  gchar *key, *name, *path;
+
+  file = g_file_new_for_uri (uri);
+  file_info = g_file_query_info (file, G_FILE_ATTRIBUTE_TIME_MODIFIED,
+                                 G_FILE_QUERY_INFO_NONE, NULL, NULL);
+  if (file_info)
+    {
+      mtime = g_file_info_get_attribute_uint64 (file_info,
+                                                G_FILE_ATTRIBUTE_TIME_MODIFIED);
+      g_object_unref (file_info);
+    }
+  g_object_unref (file);
+
+  key = g_strdup_printf ("%s\n%" G_GUINT64_FORMAT, uri, mtime);
+  name = g_compute_checksum_for_string (G_CHECKSUM_SHA1, key, -1);
+  path = g_build_filename (g_get_user_cache_dir (),
+                           "clutter-gst", "keyframes", name, NULL);
+  g_free (name);
+  g_free (key);
+
+  return path;
+}
+
+static GArray *
+index_load (const gchar *path)
+{
+  GArray *keyframes;
+  gchar *contents;
+  gsize length;
+  guint32 header[2];
+  guint64 value;
+  guint i, n;
+
+  if (!g_file_get_contents (path, &contents, &length, NULL))
+    return NULL;
+
+  if (length < sizeof (header))
+    {
+      g_free (contents);
+      return NULL;
+    }
+
+  memcpy (header, contents, sizeof (header));
+  n = GUINT32_FROM_LE (header[1]);
+
+  if (GUINT32_FROM_LE (header[0]) != INDEX_MAGIC ||
+      (length - sizeof (header)) / sizeof (guint64) != n)
+    {
+      g_free (contents);
+      return NULL;
+    }
+
+  keyframes = g_array_sized_new (FALSE, FALSE, sizeof (GstClockTime), n);
+  for (i = 0; i < n; i++)
+    {
+      memcpy (&value, contents + sizeof (header) + i * sizeof (guint64),
+              sizeof (guint64));
+      value = GUINT64_FROM_LE (value);
+      g_array_append_val (keyframes, value);
+    }
+
+  g_free (contents);
+
+  return keyframes;
+}
+
+static void
+index_save (const gchar *path,
+            GArray      *keyframes)
+{
+  GError *error = NULL;
+  guint32 *header;
+  guint64 *values;
+  gchar *contents, *dir;
+  gsize length;
+  guint i;
+
+  length = 2 * sizeof (guint32) + keyframes->len * sizeof (guint64);
+  contents = g_malloc (length);
+
+  header = (guint32 *) contents;
+  header[0] = GUINT32_TO_LE (INDEX_MAGIC);
+  header[1] = GUINT32_TO_LE (keyframes->len);
+
+  values = (guint64 *) (contents + 2 * sizeof (guint32));
+  for (i = 0; i < keyframes->len; i++)
+    values[i] = GUINT64_TO_LE (g_array_index (keyframes, GstClockTime, i));
+
+  dir = g_path_get_dirname (path);
+  g_mkdir_with_parents (dir, 0700);
+  g_free (dir);
+
+  if (!g_file_set_contents (path, contents, length, &error))
+    {
+      g_warning ("Could not save a key frame index: %s", error->message);
+      g_error_free (error);
+    }
+
+  g_free (contents);
+}
+
+/* Scan */
+
+/* expose the streams as they come out of the parsers */
+static GstAutoplugSelectResult
+on_autoplug_select (GstElement         *bin,
+                    GstPad             *pad,
+                    GstCaps            *caps,
+                    GstElementFactory  *factory,
+                    gpointer            user_data)
+{
+  if (gst_element_factory_list_is_type (factory,
+                                        GST_ELEMENT_FACTORY_TYPE_DECODER))
+    return GST_AUTOPLUG_SELECT_EXPOSE;
+
+  return GST_AUTOPLUG_SELECT_TRY;
+}
+
+/* Called from the streaming thread of the video stream, the only one
+ * touching scan->keyframes until the end of the scan */
+static GstPadProbeReturn
+on_video_buffer (GstPad          *pad,
+                 GstPadProbeInfo *info,
+                 gpointer         user_data)
+{
+  KeyframeScan *scan = user_data;
+  GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER (info);
+  const GstSegment *segment;
+  GstClockTime timestamp;
+  GstEvent *event;
+
+  if (GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DELTA_UNIT))
+    return GST_PAD_PROBE_OK;
+
+  timestamp = GST_BUFFER_PTS_IS_VALID (buffer) ? GST_BUFFER_PTS (buffer)
+                                               : GST_BUFFER_DTS (buffer);
+  if (!GST_CLOCK_TIME_IS_VALID (timestamp))
+    return GST_PAD_PROBE_OK;
+
+  event = gst_pad_get_sticky_event (pad, GST_EVENT_SEGMENT, 0);
+  if (event)
+    {
+      gst_event_parse_segment (event, &segment);
+      if (segment->format == GST_FORMAT_TIME)
+        timestamp = gst_segment_to_stream_time (segment, GST_FORMAT_TIME,
+                                                timestamp);
+      gst_event_unref (event);
+    }
+
+  if (GST_CLOCK_TIME_IS_VALID (timestamp))
+    g_array_append_val (scan->keyframes, timestamp);
+
+  return GST_PAD_PROBE_OK;
+}
+
+static void
+on_pad_added (GstElement   *bin,
+              GstPad       *pad,
+              KeyframeScan *scan)
+{
+  GstElement *sink;
+  GstPad *sink_pad;
+  GstCaps *caps;
+
+  sink = gst_element_factory_make ("fakesink", NULL);
+  g_object_set (sink, "sync", FALSE, NULL);
+  gst_bin_add (GST_BIN (scan->pipeline), sink);
+  gst_element_sync_state_with_parent (sink);
+
+  sink_pad = gst_element_get_static_pad (sink, "sink");
+  gst_pad_link (pad, sink_pad);
+  gst_object_unref (sink_pad);
+
+  caps = gst_pad_get_current_caps (pad);
+  if (caps == NULL)
+    caps = gst_pad_query_caps (pad, NULL);
+
+  /* pads are added from the streaming threads */
+  GST_OBJECT_LOCK (scan->pipeline);
+  if (scan->video_pad == NULL &&
+      g_str_has_prefix (gst_structure_get_name
+                        (gst_caps_get_structure (caps, 0)), "video/"))
+    {
+      scan->video_pad = gst_object_ref (pad);
+      gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER,
+                         on_video_buffer, scan, NULL);
+    }
+  GST_OBJECT_UNLOCK (scan->pipeline);
+
+  gst_caps_unref (caps);
+}
+
+static gint
+compare_clock_time (gconstpointer a,
+                    gconstpointer b)
+{
+  GstClockTime ta = *(const GstClockTime *) a;
+  GstClockTime tb = *(const GstClockTime *) b;
+
+  return ta < tb ? -1 : ta > tb ? 1 : 0;
+}
+
+static GArray *
+index_build (const gchar   *uri,
+             GCancellable  *cancellable,
+             GError       **error)
+{
+  KeyframeScan scan = { NULL, };
+  GstElement *decodebin;
+  GstMessage *message = NULL;
+  GArray *keyframes = NULL;
+  GstBus *bus;
+  guint i, n;
+
+  decodebin = gst_element_factory_make ("uridecodebin", NULL);
+  if (decodebin == NULL)
+    {
+      g_set_error (error, GST_CORE_ERROR, GST_CORE_ERROR_MISSING_PLUGIN,
+                   "Could not create uridecodebin");
+      return NULL;
+    }
+
+  CLUTTER_GST_NOTE (MEDIA, "building the key frame index of %s", uri);
+
+  scan.pipeline = gst_pipeline_new (NULL);
+  scan.keyframes = g_array_new (FALSE, FALSE, sizeof (GstClockTime));
+
+  g_object_set (decodebin, "uri", uri, NULL);
+  g_signal_connect (decodebin, "autoplug-select",
+                    G_CALLBACK (on_autoplug_select), NULL);
+  g_signal_connect (decodebin, "pad-added",
+                    G_CALLBACK (on_pad_added), &scan);
+  gst_bin_add (GST_BIN (scan.pipeline), decodebin);
+
+  bus = gst_element_get_bus (scan.pipeline);
+
+  if (gst_element_set_state (scan.pipeline, GST_STATE_PLAYING) !=
+      GST_STATE_CHANGE_FAILURE)
+    {
+      /* wake up from time to time to check if we should give up */
+      while (message == NULL &&
+             !g_cancellable_is_cancelled (cancellable))
+        message = gst_bus_timed_pop_filtered (bus, 100 * GST_MSECOND,
+                                              GST_MESSAGE_EOS |
+                                              GST_MESSAGE_ERROR);
+    }
+  else
+    {
+      message = gst_bus_pop_filtered (bus, GST_MESSAGE_ERROR);
+    }
+
+  gst_element_set_state (scan.pipeline, GST_STATE_NULL);
+
+  if (message == NULL)
+    {
+      if (!g_cancellable_set_error_if_cancelled (cancellable, error))
+        g_set_error (error, GST_CORE_ERROR, GST_CORE_ERROR_FAILED,
+                     "Could not index %s", uri);
+    }
+  else if (GST_MESSAGE_TYPE (message) == GST_MESSAGE_ERROR)
+    {
+      gst_message_parse_error (message, error, NULL);
+    }
+  else
+    {
+      keyframes = scan.keyframes;
+    }
+
+  if (message)
+    gst_message_unref (message);
+  gst_object_unref (bus);
+  gst_object_unref (scan.pipeline);
+  if (scan.video_pad)
+    gst_object_unref (scan.video_pad);
+
+  if (keyframes == NULL)
+    {
+      g_array_free (scan.keyframes, TRUE);
+      return NULL;
+    }
+
+  /* in presentation order, once each */
+  g_array_sort (keyframes, compare_clock_time);
+  for (i = 1, n = 1; i < keyframes->len; i++)
+    if (g_array_index (keyframes, GstClockTime, i) !=
+        g_array_index (keyframes, GstClockTime, n - 1))
+      g_array_index (keyframes, GstClockTime, n++) =
+        g_array_index (keyframes, GstClockTime, i);
+  if (keyframes->len > 0)
+    g_array_set_size (keyframes, n);
+
+  CLUTTER_GST_NOTE (MEDIA, "%u key frames in %s", keyframes->len, uri);
+
+  return keyframes;
+}
+
+static void
+index_worker (gpointer data,
+              gpointer user_data)
+{
+  GTask *task = data;
+  const gchar *uri = g_task_get_task_data (task);
+  ClutterGstKeyframeIndex *index;
+  GArray *keyframes;
+  GError *error = NULL;
+  gchar *path;
+
+  if (g_task_return_error_if_cancelled (task))
+    {
+      g_object_unref (task);
+      return;
+    }
+
+  path = index_get_path (uri);
+
+  keyframes = index_load (path);
+  if (keyframes == NULL)
+    {
+      keyframes = index_build (uri, g_task_get_cancellable (task), &error);
+      if (keyframes)
+        index_save (path, keyframes);
+    }
+
+  if (keyframes)
+    {
+      index = g_slice_new (ClutterGstKeyframeIndex);
+      index->uri = g_strdup (uri);
+      index->keyframes = keyframes;
+
+      g_task_return_pointer (task, index,
+                             (GDestroyNotify) _clutter_gst_keyframe_index_free);
+    }
+  else
+    {
+      g_task_return_error (task, error);
+    }
+
+  g_free (path);
+  g_object_unref (task);
+}
+
+/* Loads the key frame index of the local file @uri, building it first if
+ * it's not in the cache */
+void
+_clutter_gst_keyframe_index_load_async (const gchar         *uri,
+                                        GCancellable        *cancellable,
+                                        GAsyncReadyCallback  callback,
+                                        gpointer             user_data)
+{
+  GTask *task;
+
+  task = g_task_new (NULL, cancellable, callback, user_data);
+  g_task_set_task_data (task, g_strdup (uri), g_free);
+
+  G_LOCK (worker);
+
+  if (worker == NULL)
+    worker = g_thread_pool_new (index_worker, NULL, 1, FALSE, NULL);
+
+  g_thread_pool_push (worker, task, NULL);
+
+  G_UNLOCK (worker);
+}
+
+ClutterGstKeyframeIndex *
+_clutter_gst_keyframe_index_load_finish (GAsyncResult  *result,
+                                         GError       **error)
+{
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
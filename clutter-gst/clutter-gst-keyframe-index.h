@@ -0,0 +1,57 @@
+/*
+ * Clutter-GStreamer.
+ *
+ * GStreamer integration library for Clutter.
+ *
+ * clutter-gst-keyframe-index.h - An index of the key frames of local
+ *                                media, built in the background.
+ *
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __CLUTTER_GST_KEYFRAME_INDEX_H__
+#define __CLUTTER_GST_KEYFRAME_INDEX_H__
+
+#include <gio/gio.h>
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+typedef struct _ClutterGstKeyframeIndex ClutterGstKeyframeIndex;
+
+struct _ClutterGstKeyframeIndex
+{
+  gchar *uri;
+  /* the stream time of the key frames of the video, in order */
+  GArray *keyframes;
+};
+
+void                      _clutter_gst_keyframe_index_load_async  (const gchar          *uri,
+                                                                   GCancellable         *cancellable,
+                                                                   GAsyncReadyCallback   callback,
+                                                                   gpointer              user_data);
+ClutterGstKeyframeIndex * _clutter_gst_keyframe_index_load_finish (GAsyncResult         *result,
+                                                                   GError              **error);
+void                      _clutter_gst_keyframe_index_free        (ClutterGstKeyframeIndex *index);
+
+GstClockTime              _clutter_gst_keyframe_index_lookup      (ClutterGstKeyframeIndex *index,
+                                                                   GstClockTime             position);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_GST_KEYFRAME_INDEX_H__ */
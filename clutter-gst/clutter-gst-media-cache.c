@@ -0,0 +1,563 @@
+/*
+ * Clutter-GStreamer.
+ *
+ * GStreamer integration library for Clutter.
+ *
+ * clutter-gst-media-cache.c - A persistent cache of the media downloaded
+ *                             over HTTP, private to the library.
+ *
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * The cache is a directory holding one file per media and an index, a
+ * GKeyFile with one group per media. Groups, and files, are named after the
+ * SHA1 of the URI of the media, the keys of a group being:
+ *
+ *   uri            the URI of the media
+ *   size           the size of the file, in bytes
+ *   etag           the validators sent by the server, if any
+ *   last-modified
+ *   expires        the time, in seconds since the Epoch, until which the
+ *                  file can be used without asking the server. Past it, the
+ *                  file is used once the server says it has not changed,
+ *                  see _clutter_gst_media_cache_revalidated()
+ *   last-access    the time the file was last played, used to evict the
+ *                  least recently used media when the cache is full
+ *
+ * The cache is shared by all the players of the process.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include <glib/gstdio.h>
+#include <gio/gio.h>
+
+#include "clutter-gst-debug.h"
+#include "clutter-gst-media-cache.h"
+
+/* 1 GiB */
+#define DEFAULT_MAX_SIZE    (G_GUINT64_CONSTANT (1) << 30)
+/* how long media are kept when the server doesn't say (in s) */
+#define DEFAULT_FRESHNESS   (24 * 60 * 60)
+
+#define INDEX_NAME          "index"
+/* the index is saved at most this often (in s) */
+#define INDEX_SAVE_DELAY    2
+
+G_LOCK_DEFINE_STATIC (media_cache);
+
+static gchar *cache_dir = NULL;
+static guint64 cache_max_size = DEFAULT_MAX_SIZE;
+static GKeyFile *cache_index = NULL;
+static guint cache_save_id = 0;
+
+static void
+media_cache_load_unlocked (void)
+{
+  gchar *path;
+
+  if (cache_index)
+    return;
+
+  if (cache_dir == NULL)
+    cache_dir = g_build_filename (g_get_user_cache_dir (),
+                                  "clutter-gst", "media", NULL);
+
+  g_mkdir_with_parents (cache_dir, 0700);
+
+  cache_index = g_key_file_new ();
+
+  path = g_build_filename (cache_dir, INDEX_NAME, NULL);
+  g_key_file_load_from_file (cache_index, path, G_KEY_FILE_NONE, NULL);
+  g_free (path);
+}
+
+static void
+media_cache_save_unlocked (void)
+{
+  GError *error = NULL;
+  gchar *path, *data;
+  gsize length;
+
+  if (cache_save_id)
+    {
+      g_source_remove (cache_save_id);
+      cache_save_id = 0;
+    }
+
+  data = g_key_file_to_data (cache_index, &length, NULL);
+  path = g_build_filename (cache_dir, INDEX_NAME, NULL);
+
+  if (!g_file_set_contents (path, data, length, &error))
+    {
+      g_warning ("Could not save the media cache index: %s", error->message);
+      g_error_free (error);
+    }
+
+  g_free (path);
+  g_free (data);
+}
+
+static gboolean
+media_cache_save (gpointer data)
+{
+  G_LOCK (media_cache);
+
+  cache_save_id = 0;
+  if (cache_index)
+    media_cache_save_unlocked ();
+
+  G_UNLOCK (media_cache);
+
+  return FALSE;
+}
+
+/* Every lookup updates the index, saving is delayed so that a burst of
+ * changes saves once */
+static void
+media_cache_schedule_save_unlocked (void)
+{
+  if (cache_save_id == 0)
+    cache_save_id = g_timeout_add_seconds (INDEX_SAVE_DELAY,
+                                           media_cache_save, NULL);
+}
+
+static void
+media_cache_remove_unlocked (const gchar *key)
+{
+  gchar *path;
+
+  CLUTTER_GST_NOTE (MEDIA, "removing %s from the media cache", key);
+
+  path = g_build_filename (cache_dir, key, NULL);
+  g_unlink (path);
+  g_free (path);
+
+  g_key_file_remove_group (cache_index, key, NULL);
+}
+
+/* Evicts the least recently used media until @needed bytes fit in the
+ * cache */
+static void
+media_cache_evict_unlocked (guint64 needed)
+{
+  gchar **keys;
+  guint64 total = 0;
+  gsize i, n_keys;
+
+  keys = g_key_file_get_groups (cache_index, &n_keys);
+
+  for (i = 0; i < n_keys; i++)
+    total += g_key_file_get_uint64 (cache_index, keys[i], "size", NULL);
+
+  while (total + needed > cache_max_size)
+    {
+      gint64 oldest_access = G_MAXINT64;
+      gsize oldest = n_keys;
+
+      for (i = 0; i < n_keys; i++)
+        {
+          gint64 access;
+
+          if (keys[i] == NULL)
+            continue;
+
+          access = g_key_file_get_int64 (cache_index, keys[i],
+                                         "last-access", NULL);
+          if (access < oldest_access)
+            {
+              oldest_access = access;
+              oldest = i;
+            }
+        }
+
+      if (oldest == n_keys)
+        break;
+
+      total -= g_key_file_get_uint64 (cache_index, keys[oldest], "size", NULL);
+      media_cache_remove_unlocked (keys[oldest]);
+
+      g_free (keys[oldest]);
+      keys[oldest] = NULL;
+    }
+
+  for (i = 0; i < n_keys; i++)
+    g_free (keys[i]);
+  g_free (keys);
+}
+
+static gint64
+media_cache_now (void)
+{
+  return g_get_real_time () / G_USEC_PER_SEC;
+}
+
+/* Gets from the HTTP response @headers how long the media can be used
+ * without asking the server, 0 meaning it has to be revalidated every time.
+ * Returns FALSE if the media must not be stored at all */
+static gboolean
+media_cache_get_freshness (const GstStructure *headers,
+                           gint64             *freshness)
+{
+  const gchar *cache_control = NULL, *max_age;
+
+  *freshness = DEFAULT_FRESHNESS;
+
+  if (headers)
+    cache_control = gst_structure_get_string (headers, "Cache-Control");
+
+  if (cache_control == NULL)
+    return TRUE;
+
+  if (strstr (cache_control, "no-store"))
+    return FALSE;
+
+  max_age = strstr (cache_control, "max-age=");
+  if (max_age)
+    *freshness = g_ascii_strtoll (max_age + strlen ("max-age="), NULL, 10);
+
+  /* can be stored, but not used without asking */
+  if (strstr (cache_control, "no-cache"))
+    *freshness = 0;
+
+  *freshness = MAX (*freshness, 0);
+
+  return TRUE;
+}
+
+void
+_clutter_gst_media_cache_set_dir (const gchar *dir)
+{
+  G_LOCK (media_cache);
+
+  /* the changes are saved in the directory they belong to */
+  if (cache_index && cache_save_id)
+    media_cache_save_unlocked ();
+
+  g_free (cache_dir);
+  cache_dir = g_strdup (dir);
+
+  /* reloaded from the new directory on next use */
+  if (cache_index)
+    {
+      g_key_file_free (cache_index);
+      cache_index = NULL;
+    }
+
+  G_UNLOCK (media_cache);
+}
+
+gchar *
+_clutter_gst_media_cache_get_dir (void)
+{
+  gchar *dir;
+
+  G_LOCK (media_cache);
+  media_cache_load_unlocked ();
+  dir = g_strdup (cache_dir);
+  G_UNLOCK (media_cache);
+
+  return dir;
+}
+
+void
+_clutter_gst_media_cache_set_max_size (guint64 max_size)
+{
+  G_LOCK (media_cache);
+
+  cache_max_size = max_size;
+
+  if (cache_index)
+    {
+      media_cache_evict_unlocked (0);
+      media_cache_schedule_save_unlocked ();
+    }
+
+  G_UNLOCK (media_cache);
+}
+
+guint64
+_clutter_gst_media_cache_get_max_size (void)
+{
+  guint64 max_size;
+
+  G_LOCK (media_cache);
+  max_size = cache_max_size;
+  G_UNLOCK (media_cache);
+
+  return max_size;
+}
+
+/* Returns the URI of the cached copy of @uri, if there's one that can be
+ * used without asking the server, or NULL.
+ *
+ * When the copy has expired but the server gave validators for it, NULL is
+ * returned and, if @validators isn't NULL, it's set to the request headers
+ * asking the server whether the media has changed. If it answers it has
+ * not, see _clutter_gst_media_cache_revalidated() */
+gchar *
+_clutter_gst_media_cache_lookup (const gchar   *uri,
+                                 GstStructure **validators)
+{
+  gchar *key, *path, *cached_uri = NULL;
+  gchar *etag, *last_modified;
+  gint64 now;
+
+  if (validators)
+    *validators = NULL;
+
+  key = g_compute_checksum_for_string (G_CHECKSUM_SHA1, uri, -1);
+
+  G_LOCK (media_cache);
+
+  media_cache_load_unlocked ();
+
+  if (!g_key_file_has_group (cache_index, key))
+    goto out;
+
+  now = media_cache_now ();
+  path = g_build_filename (cache_dir, key, NULL);
+
+  if (!g_file_test (path, G_FILE_TEST_IS_REGULAR))
+    {
+      media_cache_remove_unlocked (key);
+    }
+  else if (now < g_key_file_get_int64 (cache_index, key, "expires", NULL))
+    {
+      g_key_file_set_int64 (cache_index, key, "last-access", now);
+      cached_uri = g_filename_to_uri (path, NULL, NULL);
+
+      CLUTTER_GST_NOTE (MEDIA, "%s is in the media cache", uri);
+    }
+  else
+    {
+      etag = g_key_file_get_string (cache_index, key, "etag", NULL);
+      last_modified = g_key_file_get_string (cache_index, key,
+                                             "last-modified", NULL);
+
+      if (etag == NULL && last_modified == NULL)
+        {
+          /* no way to know whether it changed */
+          media_cache_remove_unlocked (key);
+        }
+      else if (validators)
+        {
+          CLUTTER_GST_NOTE (MEDIA, "%s has expired, revalidating it", uri);
+
+          *validators = gst_structure_new_empty ("extra-headers");
+          if (etag)
+            gst_structure_set (*validators,
+                               "If-None-Match", G_TYPE_STRING, etag,
+                               NULL);
+          if (last_modified)
+            gst_structure_set (*validators,
+                               "If-Modified-Since", G_TYPE_STRING,
+                               last_modified,
+                               NULL);
+        }
+
+      g_free (etag);
+      g_free (last_modified);
+    }
+
+  media_cache_schedule_save_unlocked ();
+  g_free (path);
+
+ out:
+  G_UNLOCK (media_cache);
+  g_free (key);
+
+  return cached_uri;
+}
+
+/* The server answered the request with the validators given by
+ * _clutter_gst_media_cache_lookup() that the media has not changed.
+ * @headers are the headers of that response, they tell how long the cached
+ * copy can now be used.
+ *
+ * Returns the URI of the cached copy of @uri, or NULL if the cache doesn't
+ * have it anymore */
+gchar *
+_clutter_gst_media_cache_revalidated (const gchar        *uri,
+                                      const GstStructure *headers)
+{
+  gchar *key, *path, *cached_uri = NULL;
+  gint64 now, freshness;
+
+  key = g_compute_checksum_for_string (G_CHECKSUM_SHA1, uri, -1);
+
+  G_LOCK (media_cache);
+
+  media_cache_load_unlocked ();
+
+  if (!g_key_file_has_group (cache_index, key))
+    goto out;
+
+  if (!media_cache_get_freshness (headers, &freshness))
+    {
+      media_cache_remove_unlocked (key);
+      media_cache_schedule_save_unlocked ();
+      goto out;
+    }
+
+  path = g_build_filename (cache_dir, key, NULL);
+
+  if (g_file_test (path, G_FILE_TEST_IS_REGULAR))
+    {
+      CLUTTER_GST_NOTE (MEDIA, "%s has not changed on the server", uri);
+
+      now = media_cache_now ();
+      g_key_file_set_int64 (cache_index, key, "expires", now + freshness);
+      g_key_file_set_int64 (cache_index, key, "last-access", now);
+      cached_uri = g_filename_to_uri (path, NULL, NULL);
+    }
+  else
+    {
+      media_cache_remove_unlocked (key);
+    }
+
+  media_cache_schedule_save_unlocked ();
+  g_free (path);
+
+ out:
+  G_UNLOCK (media_cache);
+  g_free (key);
+
+  return cached_uri;
+}
+
+/* Moves the completely downloaded @path into the cache as the content of
+ * @uri. @headers are the HTTP response headers, when known. They give the
+ * validators of the media and how long it can be used without asking the
+ * server again.
+ *
+ * Returns TRUE if the cache took the file, otherwise the file is left
+ * untouched */
+gboolean
+_clutter_gst_media_cache_insert (const gchar        *uri,
+                                 const gchar        *path,
+                                 const GstStructure *headers)
+{
+  const gchar *etag = NULL, *last_modified = NULL, *length = NULL;
+  gint64 now, freshness;
+  gchar *key, *cache_path;
+  GStatBuf st;
+  gboolean taken = FALSE;
+
+  if (headers)
+    {
+      etag = gst_structure_get_string (headers, "ETag");
+      last_modified = gst_structure_get_string (headers, "Last-Modified");
+      length = gst_structure_get_string (headers, "Content-Length");
+    }
+
+  if (!media_cache_get_freshness (headers, &freshness))
+    {
+      CLUTTER_GST_NOTE (MEDIA, "%s can't be cached", uri);
+      return FALSE;
+    }
+
+  /* a copy that always has to be revalidated is useless without
+   * validators */
+  if (freshness == 0 && etag == NULL && last_modified == NULL)
+    return FALSE;
+
+  if (g_stat (path, &st) != 0)
+    return FALSE;
+
+  /* only keep complete downloads */
+  if (length && g_ascii_strtoull (length, NULL, 10) != (guint64) st.st_size)
+    {
+      CLUTTER_GST_NOTE (MEDIA, "%s is incomplete", path);
+      return FALSE;
+    }
+
+  G_LOCK (media_cache);
+
+  if ((guint64) st.st_size > cache_max_size)
+    {
+      G_UNLOCK (media_cache);
+      return FALSE;
+    }
+
+  key = g_compute_checksum_for_string (G_CHECKSUM_SHA1, uri, -1);
+
+  media_cache_load_unlocked ();
+
+  /* the new download replaces what we had for that URI */
+  if (g_key_file_has_group (cache_index, key))
+    media_cache_remove_unlocked (key);
+
+  media_cache_evict_unlocked (st.st_size);
+
+  cache_path = g_build_filename (cache_dir, key, NULL);
+
+  if (g_rename (path, cache_path) == 0)
+    {
+      taken = TRUE;
+    }
+  else
+    {
+      GFile *src, *dest;
+
+      /* not on the same file system */
+      src = g_file_new_for_path (path);
+      dest = g_file_new_for_path (cache_path);
+      taken = g_file_copy (src, dest, G_FILE_COPY_OVERWRITE,
+                           NULL, NULL, NULL, NULL);
+      g_object_unref (src);
+      g_object_unref (dest);
+
+      if (taken)
+        g_unlink (path);
+    }
+
+  if (taken)
+    {
+      CLUTTER_GST_NOTE (MEDIA, "adding %s to the media cache (%"
+                        G_GUINT64_FORMAT " bytes)", uri, (guint64) st.st_size);
+
+      now = media_cache_now ();
+
+      g_key_file_set_string (cache_index, key, "uri", uri);
+      g_key_file_set_uint64 (cache_index, key, "size", st.st_size);
+      if (etag)
+        g_key_file_set_string (cache_index, key, "etag", etag);
+      if (last_modified)
+        g_key_file_set_string (cache_index, key, "last-modified",
+                               last_modified);
+      g_key_file_set_int64 (cache_index, key, "expires", now + freshness);
+      g_key_file_set_int64 (cache_index, key, "last-access", now);
+
+      /* not delayed, a file missing from the index would never be
+       * evicted */
+      media_cache_save_unlocked ();
+    }
+
+  G_UNLOCK (media_cache);
+
+  g_free (cache_path);
+  g_free (key);
+
+  return taken;
+}
@@ -0,0 +1,49 @@
+/*
+ * Clutter-GStreamer.
+ *
+ * GStreamer integration library for Clutter.
+ *
+ * clutter-gst-media-cache.h - A persistent cache of the media downloaded
+ *                             over HTTP, private to the library.
+ *
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __CLUTTER_GST_MEDIA_CACHE_H__
+#define __CLUTTER_GST_MEDIA_CACHE_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+void          _clutter_gst_media_cache_set_dir      (const gchar        *dir);
+gchar *       _clutter_gst_media_cache_get_dir      (void);
+void          _clutter_gst_media_cache_set_max_size (guint64             max_size);
+guint64       _clutter_gst_media_cache_get_max_size (void);
+
+gchar *       _clutter_gst_media_cache_lookup       (const gchar        *uri,
+                                                     GstStructure      **validators);
+gchar *       _clutter_gst_media_cache_revalidated  (const gchar        *uri,
+                                                     const GstStructure *headers);
+gboolean      _clutter_gst_media_cache_insert       (const gchar        *uri,
+                                                     const gchar        *path,
+                                                     const GstStructure *headers);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_GST_MEDIA_CACHE_H__ */
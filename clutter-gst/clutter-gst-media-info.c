@@ -0,0 +1,667 @@
+/*
+ * Clutter-GStreamer.
+ *
+ * GStreamer integration library for Clutter.
+ *
+ * clutter-gst-media-info.c - Asynchronous discovery of the properties
+ *                           of media.
+ *
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * SECTION:clutter-gst-media-info
+ * @short_description: Asynchronous discovery of the properties of media
+ *
+ * #ClutterGstMediaInfo gives the duration, the streams and whether a media
+ * can be seeked in without creating a #ClutterGstPlayer, and without the
+ * cost of pre-rolling a full playback pipeline. Use it to show the
+ * properties of many media, in a media browser for instance.
+ *
+ * The properties are the ones a #ClutterGstPlayer exposes once the media is
+ * loaded: the duration in seconds and the #GstTagList of each audio stream
+ * and subtitle track, in the same order as #ClutterGstPlayer:audio-streams
+ * and #ClutterGstPlayer:subtitle-tracks.
+ *
+ * Media are discovered by a pool of worker threads, see
+ * clutter_gst_media_info_set_max_workers(). The properties of local files
+ * are kept in a cache on disk, and reused as long as the file isn't
+ * modified.
+ */
+
+/*
+ * The cache is a GKeyFile with one group per file, named after the SHA1 of
+ * the URI of the file. The keys of a group are:
+ *
+ *   uri              the URI of the file
+ *   mtime            the modification time of the file when it was
+ *                    discovered, in seconds since the Epoch
+ *   duration         in seconds
+ *   can-seek
+ *   audio-streams    a list of serialized tag lists, an empty string for a
+ *   subtitle-tracks  stream without tags
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include <gst/pbutils/pbutils.h>
+
+#include "clutter-gst-debug.h"
+#include "clutter-gst-media-info.h"
+
+/* how long discovering a media can take (in ns) */
+#define DISCOVER_TIMEOUT        (10 * GST_SECOND)
+#define DEFAULT_MAX_WORKERS     4
+
+/* number of media kept in the cache, the oldest entries are dropped */
+#define CACHE_MAX_ENTRIES       16384
+/* the cache is saved at most this often (in s) */
+#define CACHE_SAVE_DELAY        2
+
+struct _ClutterGstMediaInfo
+{
+  volatile gint ref_count;
+
+  gchar *uri;
+  gdouble duration;
+  gboolean can_seek;
+  GList *audio_streams;
+  GList *subtitle_tracks;
+};
+
+G_DEFINE_BOXED_TYPE (ClutterGstMediaInfo, clutter_gst_media_info,
+                     clutter_gst_media_info_ref,
+                     clutter_gst_media_info_unref)
+
+G_LOCK_DEFINE_STATIC (workers);
+static GThreadPool *workers = NULL;
+static guint max_workers = DEFAULT_MAX_WORKERS;
+
+/* each worker has a discoverer of its own */
+static GPrivate worker_discoverer = G_PRIVATE_INIT (g_object_unref);
+
+G_LOCK_DEFINE_STATIC (info_cache);
+static GKeyFile *info_cache = NULL;
+static gchar *info_cache_path = NULL;
+static guint info_cache_save_id = 0;
+
+static ClutterGstMediaInfo *
+media_info_new (const gchar *uri)
+{
+  ClutterGstMediaInfo *info;
+
+  info = g_slice_new0 (ClutterGstMediaInfo);
+  info->ref_count = 1;
+  info->uri = g_strdup (uri);
+
+  return info;
+}
+
+static void
+free_tags (gpointer data)
+{
+  if (data)
+    gst_tag_list_unref (data);
+}
+
+/* Tags lists */
+
+static GList *
+tags_from_streams (GList *streams)
+{
+  GList *l, *tags = NULL;
+
+  for (l = streams; l; l = l->next)
+    {
+      const GstTagList *stream_tags;
+
+      stream_tags = gst_discoverer_stream_info_get_tags (l->data);
+      tags = g_list_prepend (tags, stream_tags ?
+                             gst_tag_list_copy (stream_tags) : NULL);
+    }
+
+  gst_discoverer_stream_info_list_free (streams);
+
+  return g_list_reverse (tags);
+}
+
+static gchar **
+tags_to_strv (GList *tags)
+{
+  gchar **strv;
+  guint i;
+
+  strv = g_new0 (gchar *, g_list_length (tags) + 1);
+
+  for (i = 0; tags; tags = tags->next, i++)
+    strv[i] = tags->data ? gst_tag_list_to_string (tags->data) : g_strdup ("");
+
+  return strv;
+}
+
+static GList *
+tags_from_strv (gchar **strv)
+{
+  GList *tags = NULL;
+  guint i;
+
+  for (i = 0; strv && strv[i]; i++)
+    tags = g_list_prepend (tags, *strv[i] ?
+                           gst_tag_list_new_from_string (strv[i]) : NULL);
+
+  return g_list_reverse (tags);
+}
+
+/* Cache */
+
+static void
+info_cache_load_unlocked (void)
+{
+  gchar *dir;
+
+  if (info_cache)
+    return;
+
+  dir = g_build_filename (g_get_user_cache_dir (), "clutter-gst", NULL);
+  g_mkdir_with_parents (dir, 0700);
+  info_cache_path = g_build_filename (dir, "media-info", NULL);
+  g_free (dir);
+
+  info_cache = g_key_file_new ();
+  g_key_file_load_from_file (info_cache, info_cache_path,
+                             G_KEY_FILE_NONE, NULL);
+}
+
+static gboolean
+info_cache_save (gpointer data)
+{
+  GError *error = NULL;
+  gchar *contents;
+  gsize length;
+
+  G_LOCK (info_cache);
+
+  contents = g_key_file_to_data (info_cache, &length, NULL);
+  if (!g_file_set_contents (info_cache_path, contents, length, &error))
+    {
+      g_warning ("Could not save the media information cache: %s",
+                 error->message);
+      g_error_free (error);
+    }
+  g_free (contents);
+
+  info_cache_save_id = 0;
+
+  G_UNLOCK (info_cache);
+
+  return FALSE;
+}
+
+static ClutterGstMediaInfo *
+info_cache_lookup (const gchar *uri,
+                   guint64      mtime)
+{
+  ClutterGstMediaInfo *info = NULL;
+  gchar *key, **strv;
+
+  key = g_compute_checksum_for_string (G_CHECKSUM_SHA1, uri, -1);
+
+  G_LOCK (info_cache);
+
+  info_cache_load_unlocked ();
+
+  if (g_key_file_has_group (info_cache, key) &&
+      g_key_file_get_uint64 (info_cache, key, "mtime", NULL) == mtime)
+    {
+      info = media_info_new (uri);
+      info->duration = g_key_file_get_double (info_cache, key,
+                                              "duration", NULL);
+      info->can_seek = g_key_file_get_boolean (info_cache, key,
+                                               "can-seek", NULL);
+
+      strv = g_key_file_get_string_list (info_cache, key,
+                                         "audio-streams", NULL, NULL);
+      info->audio_streams = tags_from_strv (strv);
+      g_strfreev (strv);
+
+      strv = g_key_file_get_string_list (info_cache, key,
+                                         "subtitle-tracks", NULL, NULL);
+      info->subtitle_tracks = tags_from_strv (strv);
+      g_strfreev (strv);
+    }
+
+  G_UNLOCK (info_cache);
+
+  g_free (key);
+
+  return info;
+}
+
+static void
+info_cache_store (ClutterGstMediaInfo *info,
+                  guint64              mtime)
+{
+  gchar *key, **strv, **groups;
+  gsize n_groups, i;
+
+  key = g_compute_checksum_for_string (G_CHECKSUM_SHA1, info->uri, -1);
+
+  G_LOCK (info_cache);
+
+  info_cache_load_unlocked ();
+
+  /* an updated entry goes to the end, with the newest ones */
+  g_key_file_remove_group (info_cache, key, NULL);
+
+  groups = g_key_file_get_groups (info_cache, &n_groups);
+  for (i = 0; i + CACHE_MAX_ENTRIES <= n_groups; i++)
+    g_key_file_remove_group (info_cache, groups[i], NULL);
+  g_strfreev (groups);
+
+  g_key_file_set_string (info_cache, key, "uri", info->uri);
+  g_key_file_set_uint64 (info_cache, key, "mtime", mtime);
+  g_key_file_set_double (info_cache, key, "duration", info->duration);
+  g_key_file_set_boolean (info_cache, key, "can-seek", info->can_seek);
+
+  strv = tags_to_strv (info->audio_streams);
+  g_key_file_set_string_list (info_cache, key, "audio-streams",
+                              (const gchar * const *) strv,
+                              g_strv_length (strv));
+  g_strfreev (strv);
+
+  strv = tags_to_strv (info->subtitle_tracks);
+  g_key_file_set_string_list (info_cache, key, "subtitle-tracks",
+                              (const gchar * const *) strv,
+                              g_strv_length (strv));
+  g_strfreev (strv);
+
+  /* saving is delayed so that a burst of discoveries saves once */
+  if (info_cache_save_id == 0)
+    info_cache_save_id = g_timeout_add_seconds (CACHE_SAVE_DELAY,
+                                                info_cache_save, NULL);
+
+  G_UNLOCK (info_cache);
+
+  g_free (key);
+}
+
+/* Discovery */
+
+/* Returns the modification time of @uri if it's a local file, 0 otherwise.
+ * Only local files are cached */
+static guint64
+get_mtime (const gchar *uri)
+{
+  GFileInfo *file_info;
+  GFile *file;
+  guint64 mtime = 0;
+
+  if (!g_str_has_prefix (uri, "file:"))
+    return 0;
+
+  file = g_file_new_for_uri (uri);
+  file_info = g_file_query_info (file, G_FILE_ATTRIBUTE_TIME_MODIFIED,
+                                 G_FILE_QUERY_INFO_NONE, NULL, NULL);
+  if (file_info)
+    {
+      mtime = g_file_info_get_attribute_uint64 (file_info,
+                                                G_FILE_ATTRIBUTE_TIME_MODIFIED);
+      g_object_unref (file_info);
+    }
+  g_object_unref (file);
+
+  return mtime;
+}
+
+static ClutterGstMediaInfo *
+discover (const gchar  *uri,
+          GError      **error)
+{
+  GstDiscoverer *discoverer;
+  GstDiscovererInfo *discoverer_info;
+  GstDiscovererResult result;
+  ClutterGstMediaInfo *info = NULL;
+  GError *discover_error = NULL;
+
+  discoverer = g_private_get (&worker_discoverer);
+  if (discoverer == NULL)
+    {
+      discoverer = gst_discoverer_new (DISCOVER_TIMEOUT, error);
+      if (discoverer == NULL)
+        return NULL;
+
+      g_private_set (&worker_discoverer, discoverer);
+    }
+
+  CLUTTER_GST_NOTE (MEDIA, "discovering %s", uri);
+
+  discoverer_info = gst_discoverer_discover_uri (discoverer, uri,
+                                                 &discover_error);
+  result = discoverer_info ? gst_discoverer_info_get_result (discoverer_info)
+                           : GST_DISCOVERER_ERROR;
+
+  if (result == GST_DISCOVERER_OK)
+    {
+      info = media_info_new (uri);
+      info->duration = (gdouble)
+        gst_discoverer_info_get_duration (discoverer_info) / GST_SECOND;
+      info->can_seek = gst_discoverer_info_get_seekable (discoverer_info);
+      info->audio_streams = tags_from_streams
+        (gst_discoverer_info_get_audio_streams (discoverer_info));
+      info->subtitle_tracks = tags_from_streams
+        (gst_discoverer_info_get_subtitle_streams (discoverer_info));
+    }
+  else if (discover_error)
+    {
+      g_propagate_error (error, discover_error);
+      discover_error = NULL;
+    }
+  else
+    {
+      g_set_error (error, GST_CORE_ERROR, GST_CORE_ERROR_FAILED,
+                   "Could not discover %s", uri);
+    }
+
+  g_clear_error (&discover_error);
+  if (discoverer_info)
+    gst_discoverer_info_unref (discoverer_info);
+
+  return info;
+}
+
+static void
+discover_worker (gpointer data,
+                 gpointer user_data)
+{
+  GTask *task = data;
+  const gchar *uri = g_task_get_task_data (task);
+  ClutterGstMediaInfo *info;
+  GError *error = NULL;
+  guint64 mtime;
+
+  if (g_task_return_error_if_cancelled (task))
+    {
+      g_object_unref (task);
+      return;
+    }
+
+  mtime = get_mtime (uri);
+
+  info = mtime ? info_cache_lookup (uri, mtime) : NULL;
+  if (info)
+    {
+      CLUTTER_GST_NOTE (MEDIA, "%s is in the media information cache", uri);
+    }
+  else
+    {
+      info = discover (uri, &error);
+      if (info && mtime)
+        info_cache_store (info, mtime);
+    }
+
+  if (info)
+    g_task_return_pointer (task, info,
+                           (GDestroyNotify) clutter_gst_media_info_unref);
+  else
+    g_task_return_error (task, error);
+
+  g_object_unref (task);
+}
+
+/**
+ * clutter_gst_media_info_discover_async:
+ * @uri: the URI of a media
+ * @cancellable: (allow-none): a #GCancellable, or NULL
+ * @callback: a #GAsyncReadyCallback to call when the media is discovered
+ * @user_data: the data to pass to @callback
+ *
+ * Discovers the properties of the media at @uri in a worker thread, or
+ * gets them from the cache. @callback is called in the thread-default main
+ * context of the caller. Call clutter_gst_media_info_discover_finish()
+ * from it to get the result.
+ *
+ * Since: 2.2
+ */
+void
+clutter_gst_media_info_discover_async (const gchar         *uri,
+                                       GCancellable        *cancellable,
+                                       GAsyncReadyCallback  callback,
+                                       gpointer             user_data)
+{
+  GTask *task;
+
+  g_return_if_fail (uri != NULL);
+
+  task = g_task_new (NULL, cancellable, callback, user_data);
+  g_task_set_task_data (task, g_strdup (uri), g_free);
+
+  G_LOCK (workers);
+
+  if (workers == NULL)
+    workers = g_thread_pool_new (discover_worker, NULL, max_workers,
+                                 FALSE, NULL);
+
+  g_thread_pool_push (workers, task, NULL);
+
+  G_UNLOCK (workers);
+}
+
+/**
+ * clutter_gst_media_info_discover_finish:
+ * @result: the #GAsyncResult given to the callback of
+ *   clutter_gst_media_info_discover_async()
+ * @error: return location for a #GError, or NULL
+ *
+ * Finishes the discovery of a media started with
+ * clutter_gst_media_info_discover_async().
+ *
+ * Return value: (transfer full): the properties of the media, or NULL if
+ *   they couldn't be discovered. Use clutter_gst_media_info_unref() when
+ *   you're done with it
+ *
+ * Since: 2.2
+ */
+ClutterGstMediaInfo *
+clutter_gst_media_info_discover_finish (GAsyncResult  *result,
+                                        GError       **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, NULL), NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
+/**
+ * clutter_gst_media_info_get_max_workers:
+ *
+ * Gets the maximum number of media discovered at the same time.
+ *
+ * Return value: the maximum number of worker threads
+ *
+ * Since: 2.2
+ */
+guint
+clutter_gst_media_info_get_max_workers (void)
+{
+  return max_workers;
+}
+
+/**
+ * clutter_gst_media_info_set_max_workers:
+ * @max_workers: the maximum number of worker threads
+ *
+ * Sets the maximum number of media discovered at the same time, each in a
+ * worker thread of its own. Defaults to 4.
+ *
+ * Since: 2.2
+ */
+void
+clutter_gst_media_info_set_max_workers (guint max_workers_)
+{
+  g_return_if_fail (max_workers_ > 0);
+
+  G_LOCK (workers);
+
+  max_workers = max_workers_;
+  if (workers)
+    g_thread_pool_set_max_threads (workers, max_workers, NULL);
+
+  G_UNLOCK (workers);
+}
+
+/**
+ * clutter_gst_media_info_ref:
+ * @info: a #ClutterGstMediaInfo
+ *
+ * Increases the reference count of @info.
+ *
+ * Return value: (transfer full): @info
+ *
+ * Since: 2.2
+ */
+ClutterGstMediaInfo *
+clutter_gst_media_info_ref (ClutterGstMediaInfo *info)
+{
+  g_return_val_if_fail (info != NULL, NULL);
+
+  g_atomic_int_inc (&info->ref_count);
+
+  return info;
+}
+
+/**
+ * clutter_gst_media_info_unref:
+ * @info: a #ClutterGstMediaInfo
+ *
+ * Decreases the reference count of @info, and frees it when it reaches 0.
+ *
+ * Since: 2.2
+ */
+void
+clutter_gst_media_info_unref (ClutterGstMediaInfo *info)
+{
+  g_return_if_fail (info != NULL);
+
+  if (!g_atomic_int_dec_and_test (&info->ref_count))
+    return;
+
+  g_free (info->uri);
+  g_list_free_full (info->audio_streams, free_tags);
+  g_list_free_full (info->subtitle_tracks, free_tags);
+  g_slice_free (ClutterGstMediaInfo, info);
+}
+
+/**
+ * clutter_gst_media_info_get_uri:
+ * @info: a #ClutterGstMediaInfo
+ *
+ * Gets the URI of the media.
+ *
+ * Return value: the URI of the media
+ *
+ * Since: 2.2
+ */
+const gchar *
+clutter_gst_media_info_get_uri (ClutterGstMediaInfo *info)
+{
+  g_return_val_if_fail (info != NULL, NULL);
+
+  return info->uri;
+}
+
+/**
+ * clutter_gst_media_info_get_duration:
+ * @info: a #ClutterGstMediaInfo
+ *
+ * Gets the duration of the media, like #ClutterMedia:duration.
+ *
+ * Return value: the duration of the media in seconds
+ *
+ * Since: 2.2
+ */
+gdouble
+clutter_gst_media_info_get_duration (ClutterGstMediaInfo *info)
+{
+  g_return_val_if_fail (info != NULL, 0.0);
+
+  return info->duration;
+}
+
+/**
+ * clutter_gst_media_info_get_can_seek:
+ * @info: a #ClutterGstMediaInfo
+ *
+ * Whether the media can be seeked in, like #ClutterMedia:can-seek.
+ *
+ * Return value: TRUE if the media can be seeked in
+ *
+ * Since: 2.2
+ */
+gboolean
+clutter_gst_media_info_get_can_seek (ClutterGstMediaInfo *info)
+{
+  g_return_val_if_fail (info != NULL, FALSE);
+
+  return info->can_seek;
+}
+
+/**
+ * clutter_gst_media_info_get_audio_streams:
+ * @info: a #ClutterGstMediaInfo
+ *
+ * Gets the audio streams of the media, like
+ * clutter_gst_player_get_audio_streams().
+ *
+ * Return value: (transfer none) (element-type GstTagList): a list of
+ *   #GstTagList, one per audio stream, possibly NULL when a stream has no
+ *   tags
+ *
+ * Since: 2.2
+ */
+GList *
+clutter_gst_media_info_get_audio_streams (ClutterGstMediaInfo *info)
+{
+  g_return_val_if_fail (info != NULL, NULL);
+
+  return info->audio_streams;
+}
+
+/**
+ * clutter_gst_media_info_get_subtitle_tracks:
+ * @info: a #ClutterGstMediaInfo
+ *
+ * Gets the subtitle tracks embedded in the media, like
+ * clutter_gst_player_get_subtitle_tracks(). External subtitle files aren't
+ * part of it.
+ *
+ * Return value: (transfer none) (element-type GstTagList): a list of
+ *   #GstTagList, one per subtitle track, possibly NULL when a track has no
+ *   tags
+ *
+ * Since: 2.2
+ */
+GList *
+clutter_gst_media_info_get_subtitle_tracks (ClutterGstMediaInfo *info)
+{
+  g_return_val_if_fail (info != NULL, NULL);
+
+  return info->subtitle_tracks;
+}
@@ -0,0 +1,65 @@
+/*
+ * Clutter-GStreamer.
+ *
+ * GStreamer integration library for Clutter.
+ *
+ * clutter-gst-media-info.h - Asynchronous discovery of the properties
+ *                           of media.
+ *
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#if !defined(__CLUTTER_GST_H_INSIDE__) && !defined(CLUTTER_GST_COMPILATION)
+#error "Only <clutter-gst/clutter-gst.h> can be included directly."
+#endif
+
+#ifndef __CLUTTER_GST_MEDIA_INFO_H__
+#define __CLUTTER_GST_MEDIA_INFO_H__
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define CLUTTER_GST_TYPE_MEDIA_INFO (clutter_gst_media_info_get_type ())
+
+typedef struct _ClutterGstMediaInfo ClutterGstMediaInfo;
+
+GType                 clutter_gst_media_info_get_type            (void) G_GNUC_CONST;
+
+ClutterGstMediaInfo * clutter_gst_media_info_ref                 (ClutterGstMediaInfo  *info);
+void                  clutter_gst_media_info_unref               (ClutterGstMediaInfo  *info);
+
+const gchar *         clutter_gst_media_info_get_uri             (ClutterGstMediaInfo  *info);
+gdouble               clutter_gst_media_info_get_duration        (ClutterGstMediaInfo  *info);
+gboolean              clutter_gst_media_info_get_can_seek        (ClutterGstMediaInfo  *info);
+GList *               clutter_gst_media_info_get_audio_streams   (ClutterGstMediaInfo  *info);
+GList *               clutter_gst_media_info_get_subtitle_tracks (ClutterGstMediaInfo  *info);
+
+void                  clutter_gst_media_info_discover_async      (const gchar          *uri,
+                                                                  GCancellable         *cancellable,
+                                                                  GAsyncReadyCallback   callback,
+                                                                  gpointer              user_data);
+ClutterGstMediaInfo * clutter_gst_media_info_discover_finish     (GAsyncResult         *result,
+                                                                  GError              **error);
+
+guint                 clutter_gst_media_info_get_max_workers     (void);
+void                  clutter_gst_media_info_set_max_workers     (guint                 max_workers);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_GST_MEDIA_INFO_H__ */
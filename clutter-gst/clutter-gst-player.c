@@ -47,15 +47,22 @@
 
 #include <string.h>
 
+#include <glib/gstdio.h>
+#include <gst/base/gstbasesrc.h>
 #include <gst/video/video.h>
 #include <gst/tag/tag.h>
 #include <gst/audio/streamvolume.h>
 
+#include "clutter-gst-audio-mixer.h"
+#include "clutter-gst-bus-dispatcher.h"
 #include "clutter-gst-debug.h"
 #include "clutter-gst-enum-types.h"
+#include "clutter-gst-keyframe-index.h"
 #include "clutter-gst-marshal.h"
+#include "clutter-gst-media-cache.h"
 #include "clutter-gst-player.h"
 #include "clutter-gst-private.h"
+#include "clutter-gst-video-sink.h"
 
 #if defined (CLUTTER_WINDOWING_X11) && defined (HAVE_HW_DECODER_SUPPORT)
 #define GST_USE_UNSTABLE_API 1
@@ -80,15 +87,54 @@ G_DEFINE_INTERFACE_WITH_CODE (ClutterGstPlayer, clutter_gst_player, G_TYPE_OBJEC
 
 /* idle timeouts (in ms) */
 #define TICK_TIMEOUT        500
-#define BUFFERING_TIMEOUT   250
+
+/* default amount of media, in seconds, to download before playing when doing
+ * download buffering */
+#define DEFAULT_BUFFERING_TARGET 2.0
+
+/* default buffer-fill under which playback pauses, and from which it resumes
+ * when doing stream buffering */
+#define DEFAULT_BUFFERING_LOW_WATERMARK   0.1
+#define DEFAULT_BUFFERING_HIGH_WATERMARK  1.0
+
+/* smallest limit, in bytes, given to a queue when applying a memory budget,
+ * under it queues can't even hold a single HD frame */
+#define MEMORY_BUDGET_MIN_QUEUE_SIZE      (256 * 1024)
+
+/* decoded frames kept around the position when stepping */
+#define DEFAULT_FRAME_CACHE_SIZE          16
+
+/* how long the size of the player on the stage has to be stable before the
+ * adaptive streams are capped to it (in ms) */
+#define ADAPTIVE_UPDATE_DELAY             200
+
+/* how long the video sink has to be hidden before video decoding is
+ * disabled (in ms) */
+#define DEFAULT_HIDDEN_GRACE_PERIOD       10000
+
+/* the bus messages the player handles, the others are dropped when using
+ * the shared bus dispatcher */
+#define PLAYER_BUS_MESSAGES (GST_MESSAGE_ERROR | GST_MESSAGE_EOS |           \
+                             GST_MESSAGE_BUFFERING |                         \
+                             GST_MESSAGE_DURATION_CHANGED |                  \
+                             GST_MESSAGE_STATE_CHANGED |                     \
+                             GST_MESSAGE_ASYNC_DONE |                        \
+                             GST_MESSAGE_SEGMENT_DONE |                      \
+                             GST_MESSAGE_STREAM_START |                      \
+                             GST_MESSAGE_STEP_DONE |                         \
+                             GST_MESSAGE_ELEMENT |                           \
+                             GST_MESSAGE_APPLICATION)
 
 enum
 {
   DOWNLOAD_BUFFERING,
+  URI_LOADED,
 
   LAST_SIGNAL
 };
 
+/* The classes implementing ClutterGstPlayer share their property IDs with
+ * the ones below, IDs up to 63 are reserved for the player */
 enum
 {
   PROP_0,
@@ -112,7 +158,24 @@ enum
   PROP_AUDIO_STREAM,
   PROP_SUBTITLE_TRACKS,
   PROP_SUBTITLE_TRACK,
-  PROP_IN_SEEK
+  PROP_IN_SEEK,
+  PROP_LOOP,
+  PROP_ASYNC_STATE_CHANGES,
+  PROP_BUFFERING_TARGET,
+  PROP_BUFFERING_LOW_WATERMARK,
+  PROP_BUFFERING_HIGH_WATERMARK,
+  PROP_BUFFERING_TIME_LEFT,
+  PROP_TIMESHIFT_SIZE,
+  PROP_USE_MEDIA_CACHE,
+  PROP_MEMORY_BUDGET,
+  PROP_SHARED_AUDIO,
+  PROP_AUDIO_ENABLED,
+  PROP_FRAME_CACHE_SIZE,
+  PROP_USE_KEYFRAME_INDEX,
+  PROP_NATIVE_VIDEO,
+  PROP_ADAPT_STREAMS_TO_SIZE,
+  PROP_THROTTLE_HIDDEN,
+  PROP_HIDDEN_GRACE_PERIOD
 };
 
 struct _ClutterGstPlayerIfacePrivate
@@ -143,6 +206,26 @@ typedef enum {
   GST_PLAY_FLAG_DEINTERLACE   = (1 << 9)
 } GstPlayFlags;
 
+/* Changes signalled by playbin from its threads, see
+ * player_queue_change() */
+typedef enum {
+  PLAYER_CHANGE_VOLUME            = (1 << 0),
+  PLAYER_CHANGE_AUDIO_STREAMS     = (1 << 1),
+  PLAYER_CHANGE_AUDIO_STREAM      = (1 << 2),
+  PLAYER_CHANGE_SUBTITLE_TRACKS   = (1 << 3),
+  PLAYER_CHANGE_SUBTITLE_TRACK    = (1 << 4)
+} ClutterGstPlayerChange;
+
+/* The player as seen from GStreamer's threads. Their callbacks can be
+ * running, or about to run, while the player is deinitialized: they only
+ * touch the player with the lock held, and player is NULL once it's gone */
+typedef struct _ClutterGstPlayerRef
+{
+  volatile gint ref_count;
+  GRecMutex lock;
+  ClutterGstPlayer *player;
+} ClutterGstPlayerRef;
+
 struct _ClutterGstPlayerPrivate
 {
   GObject parent;
@@ -159,10 +242,15 @@ struct _ClutterGstPlayerPrivate
   guint in_error : 1;
   guint in_eos : 1;
   guint in_download_buffering : 1;
+  /* the pipeline has been paused to fill the buffer in stream buffering
+   * mode */
+  guint in_stream_buffering : 1;
   /* when in progressive download, we use the buffer-fill property to signal
    * that we have enough data to play the stream. This flag allows to send
    * the notify that buffer-fill is 1.0 only once */
   guint virtual_stream_buffer_signalled : 1;
+  /* the bus messages go through the shared bus dispatcher */
+  guint shared_bus : 1;
 
   gdouble stacked_progress;
 
@@ -170,7 +258,7 @@ struct _ClutterGstPlayerPrivate
   GstState target_state;
 
   guint tick_timeout_id;
-  guint buffering_timeout_id;
+  guint buffering_update_id;
 
   /* This is a cubic volume, suitable for use in a UI cf. StreamVolume doc */
   gdouble volume;
@@ -182,18 +270,227 @@ struct _ClutterGstPlayerPrivate
 
   GstSeekFlags seek_flags;    /* flags for the seek in set_progress(); */
 
+  /* seamless looping, the pipeline is kept in segment mode and we loop on
+   * SEGMENT_DONE with a non flushing seek. loop_stop < 0 means "until the
+   * end of the media" */
+  gboolean loop;
+  gdouble loop_start;
+  gdouble loop_stop;
+
   GstElement *download_buffering_element;
+  /* ranges of the media downloaded so far, and how many seconds after the
+   * playback position need to be downloaded before playing */
+  GArray *buffered_ranges;
+  gdouble buffering_target;
+
+  /* stream buffering: the buffer-fill thresholds to pause and resume
+   * playback, the last output rate measured while playing (in bytes/s)
+   * and the estimated time before playback can resume (in s) */
+  gdouble buffering_low_watermark;
+  gdouble buffering_high_watermark;
+  gint avg_out_rate;
+  gdouble buffering_time_left;
+
+  /* size, in bytes, of the ring buffer used to pause and rewind live
+   * streams. 0 disables timeshift */
+  guint64 timeshift_size;
+  /* live source and network queue left playing while the pipeline is
+   * paused, see player_update_timeshift() */
+  GstElement *timeshift_source;
+  GstElement *timeshift_queue;
+
+  /* media cache: the response headers and status code of the HTTP source,
+   * 0 when it didn't give one, and the file queue2 downloads the media to */
+  gboolean use_media_cache;
+  GstStructure *http_headers;
+  guint http_status;
+  gchar *download_temp_location;
+  /* the URI whose expired copy in the cache is being revalidated, and the
+   * request headers asking the server about it. Used from the streaming
+   * threads, under the lock of priv->ref */
+  gchar *revalidate_uri;
+  GstStructure *revalidate_headers;
+
+  /* bytes the queues of the pipeline may hold, 0 = no limit. See
+   * player_get_memory_budget() for the budget actually applied, and
+   * whether the queues have limits other than their defaults */
+  guint64 memory_budget;
+  gboolean memory_budget_applied;
+
+  /* shared audio output: the audio goes to the process-wide mixer through
+   * audio_channel. Audio isn't decoded when audio_enabled is FALSE, nor
+   * when muted while using the shared output */
+  gboolean shared_audio;
+  gboolean audio_enabled;
+  gchar *audio_channel;
 
   GList *audio_streams;
   GList *subtitle_tracks;
+
+  /* ClutterGstPlayerChange flags waiting for player_dispatch_changes(),
+   * set from the streaming threads */
+  volatile guint pending_changes;
+
+  /* gapless playback: URIs to play after the current one, and the URI given
+   * to playbin from about-to-finish, waiting for its stream-start. Both are
+   * accessed from the streaming threads */
+  GMutex queue_lock;
+  GQueue uri_queue;
+  gchar *next_uri;
+
+  /* pre-rolled pipelines, most recently used first. See
+   * clutter_gst_player_preroll_uri() */
+  GList *standby_pipelines;
+  guint max_standby_pipelines;
+
+  /* asynchronous state changes: the transitions are run, in order, by a
+   * worker thread. async_state is the state the last queued transition
+   * brings the pipeline to */
+  gboolean async_state_changes;
+  GThreadPool *state_worker;
+  guint pending_transitions;
+  GstState async_state;
+
+  /* given to the callbacks run from GStreamer's threads instead of the
+   * player, see player_ref_lock() */
+  ClutterGstPlayerRef *ref;
+
+  /* cancels the lookup of the subtitle file of the current URI */
+  GCancellable *subtitle_cancellable;
+  /* subtitle file found once the current URI was already opened, used the
+   * next time it's opened, see player_apply_subtitle() */
+  gchar *pending_suburi;
+
+  /* frame stepping: a contiguous run of decoded frames, in presentation
+   * order, the last one being the frame the pipeline is on. shown_frame is
+   * the link of the frame shown when it's an earlier one. When stepping
+   * back past the first frame, the frames from the previous key frame are
+   * decoded again until step_back_target. See clutter_gst_player_step_back()
+   */
+  GQueue frame_cache;
+  guint frame_cache_size;
+  GList *shown_frame;
+  gboolean in_step;
+  gboolean in_step_seek;
+  GstClockTime step_back_target;
+  /* basesink posts step-done before it pre-rolls the frame it stepped to,
+   * the step is over with the async-done of that preroll */
+  gboolean in_step_preroll;
+
+  /* key frame index of the current local file. With it, an accurate seek
+   * while paused goes to the key frame before the position, then steps
+   * forward to seek_step_target */
+  gboolean use_keyframe_index;
+  GCancellable *keyframe_index_cancellable;
+  ClutterGstKeyframeIndex *keyframe_index;
+  GstClockTime seek_step_target;
+  gboolean in_seek_step;
+
+  /* decoders negotiate with the sink directly, unless that failed for the
+   * current media */
+  gboolean native_video;
+  gboolean native_video_failed;
+
+  /* the pipeline is reopened in place by player_reopen(). Until the
+   * pipeline posts the marker of the last reopen, the errors on the bus are
+   * from before it and dropped */
+  guint reopen_generation;
+  guint reopened_generation;
+
+  /* the variants of adaptive streams are capped to the size the player has
+   * on the stage, 0 when not capped */
+  gboolean adapt_streams;
+  guint adaptive_update_id;
+  gint adaptive_max_width;
+  gint adaptive_max_height;
+
+  /* the video sink skips the frames of a hidden texture, and video
+   * decoding is disabled when it stays hidden for hidden_grace_period ms,
+   * until hidden_texture is painted again */
+  gboolean throttle_hidden;
+  guint hidden_grace_period;
+  gboolean video_hidden;
+  guint video_disable_id;
+  guint video_resume_id;
+  gboolean video_disabled;
+  ClutterActor *hidden_texture;
 };
 
+/* A range of the media, in fractions of the media duration */
+typedef struct _ClutterGstBufferedRange
+{
+  gdouble start;
+  gdouble stop;
+} ClutterGstBufferedRange;
+
+/* A state change run by the state worker. When player is NULL, the pipeline
+ * is being disposed of */
+typedef struct _ClutterGstTransition
+{
+  ClutterGstPlayer *player;
+  GstElement *pipeline;
+  gboolean set_uri;
+  gchar *uri;
+  gchar *suburi;
+  gboolean reopen;
+  GstPlayFlags clear_flags;
+  guint generation;
+  GstState state;
+  GstStateChangeReturn ret;
+} ClutterGstTransition;
+
+#define REOPENED_MESSAGE "clutter-gst-reopened"
+
+/* A pipeline pre-rolled in PAUSED by clutter_gst_player_preroll_uri(). Its
+ * video sink renders into an off-stage texture until the pipeline is
+ * swapped in */
+typedef struct _ClutterGstStandby
+{
+  gchar *uri;
+  gchar *play_uri;
+  GstElement *pipeline;
+  ClutterActor *texture;
+  guint bus_watch_id;
+  gboolean failed;
+} ClutterGstStandby;
+
 static GQuark clutter_gst_player_private_quark = 0;
 static GQuark clutter_gst_player_class_quark = 0;
 
 static guint signals[LAST_SIGNAL] = { 0, };
 
-static gboolean player_buffering_timeout (gpointer data);
+/* memory budget shared by all the players, and the players it is divided
+ * among. The list is only used from the main thread, the count is also
+ * read from the streaming threads */
+static guint64 global_memory_budget = 0;
+static GList *players = NULL;
+static volatile gint n_players = 0;
+
+/* whether the players created from now on use the shared bus dispatcher */
+static gboolean use_shared_bus_dispatch = FALSE;
+
+static gboolean player_swap_standby (ClutterGstPlayer *player,
+                                     const gchar      *uri);
+static GList *get_tags (GstElement  *pipeline,
+                        const gchar *property_name,
+                        const gchar *action_signal);
+static void cache_auto_audio_sink (GstElement *sink);
+static void player_ensure_audio_sink (ClutterGstPlayer *player,
+                                      GstElement       *pipeline);
+static void player_update_audio_flag (ClutterGstPlayer *player);
+static void player_update_native_video_flag (ClutterGstPlayer *player);
+static void player_standby_free (ClutterGstPlayerPrivate *priv,
+                                 ClutterGstStandby       *standby);
+static void player_add_standby (ClutterGstPlayer *player,
+                                const gchar      *uri);
+static void player_trim_standby (ClutterGstPlayer *player,
+                                 guint             max);
+static void player_resume_video (ClutterGstPlayer *player,
+                                 gboolean          seek);
+static void player_schedule_video_disable (ClutterGstPlayer *player);
+static void set_playing (ClutterGstPlayer *player,
+                         gboolean          playing);
+static gboolean get_playing (ClutterGstPlayer *player);
 
 /* Logic */
 static ClutterGstPlayerIfacePrivate *
@@ -345,2020 +642,8178 @@ player_set_user_agent (ClutterGstPlayer *player,
 }
 
 static void
-autoload_subtitle (ClutterGstPlayer *player,
-                   const gchar      *uri)
+pipeline_set_subtitle_uri (GstElement  *pipeline,
+                           const gchar *uri)
 {
-  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
-  gchar *path, *dot, *subtitle_path;
-  GFile *video;
-  guint i;
+  GstPlayFlags flags;
 
-  static const char subtitles_extensions[][4] =
-    {
-      "sub", "SUB",
-      "srt", "SRT",
-      "smi", "SMI",
-      "ssa", "SSA",
-      "ass", "ASS",
-      "asc", "ASC"
-    };
+  CLUTTER_GST_NOTE (MEDIA, "setting subtitle URI: %s", uri);
 
-  /* do not try to look for subtitle files if the video file is not mounted
-   * locally */
-  if (!g_str_has_prefix (uri, "file://"))
-    return;
+  g_object_get (pipeline, "flags", &flags, NULL);
 
-  /* Retrieve the absolute path of the video file */
-  video = g_file_new_for_uri (uri);
-  path = g_file_get_path (video);
-  g_object_unref (video);
-  if (path == NULL)
-    return;
+  g_object_set (pipeline, "suburi", uri, NULL);
 
-  /* Put a '\0' after the dot of the extension */
-  dot = strrchr (path, '.');
-  if (dot == NULL) {
-    g_free (path);
-    return;
-  }
-  *++dot = '\0';
+  g_object_set (pipeline, "flags", flags, NULL);
+}
+
+static void
+set_subtitle_uri (ClutterGstPlayer *player,
+                  const gchar      *uri)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
 
-  /* we can't use path as the temporary buffer for the paths of the potential
-   * subtitle files as we may not have enough room there */
-  subtitle_path = g_malloc (strlen (path) + 1 + 4);
-  strcpy (subtitle_path, path);
+  if (!priv->pipeline)
+    return;
 
-  /* reuse dot to point to the first byte of the extension of subtitle_path */
-  dot = subtitle_path + (dot - path);
+  pipeline_set_subtitle_uri (priv->pipeline, uri);
+}
 
-  for (i = 0; i < G_N_ELEMENTS (subtitles_extensions); i++)
-    {
-      GFile *candidate;
+/* Subtitle auto-discovery.
+ *
+ * We look for a subtitle file with the same name as the media file, in the
+ * same directory. Instead of checking for every possible file name, which
+ * costs a round trip per name on network file systems, the directory is
+ * listed once and the names of the subtitle files it contains are cached
+ * for a little while. From the main thread, the listing is done
+ * asynchronously and the subtitle URI is set once it's known */
+
+/* how long the content of a directory is trusted (in us) */
+#define SUBTITLE_CACHE_TTL        (10 * G_USEC_PER_SEC)
+/* maximum number of directories in the cache */
+#define SUBTITLE_CACHE_SIZE       32
+/* number of files asked at once to the enumerator */
+#define SUBTITLE_SCAN_BATCH       64
+
+static const char subtitles_extensions[][4] =
+  {
+    "sub", "SUB",
+    "srt", "SRT",
+    "smi", "SMI",
+    "ssa", "SSA",
+    "ass", "ASS",
+    "asc", "ASC"
+  };
+
+typedef struct _ClutterGstSubtitleDir
+{
+  GHashTable *names;          /* names of the subtitle files */
+  gint64 scan_time;
+} ClutterGstSubtitleDir;
 
-      memcpy (dot, subtitles_extensions[i], 4);
-      candidate = g_file_new_for_path (subtitle_path);
-      if (g_file_query_exists (candidate, NULL))
-        {
-          gchar *suburi;
+typedef struct _ClutterGstSubtitleScan
+{
+  ClutterGstPlayer *player;   /* NULL if we only fill the cache */
+  gchar *uri;
+  gchar *dir_path;
+  GFileEnumerator *enumerator;
+  GCancellable *cancellable;
+  ClutterGstSubtitleDir *dir;
+} ClutterGstSubtitleScan;
 
-          suburi = g_file_get_uri (candidate);
+G_LOCK_DEFINE_STATIC (subtitle_cache);
+static GHashTable *subtitle_cache = NULL;
 
-          CLUTTER_GST_NOTE (MEDIA, "found subtitle: %s", suburi);
+/* Splits the URI of a local media file into the path of its directory and
+ * its base name up to, and including, the dot of its extension */
+static gboolean
+split_media_uri (const gchar  *uri,
+                 gchar       **dir_path,
+                 gchar       **stem)
+{
+  gchar *path, *dot;
 
-          g_object_set (priv->pipeline, "suburi", suburi, NULL);
-          g_free (suburi);
+  /* do not try to look for subtitle files if the video file is not mounted
+   * locally */
+  if (!g_str_has_prefix (uri, "file://"))
+    return FALSE;
 
-          g_object_unref (candidate);
-          break;
-        }
+  path = g_filename_from_uri (uri, NULL, NULL);
+  if (path == NULL)
+    return FALSE;
 
-      g_object_unref (candidate);
+  *stem = g_path_get_basename (path);
+  dot = strrchr (*stem, '.');
+  if (dot == NULL)
+    {
+      g_free (*stem);
+      g_free (path);
+      return FALSE;
     }
+  *++dot = '\0';
 
+  *dir_path = g_path_get_dirname (path);
   g_free (path);
-  g_free (subtitle_path);
+
+  return TRUE;
 }
 
-static void
-set_subtitle_uri (ClutterGstPlayer *player,
-                  const gchar      *uri)
+static ClutterGstSubtitleDir *
+subtitle_dir_new (void)
 {
-  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
-  GstPlayFlags flags;
-
-  if (!priv->pipeline)
-    return;
+  ClutterGstSubtitleDir *dir;
 
-  CLUTTER_GST_NOTE (MEDIA, "setting subtitle URI: %s", uri);
-
-  g_object_get (priv->pipeline, "flags", &flags, NULL);
+  dir = g_slice_new (ClutterGstSubtitleDir);
+  dir->names = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  dir->scan_time = 0;
 
-  g_object_set (priv->pipeline, "suburi", uri, NULL);
+  return dir;
+}
 
-  g_object_set (priv->pipeline, "flags", flags, NULL);
+static void
+subtitle_dir_free (ClutterGstSubtitleDir *dir)
+{
+  g_hash_table_unref (dir->names);
+  g_slice_free (ClutterGstSubtitleDir, dir);
 }
 
 static void
-player_configure_buffering_timeout (ClutterGstPlayer *player,
-                                    guint             ms)
+subtitle_dir_add_file (ClutterGstSubtitleDir *dir,
+                       GFileInfo             *info)
 {
-  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  const gchar *name, *extension;
+  guint i;
 
-  if (priv->buffering_timeout_id)
-    {
-      g_source_remove (priv->buffering_timeout_id);
-      priv->buffering_timeout_id = 0;
-    }
+  name = g_file_info_get_name (info);
+  extension = strrchr (name, '.');
+  if (extension == NULL)
+    return;
 
-  if (ms)
+  for (i = 0; i < G_N_ELEMENTS (subtitles_extensions); i++)
     {
-      priv->buffering_timeout_id =
-        g_timeout_add (ms, player_buffering_timeout, player);
+      if (strcmp (extension + 1, subtitles_extensions[i]) == 0)
+        {
+          g_hash_table_insert (dir->names, g_strdup (name), dir);
+          return;
+        }
     }
 }
 
-static void
-player_clear_download_buffering (ClutterGstPlayer *player)
+static gboolean
+subtitle_dir_is_stale (gpointer key,
+                       gpointer value,
+                       gpointer user_data)
 {
-  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  ClutterGstSubtitleDir *dir = value;
+  gint64 *now = user_data;
 
-  if (priv->download_buffering_element)
-    {
-      g_object_unref (priv->download_buffering_element);
-      priv->download_buffering_element = NULL;
-    }
-  player_configure_buffering_timeout (player, 0);
-  priv->in_download_buffering = FALSE;
-  priv->virtual_stream_buffer_signalled = 0;
+  return *now - dir->scan_time > SUBTITLE_CACHE_TTL;
 }
 
+/* Takes ownership of @dir */
 static void
-set_uri (ClutterGstPlayer *player,
-         const gchar      *uri)
+subtitle_cache_insert (const gchar           *dir_path,
+                       ClutterGstSubtitleDir *dir)
 {
-  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
-  GObject *self = G_OBJECT (player);
-  GstState state, pending;
-
-  CLUTTER_GST_NOTE (MEDIA, "setting uri %s", uri);
+  gint64 now = g_get_monotonic_time ();
 
-  if (!priv->pipeline)
-    return;
+  dir->scan_time = now;
 
-  g_free (priv->uri);
+  G_LOCK (subtitle_cache);
 
-  priv->in_eos = FALSE;
-  priv->in_error = FALSE;
+  if (subtitle_cache == NULL)
+    subtitle_cache =
+      g_hash_table_new_full (g_str_hash, g_str_equal,
+                             g_free, (GDestroyNotify) subtitle_dir_free);
 
-  if (uri)
+  if (g_hash_table_size (subtitle_cache) >= SUBTITLE_CACHE_SIZE)
     {
-      priv->uri = g_strdup (uri);
+      g_hash_table_foreach_remove (subtitle_cache,
+                                   subtitle_dir_is_stale, &now);
+      if (g_hash_table_size (subtitle_cache) >= SUBTITLE_CACHE_SIZE)
+        g_hash_table_remove_all (subtitle_cache);
+    }
 
-      /* Ensure the tick timeout is installed.
-       *
-       * We also have it installed in PAUSED state, because
-       * seeks etc may have a delayed effect on the position.
-       */
-      if (priv->tick_timeout_id == 0)
-        {
-          priv->tick_timeout_id =
-            g_timeout_add (TICK_TIMEOUT, tick_timeout, self);
-        }
+  g_hash_table_replace (subtitle_cache, g_strdup (dir_path), dir);
 
-      /* try to load subtitles based on the uri of the file */
-      set_subtitle_uri (player, NULL);
+  G_UNLOCK (subtitle_cache);
+}
 
-      /* reset the states of download buffering */
-      player_clear_download_buffering (player);
-    }
-  else
-    {
-      priv->uri = NULL;
+/* Looks for the subtitle file of @stem in the cached content of @dir_path.
+ * Returns FALSE if the directory isn't in the cache (or was listed more than
+ * @max_age us ago), otherwise @suburi is set to the URI of the subtitle file
+ * or NULL */
+static gboolean
+subtitle_cache_lookup (const gchar  *dir_path,
+                       const gchar  *stem,
+                       gint64        max_age,
+                       gchar       **suburi)
+{
+  ClutterGstSubtitleDir *dir = NULL;
+  gboolean cached = FALSE;
+  guint i;
 
-      if (priv->tick_timeout_id)
-	{
-	  g_source_remove (priv->tick_timeout_id);
-	  priv->tick_timeout_id = 0;
-	}
+  *suburi = NULL;
 
-      if (priv->buffering_timeout_id)
-        {
-          g_source_remove (priv->buffering_timeout_id);
-          priv->buffering_timeout_id = 0;
-        }
+  G_LOCK (subtitle_cache);
 
-      if (priv->download_buffering_element)
+  if (subtitle_cache)
+    dir = g_hash_table_lookup (subtitle_cache, dir_path);
+
+  if (dir && g_get_monotonic_time () - dir->scan_time <= max_age)
+    {
+      cached = TRUE;
+
+      for (i = 0;
+           i < G_N_ELEMENTS (subtitles_extensions) && *suburi == NULL;
+           i++)
         {
-          g_object_unref (priv->download_buffering_element);
-          priv->download_buffering_element = NULL;
-        }
+          gchar *name, *path;
+
+          name = g_strconcat (stem, subtitles_extensions[i], NULL);
+          if (g_hash_table_lookup (dir->names, name))
+            {
+              path = g_build_filename (dir_path, name, NULL);
+              *suburi = g_filename_to_uri (path, NULL, NULL);
+              g_free (path);
 
+              CLUTTER_GST_NOTE (MEDIA, "found subtitle: %s", *suburi);
+            }
+          g_free (name);
+        }
     }
 
-  priv->can_seek = FALSE;
-  priv->duration = 0.0;
-  priv->stacked_progress = 0.0;
-  priv->target_progress = 0.0;
+  G_UNLOCK (subtitle_cache);
 
-  CLUTTER_GST_NOTE (MEDIA, "setting URI: %s", uri);
+  return cached;
+}
 
-  if (uri)
-    {
-      gst_element_get_state (priv->pipeline, &state, &pending, 0);
-      if (pending)
-        state = pending;
+/* Looks for a subtitle file next to the media file pointed by @uri. Returns
+ * the URI of the subtitle file, or NULL. This may block on I/O, and thus is
+ * only used outside of the main thread */
+static gchar *
+find_subtitle (const gchar *uri)
+{
+  ClutterGstSubtitleDir *dir;
+  GFileEnumerator *enumerator;
+  GFileInfo *info;
+  GFile *file;
+  gchar *dir_path, *stem, *suburi = NULL;
 
-      gst_element_set_state (priv->pipeline, GST_STATE_NULL);
+  if (!split_media_uri (uri, &dir_path, &stem))
+    return NULL;
 
-      g_object_set (priv->pipeline, "uri", uri, NULL);
-      set_subtitle_uri (player, NULL);
-      autoload_subtitle (player, uri);
+  if (subtitle_cache_lookup (dir_path, stem, SUBTITLE_CACHE_TTL, &suburi))
+    goto out;
 
-      gst_element_set_state (priv->pipeline, state);
+  file = g_file_new_for_path (dir_path);
+  enumerator = g_file_enumerate_children (file,
+                                          G_FILE_ATTRIBUTE_STANDARD_NAME,
+                                          G_FILE_QUERY_INFO_NONE,
+                                          NULL, NULL);
+  g_object_unref (file);
+  if (enumerator == NULL)
+    goto out;
 
-      priv->is_changing_uri = TRUE;
-    }
-  else
+  dir = subtitle_dir_new ();
+  while ((info = g_file_enumerator_next_file (enumerator, NULL, NULL)))
     {
-      priv->is_idle = TRUE;
-      set_subtitle_uri (player, NULL);
-      gst_element_set_state (priv->pipeline, GST_STATE_NULL);
-      g_object_notify (G_OBJECT (player), "idle");
+      subtitle_dir_add_file (dir, info);
+      g_object_unref (info);
     }
+  g_object_unref (enumerator);
 
-  /*
-   * Emit notifications for all these to make sure UI is not showing
-   * any properties of the old URI.
-   */
-  g_object_notify (self, "uri");
-  g_object_notify (self, "can-seek");
-  g_object_notify (self, "duration");
-  g_object_notify (self, "progress");
+  subtitle_cache_insert (dir_path, dir);
+  subtitle_cache_lookup (dir_path, stem, SUBTITLE_CACHE_TTL, &suburi);
 
-  free_tags_list (&priv->audio_streams);
-  CLUTTER_GST_NOTE (AUDIO_STREAM, "audio-streams changed");
-  g_object_notify (self, "audio-streams");
+ out:
+  g_free (dir_path);
+  g_free (stem);
 
-  free_tags_list (&priv->subtitle_tracks);
-  CLUTTER_GST_NOTE (SUBTITLES, "subtitle-tracks changed");
-  g_object_notify (self, "subtitle-tracks");
+  return suburi;
 }
 
-static void
-set_in_seek (ClutterGstPlayer *player,
-             gboolean          seeking)
+/* Same as find_subtitle(), without blocking: only the cached content of
+ * the directory is used, however old it is */
+static gchar *
+lookup_subtitle (const gchar *uri)
 {
-  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  gchar *dir_path, *stem, *suburi = NULL;
 
-  priv->in_seek = seeking;
-  g_object_notify (G_OBJECT (player), "in-seek");
-}
+  if (!split_media_uri (uri, &dir_path, &stem))
+    return NULL;
 
+  subtitle_cache_lookup (dir_path, stem, G_MAXINT64, &suburi);
 
-static void
-set_playing (ClutterGstPlayer *player,
-             gboolean          playing)
+  g_free (dir_path);
+  g_free (stem);
+
+  return suburi;
+}
+
+/* Whether the media isn't being opened, or open, already. playbin only
+ * looks at some of its properties, like suburi or the flags of the sinks,
+ * when it opens the media */
+static gboolean
+player_media_is_closed (ClutterGstPlayer *player)
 {
   ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  GstState state, pending;
 
-  if (!priv->pipeline)
-    return;
-
-  CLUTTER_GST_NOTE (MEDIA, "set playing: %d", playing);
+  if (priv->pending_transitions)
+    return FALSE;
 
-  priv->in_error = FALSE;
-  priv->in_eos = FALSE;
+  gst_element_get_state (priv->pipeline, &state, &pending, 0);
 
-  priv->target_state = playing ? GST_STATE_PLAYING : GST_STATE_PAUSED;
+  return state == GST_STATE_NULL ||
+         (state == GST_STATE_READY && pending == GST_STATE_VOID_PENDING);
+}
 
-  if (priv->uri)
-    {
-      set_in_seek (player, FALSE);
+/* Sets the subtitle URI found for the current media. playbin only looks at
+ * the suburi property when the media is being opened. Reopening the media
+ * would interrupt playback, so if that's already done, the subtitle is kept
+ * for the next time the media is opened */
+static void
+player_apply_subtitle (ClutterGstPlayer *player,
+                       const gchar      *suburi)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
 
-      gst_element_set_state (priv->pipeline, priv->target_state);
-    }
-  else
+  if (player_media_is_closed (player))
     {
-      if (playing)
-       g_warning ("Unable to start playing: no URI is set");
+      set_subtitle_uri (player, suburi);
+      return;
     }
 
-  g_object_notify (G_OBJECT (player), "playing");
-  g_object_notify (G_OBJECT (player), "progress");
+  CLUTTER_GST_NOTE (MEDIA, "%s is already open, keeping subtitle %s for "
+                    "later", priv->uri, suburi);
+
+  g_free (priv->pending_suburi);
+  priv->pending_suburi = g_strdup (suburi);
 }
 
-static gboolean
-get_playing (ClutterGstPlayer *player)
+/* Sets the subtitle found too late for the current media, if any, when the
+ * pipeline is back to READY */
+static void
+player_apply_pending_subtitle (ClutterGstPlayer *player)
 {
   ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
-  GstState state, pending;
-  gboolean playing;
 
-  if (!priv->pipeline)
-    return FALSE;
-
-  gst_element_get_state (priv->pipeline, &state, &pending, 0);
+  if (priv->pending_suburi == NULL || !player_media_is_closed (player))
+    return;
 
-  if (pending)
-    playing = (pending == GST_STATE_PLAYING);
-  else
-    playing = (state == GST_STATE_PLAYING);
+  set_subtitle_uri (player, priv->pending_suburi);
 
-  CLUTTER_GST_NOTE (MEDIA, "get playing: %d", playing);
+  g_free (priv->pending_suburi);
+  priv->pending_suburi = NULL;
+}
 
-  return playing;
+static void
+subtitle_scan_free (ClutterGstSubtitleScan *scan)
+{
+  if (scan->player)
+    g_object_unref (scan->player);
+  if (scan->enumerator)
+    g_object_unref (scan->enumerator);
+  if (scan->cancellable)
+    g_object_unref (scan->cancellable);
+  if (scan->dir)
+    subtitle_dir_free (scan->dir);
+  g_free (scan->uri);
+  g_free (scan->dir_path);
+  g_slice_free (ClutterGstSubtitleScan, scan);
 }
 
 static void
-set_progress (ClutterGstPlayer *player,
-              gdouble           progress)
+subtitle_scan_done (ClutterGstSubtitleScan *scan)
 {
-  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
-  GstQuery *duration_q;
-  gint64 position;
+  ClutterGstPlayerPrivate *priv;
+  gchar *suburi, *dir_path, *stem;
 
-  if (!priv->pipeline)
+  subtitle_cache_insert (scan->dir_path, scan->dir);
+  scan->dir = NULL;
+
+  if (scan->player == NULL ||
+      g_cancellable_is_cancelled (scan->cancellable))
     return;
 
-  CLUTTER_GST_NOTE (MEDIA, "set progress: %.02f", progress);
+  /* the player may have been disposed of in the meantime */
+  priv = PLAYER_GET_PRIVATE (scan->player);
+  if (priv == NULL || g_strcmp0 (priv->uri, scan->uri) != 0)
+    return;
 
-  priv->in_eos = FALSE;
-  priv->target_progress = progress;
+  if (!split_media_uri (scan->uri, &dir_path, &stem))
+    return;
 
-  if (priv->in_download_buffering)
+  subtitle_cache_lookup (dir_path, stem, SUBTITLE_CACHE_TTL, &suburi);
+  if (suburi)
     {
-      /* we clear the virtual_stream_buffer_signalled flag as it's likely we
-       * need to buffer again */
-      priv->virtual_stream_buffer_signalled = 0;
+      player_apply_subtitle (scan->player, suburi);
+      g_free (suburi);
     }
 
-  if (priv->in_seek || priv->is_idle || priv->is_changing_uri)
+  g_free (dir_path);
+  g_free (stem);
+}
+
+static void
+subtitle_scan_next_files_cb (GObject      *source,
+                             GAsyncResult *result,
+                             gpointer      user_data)
+{
+  ClutterGstSubtitleScan *scan = user_data;
+  GList *infos, *l;
+  GError *error = NULL;
+
+  infos = g_file_enumerator_next_files_finish (scan->enumerator,
+                                               result, &error);
+  if (error)
     {
-      /* We can't seek right now, let's save the position where we
-         want to seek and do that later. */
-      CLUTTER_GST_NOTE (MEDIA,
-                        "already seeking/idleing. stacking progress point.");
-      priv->stacked_progress = progress;
+      CLUTTER_GST_NOTE (MEDIA, "could not list %s: %s",
+                        scan->dir_path, error->message);
+      g_error_free (error);
+      subtitle_scan_free (scan);
       return;
     }
 
-  duration_q = gst_query_new_duration (GST_FORMAT_TIME);
+  if (infos == NULL)
+    {
+      g_file_enumerator_close_async (scan->enumerator, G_PRIORITY_DEFAULT,
+                                     NULL, NULL, NULL);
+      subtitle_scan_done (scan);
+      subtitle_scan_free (scan);
+      return;
+    }
 
-  if (gst_element_query (priv->pipeline, duration_q))
+  for (l = infos; l; l = l->next)
     {
-      gint64 duration = 0;
+      subtitle_dir_add_file (scan->dir, l->data);
+      g_object_unref (l->data);
+    }
+  g_list_free (infos);
+
+  g_file_enumerator_next_files_async (scan->enumerator,
+                                      SUBTITLE_SCAN_BATCH,
+                                      G_PRIORITY_DEFAULT,
+                                      scan->cancellable,
+                                      subtitle_scan_next_files_cb,
+                                      scan);
+}
 
-      gst_query_parse_duration (duration_q, NULL, &duration);
+static void
+subtitle_scan_enumerate_cb (GObject      *source,
+                            GAsyncResult *result,
+                            gpointer      user_data)
+{
+  ClutterGstSubtitleScan *scan = user_data;
+  GError *error = NULL;
 
-      position = progress * duration;
+  scan->enumerator = g_file_enumerate_children_finish (G_FILE (source),
+                                                       result, &error);
+  if (error)
+    {
+      CLUTTER_GST_NOTE (MEDIA, "could not list %s: %s",
+                        scan->dir_path, error->message);
+      g_error_free (error);
+      subtitle_scan_free (scan);
+      return;
     }
-  else
-    position = 0;
 
-  gst_query_unref (duration_q);
+  scan->dir = subtitle_dir_new ();
 
-  gst_element_seek (priv->pipeline,
-		    1.0,
-		    GST_FORMAT_TIME,
-		    GST_SEEK_FLAG_FLUSH | priv->seek_flags,
-		    GST_SEEK_TYPE_SET,
-		    position,
-		    GST_SEEK_TYPE_NONE, GST_CLOCK_TIME_NONE);
+  g_file_enumerator_next_files_async (scan->enumerator,
+                                      SUBTITLE_SCAN_BATCH,
+                                      G_PRIORITY_DEFAULT,
+                                      scan->cancellable,
+                                      subtitle_scan_next_files_cb,
+                                      scan);
+}
 
-  set_in_seek (player, TRUE);
+/* Looks for the subtitle file of @uri without blocking. If @player is not
+ * NULL, the subtitle is set on its pipeline as soon as it's known, unless
+ * @cancellable is cancelled before */
+static void
+subtitle_scan_start (ClutterGstPlayer *player,
+                     const gchar      *uri,
+                     GCancellable     *cancellable)
+{
+  ClutterGstSubtitleScan *scan;
+  GFile *file;
+  gchar *dir_path, *stem, *suburi;
 
-  priv->stacked_progress = 0.0;
+  if (!split_media_uri (uri, &dir_path, &stem))
+    return;
 
-  CLUTTER_GST_NOTE (MEDIA, "set progress (seeked): %.02f", progress);
+  if (subtitle_cache_lookup (dir_path, stem, SUBTITLE_CACHE_TTL, &suburi))
+    {
+      if (player && suburi)
+        player_apply_subtitle (player, suburi);
+
+      g_free (suburi);
+      g_free (dir_path);
+      g_free (stem);
+      return;
+    }
+
+  CLUTTER_GST_NOTE (MEDIA, "listing %s", dir_path);
+
+  scan = g_slice_new0 (ClutterGstSubtitleScan);
+  scan->player = player ? g_object_ref (player) : NULL;
+  scan->uri = g_strdup (uri);
+  scan->dir_path = dir_path;
+  scan->cancellable = cancellable ? g_object_ref (cancellable) : NULL;
+
+  file = g_file_new_for_path (dir_path);
+  g_file_enumerate_children_async (file,
+                                   G_FILE_ATTRIBUTE_STANDARD_NAME,
+                                   G_FILE_QUERY_INFO_NONE,
+                                   G_PRIORITY_DEFAULT,
+                                   cancellable,
+                                   subtitle_scan_enumerate_cb,
+                                   scan);
+  g_object_unref (file);
+  g_free (stem);
 }
 
-static gdouble
-get_progress (ClutterGstPlayer *player)
+static void
+player_cancel_subtitle_scan (ClutterGstPlayerPrivate *priv)
+{
+  if (priv->subtitle_cancellable)
+    {
+      g_cancellable_cancel (priv->subtitle_cancellable);
+      g_object_unref (priv->subtitle_cancellable);
+      priv->subtitle_cancellable = NULL;
+    }
+}
+
+static void
+autoload_subtitle (ClutterGstPlayer *player,
+                   const gchar      *uri)
 {
   ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
-  GstQuery *position_q, *duration_q;
-  gdouble progress;
 
-  if (!priv->pipeline)
-    return 0.0;
+  player_cancel_subtitle_scan (priv);
 
-  /* when hitting an error or after an EOS, playbin has some weird values when
-   * querying the duration and progress. We default to 0.0 on error and 1.0 on
-   * EOS */
-  if (priv->in_error)
-    {
-      CLUTTER_GST_NOTE (MEDIA, "get progress (error): 0.0");
-      return 0.0;
-    }
+  priv->subtitle_cancellable = g_cancellable_new ();
+  subtitle_scan_start (player, uri, priv->subtitle_cancellable);
+}
 
-  if (priv->in_eos)
+static void
+player_clear_keyframe_index (ClutterGstPlayerPrivate *priv)
+{
+  if (priv->keyframe_index_cancellable)
     {
-      CLUTTER_GST_NOTE (MEDIA, "get progress (eos): 1.0");
-      return 1.0;
+      g_cancellable_cancel (priv->keyframe_index_cancellable);
+      g_object_unref (priv->keyframe_index_cancellable);
+      priv->keyframe_index_cancellable = NULL;
     }
 
-  /* When seeking, the progress returned by playbin is 0.0. We want that to be
-   * the last known position instead as returning 0.0 will have some ugly
-   * effects, say on a progress bar getting updated from the progress tick. */
-  if (priv->in_seek || priv->is_changing_uri)
+  if (priv->keyframe_index)
     {
-      CLUTTER_GST_NOTE (MEDIA, "get progress (target): %.02f",
-                        priv->target_progress);
-      return priv->target_progress;
+      _clutter_gst_keyframe_index_free (priv->keyframe_index);
+      priv->keyframe_index = NULL;
     }
+}
 
-  position_q = gst_query_new_position (GST_FORMAT_TIME);
-  duration_q = gst_query_new_duration (GST_FORMAT_TIME);
+static void
+keyframe_index_loaded_cb (GObject      *source,
+                          GAsyncResult *result,
+                          gpointer      user_data)
+{
+  GWeakRef *player_ref = user_data;
+  ClutterGstKeyframeIndex *index;
+  ClutterGstPlayerPrivate *priv = NULL;
+  ClutterGstPlayer *player;
+  GError *error = NULL;
 
-  if (gst_element_query (priv->pipeline, position_q) &&
-      gst_element_query (priv->pipeline, duration_q))
+  index = _clutter_gst_keyframe_index_load_finish (result, &error);
+  if (index == NULL)
     {
-      gint64 position, duration;
-
-      position = duration = 0;
+      if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        CLUTTER_GST_NOTE (MEDIA, "no key frame index: %s", error->message);
+      g_error_free (error);
+    }
 
-      gst_query_parse_position (position_q, NULL, &position);
-      gst_query_parse_duration (duration_q, NULL, &duration);
+  /* the player may have been disposed of, or be on another media */
+  player = g_weak_ref_get (player_ref);
+  if (player)
+    priv = PLAYER_GET_PRIVATE (player);
 
-      progress = CLAMP ((gdouble) position / (gdouble) duration, 0.0, 1.0);
+  if (index && priv && priv->keyframe_index == NULL &&
+      g_strcmp0 (priv->uri, index->uri) == 0)
+    {
+      priv->keyframe_index = index;
+      index = NULL;
     }
-  else
-    progress = 0.0;
 
-  gst_query_unref (position_q);
-  gst_query_unref (duration_q);
-
-  CLUTTER_GST_NOTE (MEDIA, "get progress (pipeline): %.02f", progress);
+  if (index)
+    _clutter_gst_keyframe_index_free (index);
+  if (player)
+    g_object_unref (player);
 
-  return progress;
+  g_weak_ref_clear (player_ref);
+  g_slice_free (GWeakRef, player_ref);
 }
 
+/* The index is built in the background the first time a file is played.
+ * Only local files are indexed, reading remote media twice isn't cheap */
 static void
-set_subtitle_font_name (ClutterGstPlayer *player,
-                        const gchar      *font_name)
+player_load_keyframe_index (ClutterGstPlayer *player)
 {
   ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  GWeakRef *player_ref;
 
-  if (!priv->pipeline)
+  player_clear_keyframe_index (priv);
+
+  if (!priv->use_keyframe_index || priv->uri == NULL ||
+      !g_str_has_prefix (priv->uri, "file:"))
     return;
 
-  CLUTTER_GST_NOTE (MEDIA, "setting subtitle font to %s", font_name);
+  player_ref = g_slice_new (GWeakRef);
+  g_weak_ref_init (player_ref, player);
 
-  g_free (priv->font_name);
-  priv->font_name = g_strdup (font_name);
-  g_object_set (priv->pipeline, "subtitle-font-desc", font_name, NULL);
+  priv->keyframe_index_cancellable = g_cancellable_new ();
+  _clutter_gst_keyframe_index_load_async (priv->uri,
+                                          priv->keyframe_index_cancellable,
+                                          keyframe_index_loaded_cb,
+                                          player_ref);
 }
 
 static void
-set_audio_volume (ClutterGstPlayer *player,
-                  gdouble           volume)
+player_clear_download_buffering (ClutterGstPlayer *player)
 {
   ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
 
-    if (!priv->pipeline)
-      return;
-
-  CLUTTER_GST_NOTE (MEDIA, "set volume: %.02f", volume);
-
-  volume = CLAMP (volume, 0.0, 1.0);
-  gst_stream_volume_set_volume (GST_STREAM_VOLUME (priv->pipeline),
-				GST_STREAM_VOLUME_FORMAT_CUBIC,
-				volume);
-  g_object_notify (G_OBJECT (player), "audio-volume");
+  if (priv->download_buffering_element)
+    {
+      g_object_unref (priv->download_buffering_element);
+      priv->download_buffering_element = NULL;
+    }
+  if (priv->buffering_update_id)
+    {
+      g_source_remove (priv->buffering_update_id);
+      priv->buffering_update_id = 0;
+    }
+  priv->in_download_buffering = FALSE;
+  priv->virtual_stream_buffer_signalled = 0;
 }
 
-static gdouble
-get_audio_volume (ClutterGstPlayer *player)
+/* Media cache */
+
+static void
+player_set_revalidation (ClutterGstPlayerPrivate *priv,
+                         const gchar             *uri,
+                         GstStructure            *headers)
 {
-  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  g_rec_mutex_lock (&priv->ref->lock);
 
-  if (!priv->pipeline)
-    return 0.0;
+  g_free (priv->revalidate_uri);
+  priv->revalidate_uri = g_strdup (uri);
 
-  CLUTTER_GST_NOTE (MEDIA, "get volume: %.02f", priv->volume);
+  if (priv->revalidate_headers)
+    gst_structure_free (priv->revalidate_headers);
+  priv->revalidate_headers = headers;
 
-  return priv->volume;
+  g_rec_mutex_unlock (&priv->ref->lock);
 }
 
-static gboolean
-player_buffering_timeout (gpointer data)
+/* Returns the URI to give to playbin to play @uri, that is the URI of its
+ * copy in the media cache if there's one. When the copy has expired and
+ * @revalidate is TRUE, @uri is played and the HTTP source asks the server
+ * whether the copy is still good, see player_revalidated() */
+static gchar *
+player_resolve_uri (ClutterGstPlayerPrivate *priv,
+                    const gchar             *uri,
+                    gboolean                 revalidate)
 {
-  ClutterGstPlayer *player = (ClutterGstPlayer *) data;
-  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
-  gdouble start_d, stop_d, seconds_buffered;
-  gint64 start, stop, left;
-  GstState current_state;
-  GstElement *element;
-  GstQuery *query;
-  gboolean res;
-
-  element = priv->download_buffering_element;
-  if (element == NULL)
-    element = priv->pipeline;
+  GstStructure *validators = NULL;
+  gchar *cached_uri = NULL;
 
-  /* queue2 only knows about _PERCENT and _BYTES */
-  query = gst_query_new_buffering (GST_FORMAT_PERCENT);
-  res = gst_element_query (element, query);
-
-  if (res == FALSE)
+  if (priv->use_media_cache &&
+      (g_str_has_prefix (uri, "http://") || g_str_has_prefix (uri, "https://")))
     {
-      priv->buffering_timeout_id = 0;
-      player_clear_download_buffering (player);
-      return FALSE;
+      cached_uri = _clutter_gst_media_cache_lookup (uri,
+                                                    revalidate ?
+                                                    &validators : NULL);
     }
 
-  /* signal the current range */
-  gst_query_parse_buffering_stats (query, NULL, NULL, NULL, &left);
-  gst_query_parse_buffering_range (query, NULL, &start, &stop, NULL);
+  if (revalidate)
+    player_set_revalidation (priv, validators ? uri : NULL, validators);
 
-  CLUTTER_GST_NOTE (BUFFERING,
-                    "start %" G_GINT64_FORMAT ", stop %" G_GINT64_FORMAT
-                    ", buffering left %" G_GINT64_FORMAT, start, stop, left);
+  if (cached_uri)
+    return cached_uri;
+
+  return g_strdup (uri);
+}
 
-  start_d = (gdouble) start / GST_FORMAT_PERCENT_MAX;
-  stop_d = (gdouble) stop / GST_FORMAT_PERCENT_MAX;
+/* Sets the validators of the expired copy of the media on the HTTP source
+ * of @pipeline, if it's the one downloading that media */
+static void
+player_setup_revalidation (ClutterGstPlayerPrivate *priv,
+                           GstElement              *pipeline)
+{
+  GstElement *source;
+  gchar *location = NULL;
 
-  g_signal_emit (player, signals[DOWNLOAD_BUFFERING], 0, start_d, stop_d);
+  if (priv->revalidate_uri == NULL)
+    return;
 
-  /* handle the "virtual stream buffer" and the associated pipeline state.
-   * We pause the pipeline until 2s of content is buffered. With the current
-   * implementation of queue2, start is always 0, so even when we seek in
-   * the stream the start position of the download-buffering signal is
-   * always 0.0. FIXME: look at gst_query_parse_nth_buffering_range () */
-  seconds_buffered = priv->duration * (stop_d - start_d);
-  priv->buffer_fill = seconds_buffered / 2.0;
-  priv->buffer_fill = CLAMP (priv->buffer_fill, 0.0, 1.0);
+  g_object_get (pipeline, "source", &source, NULL);
+  if (source == NULL)
+    return;
 
-  if (priv->buffer_fill != 1.0 || !priv->virtual_stream_buffer_signalled)
+  if (g_object_class_find_property (G_OBJECT_GET_CLASS (source),
+                                    "extra-headers") &&
+      g_object_class_find_property (G_OBJECT_GET_CLASS (source), "location"))
     {
-      CLUTTER_GST_NOTE (BUFFERING, "buffer holds %0.2fs of data, buffer-fill "
-                        "is %.02f", seconds_buffered, priv->buffer_fill);
+      g_object_get (source, "location", &location, NULL);
 
-      g_object_notify (G_OBJECT (player), "buffer-fill");
+      if (g_strcmp0 (location, priv->revalidate_uri) == 0)
+        g_object_set (source,
+                      "extra-headers", priv->revalidate_headers,
+                      NULL);
 
-      if (priv->buffer_fill == 1.0)
-        priv->virtual_stream_buffer_signalled = 1;
+      g_free (location);
     }
 
-  gst_element_get_state (priv->pipeline, &current_state, NULL, 0);
-  if (priv->buffer_fill < 1.0)
-    {
-      if (current_state != GST_STATE_PAUSED)
-        {
-          CLUTTER_GST_NOTE (BUFFERING, "pausing the pipeline");
-          gst_element_set_state (priv->pipeline, GST_STATE_PAUSED);
-        }
-    }
-  else
+  gst_object_unref (source);
+}
+
+/* queue2 is told to keep the files it downloads media to, we have to remove
+ * the ones the cache didn't take */
+static void
+player_discard_download (ClutterGstPlayerPrivate *priv)
+{
+  if (priv->download_temp_location)
     {
-      if (current_state != priv->target_state)
-        {
-          CLUTTER_GST_NOTE (BUFFERING, "restoring the pipeline");
-          gst_element_set_state (priv->pipeline, priv->target_state);
-        }
+      g_unlink (priv->download_temp_location);
+      g_free (priv->download_temp_location);
+      priv->download_temp_location = NULL;
     }
 
-  /* the file has finished downloading */
-  if (left == G_GINT64_CONSTANT (0))
+  if (priv->http_headers)
     {
-      priv->buffering_timeout_id = 0;
-
-      player_clear_download_buffering (player);
-      gst_query_unref (query);
-      return FALSE;
+      gst_structure_free (priv->http_headers);
+      priv->http_headers = NULL;
     }
-
-  gst_query_unref (query);
-  return TRUE;
+  priv->http_status = 0;
 }
 
 static void
-bus_message_error_cb (GstBus           *bus,
-                      GstMessage       *message,
-                      ClutterGstPlayer *player)
+player_store_download (ClutterGstPlayer *player)
 {
   ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
-  GError *error = NULL;
 
-  gst_element_set_state (priv->pipeline, GST_STATE_NULL);
+  if (priv->download_temp_location == NULL || priv->uri == NULL)
+    return;
 
-  gst_message_parse_error (message, &error, NULL);
-  g_signal_emit_by_name (player, "error", error);
-  g_error_free (error);
+  if (_clutter_gst_media_cache_insert (priv->uri,
+                                       priv->download_temp_location,
+                                       priv->http_headers))
+    {
+      g_free (priv->download_temp_location);
+      priv->download_temp_location = NULL;
+    }
 
-  priv->is_idle = TRUE;
-  g_object_notify (G_OBJECT (player), "idle");
+  player_discard_download (priv);
 }
 
-/*
- * This is what's intented in the EOS callback:
- *   - receive EOS from playbin
- *   - fire the EOS signal, the user can install a signal handler to loop the
- *     video for instance.
- *   - after having emitted the signal, check the state of the pipeline
- *   - if the pipeline has been set back to playing or pause, don't touch the
- *     idle state. This will avoid drawing a frame (or more) with the idle
- *     material when looping
- */
+/* Asynchronous state changes */
+
+/* Brings @pipeline back to READY through NULL, clearing @clear_flags and
+ * switching to @uri, when not NULL, on the way. Then posts the marker of the
+ * reopen on its bus. Anything posted on the bus before the marker is from
+ * before the reopen */
 static void
-bus_message_eos_cb (GstBus           *bus,
-                    GstMessage       *message,
-                    ClutterGstPlayer *player)
+pipeline_reopen (GstElement   *pipeline,
+                 GstPlayFlags  clear_flags,
+                 const gchar  *uri,
+                 guint         generation)
 {
-  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
-  GstState state, pending;
-
-  priv->in_eos = TRUE;
+  GstPlayFlags flags;
+  GstStructure *structure;
 
-  gst_element_set_state (priv->pipeline, GST_STATE_READY);
+  gst_element_set_state (pipeline, GST_STATE_NULL);
 
-  g_signal_emit_by_name (player, "eos");
-  g_object_notify (G_OBJECT (player), "progress");
+  /* see set_subtitle_uri() for the flags dance */
+  g_object_get (pipeline, "flags", &flags, NULL);
+  if (uri)
+    g_object_set (pipeline, "uri", uri, NULL);
+  g_object_set (pipeline, "flags", flags & ~clear_flags, NULL);
 
-  gst_element_get_state (priv->pipeline, &state, &pending, 0);
-  if (pending)
-    state = pending;
+  gst_element_set_state (pipeline, GST_STATE_READY);
 
-  if (!(state == GST_STATE_PLAYING || state == GST_STATE_PAUSED))
-    {
-      priv->is_idle = TRUE;
-      g_object_notify (G_OBJECT (player), "idle");
-    }
+  structure = gst_structure_new (REOPENED_MESSAGE,
+                                 "generation", G_TYPE_UINT, generation,
+                                 NULL);
+  gst_element_post_message (pipeline,
+                            gst_message_new_application (GST_OBJECT (pipeline),
+                                                         structure));
 }
 
-static void
-bus_message_buffering_cb (GstBus           *bus,
-                          GstMessage       *message,
-                          ClutterGstPlayer *player)
+static gboolean
+player_transition_done (gpointer data)
 {
-  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
-  GstBufferingMode mode;
-  GstState current_state;
-  gint buffer_percent;
+  ClutterGstTransition *transition = data;
+  ClutterGstPlayer *player = transition->player;
 
-  gst_message_parse_buffering_stats (message, &mode, NULL, NULL, NULL);
-
-  if (mode != GST_BUFFERING_DOWNLOAD)
-    priv->in_download_buffering = FALSE;
-
-  switch (mode)
+  if (player)
     {
-    case GST_BUFFERING_STREAM:
-      gst_message_parse_buffering (message, &buffer_percent);
-      priv->buffer_fill = CLAMP ((gdouble) buffer_percent / 100.0, 0.0, 1.0);
+      ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
 
-      CLUTTER_GST_NOTE (BUFFERING, "buffer-fill: %.02f", priv->buffer_fill);
+      if (priv)
+        {
+          priv->pending_transitions--;
 
-      /* The playbin documentation says that we need to pause the pipeline
-       * when there's not enough data yet. We try to limit the calls to
-       * gst_element_set_state() */
-      gst_element_get_state (priv->pipeline, &current_state, NULL, 0);
+          CLUTTER_GST_NOTE (MEDIA, "transition to %s done, %u pending",
+                            gst_state_to_string (transition->state),
+                            priv->pending_transitions);
 
-      if (priv->buffer_fill < 1.0)
-        {
-          if (current_state != GST_STATE_PAUSED)
-            {
-              CLUTTER_GST_NOTE (BUFFERING, "pausing the pipeline");
-              gst_element_set_state (priv->pipeline, GST_STATE_PAUSED);
-            }
-        }
-      else
-        {
-          if (current_state != priv->target_state)
-            {
-              CLUTTER_GST_NOTE (BUFFERING, "restoring the pipeline");
-              gst_element_set_state (priv->pipeline, priv->target_state);
-            }
+          if (transition->set_uri && transition->pipeline == priv->pipeline)
+            g_signal_emit (player, signals[URI_LOADED], 0,
+                           transition->ret != GST_STATE_CHANGE_FAILURE);
+
+          /* the marker of a failed reopen may never be posted */
+          if (transition->reopen &&
+              transition->ret == GST_STATE_CHANGE_FAILURE &&
+              transition->generation == priv->reopen_generation)
+            priv->reopened_generation = transition->generation;
         }
 
-      g_object_notify (G_OBJECT (player), "buffer-fill");
-      break;
+      g_object_unref (player);
+    }
 
-    case GST_BUFFERING_DOWNLOAD:
-      /* we rate limit the messages from GStreamer for a usage in a UI (we
-       * don't want *that* many updates). This is done by installing an idle
-       * handler querying the buffer range and sending a signal from there */
+  /* the last reference on a pipeline has to be dropped from the main
+   * thread, its video sink owns Cogl resources */
+  gst_object_unref (transition->pipeline);
 
-      if (priv->in_download_buffering)
-        break;
-
-      /* install the querying idle handler the first time we receive a download
-       * buffering message */
-      player_configure_buffering_timeout (player, BUFFERING_TIMEOUT);
-
-      /* pause the stream. the idle timeout will set the target state when
-       * having received enough data. We'll use buffer_fill as a "virtual
-       * stream buffer" to signal the application we're buffering until we
-       * can play back from the downloaded stream. */
-      gst_element_set_state (priv->pipeline, GST_STATE_PAUSED);
-      priv->buffer_fill = 0.0;
-      g_object_notify (G_OBJECT (player), "buffer-fill");
+  g_free (transition->uri);
+  g_free (transition->suburi);
+  g_slice_free (ClutterGstTransition, transition);
 
-      priv->download_buffering_element = g_object_ref (message->src);
-      priv->in_download_buffering = TRUE;
-      priv->virtual_stream_buffer_signalled = 0;
-      break;
+  return FALSE;
+}
 
-    case GST_BUFFERING_TIMESHIFT:
-    case GST_BUFFERING_LIVE:
-    default:
-      g_warning ("Buffering mode %d not handled", mode);
-      break;
+static void
+player_transition_worker (gpointer data,
+                          gpointer user_data)
+{
+  ClutterGstTransition *transition = data;
+
+  if (transition->set_uri)
+    {
+      GstPlayFlags flags;
+
+      gst_element_set_state (transition->pipeline, GST_STATE_NULL);
+
+      transition->suburi = find_subtitle (transition->uri);
+
+      /* see set_subtitle_uri() for the flags dance */
+      g_object_get (transition->pipeline, "flags", &flags, NULL);
+      g_object_set (transition->pipeline,
+                    "uri", transition->uri,
+                    "suburi", transition->suburi,
+                    NULL);
+      g_object_set (transition->pipeline, "flags", flags, NULL);
+    }
+  else if (transition->reopen)
+    {
+      pipeline_reopen (transition->pipeline, transition->clear_flags,
+                       transition->uri, transition->generation);
     }
+
+  transition->ret = gst_element_set_state (transition->pipeline,
+                                           transition->state);
+
+  g_idle_add (player_transition_done, transition);
 }
 
 static void
-on_source_changed (GstElement       *pipeline,
-                   GParamSpec       *pspec,
-                   ClutterGstPlayer *player)
+player_ensure_state_worker (ClutterGstPlayerPrivate *priv)
 {
-  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
-
-  player_set_user_agent (player, priv->user_agent);
+  if (priv->state_worker == NULL)
+    priv->state_worker = g_thread_pool_new (player_transition_worker, NULL,
+                                            1, FALSE, NULL);
 }
 
+/* Queues a state change of priv->pipeline, optionally changing its URI.
+ * Transitions are run in the order they are queued */
 static void
-query_duration (ClutterGstPlayer *player)
+player_push_transition (ClutterGstPlayer *player,
+                        const gchar      *uri,
+                        GstState          state)
 {
   ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
-  gboolean success;
-  gint64 duration;
-  gdouble new_duration, difference;
+  ClutterGstTransition *transition;
 
-  success = gst_element_query_duration (priv->pipeline,
-                                        GST_FORMAT_TIME,
-                                        &duration);
-  if (G_UNLIKELY (success != TRUE))
-    return;
+  player_ensure_state_worker (priv);
 
-  new_duration = (gdouble) duration / GST_SECOND;
+  transition = g_slice_new0 (ClutterGstTransition);
+  transition->player = g_object_ref (player);
+  transition->pipeline = gst_object_ref (priv->pipeline);
+  transition->state = state;
 
-  /* while we store the new duration if it sligthly changes, the duration
-   * signal is sent only if the new duration is at least one second different
-   * from the old one (as the duration signal is mainly used to update the
-   * time displayed in a UI */
-  difference = ABS (priv->duration - new_duration);
-  if (difference > 1e-3)
+  if (uri)
     {
-      CLUTTER_GST_NOTE (MEDIA, "duration: %.02f", new_duration);
-      priv->duration = new_duration;
-
-      if (difference > 1.0)
-        g_object_notify (G_OBJECT (player), "duration");
+      transition->set_uri = TRUE;
+      transition->uri = player_resolve_uri (priv, uri, TRUE);
     }
+
+  priv->pending_transitions++;
+  priv->async_state = state;
+
+  CLUTTER_GST_NOTE (MEDIA, "queuing transition to %s",
+                    gst_state_to_string (state));
+
+  g_thread_pool_push (priv->state_worker, transition, NULL);
 }
 
+/* Sets the state of the pipeline, from the state worker when asynchronous
+ * state changes are enabled */
 static void
-bus_message_duration_changed_cb (GstBus           *bus,
-                                 GstMessage       *message,
-                                 ClutterGstPlayer *player)
+player_set_state (ClutterGstPlayer *player,
+                  GstState          state)
 {
-  /* GstElements send a duration-changed message on the bus to signal
-   * that the duration has changed and should be re-queried */
-  query_duration (player);
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+
+  if (priv->async_state_changes)
+    player_push_transition (player, NULL, state);
+  else
+    gst_element_set_state (priv->pipeline, state);
 }
 
+/* Reopens priv->pipeline in place, without the playbin @clear_flags and
+ * with @uri when not NULL, and brings it back to @state. The errors already
+ * on the bus are dropped, see bus_message_error_cb() */
 static void
-bus_message_state_change_cb (GstBus           *bus,
-                             GstMessage       *message,
-                             ClutterGstPlayer *player)
+player_reopen (ClutterGstPlayer *player,
+               GstPlayFlags      clear_flags,
+               const gchar      *uri,
+               GstState          state)
 {
   ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
-  GstState old_state, new_state;
-  gpointer src;
-
-  src = GST_MESSAGE_SRC (message);
-  if (src != priv->pipeline)
-    return;
-
-  gst_message_parse_state_changed (message, &old_state, &new_state, NULL);
-
-  CLUTTER_GST_NOTE (MEDIA, "state change:  %s -> %s",
-                    gst_state_to_string (old_state),
-                    gst_state_to_string (new_state));
+  ClutterGstTransition *transition;
 
-  if (old_state == new_state)
-    return;
+  priv->reopen_generation++;
 
-  if (old_state == GST_STATE_READY &&
-      new_state == GST_STATE_PAUSED)
+  if (!priv->async_state_changes)
     {
-      GstQuery *query;
-
-      /* Determine whether we can seek */
-      query = gst_query_new_seeking (GST_FORMAT_TIME);
-
-      if (gst_element_query (priv->pipeline, query))
-        {
-          gboolean can_seek = FALSE;
+      pipeline_reopen (priv->pipeline, clear_flags, uri,
+                       priv->reopen_generation);
+      if (gst_element_set_state (priv->pipeline, state) ==
+          GST_STATE_CHANGE_FAILURE)
+        priv->reopened_generation = priv->reopen_generation;
+      return;
+    }
 
-          gst_query_parse_seeking (query, NULL, &can_seek,
-                                   NULL,
-                                   NULL);
+  player_ensure_state_worker (priv);
 
-          priv->can_seek = (can_seek == TRUE) ? TRUE : FALSE;
-        }
-      else
-        {
-	  /* could not query for ability to seek by querying the
-           * pipeline; let's crudely try by using the URI
-	   */
-	  if (priv->uri && g_str_has_prefix (priv->uri, "http://"))
-            priv->can_seek = FALSE;
-          else
-            priv->can_seek = TRUE;
-	}
+  transition = g_slice_new0 (ClutterGstTransition);
+  transition->player = g_object_ref (player);
+  transition->pipeline = gst_object_ref (priv->pipeline);
+  transition->reopen = TRUE;
+  transition->clear_flags = clear_flags;
+  transition->uri = g_strdup (uri);
+  transition->generation = priv->reopen_generation;
+  transition->state = state;
 
-      gst_query_unref (query);
+  priv->pending_transitions++;
+  priv->async_state = state;
 
-      CLUTTER_GST_NOTE (MEDIA, "can-seek: %d", priv->can_seek);
+  CLUTTER_GST_NOTE (MEDIA, "queuing reopen to %s",
+                    gst_state_to_string (state));
 
-      g_object_notify (G_OBJECT (player), "can-seek");
+  g_thread_pool_push (priv->state_worker, transition, NULL);
+}
 
-      query_duration (player);
-    }
+/* Sets the state of a pipeline of the player other than priv->pipeline,
+ * like the pre-rolled ones, from the state worker when there's one */
+static void
+player_set_pipeline_state (ClutterGstPlayerPrivate *priv,
+                           GstElement              *pipeline,
+                           GstState                 state)
+{
+  ClutterGstTransition *transition;
 
-  /* is_idle controls the drawing with the idle material */
-  if (new_state == GST_STATE_NULL)
-    {
-      priv->is_idle = TRUE;
-      g_object_notify (G_OBJECT (player), "idle");
-    }
-  else if (new_state == GST_STATE_PLAYING)
+  if (!priv->async_state_changes && priv->state_worker == NULL)
     {
-      priv->is_idle = FALSE;
-      priv->is_changing_uri = FALSE;
-      g_object_notify (G_OBJECT (player), "idle");
+      gst_element_set_state (pipeline, state);
+      return;
     }
 
-  if (!priv->is_idle)
-    {
-      if (priv->stacked_progress)
-        {
-          set_progress (player, priv->stacked_progress);
-        }
-    }
+  player_ensure_state_worker (priv);
+
+  transition = g_slice_new0 (ClutterGstTransition);
+  transition->pipeline = gst_object_ref (pipeline);
+  transition->state = state;
+
+  g_thread_pool_push (priv->state_worker, transition, NULL);
 }
 
+/* Gets rid of a pipeline the player does not use anymore, taking ownership
+ * of @pipeline */
 static void
-bus_message_async_done_cb (GstBus           *bus,
-                           GstMessage       *message,
-                           ClutterGstPlayer *player)
+player_release_pipeline (ClutterGstPlayerPrivate *priv,
+                         GstElement              *pipeline)
+{
+  player_set_pipeline_state (priv, pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+}
+
+/* Returns the state priv->pipeline is going to, once the transitions queued
+ * to the state worker are done */
+static GstState
+player_get_pending_state (ClutterGstPlayer *player)
 {
   ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  GstState state, pending;
 
-  if (priv->in_seek)
-    {
-      g_object_notify (G_OBJECT (player), "progress");
+  if (priv->pending_transitions)
+    return priv->async_state;
 
-      set_in_seek (player, FALSE);
+  gst_element_get_state (priv->pipeline, &state, &pending, 0);
+  if (pending)
+    state = pending;
 
-      if (priv->stacked_progress)
-        {
-          set_progress (player, priv->stacked_progress);
-        }
-    }
+  return state;
 }
 
-static gboolean
-on_volume_changed_main_context (gpointer data)
+/* Callbacks from GStreamer's threads */
+
+static ClutterGstPlayerRef *
+player_ref_new (ClutterGstPlayer *player)
 {
-  ClutterGstPlayer *player = CLUTTER_GST_PLAYER (data);
-  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  ClutterGstPlayerRef *ref;
 
-  if (priv)
-    {
-      gdouble volume =
-        gst_stream_volume_get_volume (GST_STREAM_VOLUME (priv->pipeline),
-                                      GST_STREAM_VOLUME_FORMAT_CUBIC);
-      priv->volume = volume;
+  ref = g_slice_new0 (ClutterGstPlayerRef);
+  ref->ref_count = 1;
+  g_rec_mutex_init (&ref->lock);
+  ref->player = player;
 
-      g_object_notify (G_OBJECT (player), "audio-volume");
-    }
+  return ref;
+}
 
-  g_object_unref (player);
+static ClutterGstPlayerRef *
+player_ref_ref (ClutterGstPlayerRef *ref)
+{
+  g_atomic_int_inc (&ref->ref_count);
 
-  return FALSE;
+  return ref;
 }
 
-/* playbin proxies the volume property change notification directly from
- * the element having the "volume" property. This means this callback is
- * called from the thread that runs the element, potentially different from
- * the main thread */
+/* also used as the GClosureNotify of the signal handlers given @ref */
 static void
-on_volume_changed (GstElement       *pipeline,
-		   GParamSpec       *pspec,
-		   ClutterGstPlayer *player)
+player_ref_unref (ClutterGstPlayerRef *ref)
 {
-  g_idle_add (on_volume_changed_main_context, g_object_ref (player));
+  if (!g_atomic_int_dec_and_test (&ref->ref_count))
+    return;
+
+  g_rec_mutex_clear (&ref->lock);
+  g_slice_free (ClutterGstPlayerRef, ref);
 }
 
-static GList *
-get_tags (GstElement  *pipeline,
-          const gchar *property_name,
-          const gchar *action_signal)
+/* Returns the player of @ref with its lock held, the player and its private
+ * data staying around until player_ref_unlock(). Returns NULL, without the
+ * lock, once the player has been deinitialized */
+static ClutterGstPlayer *
+player_ref_lock (ClutterGstPlayerRef *ref)
 {
-  GList *ret = NULL;
-  gint i, n;
-
-  g_object_get (G_OBJECT (pipeline), property_name, &n, NULL);
-  if (n == 0)
-    return NULL;
+  g_rec_mutex_lock (&ref->lock);
 
-  for (i = 0; i < n; i++)
+  if (ref->player == NULL)
     {
-      GstTagList *tags = NULL;
+      g_rec_mutex_unlock (&ref->lock);
+      return NULL;
+    }
 
-      g_signal_emit_by_name (G_OBJECT (pipeline), action_signal, i, &tags);
+  return ref->player;
+}
 
-      ret = g_list_prepend (ret, tags);
-    }
+static void
+player_ref_unlock (ClutterGstPlayerRef *ref)
+{
+  g_rec_mutex_unlock (&ref->lock);
+}
 
-  return g_list_reverse (ret);
+/* Connects @callback to @signal of @instance with ref as user data */
+static void
+player_connect_ref (ClutterGstPlayerRef *ref,
+                    gpointer             instance,
+                    const gchar         *signal,
+                    GCallback            callback)
+{
+  g_signal_connect_data (instance, signal, callback,
+                         player_ref_ref (ref),
+                         (GClosureNotify) player_ref_unref,
+                         0);
 }
 
-static gboolean
-on_audio_changed_main_context (gpointer data)
+/* Frame stepping */
+
+static gint
+find_clutter_sink (gconstpointer a,
+                   gconstpointer b)
 {
-  ClutterGstPlayer *player = CLUTTER_GST_PLAYER (data);
-  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  return CLUTTER_GST_IS_VIDEO_SINK (g_value_get_object (a)) ? 0 : 1;
+}
 
-  if (priv)
-    {
-      free_tags_list (&priv->audio_streams);
-      priv->audio_streams = get_tags (priv->pipeline, "n-audio", "get-audio-tags");
+/* Returns the ClutterGstVideoSink of the pipeline, playbin's video sink
+ * usually being the autocluttersink bin around it */
+static GstElement *
+player_get_clutter_sink (ClutterGstPlayerPrivate *priv)
+{
+  GstElement *video_sink = NULL, *sink = NULL;
+  GValue item = G_VALUE_INIT;
+  GstIterator *it;
 
-      CLUTTER_GST_NOTE (AUDIO_STREAM, "audio-streams changed");
+  g_object_get (priv->pipeline, "video-sink", &video_sink, NULL);
+  if (video_sink == NULL)
+    return NULL;
 
-      g_object_notify (G_OBJECT (player), "audio-streams");
-    }
+  if (CLUTTER_GST_IS_VIDEO_SINK (video_sink))
+    return video_sink;
 
-  g_object_unref (player);
+  if (GST_IS_BIN (video_sink))
+    {
+      it = gst_bin_iterate_recurse (GST_BIN (video_sink));
+      if (gst_iterator_find_custom (it, find_clutter_sink, &item, NULL))
+        {
+          sink = g_value_dup_object (&item);
+          g_value_unset (&item);
+        }
+      gst_iterator_free (it);
+    }
 
-  return FALSE;
-}
+  gst_object_unref (video_sink);
 
-/* same explanation as for notify::volume's usage of g_idle_add() */
-static void
-on_audio_changed (GstElement       *pipeline,
-                  ClutterGstPlayer *player)
-{
-  g_idle_add (on_audio_changed_main_context, g_object_ref (player));
+  return sink;
 }
 
-static void
-on_audio_tags_changed (GstElement       *pipeline,
-                       gint              stream,
-                       ClutterGstPlayer *player)
+/* Returns the frame the pipeline is on */
+static GstSample *
+player_get_current_frame (ClutterGstPlayerPrivate *priv)
 {
-  gint current_stream;
+  GstSample *sample = NULL;
+  GstElement *sink;
 
-  g_object_get (G_OBJECT (pipeline), "current-audio", &current_stream, NULL);
+  sink = player_get_clutter_sink (priv);
+  if (sink == NULL)
+    return NULL;
 
-  if (current_stream != stream)
-    return;
+  g_object_get (sink, "last-sample", &sample, NULL);
+  gst_object_unref (sink);
 
-  g_idle_add (on_audio_changed_main_context, g_object_ref (player));
+  return sample;
 }
 
-static gboolean
-on_current_audio_changed_main_context (gpointer data)
+static GstClockTime
+frame_get_stream_time (GstSample *sample)
 {
-  ClutterGstPlayer *player = CLUTTER_GST_PLAYER (data);
+  const GstSegment *segment = gst_sample_get_segment (sample);
+  GstBuffer *buffer = gst_sample_get_buffer (sample);
 
-  CLUTTER_GST_NOTE (AUDIO_STREAM, "audio stream changed");
-  g_object_notify (G_OBJECT (player), "audio-stream");
+  if (buffer == NULL || !GST_BUFFER_PTS_IS_VALID (buffer))
+    return GST_CLOCK_TIME_NONE;
 
-  g_object_unref (player);
+  if (segment == NULL || segment->format != GST_FORMAT_TIME)
+    return GST_BUFFER_PTS (buffer);
 
-  return FALSE;
+  return gst_segment_to_stream_time (segment, GST_FORMAT_TIME,
+                                     GST_BUFFER_PTS (buffer));
 }
 
 static void
-on_current_audio_changed (GstElement       *pipeline,
-                          GParamSpec       *pspec,
-                          ClutterGstPlayer *player)
+player_clear_frame_cache (ClutterGstPlayerPrivate *priv)
 {
-  g_idle_add (on_current_audio_changed_main_context, g_object_ref (player));
+  g_queue_foreach (&priv->frame_cache, (GFunc) gst_sample_unref, NULL);
+  g_queue_clear (&priv->frame_cache);
+  priv->shown_frame = NULL;
+
+  priv->in_step = FALSE;
+  priv->in_step_seek = FALSE;
+  priv->step_back_target = GST_CLOCK_TIME_NONE;
+  priv->in_step_preroll = FALSE;
 }
 
-static gboolean
-on_text_changed_main_context (gpointer data)
+static void
+player_show_cached_frame (ClutterGstPlayer *player,
+                          GList            *link)
 {
-  ClutterGstPlayer *player = CLUTTER_GST_PLAYER (data);
   ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  GstElement *sink;
 
-  if (priv)
+  sink = player_get_clutter_sink (priv);
+  if (sink)
     {
-      free_tags_list (&priv->subtitle_tracks);
-      priv->subtitle_tracks = get_tags (priv->pipeline, "n-text", "get-text-tags");
-
-      CLUTTER_GST_NOTE (AUDIO_STREAM, "subtitle-tracks changed");
-
-      g_object_notify (G_OBJECT (player), "subtitle-tracks");
+      _clutter_gst_video_sink_show_buffer (sink,
+                                           gst_sample_get_buffer (link->data));
+      gst_object_unref (sink);
     }
 
-  g_object_unref (player);
+  /* the last frame is the one the pipeline is on */
+  priv->shown_frame = link == priv->frame_cache.tail ? NULL : link;
 
-  return FALSE;
+  g_object_notify (G_OBJECT (player), "progress");
 }
 
-/* same explanation as for notify::volume's usage of g_idle_add() */
+/* Drops the earliest frames the cache can't hold anymore. When the frame
+ * shown is one of them, the earliest frame left is shown instead */
 static void
-on_text_changed (GstElement       *pipeline,
-                  ClutterGstPlayer *player)
+player_trim_frame_cache (ClutterGstPlayer *player)
 {
-  g_idle_add (on_text_changed_main_context, g_object_ref (player));
-}
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  gboolean shown_dropped = FALSE;
 
-static void
-on_text_tags_changed (GstElement       *pipeline,
-                       gint              stream,
-                       ClutterGstPlayer *player)
-{
-  g_idle_add (on_text_changed_main_context, g_object_ref (player));
+  while (priv->frame_cache.length > priv->frame_cache_size)
+    {
+      if (priv->shown_frame == priv->frame_cache.head)
+        {
+          priv->shown_frame = NULL;
+          shown_dropped = TRUE;
+        }
+
+      gst_sample_unref (g_queue_pop_head (&priv->frame_cache));
+    }
+
+  if (shown_dropped && priv->frame_cache.head)
+    player_show_cached_frame (player, priv->frame_cache.head);
 }
 
-static gboolean
-on_current_text_changed_main_context (gpointer data)
+/* Adds @sample to the end of the cache. It's copied so that the cache
+ * doesn't hold buffers the decoder needs back */
+static void
+player_cache_frame (ClutterGstPlayer *player,
+                    GstSample        *sample)
 {
-  ClutterGstPlayer *player = CLUTTER_GST_PLAYER (data);
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  GstSample *frame;
+  GstBuffer *buffer;
 
-  CLUTTER_GST_NOTE (AUDIO_STREAM, "text stream changed");
-  g_object_notify (G_OBJECT (player), "subtitle-track");
+  buffer = gst_buffer_copy_region (gst_sample_get_buffer (sample),
+                                   GST_BUFFER_COPY_ALL | GST_BUFFER_COPY_DEEP,
+                                   0, -1);
+  frame = gst_sample_new (buffer,
+                          gst_sample_get_caps (sample),
+                          gst_sample_get_segment (sample),
+                          NULL);
+  gst_buffer_unref (buffer);
 
-  g_object_unref (player);
+  g_queue_push_tail (&priv->frame_cache, frame);
 
-  return FALSE;
+  player_trim_frame_cache (player);
 }
 
+/* Called with the frame the pipeline got to, during the pass decoding the
+ * frames before step_back_target */
 static void
-on_current_text_changed (GstElement       *pipeline,
-                          GParamSpec       *pspec,
-                          ClutterGstPlayer *player)
+player_continue_step_back (ClutterGstPlayer *player,
+                           GstSample        *sample)
 {
-  g_idle_add (on_current_text_changed_main_context, g_object_ref (player));
-}
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  GstClockTime position, duration;
 
-/* GObject's magic/madness */
+  position = sample ? frame_get_stream_time (sample) : GST_CLOCK_TIME_NONE;
+  if (!GST_CLOCK_TIME_IS_VALID (position))
+    {
+      player_clear_frame_cache (priv);
+      return;
+    }
 
-static void
-clutter_gst_player_set_property (GObject      *object,
-                                 guint         property_id,
-                                 const GValue *value,
-                                 GParamSpec   *pspec)
-{
-  ClutterGstPlayer *player = CLUTTER_GST_PLAYER (object);
-  ClutterGstPlayerIfacePrivate *iface_priv;
+  player_cache_frame (player, sample);
 
-  switch (property_id)
+  if (position >= priv->step_back_target)
     {
-    case PROP_URI:
-      set_uri (player, g_value_get_string (value));
-      break;
+      GList *previous = priv->frame_cache.tail->prev;
 
-    case PROP_PLAYING:
-      set_playing (player, g_value_get_boolean (value));
-      break;
+      /* one frame too far, the one we want is the one before, if any */
+      priv->in_step = FALSE;
+      priv->step_back_target = GST_CLOCK_TIME_NONE;
 
-    case PROP_PROGRESS:
-      set_progress (player, g_value_get_double (value));
-      break;
+      if (previous)
+        player_show_cached_frame (player, previous);
 
-    case PROP_SUBTITLE_URI:
-      set_subtitle_uri (player, g_value_get_string (value));
-      break;
+      return;
+    }
 
-    case PROP_SUBTITLE_FONT_NAME:
-      set_subtitle_font_name (player, g_value_get_string (value));
-      break;
+  /* when the next frame is the one we started from, this is the one we
+   * want and the pipeline is already on it */
+  duration = GST_BUFFER_DURATION (gst_sample_get_buffer (sample));
+  if (GST_CLOCK_TIME_IS_VALID (duration) &&
+      position + duration + duration / 2 > priv->step_back_target)
+    {
+      priv->in_step = FALSE;
+      priv->step_back_target = GST_CLOCK_TIME_NONE;
 
-    case PROP_AUDIO_VOLUME:
-      set_audio_volume (player, g_value_get_double (value));
-      break;
+      g_object_notify (G_OBJECT (player), "progress");
 
-    case PROP_USER_AGENT:
-      clutter_gst_player_set_user_agent (player,
-                                         g_value_get_string (value));
-      break;
+      return;
+    }
 
-    case PROP_SEEK_FLAGS:
-      clutter_gst_player_set_seek_flags (player,
-                                         g_value_get_flags (value));
-      break;
+  gst_element_send_event (priv->pipeline,
+                          gst_event_new_step (GST_FORMAT_BUFFERS, 1, 1.0,
+                                              TRUE, FALSE));
+}
 
-    case PROP_AUDIO_STREAM:
-      clutter_gst_player_set_audio_stream (player,
-                                           g_value_get_int (value));
-      break;
+/* Called once the frame the pipeline stepped to is pre-rolled, or once
+ * there's nothing to step to anymore */
+static void
+player_finish_step (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  GstClockTime previous = GST_CLOCK_TIME_NONE;
+  GstSample *sample;
 
-    case PROP_SUBTITLE_TRACK:
-      clutter_gst_player_set_subtitle_track (player,
-                                             g_value_get_int (value));
-      break;
+  priv->in_step_preroll = FALSE;
 
-    default:
-      iface_priv = clutter_gst_player_get_class_iface_priv (object);
-      g_assert (iface_priv != NULL);
-      iface_priv->set_property (object, property_id, value, pspec);
+  if (priv->frame_cache.tail)
+    previous = frame_get_stream_time (priv->frame_cache.tail->data);
+
+  sample = player_get_current_frame (priv);
+
+  /* nothing to step to, at the end of the media */
+  if (sample && GST_CLOCK_TIME_IS_VALID (previous) &&
+      frame_get_stream_time (sample) == previous)
+    {
+      gst_sample_unref (sample);
+      sample = NULL;
+    }
+
+  if (GST_CLOCK_TIME_IS_VALID (priv->step_back_target))
+    {
+      player_continue_step_back (player, sample);
+    }
+  else
+    {
+      priv->in_step = FALSE;
+
+      if (sample)
+        player_cache_frame (player, sample);
+
+      g_object_notify (G_OBJECT (player), "progress");
     }
+
+  if (sample)
+    gst_sample_unref (sample);
 }
 
+/* Stepping needs a paused pipeline, and one step at a time */
+static gboolean
+player_prepare_step (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+
+  if (!priv->pipeline || !priv->uri ||
+      priv->in_step || priv->in_seek || priv->is_changing_uri)
+    return FALSE;
+
+  if (get_playing (player))
+    {
+      set_playing (player, FALSE);
+      return FALSE;
+    }
+
+  return TRUE;
+}
 
 static void
-clutter_gst_player_get_property (GObject    *object,
-                                 guint       property_id,
-                                 GValue     *value,
-                                 GParamSpec *pspec)
+set_uri (ClutterGstPlayer *player,
+         const gchar      *uri)
 {
-  ClutterGstPlayer *player = CLUTTER_GST_PLAYER (object);
   ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
-  ClutterGstPlayerIfacePrivate *iface_priv;
-  gchar *str;
+  GObject *self = G_OBJECT (player);
+  GstState state;
+  gboolean swapped = FALSE;
 
-  switch (property_id)
+  CLUTTER_GST_NOTE (MEDIA, "setting uri %s", uri);
+
+  if (!priv->pipeline)
+    return;
+
+  /* a subtitle found too late is only kept for the media it belongs to */
+  if (g_strcmp0 (uri, priv->uri) != 0)
     {
-    case PROP_URI:
-      g_value_set_string (value, priv->uri);
-      break;
+      g_free (priv->pending_suburi);
+      priv->pending_suburi = NULL;
+    }
 
-    case PROP_PLAYING:
-      g_value_set_boolean (value, get_playing (player));
-      break;
+  g_free (priv->uri);
 
-    case PROP_PROGRESS:
-      g_value_set_double (value, get_progress (player));
-      break;
+  /* an explicit URI change cancels the gapless switch playbin may have
+   * been prepared for */
+  g_mutex_lock (&priv->queue_lock);
+  g_free (priv->next_uri);
+  priv->next_uri = NULL;
+  g_mutex_unlock (&priv->queue_lock);
 
-    case PROP_SUBTITLE_URI:
-      g_object_get (priv->pipeline, "suburi", &str, NULL);
-      g_value_take_string (value, str);
-      break;
+  priv->in_eos = FALSE;
+  priv->in_error = FALSE;
 
-    case PROP_SUBTITLE_FONT_NAME:
-      g_value_set_string (value, priv->font_name);
-      break;
+  player_cancel_subtitle_scan (priv);
+  player_discard_download (priv);
+  player_clear_frame_cache (priv);
+  player_release_timeshift (priv);
 
-    case PROP_AUDIO_VOLUME:
-      g_value_set_double (value, get_audio_volume (player));
-      break;
+  if (uri)
+    {
+      priv->uri = g_strdup (uri);
 
-    case PROP_CAN_SEEK:
-      g_value_set_boolean (value, priv->can_seek);
-      break;
+      player_ensure_audio_sink (player, priv->pipeline);
+      player_update_audio_flag (player);
 
-    case PROP_BUFFER_FILL:
-      g_value_set_double (value, priv->buffer_fill);
-      break;
+      /* give native video another chance with the new media, the errors
+       * of the previous one don't matter anymore */
+      priv->native_video_failed = FALSE;
+      priv->reopened_generation = priv->reopen_generation;
+      player_update_native_video_flag (player);
 
-    case PROP_DURATION:
-      g_value_set_double (value, priv->duration);
-      break;
+      /* the new media starts with its video, it's disabled again if the
+       * texture is still hidden after the grace period */
+      player_resume_video (player, FALSE);
+      if (priv->video_hidden)
+        player_schedule_video_disable (player);
 
-    case PROP_IDLE:
-      g_value_set_boolean (value, priv->is_idle);
-      break;
+      /* Ensure the tick timeout is installed.
+       *
+       * We also have it installed in PAUSED state, because
+       * seeks etc may have a delayed effect on the position.
+       */
+      if (priv->tick_timeout_id == 0)
+        {
+          priv->tick_timeout_id =
+            g_timeout_add (TICK_TIMEOUT, tick_timeout, self);
+        }
 
-    case PROP_USER_AGENT:
-      {
-        gchar *user_agent;
+      /* try to load subtitles based on the uri of the file */
+      set_subtitle_uri (player, NULL);
 
-        user_agent = clutter_gst_player_get_user_agent (player);
-        g_value_take_string (value, user_agent);
-      }
-      break;
+      /* reset the states of download buffering */
+      player_clear_download_buffering (player);
+    }
+  else
+    {
+      priv->uri = NULL;
 
-    case PROP_SEEK_FLAGS:
-      {
-        ClutterGstSeekFlags seek_flags;
+      if (priv->tick_timeout_id)
+	{
+	  g_source_remove (priv->tick_timeout_id);
+	  priv->tick_timeout_id = 0;
+	}
 
-        seek_flags = clutter_gst_player_get_seek_flags (player);
-        g_value_set_flags (value, seek_flags);
-      }
-      break;
+      if (priv->buffering_update_id)
+        {
+          g_source_remove (priv->buffering_update_id);
+          priv->buffering_update_id = 0;
+        }
 
-    case PROP_AUDIO_STREAMS:
-      g_value_set_pointer (value, priv->audio_streams);
-      break;
+      if (priv->download_buffering_element)
+        {
+          g_object_unref (priv->download_buffering_element);
+          priv->download_buffering_element = NULL;
+        }
 
-    case PROP_AUDIO_STREAM:
-      {
-        gint index_;
+    }
 
-        index_ = clutter_gst_player_get_audio_stream (player);
-        g_value_set_int (value, index_);
-      }
-      break;
+  g_array_set_size (priv->buffered_ranges, 0);
 
-    case PROP_SUBTITLE_TRACKS:
-      g_value_set_pointer (value, priv->subtitle_tracks);
-      break;
+  /* a new stream starts by filling its buffer */
+  priv->in_stream_buffering = TRUE;
+  priv->avg_out_rate = 0;
+  priv->buffering_time_left = 0.0;
 
-    case PROP_SUBTITLE_TRACK:
-      {
-        gint index_;
+  priv->can_seek = FALSE;
+  priv->duration = 0.0;
+  priv->stacked_progress = 0.0;
+  priv->target_progress = 0.0;
+  priv->seek_step_target = GST_CLOCK_TIME_NONE;
+  priv->in_seek_step = FALSE;
 
-        index_ = clutter_gst_player_get_subtitle_track (player);
-        g_value_set_int (value, index_);
-      }
-      break;
+  player_load_keyframe_index (player);
 
-    case PROP_IN_SEEK:
-      g_value_set_boolean (value, priv->in_seek);
-      break;
+  CLUTTER_GST_NOTE (MEDIA, "setting URI: %s", uri);
 
-    default:
-      iface_priv = clutter_gst_player_get_class_iface_priv (object);
-      iface_priv->get_property (object, property_id, value, pspec);
+  if (uri)
+    {
+      swapped = player_swap_standby (player, uri);
     }
-}
 
-/**
- * clutter_gst_player_class_init:
- * @object_class: a #GObjectClass
- *
- * Adds the #ClutterGstPlayer properties to a class and surchages the
- * set/get_property of #GObjectClass. You should call this
- * function at the end of the class_init method of the class
- * implementing #ClutterGstPlayer.
- *
- * Since: 1.4
- */
-void
-clutter_gst_player_class_init (GObjectClass *object_class)
-{
-  ClutterGstPlayerIfacePrivate *priv;
+  /* when swapped, the pipeline for uri was already pre-rolled */
+  if (!swapped && uri && priv->async_state_changes)
+    {
+      state = player_get_pending_state (player);
 
-  priv = g_new0 (ClutterGstPlayerIfacePrivate, 1);
-  g_type_set_qdata (G_OBJECT_CLASS_TYPE (object_class),
-                    clutter_gst_player_class_quark,
-                    priv);
+      /* the worker thread takes care of the NULL state, the URI and the
+       * subtitles, ::uri-loaded is emitted when it's done */
+      player_push_transition (player, uri, state);
 
-  /* Save object's methods we want to override */
-  priv->set_property = object_class->set_property;
-  priv->get_property = object_class->get_property;
+      priv->is_changing_uri = TRUE;
+    }
+  else if (!swapped && uri)
+    {
+      gchar *play_uri;
 
-  /* Replace by our methods */
-  object_class->set_property = clutter_gst_player_set_property;
-  object_class->get_property = clutter_gst_player_get_property;
+      state = player_get_pending_state (player);
 
-  /* Override ClutterMedia's properties */
-  g_object_class_override_property (object_class,
-                                    PROP_URI, "uri");
-  g_object_class_override_property (object_class,
-                                    PROP_PLAYING, "playing");
-  g_object_class_override_property (object_class,
-                                    PROP_PROGRESS, "progress");
-  g_object_class_override_property (object_class,
-                                    PROP_SUBTITLE_URI, "subtitle-uri");
-  g_object_class_override_property (object_class,
-                                    PROP_SUBTITLE_FONT_NAME,
-                                    "subtitle-font-name");
-  g_object_class_override_property (object_class,
-                                    PROP_AUDIO_VOLUME, "audio-volume");
-  g_object_class_override_property (object_class,
-                                    PROP_CAN_SEEK, "can-seek");
-  g_object_class_override_property (object_class,
-                                    PROP_DURATION, "duration");
-  g_object_class_override_property (object_class,
-                                    PROP_BUFFER_FILL, "buffer-fill");
-
-  /* Override ClutterGstPlayer's properties */
-  g_object_class_override_property (object_class,
-                                    PROP_IDLE, "idle");
-  g_object_class_override_property (object_class,
-                                    PROP_USER_AGENT, "user-agent");
-  g_object_class_override_property (object_class,
-                                    PROP_SEEK_FLAGS, "seek-flags");
+      player_set_state (player, GST_STATE_NULL);
 
-  g_object_class_override_property (object_class,
-                                    PROP_AUDIO_STREAMS, "audio-streams");
-  g_object_class_override_property (object_class,
-                                    PROP_AUDIO_STREAM, "audio-stream");
+      play_uri = player_resolve_uri (priv, uri, TRUE);
+      g_object_set (priv->pipeline, "uri", play_uri, NULL);
+      g_free (play_uri);
 
-  g_object_class_override_property (object_class,
-                                    PROP_SUBTITLE_TRACKS, "subtitle-tracks");
-  g_object_class_override_property (object_class,
-                                    PROP_SUBTITLE_TRACK, "subtitle-track");
-  g_object_class_override_property (object_class,
-                                    PROP_IN_SEEK, "in-seek");
-}
+      set_subtitle_uri (player, priv->pending_suburi);
+      g_free (priv->pending_suburi);
+      priv->pending_suburi = NULL;
+      autoload_subtitle (player, uri);
 
-static GstElement *
-get_pipeline (void)
-{
-  GstElement *pipeline, *audio_sink;
+      player_set_state (player, state);
 
-  pipeline = gst_element_factory_make ("playbin", "pipeline");
-  if (!pipeline)
+      priv->is_changing_uri = TRUE;
+    }
+  else if (uri == NULL)
     {
-      g_critical ("Unable to create playbin element");
-      return NULL;
+      priv->is_idle = TRUE;
+      set_subtitle_uri (player, NULL);
+      player_set_state (player, GST_STATE_NULL);
+      g_object_notify (G_OBJECT (player), "idle");
     }
 
-  audio_sink = gst_element_factory_make ("gconfaudiosink", "audio-sink");
-  if (!audio_sink)
-    {
-      audio_sink = gst_element_factory_make ("autoaudiosink", "audio-sink");
-      if (!audio_sink)
-	{
-	  audio_sink = gst_element_factory_make ("alsasink", "audio-sink");
-	  g_warning ("Could not create a GST audio_sink. "
-		     "Audio unavailable.");
+  /*
+   * Emit notifications for all these to make sure UI is not showing
+   * any properties of the old URI.
+   */
+  g_object_notify (self, "uri");
+  g_object_notify (self, "can-seek");
+  g_object_notify (self, "duration");
+  g_object_notify (self, "progress");
 
-          /* do we even need to bother? */
-	  if (!audio_sink)
-	    audio_sink = gst_element_factory_make ("fakesink", "audio-sink");
-	}
+  free_tags_list (&priv->audio_streams);
+  free_tags_list (&priv->subtitle_tracks);
+
+  /* a pre-rolled pipeline has already announced its streams */
+  if (swapped)
+    {
+      priv->audio_streams =
+        get_tags (priv->pipeline, "n-audio", "get-audio-tags");
+      priv->subtitle_tracks =
+        get_tags (priv->pipeline, "n-text", "get-text-tags");
     }
 
-  g_object_set (G_OBJECT (pipeline),
-                "audio-sink", audio_sink,
-                "subtitle-font-desc", "Sans 16",
-                NULL);
+  CLUTTER_GST_NOTE (AUDIO_STREAM, "audio-streams changed");
+  g_object_notify (self, "audio-streams");
 
-  return pipeline;
+  CLUTTER_GST_NOTE (SUBTITLES, "subtitle-tracks changed");
+  g_object_notify (self, "subtitle-tracks");
 }
 
-/* ClutterGstPlayerIface implementation */
-
-static GstElement *
-clutter_gst_player_get_pipeline_impl (ClutterGstPlayer *player)
+static void
+set_in_seek (ClutterGstPlayer *player,
+             gboolean          seeking)
 {
-  ClutterGstPlayerPrivate *priv;
-
-  priv = PLAYER_GET_PRIVATE (player);
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
 
-  return priv->pipeline;
+  priv->in_seek = seeking;
+  g_object_notify (G_OBJECT (player), "in-seek");
 }
 
-static gchar *
-clutter_gst_player_get_user_agent_impl (ClutterGstPlayer *player)
+/* Flushing seek to @position. When looping, the pipeline is kept in segment
+ * mode, we want a SEGMENT_DONE message instead of an EOS at the end of the
+ * loop */
+static void
+player_seek (ClutterGstPlayer *player,
+             gint64            position,
+             GstSeekFlags      flags)
 {
-  ClutterGstPlayerPrivate *priv;
-  GstElement *source;
-  GParamSpec *pspec;
-  gchar *user_agent;
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  GstSeekType stop_type = GST_SEEK_TYPE_NONE;
+  gint64 stop = GST_CLOCK_TIME_NONE;
 
-  priv = PLAYER_GET_PRIVATE (player);
+  flags |= GST_SEEK_FLAG_FLUSH;
 
-  /* If the user has set a custom user agent, we just return it even if it is
-   * not used by the current source element of the pipeline */
-  if (priv->user_agent)
-    return g_strdup (priv->user_agent);
+  if (priv->loop)
+    {
+      flags |= GST_SEEK_FLAG_SEGMENT;
+      stop_type = GST_SEEK_TYPE_SET;
+      if (priv->loop_stop >= 0.0)
+        stop = priv->loop_stop * GST_SECOND;
+    }
 
-  /* If not, we try to retrieve the user agent used by the current source */
-  g_object_get (priv->pipeline, "source", &source, NULL);
-  if (source == NULL)
-    return NULL;
+  gst_element_seek (priv->pipeline,
+                    1.0,
+                    GST_FORMAT_TIME,
+                    flags,
+                    GST_SEEK_TYPE_SET,
+                    position,
+                    stop_type, stop);
 
-  pspec = g_object_class_find_property (G_OBJECT_GET_CLASS (source),
-                                        "user-agent");
-  if (pspec == NULL)
-    return NULL;
+  set_in_seek (player, TRUE);
+}
 
-  g_object_get (source, "user-agent", &user_agent, NULL);
 
-  return user_agent;
-}
+/* Timeshift */
 
-static void
-clutter_gst_player_set_user_agent_impl (ClutterGstPlayer *player,
-                                        const gchar      *user_agent)
+/* uridecodebin puts a queue2 between the source and the demuxer of network
+ * streams. That's the one receiving the stream, where it can be kept */
+static gboolean
+element_is_network_queue (GstElement *element)
 {
-  ClutterGstPlayerPrivate *priv;
+  GstElementFactory *factory;
+  GstObject *parent;
+  gboolean ret = FALSE;
+
+  factory = gst_element_get_factory (element);
+  if (factory == NULL ||
+      strcmp (gst_plugin_feature_get_name (GST_PLUGIN_FEATURE (factory)),
+              "queue2") != 0)
+    return FALSE;
 
-  priv = PLAYER_GET_PRIVATE (player);
+  parent = gst_object_get_parent (GST_OBJECT (element));
+  if (parent == NULL)
+    return FALSE;
 
-  g_free (priv->user_agent);
-  if (user_agent)
-    priv->user_agent = g_strdup (user_agent);
-  else
-    priv->user_agent = NULL;
+  if (GST_IS_ELEMENT (parent))
+    {
+      factory = gst_element_get_factory (GST_ELEMENT (parent));
+      ret = factory &&
+            strcmp (gst_plugin_feature_get_name (GST_PLUGIN_FEATURE (factory)),
+                    "uridecodebin") == 0;
+    }
+  gst_object_unref (parent);
 
-  player_set_user_agent (player, user_agent);
+  return ret;
 }
 
-static ClutterGstSeekFlags
-clutter_gst_player_get_seek_flags_impl (ClutterGstPlayer *player)
+static gint
+find_network_queue (gconstpointer a,
+                    gconstpointer b)
 {
-  ClutterGstPlayerPrivate *priv;
-
-  priv = PLAYER_GET_PRIVATE (player);
-
-  if (priv->seek_flags == GST_SEEK_FLAG_ACCURATE)
-    return CLUTTER_GST_SEEK_FLAG_ACCURATE;
-  else
-    return CLUTTER_GST_SEEK_FLAG_NONE;
+  return element_is_network_queue (g_value_get_object (a)) ? 0 : 1;
 }
 
-static void
-clutter_gst_player_set_seek_flags_impl (ClutterGstPlayer    *player,
-                                        ClutterGstSeekFlags  flags)
+static gboolean
+source_is_live (GstElement *source)
 {
-  ClutterGstPlayerPrivate *priv;
+  gboolean live = FALSE;
 
-  priv = PLAYER_GET_PRIVATE (player);
+  if (GST_IS_BASE_SRC (source))
+    return gst_base_src_is_live (GST_BASE_SRC (source));
 
-  if (flags == CLUTTER_GST_SEEK_FLAG_NONE)
-    priv->seek_flags = GST_SEEK_FLAG_KEY_UNIT;
-  else if (flags & CLUTTER_GST_SEEK_FLAG_ACCURATE)
-    priv->seek_flags = GST_SEEK_FLAG_ACCURATE;
+  if (g_object_class_find_property (G_OBJECT_GET_CLASS (source), "is-live"))
+    g_object_get (source, "is-live", &live, NULL);
+
+  return live;
 }
 
-static ClutterGstBufferingMode
-clutter_gst_player_get_buffering_mode_impl (ClutterGstPlayer *player)
+static void
+player_release_timeshift (ClutterGstPlayerPrivate *priv)
 {
-  ClutterGstPlayerPrivate *priv;
-  GstPlayFlags flags;
-
-  priv = PLAYER_GET_PRIVATE (player);
-
-  g_object_get (G_OBJECT (priv->pipeline), "flags", &flags, NULL);
-
-  if (flags & GST_PLAY_FLAG_DOWNLOAD)
-    return CLUTTER_GST_BUFFERING_MODE_DOWNLOAD;
+  if (priv->timeshift_source)
+    {
+      gst_element_set_locked_state (priv->timeshift_source, FALSE);
+      gst_object_unref (priv->timeshift_source);
+      priv->timeshift_source = NULL;
+    }
 
-  return CLUTTER_GST_BUFFERING_MODE_STREAM;
+  if (priv->timeshift_queue)
+    {
+      gst_element_set_locked_state (priv->timeshift_queue, FALSE);
+      gst_object_unref (priv->timeshift_queue);
+      priv->timeshift_queue = NULL;
+    }
 }
 
+/* A live source doesn't produce anything while paused. To pause a live
+ * stream without losing it, the source and the network queue, with its
+ * ring buffer, are left playing while the rest of the pipeline is paused.
+ * The stream piles up in the ring buffer, and playback resumes from where
+ * it was paused */
 static void
-clutter_gst_player_set_buffering_mode_impl (ClutterGstPlayer        *player,
-                                            ClutterGstBufferingMode  mode)
+player_update_timeshift (ClutterGstPlayer *player,
+                         gboolean          playing)
 {
-  ClutterGstPlayerPrivate *priv;
-  GstPlayFlags flags;
-
-  priv = PLAYER_GET_PRIVATE (player);
-
-  g_object_get (G_OBJECT (priv->pipeline), "flags", &flags, NULL);
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  GstElement *source = NULL, *queue = NULL;
+  GValue item = G_VALUE_INIT;
+  GstIterator *it;
 
-  switch (mode)
+  if (playing || priv->timeshift_size == 0)
     {
-    case CLUTTER_GST_BUFFERING_MODE_STREAM:
-      flags &= ~GST_PLAY_FLAG_DOWNLOAD;
-      break;
-
-    case CLUTTER_GST_BUFFERING_MODE_DOWNLOAD:
-      flags |= GST_PLAY_FLAG_DOWNLOAD;
-      break;
-
-    default:
-      g_warning ("Unexpected buffering mode %d", mode);
-      break;
+      player_release_timeshift (priv);
+      return;
     }
 
-  g_object_set (G_OBJECT (priv->pipeline), "flags", flags, NULL);
-}
-
-static GList *
-clutter_gst_player_get_audio_streams_impl (ClutterGstPlayer *player)
-{
-  ClutterGstPlayerPrivate *priv;
+  if (priv->timeshift_source)
+    return;
 
-  priv = PLAYER_GET_PRIVATE (player);
+  g_object_get (priv->pipeline, "source", &source, NULL);
+  if (source == NULL)
+    return;
 
-  if (CLUTTER_GST_DEBUG_ENABLED (AUDIO_STREAM))
+  if (!source_is_live (source))
     {
-      gchar *streams;
-
-      streams = list_to_string (priv->audio_streams);
-      CLUTTER_GST_NOTE (AUDIO_STREAM, "audio streams: %s", streams);
-      g_free (streams);
+      gst_object_unref (source);
+      return;
     }
 
-  return priv->audio_streams;
-}
-
-static gint
-clutter_gst_player_get_audio_stream_impl (ClutterGstPlayer *player)
-{
-  ClutterGstPlayerPrivate *priv;
-  gint index_ = -1;
+  it = gst_bin_iterate_recurse (GST_BIN (priv->pipeline));
+  if (gst_iterator_find_custom (it, find_network_queue, &item, NULL))
+    {
+      queue = g_value_dup_object (&item);
+      g_value_unset (&item);
+    }
+  gst_iterator_free (it);
 
-  priv = PLAYER_GET_PRIVATE (player);
+  if (queue == NULL)
+    {
+      gst_object_unref (source);
+      return;
+    }
 
-  g_object_get (G_OBJECT (priv->pipeline),
-                "current-audio", &index_,
-                NULL);
+  CLUTTER_GST_NOTE (BUFFERING, "timeshift: %s keeps receiving while paused",
+                    GST_ELEMENT_NAME (source));
 
-  CLUTTER_GST_NOTE (AUDIO_STREAM, "audio stream is #%d", index_);
+  gst_element_set_locked_state (source, TRUE);
+  gst_element_set_locked_state (queue, TRUE);
 
-  return index_;
+  priv->timeshift_source = source;
+  priv->timeshift_queue = queue;
 }
 
 static void
-clutter_gst_player_set_audio_stream_impl (ClutterGstPlayer *player,
-                                          gint              index_)
+set_playing (ClutterGstPlayer *player,
+             gboolean          playing)
 {
-  ClutterGstPlayerPrivate *priv;
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
 
-  priv = PLAYER_GET_PRIVATE (player);
+  if (!priv->pipeline)
+    return;
 
-  g_return_if_fail (index_ >= 0 &&
-                    index_ < (gint) g_list_length (priv->audio_streams));
+  CLUTTER_GST_NOTE (MEDIA, "set playing: %d", playing);
 
-  CLUTTER_GST_NOTE (AUDIO_STREAM, "set audio audio stream to #%d", index_);
+  priv->in_error = FALSE;
+  priv->in_eos = FALSE;
 
-  g_object_set (G_OBJECT (priv->pipeline),
-                "current-audio", index_,
-                NULL);
-}
+  priv->target_state = playing ? GST_STATE_PLAYING : GST_STATE_PAUSED;
 
-static GList *
-clutter_gst_player_get_subtitle_tracks_impl (ClutterGstPlayer *player)
-{
-  ClutterGstPlayerPrivate *priv;
+  if (priv->uri)
+    {
+      set_in_seek (player, FALSE);
 
-  priv = PLAYER_GET_PRIVATE (player);
+      /* resume from the frame shown, not from where stepping back left the
+       * pipeline */
+      if (playing && priv->shown_frame)
+        player_seek (player,
+                     frame_get_stream_time (priv->shown_frame->data),
+                     GST_SEEK_FLAG_ACCURATE);
 
-  if (CLUTTER_GST_DEBUG_ENABLED (SUBTITLES))
+      player_update_timeshift (player, playing);
+      player_set_state (player, priv->target_state);
+    }
+  else
     {
-      gchar *tracks;
-
-      tracks = list_to_string (priv->subtitle_tracks);
-      CLUTTER_GST_NOTE (SUBTITLES, "subtitle tracks: %s", tracks);
-      g_free (tracks);
+      if (playing)
+       g_warning ("Unable to start playing: no URI is set");
     }
 
-  return priv->subtitle_tracks;
+  if (playing)
+    player_clear_frame_cache (priv);
+
+  g_object_notify (G_OBJECT (player), "playing");
+  g_object_notify (G_OBJECT (player), "progress");
 }
 
-static gint
-clutter_gst_player_get_subtitle_track_impl (ClutterGstPlayer *player)
+static gboolean
+get_playing (ClutterGstPlayer *player)
 {
-  ClutterGstPlayerPrivate *priv;
-  gint index_ = -1;
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  GstState state, pending;
+  gboolean playing;
 
-  priv = PLAYER_GET_PRIVATE (player);
+  if (!priv->pipeline)
+    return FALSE;
 
-  g_object_get (G_OBJECT (priv->pipeline),
-                "current-text", &index_,
-                NULL);
+  gst_element_get_state (priv->pipeline, &state, &pending, 0);
 
-  CLUTTER_GST_NOTE (SUBTITLES, "text track is #%d", index_);
+  if (priv->pending_transitions)
+    playing = (priv->async_state == GST_STATE_PLAYING);
+  else if (pending)
+    playing = (pending == GST_STATE_PLAYING);
+  else
+    playing = (state == GST_STATE_PLAYING);
 
-  return index_;
+  CLUTTER_GST_NOTE (MEDIA, "get playing: %d", playing);
+
+  return playing;
 }
 
 static void
-clutter_gst_player_set_subtitle_track_impl (ClutterGstPlayer *player,
-                                            gint              index_)
+set_progress (ClutterGstPlayer *player,
+              gdouble           progress)
 {
-  ClutterGstPlayerPrivate *priv;
-  GstPlayFlags flags;
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  GstQuery *duration_q;
+  GstSeekFlags flags;
+  gint64 position;
 
-  priv = PLAYER_GET_PRIVATE (player);
+  if (!priv->pipeline)
+    return;
 
-  g_return_if_fail (index_ >= -1 &&
-                    index_ < (gint) g_list_length (priv->subtitle_tracks));
+  CLUTTER_GST_NOTE (MEDIA, "set progress: %.02f", progress);
 
-  CLUTTER_GST_NOTE (SUBTITLES, "set subtitle track to #%d", index_);
+  player_clear_frame_cache (priv);
 
-  g_object_get (priv->pipeline, "flags", &flags, NULL);
-  flags &= ~GST_PLAY_FLAG_TEXT;
-  g_object_set (priv->pipeline, "flags", flags, NULL);
+  priv->in_eos = FALSE;
+  priv->target_progress = progress;
 
-  if (index_ >= 0)
+  if (priv->in_download_buffering)
     {
-      g_object_set (G_OBJECT (priv->pipeline),
-                    "current-text", index_,
-                    NULL);
-
-      flags |= GST_PLAY_FLAG_TEXT;
-      g_object_set (priv->pipeline, "flags", flags, NULL);
+      /* we clear the virtual_stream_buffer_signalled flag as it's likely we
+       * need to buffer again */
+      priv->virtual_stream_buffer_signalled = 0;
     }
-}
 
-static gboolean
-clutter_gst_player_get_idle_impl (ClutterGstPlayer *player)
-{
-  ClutterGstPlayerPrivate *priv;
+  if (priv->in_seek || priv->is_idle || priv->is_changing_uri)
+    {
+      /* We can't seek right now, let's save the position where we
+         want to seek and do that later. */
+      CLUTTER_GST_NOTE (MEDIA,
+                        "already seeking/idleing. stacking progress point.");
+      priv->stacked_progress = progress;
+      return;
+    }
 
-  priv = PLAYER_GET_PRIVATE (player);
+  duration_q = gst_query_new_duration (GST_FORMAT_TIME);
 
-  return priv->is_idle;
-}
+  if (gst_element_query (priv->pipeline, duration_q))
+    {
+      gint64 duration = 0;
 
-static gboolean
-clutter_gst_player_get_in_seek_impl (ClutterGstPlayer *player)
-{
-  ClutterGstPlayerPrivate *priv;
+      gst_query_parse_duration (duration_q, NULL, &duration);
 
-  priv = PLAYER_GET_PRIVATE (player);
+      position = progress * duration;
+    }
+  else
+    position = 0;
 
-  return priv->in_seek;
-}
+  gst_query_unref (duration_q);
 
+  flags = priv->seek_flags;
 
-/**/
+  priv->seek_step_target = GST_CLOCK_TIME_NONE;
+  priv->in_seek_step = FALSE;
 
-#if defined (CLUTTER_WINDOWING_X11) && defined (HAVE_HW_DECODER_SUPPORT)
-static GstBusSyncReply
-on_sync_message (GstBus * bus, GstMessage * message, gpointer user_data)
-{
-  Display *display = user_data;
-  GstVideoContext *context;
-  const gchar **types;
+  /* how demuxers find the frame of an accurate seek depends on the index of
+   * the container, from a jump to a slow scan. When we know the key frame
+   * before the position, we go there and step forward, a known amount of
+   * decoding. Only when paused, stepping is for the video only and would
+   * leave the audio behind while playing */
+  if (priv->keyframe_index && priv->seek_flags == GST_SEEK_FLAG_ACCURATE &&
+      priv->target_state == GST_STATE_PAUSED && !priv->loop)
+    {
+      GstClockTime keyframe;
 
-  if (gst_video_context_message_parse_prepare (message, &types, &context)) {
-    gint i;
+      keyframe = _clutter_gst_keyframe_index_lookup (priv->keyframe_index,
+                                                     position);
+      if (GST_CLOCK_TIME_IS_VALID (keyframe) && keyframe < (guint64) position)
+        {
+          CLUTTER_GST_NOTE (MEDIA, "seeking to the key frame at %"
+                            GST_TIME_FORMAT, GST_TIME_ARGS (keyframe));
 
-    for (i = 0; types[i]; i++) {
+          flags = GST_SEEK_FLAG_KEY_UNIT | GST_SEEK_FLAG_SNAP_BEFORE;
+          priv->seek_step_target = position;
+          position = keyframe;
+        }
+    }
 
-      if (!strcmp(types[i], "x11-display")) {
-        gst_video_context_set_context_pointer (context, "x11-display", display);
-      }
-      else if (!strcmp(types[i], "x11-display-name")) {
-        gst_video_context_set_context_string (context, "x11-display-name",
-            DisplayString (display));
-      } else {
-        continue;
-      }
+  player_seek (player, position, flags);
 
-      gst_message_unref (message);
-      return GST_BUS_DROP;
-    }
-  }
+  priv->stacked_progress = 0.0;
 
-  return GST_BUS_PASS;
+  CLUTTER_GST_NOTE (MEDIA, "set progress (seeked): %.02f", progress);
 }
-#endif
 
-/**
- * clutter_gst_player_init:
- * @player: a #ClutterGstPlayer
- *
- * Initialize a #ClutterGstPlayer instance. You should call this
- * function at the beginning of the init method of the class
- * implementing #ClutterGstPlayer.
- *
- * When you're finished with the ClutterGstPlayer mixin features (usually in
- * the dispose or finalize vfuncs), call clutter_gst_player_deinit() to
- * desallocate the resources created by clutter_gst_player_init().
- *
- * Return value: TRUE if the initialization was successfull, FALSE otherwise.
- *
- * Since: 1.4
- */
-gboolean
-clutter_gst_player_init (ClutterGstPlayer *player)
+static gdouble
+get_progress (ClutterGstPlayer *player)
 {
-  ClutterGstPlayerPrivate *priv;
-  ClutterGstPlayerIface *iface;
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  GstQuery *position_q, *duration_q;
+  gdouble progress;
 
-  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player), FALSE);
+  if (!priv->pipeline)
+    return 0.0;
 
-  priv = PLAYER_GET_PRIVATE (player);
-  if (priv)
-    return TRUE;
+  /* when hitting an error or after an EOS, playbin has some weird values when
+   * querying the duration and progress. We default to 0.0 on error and 1.0 on
+   * EOS */
+  if (priv->in_error)
+    {
+      CLUTTER_GST_NOTE (MEDIA, "get progress (error): 0.0");
+      return 0.0;
+    }
 
-  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+  if (priv->in_eos)
+    {
+      CLUTTER_GST_NOTE (MEDIA, "get progress (eos): 1.0");
+      return 1.0;
+    }
 
-  iface->get_pipeline = clutter_gst_player_get_pipeline_impl;
-  iface->get_user_agent = clutter_gst_player_get_user_agent_impl;
-  iface->set_user_agent = clutter_gst_player_set_user_agent_impl;
-  iface->get_seek_flags = clutter_gst_player_get_seek_flags_impl;
-  iface->set_seek_flags = clutter_gst_player_set_seek_flags_impl;
-  iface->get_buffering_mode = clutter_gst_player_get_buffering_mode_impl;
-  iface->set_buffering_mode = clutter_gst_player_set_buffering_mode_impl;
-  iface->get_audio_streams = clutter_gst_player_get_audio_streams_impl;
-  iface->get_audio_stream = clutter_gst_player_get_audio_stream_impl;
-  iface->set_audio_stream = clutter_gst_player_set_audio_stream_impl;
-  iface->get_subtitle_tracks = clutter_gst_player_get_subtitle_tracks_impl;
-  iface->get_subtitle_track = clutter_gst_player_get_subtitle_track_impl;
-  iface->set_subtitle_track = clutter_gst_player_set_subtitle_track_impl;
-  iface->get_idle = clutter_gst_player_get_idle_impl;
-  iface->get_in_seek = clutter_gst_player_get_in_seek_impl;
+  /* When seeking, the progress returned by playbin is 0.0. We want that to be
+   * the last known position instead as returning 0.0 will have some ugly
+   * effects, say on a progress bar getting updated from the progress tick. */
+  if (priv->in_seek || priv->is_changing_uri)
+    {
+      CLUTTER_GST_NOTE (MEDIA, "get progress (target): %.02f",
+                        priv->target_progress);
+      return priv->target_progress;
+    }
 
-  priv = g_slice_new0 (ClutterGstPlayerPrivate);
-  PLAYER_SET_PRIVATE (player, priv);
+  /* the pipeline is further than the frame shown after stepping back */
+  if (priv->shown_frame && priv->duration > 0)
+    {
+      GstClockTime position;
 
-  priv->is_idle = TRUE;
-  priv->in_seek = FALSE;
-  priv->is_changing_uri = FALSE;
-  priv->in_download_buffering = FALSE;
+      position = frame_get_stream_time (priv->shown_frame->data);
+      progress = CLAMP ((gdouble) position / GST_SECOND / priv->duration,
+                        0.0, 1.0);
 
-  priv->pipeline = get_pipeline ();
-  if (!priv->pipeline)
-    {
-      g_critical ("Unable to create pipeline");
-      return FALSE;
+      CLUTTER_GST_NOTE (MEDIA, "get progress (frame): %.02f", progress);
+      return progress;
     }
 
-  g_signal_connect (priv->pipeline, "notify::source",
-                    G_CALLBACK (on_source_changed), player);
+  position_q = gst_query_new_position (GST_FORMAT_TIME);
+  duration_q = gst_query_new_duration (GST_FORMAT_TIME);
 
-  /* We default to not playing until someone calls set_playing(TRUE) */
-  priv->target_state = GST_STATE_PAUSED;
+  if (gst_element_query (priv->pipeline, position_q) &&
+      gst_element_query (priv->pipeline, duration_q))
+    {
+      gint64 position, duration;
 
-  /* Default to a fast seek, ie. same effect than set_seek_flags (NONE); */
-  priv->seek_flags = GST_SEEK_FLAG_KEY_UNIT;
+      position = duration = 0;
 
-  priv->bus = gst_pipeline_get_bus (GST_PIPELINE (priv->pipeline));
+      gst_query_parse_position (position_q, NULL, &position);
+      gst_query_parse_duration (duration_q, NULL, &duration);
 
-  gst_bus_add_signal_watch (priv->bus);
+      progress = CLAMP ((gdouble) position / (gdouble) duration, 0.0, 1.0);
+    }
+  else
+    progress = 0.0;
 
-  g_signal_connect_object (priv->bus, "message::error",
-			   G_CALLBACK (bus_message_error_cb),
-			   player, 0);
-  g_signal_connect_object (priv->bus, "message::eos",
-			   G_CALLBACK (bus_message_eos_cb),
-			   player, 0);
-  g_signal_connect_object (priv->bus, "message::buffering",
-			   G_CALLBACK (bus_message_buffering_cb),
-			   player, 0);
-  g_signal_connect_object (priv->bus, "message::duration-changed",
-			   G_CALLBACK (bus_message_duration_changed_cb),
-			   player, 0);
-  g_signal_connect_object (priv->bus, "message::state-changed",
-			   G_CALLBACK (bus_message_state_change_cb),
-			   player, 0);
-  g_signal_connect_object (priv->bus, "message::async-done",
-                           G_CALLBACK (bus_message_async_done_cb),
-                           player, 0);
+  gst_query_unref (position_q);
+  gst_query_unref (duration_q);
 
-  g_signal_connect (priv->pipeline, "notify::volume",
-		    G_CALLBACK (on_volume_changed),
-                    player);
-
-  g_signal_connect (priv->pipeline, "audio-changed",
-                    G_CALLBACK (on_audio_changed),
-                    player);
-  g_signal_connect (priv->pipeline, "audio-tags-changed",
-                    G_CALLBACK (on_audio_tags_changed),
-                    player);
-  g_signal_connect (priv->pipeline, "notify::current-audio",
-                    G_CALLBACK (on_current_audio_changed),
-                    player);
-
-  g_signal_connect (priv->pipeline, "text-changed",
-                    G_CALLBACK (on_text_changed),
-                    player);
-  g_signal_connect (priv->pipeline, "text-tags-changed",
-                    G_CALLBACK (on_text_tags_changed),
-                    player);
-  g_signal_connect (priv->pipeline, "notify::current-text",
-                    G_CALLBACK (on_current_text_changed),
-                    player);
+  CLUTTER_GST_NOTE (MEDIA, "get progress (pipeline): %.02f", progress);
 
-#if defined(CLUTTER_WINDOWING_X11) && defined (HAVE_HW_DECODER_SUPPORT)
-  if (clutter_check_windowing_backend (CLUTTER_WINDOWING_X11))
-    gst_bus_set_sync_handler (priv->bus, on_sync_message,
-                              clutter_x11_get_default_display (), NULL);
-#endif
+  return progress;
+}
 
-  gst_object_unref (GST_OBJECT (priv->bus));
+static void
+set_subtitle_font_name (ClutterGstPlayer *player,
+                        const gchar      *font_name)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
 
-  return TRUE;
+  if (!priv->pipeline)
+    return;
+
+  CLUTTER_GST_NOTE (MEDIA, "setting subtitle font to %s", font_name);
+
+  g_free (priv->font_name);
+  priv->font_name = g_strdup (font_name);
+  g_object_set (priv->pipeline, "subtitle-font-desc", font_name, NULL);
 }
 
-/**
- * clutter_gst_player_deinit:
- * @player: a #ClutterGstPlayer
- *
- * Frees the resources created by clutter_gst_player_init(). After
- * clutter_gst_player_deinit() has been called, no other player method can be
- * called on the instance.
- *
- * Since: 1.4
- */
-void
-clutter_gst_player_deinit (ClutterGstPlayer *player)
+static void
+set_audio_volume (ClutterGstPlayer *player,
+                  gdouble           volume)
 {
-  ClutterGstPlayerPrivate *priv;
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
 
-  g_return_if_fail (CLUTTER_GST_IS_PLAYER (player));
+    if (!priv->pipeline)
+      return;
 
-  priv = PLAYER_GET_PRIVATE (player);
+  CLUTTER_GST_NOTE (MEDIA, "set volume: %.02f", volume);
 
-  if (priv == NULL)
-    return;
+  volume = CLAMP (volume, 0.0, 1.0);
+  gst_stream_volume_set_volume (GST_STREAM_VOLUME (priv->pipeline),
+				GST_STREAM_VOLUME_FORMAT_CUBIC,
+				volume);
 
-  PLAYER_SET_PRIVATE (player, NULL);
+  priv->volume = volume;
+  player_update_audio_flag (player);
 
-  if (priv->tick_timeout_id)
+  g_object_notify (G_OBJECT (player), "audio-volume");
+}
+
+static gdouble
+get_audio_volume (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+
+  if (!priv->pipeline)
+    return 0.0;
+
+  CLUTTER_GST_NOTE (MEDIA, "get volume: %.02f", priv->volume);
+
+  return priv->volume;
+}
+
+/* Queries the ranges downloaded by the download buffering element and
+ * updates the "virtual stream buffer": buffer-fill is the part of the
+ * buffering target that has been downloaded after the playback position.
+ * The pipeline is paused until the buffer is full */
+static void
+player_update_download_buffering (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  ClutterGstBufferedRange range, current = { 0.0, 0.0 };
+  gdouble position, seconds_buffered, buffer_fill;
+  gint64 start, stop, left;
+  GstState current_state;
+  GstElement *element;
+  GstQuery *query;
+  gboolean changed;
+  guint i, n_ranges;
+
+  element = priv->download_buffering_element;
+  if (element == NULL)
+    element = priv->pipeline;
+
+  /* queue2 only knows about _PERCENT and _BYTES */
+  query = gst_query_new_buffering (GST_FORMAT_PERCENT);
+  if (!gst_element_query (element, query))
     {
-      g_source_remove (priv->tick_timeout_id);
-      priv->tick_timeout_id = 0;
+      gst_query_unref (query);
+      player_clear_download_buffering (player);
+      return;
     }
 
-  if (priv->buffering_timeout_id)
+  gst_query_parse_buffering_stats (query, NULL, NULL, NULL, &left);
+
+  /* the file queue2 downloads to, for the media cache. It's only known once
+   * the download has started */
+  if (priv->use_media_cache && priv->download_temp_location == NULL &&
+      g_object_class_find_property (G_OBJECT_GET_CLASS (element),
+                                    "temp-location"))
+    g_object_get (element, "temp-location", &priv->download_temp_location,
+                  NULL);
+
+  /* queue2 gives every range of the file it has downloaded. Without them,
+   * fall back to the range currently being downloaded */
+  n_ranges = gst_query_get_n_buffering_ranges (query);
+  if (n_ranges == 0)
     {
-      g_source_remove (priv->buffering_timeout_id);
-      priv->buffering_timeout_id = 0;
+      ClutterGstBufferedRange *r;
+
+      gst_query_parse_buffering_range (query, NULL, &start, &stop, NULL);
+      range.start = (gdouble) start / GST_FORMAT_PERCENT_MAX;
+      range.stop = (gdouble) stop / GST_FORMAT_PERCENT_MAX;
+
+      changed = priv->buffered_ranges->len != 1;
+      g_array_set_size (priv->buffered_ranges, 1);
+
+      r = &g_array_index (priv->buffered_ranges, ClutterGstBufferedRange, 0);
+      if (r->start != range.start || r->stop != range.stop)
+        changed = TRUE;
+      *r = range;
+
+      n_ranges = 1;
     }
+  else
+    {
+      changed = priv->buffered_ranges->len != n_ranges;
+      g_array_set_size (priv->buffered_ranges, n_ranges);
 
-  if (priv->download_buffering_element)
+      for (i = 0; i < n_ranges; i++)
+        {
+          ClutterGstBufferedRange *r;
+
+          gst_query_parse_nth_buffering_range (query, i, &start, &stop);
+          range.start = (gdouble) start / GST_FORMAT_PERCENT_MAX;
+          range.stop = (gdouble) stop / GST_FORMAT_PERCENT_MAX;
+
+          r = &g_array_index (priv->buffered_ranges,
+                              ClutterGstBufferedRange, i);
+          if (r->start != range.start || r->stop != range.stop)
+            changed = TRUE;
+          *r = range;
+        }
+    }
+
+  gst_query_unref (query);
+
+  /* the range the playback position, or the position we're seeking to, is
+   * in. That's the one that matters to know if we can play */
+  position = get_progress (player);
+  for (i = 0; i < n_ranges; i++)
     {
-      g_object_unref (priv->download_buffering_element);
-      priv->download_buffering_element = NULL;
+      range = g_array_index (priv->buffered_ranges,
+                             ClutterGstBufferedRange, i);
+
+      CLUTTER_GST_NOTE (BUFFERING, "range %u: %.02f - %.02f",
+                        i, range.start, range.stop);
+
+      if (range.start <= position && position <= range.stop)
+        current = range;
     }
 
-  gst_element_set_state (priv->pipeline, GST_STATE_NULL);
+  CLUTTER_GST_NOTE (BUFFERING,
+                    "position %.02f, buffering left %" G_GINT64_FORMAT,
+                    position, left);
+
+  if (changed)
+    g_signal_emit (player, signals[DOWNLOAD_BUFFERING], 0,
+                   current.start, current.stop);
+
+  /* everything up to the end of the media is there, or the download is
+   * done */
+  seconds_buffered = priv->duration * (current.stop - position);
+  if (current.stop >= 1.0 || left == G_GINT64_CONSTANT (0) ||
+      priv->buffering_target <= 0.0)
+    buffer_fill = 1.0;
+  else
+    buffer_fill = seconds_buffered / priv->buffering_target;
+  priv->buffer_fill = CLAMP (buffer_fill, 0.0, 1.0);
 
-  if (priv->bus)
+  if (priv->buffer_fill != 1.0 || !priv->virtual_stream_buffer_signalled)
     {
-      gst_bus_remove_signal_watch (priv->bus);
-      priv->bus = NULL;
+      CLUTTER_GST_NOTE (BUFFERING, "buffer holds %0.2fs of data, buffer-fill "
+                        "is %.02f", seconds_buffered, priv->buffer_fill);
+
+      g_object_notify (G_OBJECT (player), "buffer-fill");
+
+      if (priv->buffer_fill == 1.0)
+        priv->virtual_stream_buffer_signalled = 1;
     }
 
-  if (priv->pipeline)
+  current_state = player_get_pending_state (player);
+  if (priv->buffer_fill < 1.0)
     {
-      gst_object_unref (GST_OBJECT (priv->pipeline));
-      priv->pipeline = NULL;
+      if (current_state != GST_STATE_PAUSED)
+        {
+          CLUTTER_GST_NOTE (BUFFERING, "pausing the pipeline");
+          player_set_state (player, GST_STATE_PAUSED);
+        }
+    }
+  else
+    {
+      if (current_state != priv->target_state)
+        {
+          CLUTTER_GST_NOTE (BUFFERING, "restoring the pipeline");
+          player_set_state (player, priv->target_state);
+        }
     }
 
-  g_free (priv->uri);
-  g_free (priv->font_name);
-  g_free (priv->user_agent);
-  free_tags_list (&priv->audio_streams);
-  free_tags_list (&priv->subtitle_tracks);
+  /* the file has finished downloading */
+  if (left == G_GINT64_CONSTANT (0))
+    {
+      if (priv->use_media_cache && n_ranges == 1 &&
+          current.start == 0.0 && current.stop >= 1.0)
+        player_store_download (player);
 
-  g_slice_free (ClutterGstPlayerPrivate, priv);
+      player_clear_download_buffering (player);
+    }
 }
 
+static gboolean
+player_buffering_update_cb (gpointer data)
+{
+  ClutterGstPlayer *player = (ClutterGstPlayer *) data;
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+
+  priv->buffering_update_id = 0;
+
+  if (priv->in_download_buffering)
+    player_update_download_buffering (player);
+
+  return FALSE;
+}
+
+/* queue2 can post a lot of buffering messages, and a seek changes the range
+ * that matters without any message. Updates are coalesced in an idle
+ * handler so a UI gets one ::download-buffering per main loop iteration at
+ * most */
 static void
-clutter_gst_player_default_init (ClutterGstPlayerIface *iface)
+player_schedule_buffering_update (ClutterGstPlayer *player)
 {
-  GParamSpec *pspec;
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
 
-  /**
-   * ClutterGstPlayer:idle:
-   *
-   * Whether the #ClutterGstPlayer is in idle mode.
-   *
-   * Since: 1.4
-   */
-  pspec = g_param_spec_boolean ("idle",
-                                "Idle",
-                                "Idle state of the player's pipeline",
-                                TRUE,
-                                CLUTTER_GST_PARAM_READABLE);
-  g_object_interface_install_property (iface, pspec);
+  if (priv->buffering_update_id == 0)
+    priv->buffering_update_id =
+      g_idle_add (player_buffering_update_cb, player);
+}
 
-  /**
-   * ClutterGstPlayer:user-agent:
-   *
-   * The User Agent used by #ClutterGstPlayer with network protocols.
-   *
-   * Since: 1.4
-   */
-  pspec = g_param_spec_string ("user-agent",
-                               "User Agent",
-                               "User Agent used with network protocols",
-                               NULL,
-                               CLUTTER_GST_PARAM_READWRITE);
-  g_object_interface_install_property (iface, pspec);
+/* Seeks to @position in segment mode. The first seek of a loop needs to be a
+ * flushing seek, subsequent ones (from the SEGMENT_DONE handler) are not
+ * flushing so the pipeline goes on from the loop start without a glitch */
+static void
+player_loop_seek (ClutterGstPlayer *player,
+                  gint64            position,
+                  gboolean          flush)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  GstSeekFlags flags;
+  gint64 stop = GST_CLOCK_TIME_NONE;
 
-  /**
-   * ClutterGstPlayer:seek-flags:
-   *
-   * Flags to use when seeking.
-   *
-   * Since: 1.4
-   */
-  pspec = g_param_spec_flags ("seek-flags",
-                              "Seek Flags",
-                              "Flags to use when seeking",
-                              CLUTTER_GST_TYPE_SEEK_FLAGS,
-                              CLUTTER_GST_SEEK_FLAG_NONE,
-                              CLUTTER_GST_PARAM_READWRITE);
-  g_object_interface_install_property (iface, pspec);
+  flags = GST_SEEK_FLAG_SEGMENT;
+  if (flush)
+    flags |= GST_SEEK_FLAG_FLUSH;
 
-  /**
-   * ClutterGstPlayer:audio-streams:
-   *
-   * List of audio streams available on the current media.
-   *
-   * Since: 1.4
-   */
-  pspec = g_param_spec_pointer ("audio-streams",
-                                "Audio Streams",
-                                "List of the audio streams of the media",
-                                CLUTTER_GST_PARAM_READABLE);
-  g_object_interface_install_property (iface, pspec);
+  /* the A point of an A-B loop is unlikely to be a key frame */
+  if (position > 0)
+    flags |= GST_SEEK_FLAG_ACCURATE;
 
-  /**
-   * ClutterGstPlayer:audio-stream:
-   *
-   * Index of the current audio stream.
-   *
-   * Since: 1.4
-   */
-  pspec = g_param_spec_int ("audio-stream",
-                            "Audio Stream",
-                            "Index of the current audio stream",
-                            -1, G_MAXINT, -1,
-                            CLUTTER_GST_PARAM_READWRITE);
-  g_object_interface_install_property (iface, pspec);
+  if (priv->loop_stop >= 0.0)
+    stop = priv->loop_stop * GST_SECOND;
 
-  pspec = g_param_spec_pointer ("subtitle-tracks",
-                                "Subtitles Tracks",
-                                "List of the subtitles tracks of the media",
-                                CLUTTER_GST_PARAM_READABLE);
-  g_object_interface_install_property (iface, pspec);
+  CLUTTER_GST_NOTE (MEDIA, "loop seek to %" GST_TIME_FORMAT " (flush: %d)",
+                    GST_TIME_ARGS (position), flush);
 
-  pspec = g_param_spec_int ("subtitle-track",
-                            "Subtitles Track",
-                            "Index of the current subtitles track",
-                            -1, G_MAXINT, -1,
-                            CLUTTER_GST_PARAM_READWRITE);
-  g_object_interface_install_property (iface, pspec);
+  gst_element_seek (priv->pipeline,
+                    1.0,
+                    GST_FORMAT_TIME,
+                    flags,
+                    GST_SEEK_TYPE_SET,
+                    position,
+                    GST_SEEK_TYPE_SET, stop);
+}
+
+/* Puts the pipeline in segment mode, starting from the current position if it
+ * is inside the loop, from the loop start otherwise */
+static void
+player_start_loop (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  gint64 position, start;
+
+  start = priv->loop_start * GST_SECOND;
+
+  if (!gst_element_query_position (priv->pipeline, GST_FORMAT_TIME,
+                                   &position) ||
+      position < start ||
+      (priv->loop_stop >= 0.0 && position >= priv->loop_stop * GST_SECOND))
+    position = start;
+
+  player_loop_seek (player, position, TRUE);
+}
+
+/* An HTTP source doesn't know about conditional requests, a "304 Not
+ * Modified" answer is an error for it. The status code comes from the
+ * http-headers message the source posts before failing, without one the
+ * copy isn't considered revalidated. The media is then reopened with its
+ * copy in the cache */
+static gboolean
+player_revalidated (ClutterGstPlayer *player,
+                    GError           *error)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  gchar *uri, *cached_uri;
+
+  if (error->domain != GST_RESOURCE_ERROR || priv->http_status != 304)
+    return FALSE;
+
+  g_rec_mutex_lock (&priv->ref->lock);
+  uri = g_strdup (priv->revalidate_uri);
+  g_rec_mutex_unlock (&priv->ref->lock);
+
+  if (uri == NULL)
+    return FALSE;
+
+  player_set_revalidation (priv, NULL, NULL);
+
+  cached_uri = _clutter_gst_media_cache_revalidated (uri, priv->http_headers);
+  g_free (uri);
+
+  if (cached_uri == NULL)
+    return FALSE;
+
+  player_discard_download (priv);
+  player_reopen (player, 0, cached_uri, priv->target_state);
+  g_free (cached_uri);
+
+  return TRUE;
+}
+
+/* When none of the renderers of the sink takes what the decoder outputs,
+ * the video fails to negotiate. In native video mode, that's not an error
+ * for the application: the media is reopened with the converters, and
+ * playback resumes where it was */
+static gboolean
+player_native_video_fallback (ClutterGstPlayer *player,
+                              GError           *error,
+                              const gchar      *debug)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  GstPlayFlags flags;
+  gint64 position;
+
+  g_object_get (priv->pipeline, "flags", &flags, NULL);
+  if (!(flags & GST_PLAY_FLAG_NATIVE_VIDEO))
+    return FALSE;
+
+  if (!g_error_matches (error, GST_CORE_ERROR, GST_CORE_ERROR_NEGOTIATION) &&
+      !g_error_matches (error, GST_STREAM_ERROR, GST_STREAM_ERROR_FORMAT) &&
+      !(debug && strstr (debug, "not-negotiated")))
+    return FALSE;
+
+  CLUTTER_GST_NOTE (MEDIA, "the sink can't render the decoded video of %s, "
+                    "falling back to converters", priv->uri);
+
+  if (priv->can_seek && priv->duration > 0 &&
+      gst_element_query_position (priv->pipeline, GST_FORMAT_TIME, &position))
+    {
+      priv->stacked_progress = (gdouble) position / GST_SECOND / priv->duration;
+    }
+
+  /* the other elements of the failed negotiation may have posted errors
+   * too, they are dropped until the pipeline is reopened */
+  priv->native_video_failed = TRUE;
+  player_reopen (player, GST_PLAY_FLAG_NATIVE_VIDEO, NULL,
+                 priv->target_state);
+
+  return TRUE;
+}
+
+static void
+bus_message_error_cb (GstBus           *bus,
+                      GstMessage       *message,
+                      ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  GError *error = NULL;
+  gchar *debug = NULL;
+
+  gst_message_parse_error (message, &error, &debug);
+
+  if (priv->reopened_generation != priv->reopen_generation)
+    {
+      CLUTTER_GST_NOTE (MEDIA, "dropping error from before the reopen: %s",
+                        error->message);
+      g_error_free (error);
+      g_free (debug);
+      return;
+    }
+
+  if (player_revalidated (player, error) ||
+      player_native_video_fallback (player, error, debug))
+    {
+      g_error_free (error);
+      g_free (debug);
+      return;
+    }
+
+  player_release_timeshift (priv);
+  player_set_state (player, GST_STATE_NULL);
+
+  g_signal_emit_by_name (player, "error", error);
+  g_error_free (error);
+  g_free (debug);
+
+  priv->is_idle = TRUE;
+  g_object_notify (G_OBJECT (player), "idle");
+}
+
+static void
+bus_message_application_cb (GstBus           *bus,
+                            GstMessage       *message,
+                            ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  const GstStructure *structure;
+  guint generation;
+
+  structure = gst_message_get_structure (message);
+  if (!gst_structure_has_name (structure, REOPENED_MESSAGE) ||
+      !gst_structure_get_uint (structure, "generation", &generation))
+    return;
+
+  /* a later reopen may still be queued */
+  if (generation == priv->reopen_generation)
+    priv->reopened_generation = generation;
+}
+
+/*
+ * This is what's intented in the EOS callback:
+ *   - receive EOS from playbin
+ *   - fire the EOS signal, the user can install a signal handler to loop the
+ *     video for instance.
+ *   - after having emitted the signal, check the state of the pipeline
+ *   - if the pipeline has been set back to playing or pause, don't touch the
+ *     idle state. This will avoid drawing a frame (or more) with the idle
+ *     material when looping
+ */
+static void
+player_handle_eos (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  GstState state;
+
+  priv->in_eos = TRUE;
+
+  player_release_timeshift (priv);
+  player_set_state (player, GST_STATE_READY);
+
+  g_signal_emit_by_name (player, "eos");
+  g_object_notify (G_OBJECT (player), "progress");
+
+  state = player_get_pending_state (player);
+
+  if (!(state == GST_STATE_PLAYING || state == GST_STATE_PAUSED))
+    {
+      priv->is_idle = TRUE;
+      g_object_notify (G_OBJECT (player), "idle");
+    }
+}
+
+static void
+bus_message_eos_cb (GstBus           *bus,
+                    GstMessage       *message,
+                    ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+
+  /* looping has been enabled before the pipeline could be put in segment
+   * mode, restart from the loop start instead of tearing down the pipeline */
+  if (priv->loop)
+    {
+      player_loop_seek (player, priv->loop_start * GST_SECOND, TRUE);
+      return;
+    }
+
+  player_handle_eos (player);
+}
+
+static void
+bus_message_segment_done_cb (GstBus           *bus,
+                             GstMessage       *message,
+                             ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+
+  /* looping has been disabled while playing the last segment */
+  if (!priv->loop)
+    {
+      player_handle_eos (player);
+      return;
+    }
+
+  CLUTTER_GST_NOTE (MEDIA, "segment done, looping");
+
+  player_loop_seek (player, priv->loop_start * GST_SECOND, FALSE);
+}
+
+/* Pauses or resumes playback according to a STREAM buffering message.
+ *
+ * While paused for buffering, playback resumes once the buffer reaches the
+ * high watermark. It resumes earlier, from the low watermark, when the data
+ * comes in faster than it's played: the buffer can only grow from there.
+ * While playing, the pipeline is only paused again when the buffer falls
+ * under the low watermark. That way a link that's barely fast enough
+ * doesn't make the pipeline flip between PAUSED and PLAYING on every
+ * message */
+static void
+player_update_stream_buffering (ClutterGstPlayer *player,
+                                GstMessage       *message)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  gint buffer_percent, avg_in, avg_out;
+  gint64 buffering_left;
+  gdouble time_left, watermark;
+  gboolean fast_link, can_play;
+  GstState current_state;
+
+  gst_message_parse_buffering (message, &buffer_percent);
+  gst_message_parse_buffering_stats (message, NULL,
+                                     &avg_in, &avg_out, &buffering_left);
+
+  priv->buffer_fill = CLAMP ((gdouble) buffer_percent / 100.0, 0.0, 1.0);
+
+  /* the output rate means something only when the pipeline plays */
+  if (!priv->in_stream_buffering && avg_out > 0)
+    priv->avg_out_rate = avg_out;
+
+  CLUTTER_GST_NOTE (BUFFERING, "buffer-fill: %.02f, in: %d B/s, out: %d B/s, "
+                    "left: %" G_GINT64_FORMAT " ms", priv->buffer_fill,
+                    avg_in, priv->avg_out_rate, buffering_left);
+
+  fast_link = avg_in > 0 && priv->avg_out_rate > 0 &&
+              avg_in >= priv->avg_out_rate;
+
+  if (priv->in_stream_buffering && !fast_link)
+    watermark = priv->buffering_high_watermark;
+  else
+    watermark = priv->buffering_low_watermark;
+
+  can_play = priv->buffer_fill >= watermark;
+
+  /* buffering_left is the time queue2 needs to fill its buffer, we only
+   * need to get to the watermark */
+  if (can_play)
+    time_left = 0.0;
+  else if (buffering_left >= 0)
+    time_left = (gdouble) buffering_left / 1000.0 *
+                (watermark - priv->buffer_fill) / (1.0 - priv->buffer_fill);
+  else
+    time_left = -1.0;
+
+  /* The playbin documentation says that we need to pause the pipeline
+   * when there's not enough data yet. We try to limit the calls to
+   * gst_element_set_state() */
+  current_state = player_get_pending_state (player);
+
+  if (!can_play)
+    {
+      priv->in_stream_buffering = TRUE;
+
+      if (current_state != GST_STATE_PAUSED)
+        {
+          CLUTTER_GST_NOTE (BUFFERING, "pausing the pipeline");
+          player_set_state (player, GST_STATE_PAUSED);
+        }
+    }
+  else
+    {
+      priv->in_stream_buffering = FALSE;
+
+      if (current_state != priv->target_state)
+        {
+          CLUTTER_GST_NOTE (BUFFERING, "restoring the pipeline");
+          player_set_state (player, priv->target_state);
+        }
+    }
+
+  g_object_notify (G_OBJECT (player), "buffer-fill");
+
+  if (priv->buffering_time_left != time_left)
+    {
+      priv->buffering_time_left = time_left;
+      g_object_notify (G_OBJECT (player), "buffering-time-left");
+    }
+}
+
+static void
+bus_message_buffering_cb (GstBus           *bus,
+                          GstMessage       *message,
+                          ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  GstBufferingMode mode;
+  gint buffer_percent;
+
+  gst_message_parse_buffering_stats (message, &mode, NULL, NULL, NULL);
+
+  if (mode != GST_BUFFERING_DOWNLOAD)
+    priv->in_download_buffering = FALSE;
+
+  switch (mode)
+    {
+    case GST_BUFFERING_STREAM:
+      player_update_stream_buffering (player, message);
+      break;
+
+    case GST_BUFFERING_DOWNLOAD:
+      /* we rate limit the messages from GStreamer for a usage in a UI (we
+       * don't want *that* many updates). The buffered ranges are queried
+       * and the signals sent from an idle handler */
+      if (priv->in_download_buffering)
+        {
+          player_schedule_buffering_update (player);
+          break;
+        }
+
+      /* the first time we receive a download buffering message, see right
+       * away if there's enough data to play from. We'll use buffer_fill as a
+       * "virtual stream buffer" to signal the application we're buffering
+       * until we can play back from the downloaded stream, the pipeline
+       * being paused in the meantime */
+      priv->download_buffering_element = g_object_ref (message->src);
+      priv->in_download_buffering = TRUE;
+      priv->virtual_stream_buffer_signalled = 0;
+
+      player_update_download_buffering (player);
+      break;
+
+    case GST_BUFFERING_TIMESHIFT:
+      /* the ring buffer of queue2 keeps receiving data while the pipeline is
+       * paused, so we can pause to buffer like with a stream */
+      player_update_stream_buffering (player, message);
+      break;
+
+    case GST_BUFFERING_LIVE:
+      /* a live pipeline doesn't preroll and pausing it only makes the
+       * source drop data, we just report how full the buffer is */
+      gst_message_parse_buffering (message, &buffer_percent);
+      priv->buffer_fill = CLAMP ((gdouble) buffer_percent / 100.0, 0.0, 1.0);
+
+      CLUTTER_GST_NOTE (BUFFERING, "live buffer-fill: %.02f",
+                        priv->buffer_fill);
+
+      g_object_notify (G_OBJECT (player), "buffer-fill");
+      break;
+
+    default:
+      g_warning ("Buffering mode %d not handled", mode);
+      break;
+    }
+}
+
+/* The memory budget of a player is the smallest of its own budget and of
+ * its share of the global budget */
+static guint64
+player_get_memory_budget (ClutterGstPlayerPrivate *priv)
+{
+  guint64 budget = priv->memory_budget;
+  gint n = g_atomic_int_get (&n_players);
+
+  if (global_memory_budget && n > 0)
+    {
+      guint64 share = global_memory_budget / n;
+
+      budget = budget ? MIN (budget, share) : share;
+    }
+
+  return budget;
+}
+
+/* Half of the budget goes to the network buffer (queue2), the other half to
+ * the queues decodebin puts after the demuxer, one per stream and assuming
+ * an audio and a video stream */
+static void
+player_apply_memory_budget (ClutterGstPlayerPrivate *priv,
+                            GstElement              *element)
+{
+  GstElementFactory *factory;
+  const gchar *name;
+  guint64 budget;
+  guint size;
+
+  budget = player_get_memory_budget (priv);
+  factory = gst_element_get_factory (element);
+  if (budget == 0 || factory == NULL)
+    return;
+
+  name = gst_plugin_feature_get_name (GST_PLUGIN_FEATURE (factory));
+
+  if (strcmp (name, "queue2") == 0)
+    {
+      size = CLAMP (budget / 2, MEMORY_BUDGET_MIN_QUEUE_SIZE, G_MAXUINT);
+
+      CLUTTER_GST_NOTE (BUFFERING, "%s: %u bytes", GST_ELEMENT_NAME (element),
+                        size);
+
+      g_object_set (element, "max-size-bytes", size, NULL);
+    }
+  else if (strcmp (name, "decodebin") == 0 ||
+           strcmp (name, "multiqueue") == 0)
+    {
+      /* decodebin configures its multiqueue from its own limits once
+       * pre-rolled, set both */
+      size = CLAMP (budget / 4, MEMORY_BUDGET_MIN_QUEUE_SIZE, G_MAXUINT);
+
+      CLUTTER_GST_NOTE (BUFFERING, "%s: %u bytes per stream",
+                        GST_ELEMENT_NAME (element), size);
+
+      g_object_set (element, "max-size-bytes", size, NULL);
+    }
+}
+
+static void
+apply_memory_budget (const GValue *value,
+                     gpointer      user_data)
+{
+  player_apply_memory_budget (user_data, g_value_get_object (value));
+}
+
+/* Gives the queues their default limits back once there's no budget */
+static void
+reset_memory_budget (const GValue *value,
+                     gpointer      user_data)
+{
+  GstElement *element = g_value_get_object (value);
+  GstElementFactory *factory;
+  GParamSpec *pspec;
+  GValue size = G_VALUE_INIT;
+  const gchar *name;
+
+  factory = gst_element_get_factory (element);
+  if (factory == NULL)
+    return;
+
+  name = gst_plugin_feature_get_name (GST_PLUGIN_FEATURE (factory));
+  if (strcmp (name, "queue2") != 0 &&
+      strcmp (name, "decodebin") != 0 &&
+      strcmp (name, "multiqueue") != 0)
+    return;
+
+  pspec = g_object_class_find_property (G_OBJECT_GET_CLASS (element),
+                                        "max-size-bytes");
+  if (pspec == NULL)
+    return;
+
+  g_value_init (&size, G_PARAM_SPEC_VALUE_TYPE (pspec));
+  g_param_value_set_default (pspec, &size);
+  g_object_set_property (G_OBJECT (element), "max-size-bytes", &size);
+  g_value_unset (&size);
+}
+
+/* Applies the memory budget to priv->pipeline, including the elements
+ * already in it */
+static void
+player_update_memory_budget (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  GstIterator *it;
+  guint64 budget;
+
+  budget = player_get_memory_budget (priv);
+
+  /* the queues are left alone as long as there never was a budget */
+  if (budget == 0 && !priv->memory_budget_applied)
+    return;
+
+  priv->memory_budget_applied = budget != 0;
+
+  /* used by uridecodebin for the queue2 of network streams, -1 is its
+   * default */
+  g_object_set (priv->pipeline,
+                "buffer-size", budget ? (gint) MIN (budget / 2, G_MAXINT) : -1,
+                NULL);
+
+  it = gst_bin_iterate_recurse (GST_BIN (priv->pipeline));
+  while (gst_iterator_foreach (it,
+                               budget ? apply_memory_budget
+                                      : reset_memory_budget,
+                               priv) == GST_ITERATOR_RESYNC)
+    gst_iterator_resync (it);
+  gst_iterator_free (it);
+}
+
+/* Called when the share of the global budget of each player changes */
+static void
+update_global_memory_budget (void)
+{
+  GList *l;
+
+  for (l = players; l; l = l->next)
+    player_update_memory_budget (l->data);
+}
+
+static void
+add_queued_bytes (const GValue *value,
+                  gpointer      user_data)
+{
+  GObject *object = g_value_get_object (value);
+  GstElementFactory *factory = NULL;
+  guint64 *total = user_data;
+  gchar *temp_location = NULL;
+  guint bytes = 0;
+
+  if (GST_IS_ELEMENT (object))
+    factory = gst_element_get_factory (GST_ELEMENT (object));
+
+  /* multiqueue reports the level of each of its queues on their sink pad,
+   * older versions don't report it at all */
+  if (factory &&
+      strcmp (gst_plugin_feature_get_name (GST_PLUGIN_FEATURE (factory)),
+              "multiqueue") == 0)
+    {
+      GstIterator *it;
+      guint64 pads_total = 0;
+
+      it = gst_element_iterate_sink_pads (GST_ELEMENT (object));
+      while (gst_iterator_foreach (it, add_queued_bytes, &pads_total) ==
+             GST_ITERATOR_RESYNC)
+        {
+          gst_iterator_resync (it);
+          pads_total = 0;
+        }
+      gst_iterator_free (it);
+
+      *total += pads_total;
+      return;
+    }
+
+  if (!g_object_class_find_property (G_OBJECT_GET_CLASS (object),
+                                     "current-level-bytes"))
+    return;
+
+  /* media downloaded to a file don't use memory */
+  if (g_object_class_find_property (G_OBJECT_GET_CLASS (object),
+                                    "temp-location"))
+    g_object_get (object, "temp-location", &temp_location, NULL);
+
+  if (temp_location == NULL)
+    {
+      g_object_get (object, "current-level-bytes", &bytes, NULL);
+      *total += bytes;
+    }
+
+  g_free (temp_location);
+}
+
+static guint64
+player_get_queued_bytes (ClutterGstPlayerPrivate *priv)
+{
+  GstIterator *it;
+  guint64 total = 0;
+
+  it = gst_bin_iterate_recurse (GST_BIN (priv->pipeline));
+  while (gst_iterator_foreach (it, add_queued_bytes, &total) ==
+         GST_ITERATOR_RESYNC)
+    {
+      gst_iterator_resync (it);
+      total = 0;
+    }
+  gst_iterator_free (it);
+
+  return total;
+}
+
+/* Called for every element created in the pipeline, at any depth, before
+ * it leaves the NULL state. This is the place to configure the elements
+ * playbin creates itself. Can be called from a streaming thread */
+static void
+player_configure_element (ClutterGstPlayer *player,
+                          GstElement       *element)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  GstElementFactory *factory;
+  const gchar *name;
+
+  factory = gst_element_get_factory (element);
+  if (priv == NULL || factory == NULL)
+    return;
+
+  name = gst_plugin_feature_get_name (GST_PLUGIN_FEATURE (factory));
+
+  player_apply_memory_budget (priv, element);
+
+  if (priv->adaptive_max_width)
+    player_apply_adaptive_size (priv, element);
+
+  if (GST_OBJECT_FLAG_IS_SET (element, GST_ELEMENT_FLAG_SINK))
+    cache_auto_audio_sink (element);
+
+  /* keep the downloaded media around for the media cache, it's removed
+   * by player_discard_download() otherwise */
+  if (priv->use_media_cache && strcmp (name, "queue2") == 0)
+    g_object_set (element, "temp-remove", FALSE, NULL);
+
+  if (priv->timeshift_size && element_is_network_queue (element))
+    {
+      CLUTTER_GST_NOTE (BUFFERING, "%s: timeshift buffer of %"
+                        G_GUINT64_FORMAT " bytes",
+                        GST_ELEMENT_NAME (element), priv->timeshift_size);
+
+      g_object_set (element,
+                    "ring-buffer-max-size", priv->timeshift_size,
+                    NULL);
+    }
+}
+
+/* The demuxers of adaptive streams pick their variant from the bandwidth.
+ * There's no point in downloading 1080p for a player shown as a 320 pixels
+ * wide tile, so they're given the largest resolution worth having when
+ * they can take it. The others are left alone: the bandwidth they measure
+ * is all they have, giving them one would override it */
+static void
+player_apply_adaptive_size (ClutterGstPlayerPrivate *priv,
+                            GstElement              *element)
+{
+  GObjectClass *klass = G_OBJECT_GET_CLASS (element);
+  GstElementFactory *factory;
+
+  factory = gst_element_get_factory (element);
+  if (factory == NULL ||
+      !gst_element_factory_list_is_type (factory,
+                                         GST_ELEMENT_FACTORY_TYPE_DEMUXER))
+    return;
+
+  if (g_object_class_find_property (klass, "max-video-width") &&
+      g_object_class_find_property (klass, "max-video-height"))
+    {
+      CLUTTER_GST_NOTE (MEDIA, "%s: variants up to %dx%d",
+                        GST_ELEMENT_NAME (element),
+                        priv->adaptive_max_width, priv->adaptive_max_height);
+
+      g_object_set (element,
+                    "max-video-width", priv->adaptive_max_width,
+                    "max-video-height", priv->adaptive_max_height,
+                    NULL);
+    }
+}
+
+static void
+apply_adaptive_size (const GValue *value,
+                     gpointer      user_data)
+{
+  player_apply_adaptive_size (user_data, g_value_get_object (value));
+}
+
+static gboolean
+player_update_adaptive_size (gpointer user_data)
+{
+  ClutterGstPlayer *player = user_data;
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  gint max_width = 0, max_height = 0;
+  GstIterator *it;
+
+  priv->adaptive_update_id = 0;
+
+  if (priv->adapt_streams && CLUTTER_IS_ACTOR (player))
+    {
+      gfloat width, height;
+
+      /* keep the variant we have while hidden */
+      if (!CLUTTER_ACTOR_IS_MAPPED (player))
+        return FALSE;
+
+      clutter_actor_get_transformed_size (CLUTTER_ACTOR (player),
+                                          &width, &height);
+      max_width = MAX (width, 0.0);
+      max_height = MAX (height, 0.0);
+      if (max_width == 0 || max_height == 0)
+        max_width = max_height = 0;
+    }
+
+  if (max_width == priv->adaptive_max_width &&
+      max_height == priv->adaptive_max_height)
+    return FALSE;
+
+  priv->adaptive_max_width = max_width;
+  priv->adaptive_max_height = max_height;
+
+  it = gst_bin_iterate_recurse (GST_BIN (priv->pipeline));
+  while (gst_iterator_foreach (it, apply_adaptive_size, priv) ==
+         GST_ITERATOR_RESYNC)
+    gst_iterator_resync (it);
+  gst_iterator_free (it);
+
+  return FALSE;
+}
+
+static void
+player_schedule_adaptive_size (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+
+  if (priv == NULL)
+    return;
+
+  if (priv->adaptive_update_id)
+    g_source_remove (priv->adaptive_update_id);
+
+  priv->adaptive_update_id = g_timeout_add (ADAPTIVE_UPDATE_DELAY,
+                                            player_update_adaptive_size,
+                                            player);
+}
+
+/*
+ * Hidden players
+ *
+ * With throttle-hidden, the video sink doesn't upload the frames of a
+ * texture nobody sees and soon throttles upstream, see
+ * ClutterGstVideoSink:throttle-hidden. It posts an element message each
+ * time the texture gets hidden or shown. When the texture stays hidden for
+ * the grace period, the video isn't decoded at all anymore. The audio goes
+ * on, and the video is decoded again from the current position as soon as
+ * the texture is painted.
+ */
+
+static void
+player_configure_video_sink (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  GstElement *video_sink = NULL;
+
+  if (!priv->pipeline)
+    return;
+
+  g_object_get (priv->pipeline, "video-sink", &video_sink, NULL);
+  if (video_sink == NULL)
+    return;
+
+  if (g_object_class_find_property (G_OBJECT_GET_CLASS (video_sink),
+                                    "throttle-hidden"))
+    g_object_set (video_sink, "throttle-hidden", priv->throttle_hidden, NULL);
+
+  gst_object_unref (video_sink);
+}
+
+static void
+player_set_video_flag (ClutterGstPlayer *player,
+                       gboolean          enabled)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  GstPlayFlags flags, new_flags;
+
+  g_object_get (priv->pipeline, "flags", &flags, NULL);
+
+  if (enabled)
+    new_flags = flags | GST_PLAY_FLAG_VIDEO;
+  else
+    new_flags = flags & ~GST_PLAY_FLAG_VIDEO;
+
+  if (new_flags == flags)
+    return;
+
+  CLUTTER_GST_NOTE (MEDIA, "%s video decoding",
+                    enabled ? "enabling" : "disabling");
+
+  g_object_set (priv->pipeline, "flags", new_flags, NULL);
+}
+
+static gboolean
+player_resume_video_cb (gpointer user_data)
+{
+  ClutterGstPlayer *player = user_data;
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+
+  priv->video_resume_id = 0;
+
+  /* the sink is out of the pipeline while the video is disabled, it
+   * couldn't tell us about the texture being shown */
+  priv->video_hidden = FALSE;
+  player_resume_video (player, TRUE);
+
+  return FALSE;
+}
+
+/* not from the paint handler itself, playbin has to plug the video chain
+ * back */
+static void
+player_hidden_texture_painted (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+
+  if (priv == NULL || priv->video_resume_id)
+    return;
+
+  priv->video_resume_id = g_idle_add (player_resume_video_cb, player);
+}
+
+/* takes @priv as well, the player no longer has it in deinit */
+static void
+player_release_hidden_texture (ClutterGstPlayer        *player,
+                               ClutterGstPlayerPrivate *priv)
+{
+  if (priv->hidden_texture == NULL)
+    return;
+
+  g_signal_handlers_disconnect_by_func (priv->hidden_texture,
+                                        player_hidden_texture_painted,
+                                        player);
+  g_object_remove_weak_pointer (G_OBJECT (priv->hidden_texture),
+                                (gpointer *) &priv->hidden_texture);
+  priv->hidden_texture = NULL;
+}
+
+/* Decodes the video again, from the current position when @seek, so that
+ * the frame shown matches the audio */
+static void
+player_resume_video (ClutterGstPlayer *player,
+                     gboolean          seek)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  gint64 position = 0;
+
+  if (priv->video_disable_id)
+    {
+      g_source_remove (priv->video_disable_id);
+      priv->video_disable_id = 0;
+    }
+
+  if (priv->video_resume_id)
+    {
+      g_source_remove (priv->video_resume_id);
+      priv->video_resume_id = 0;
+    }
+
+  player_release_hidden_texture (player, priv);
+
+  if (!priv->video_disabled)
+    return;
+
+  priv->video_disabled = FALSE;
+
+  seek = seek && priv->uri &&
+    gst_element_query_position (priv->pipeline, GST_FORMAT_TIME, &position);
+
+  player_set_video_flag (player, TRUE);
+
+  if (seek)
+    player_seek (player, position, GST_SEEK_FLAG_ACCURATE);
+}
+
+static gboolean
+player_disable_video_cb (gpointer user_data)
+{
+  ClutterGstPlayer *player = user_data;
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  GstElement *video_sink = NULL;
+  ClutterActor *texture = NULL;
+
+  priv->video_disable_id = 0;
+
+  /* without the video sink, we wouldn't hear about the texture being
+   * shown again, watch it ourselves */
+  g_object_get (priv->pipeline, "video-sink", &video_sink, NULL);
+  if (video_sink)
+    {
+      if (g_object_class_find_property (G_OBJECT_GET_CLASS (video_sink),
+                                        "texture"))
+        g_object_get (video_sink, "texture", &texture, NULL);
+      gst_object_unref (video_sink);
+    }
+
+  if (texture == NULL)
+    return FALSE;
+
+  priv->hidden_texture = texture;
+  g_object_add_weak_pointer (G_OBJECT (texture),
+                             (gpointer *) &priv->hidden_texture);
+  g_signal_connect_swapped (texture, "paint",
+                            G_CALLBACK (player_hidden_texture_painted),
+                            player);
+  g_object_unref (texture);
+
+  priv->video_disabled = TRUE;
+  player_set_video_flag (player, FALSE);
+
+  return FALSE;
+}
+
+static void
+player_schedule_video_disable (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+
+  if (!priv->throttle_hidden || priv->video_disabled ||
+      priv->video_disable_id)
+    return;
+
+  priv->video_disable_id = g_timeout_add (priv->hidden_grace_period,
+                                          player_disable_video_cb,
+                                          player);
+}
+
+static void
+player_set_video_hidden (ClutterGstPlayer *player,
+                         gboolean          hidden)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+
+  CLUTTER_GST_NOTE (MEDIA, "video %s", hidden ? "hidden" : "shown");
+
+  priv->video_hidden = hidden;
+
+  if (hidden)
+    player_schedule_video_disable (player);
+  else
+    player_resume_video (player, TRUE);
+}
+
+static void
+on_element_added (GstBin              *bin,
+                  GstElement          *element,
+                  ClutterGstPlayerRef *ref)
+{
+  ClutterGstPlayer *player;
+
+  player = player_ref_lock (ref);
+  if (player == NULL)
+    return;
+
+  player_configure_element (player, element);
+
+  player_ref_unlock (ref);
+
+  if (GST_IS_BIN (element))
+    player_connect_ref (ref, element, "element-added",
+                        G_CALLBACK (on_element_added));
+}
+
+static void
+disconnect_element_added (const GValue *value,
+                          gpointer      user_data)
+{
+  GstElement *element = g_value_get_object (value);
+
+  if (GST_IS_BIN (element))
+    g_signal_handlers_disconnect_by_func (element,
+                                          on_element_added, user_data);
+}
+
+static void
+on_source_changed (GstElement          *pipeline,
+                   GParamSpec          *pspec,
+                   ClutterGstPlayerRef *ref)
+{
+  ClutterGstPlayer *player;
+  ClutterGstPlayerPrivate *priv;
+
+  player = player_ref_lock (ref);
+  if (player == NULL)
+    return;
+
+  priv = PLAYER_GET_PRIVATE (player);
+  player_set_user_agent (player, priv->user_agent);
+  player_setup_revalidation (priv, pipeline);
+
+  player_ref_unlock (ref);
+}
+
+static void
+query_duration (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  gboolean success;
+  gint64 duration;
+  gdouble new_duration, difference;
+
+  success = gst_element_query_duration (priv->pipeline,
+                                        GST_FORMAT_TIME,
+                                        &duration);
+  if (G_UNLIKELY (success != TRUE))
+    return;
+
+  new_duration = (gdouble) duration / GST_SECOND;
+
+  /* while we store the new duration if it sligthly changes, the duration
+   * signal is sent only if the new duration is at least one second different
+   * from the old one (as the duration signal is mainly used to update the
+   * time displayed in a UI */
+  difference = ABS (priv->duration - new_duration);
+  if (difference > 1e-3)
+    {
+      CLUTTER_GST_NOTE (MEDIA, "duration: %.02f", new_duration);
+      priv->duration = new_duration;
+
+      if (difference > 1.0)
+        g_object_notify (G_OBJECT (player), "duration");
+    }
+}
+
+static void
+query_seeking (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  GstQuery *query;
+
+  /* Determine whether we can seek */
+  query = gst_query_new_seeking (GST_FORMAT_TIME);
+
+  if (gst_element_query (priv->pipeline, query))
+    {
+      gboolean can_seek = FALSE;
+
+      gst_query_parse_seeking (query, NULL, &can_seek,
+                               NULL,
+                               NULL);
+
+      priv->can_seek = (can_seek == TRUE) ? TRUE : FALSE;
+    }
+  else
+    {
+      /* could not query for ability to seek by querying the
+       * pipeline; let's crudely try by using the URI
+       */
+      if (priv->uri && g_str_has_prefix (priv->uri, "http://"))
+        priv->can_seek = FALSE;
+      else
+        priv->can_seek = TRUE;
+    }
+
+  gst_query_unref (query);
+
+  CLUTTER_GST_NOTE (MEDIA, "can-seek: %d", priv->can_seek);
+
+  g_object_notify (G_OBJECT (player), "can-seek");
+}
+
+static void
+bus_message_duration_changed_cb (GstBus           *bus,
+                                 GstMessage       *message,
+                                 ClutterGstPlayer *player)
+{
+  /* GstElements send a duration-changed message on the bus to signal
+   * that the duration has changed and should be re-queried */
+  query_duration (player);
+}
+
+static void
+bus_message_state_change_cb (GstBus           *bus,
+                             GstMessage       *message,
+                             ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  GstState old_state, new_state;
+  gpointer src;
+
+  src = GST_MESSAGE_SRC (message);
+  if (src != priv->pipeline)
+    return;
+
+  gst_message_parse_state_changed (message, &old_state, &new_state, NULL);
+
+  CLUTTER_GST_NOTE (MEDIA, "state change:  %s -> %s",
+                    gst_state_to_string (old_state),
+                    gst_state_to_string (new_state));
+
+  if (old_state == new_state)
+    return;
+
+  if (old_state == GST_STATE_READY &&
+      new_state == GST_STATE_PAUSED)
+    {
+      query_seeking (player);
+      query_duration (player);
+
+      /* a stacked seek will put the pipeline in segment mode itself */
+      if (priv->loop && priv->can_seek && !priv->stacked_progress)
+        player_start_loop (player);
+    }
+
+  if (new_state == GST_STATE_READY)
+    player_apply_pending_subtitle (player);
+
+  /* is_idle controls the drawing with the idle material */
+  if (new_state == GST_STATE_NULL)
+    {
+      priv->is_idle = TRUE;
+      g_object_notify (G_OBJECT (player), "idle");
+    }
+  else if (new_state == GST_STATE_PLAYING)
+    {
+      priv->is_idle = FALSE;
+      priv->is_changing_uri = FALSE;
+      g_object_notify (G_OBJECT (player), "idle");
+    }
+
+  if (!priv->is_idle)
+    {
+      if (priv->stacked_progress)
+        {
+          set_progress (player, priv->stacked_progress);
+        }
+    }
+}
+
+static void
+player_finish_seek (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+
+  g_object_notify (G_OBJECT (player), "progress");
+
+  set_in_seek (player, FALSE);
+
+  /* we may have moved to, or away from, an already downloaded range */
+  if (priv->in_download_buffering)
+    player_schedule_buffering_update (player);
+
+  if (priv->stacked_progress)
+    {
+      set_progress (player, priv->stacked_progress);
+    }
+}
+
+/* After the seek to the key frame before seek_step_target, steps to it.
+ * Returns FALSE if there's nothing to step over */
+static gboolean
+player_step_to_seek_target (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  GstClockTime position = GST_CLOCK_TIME_NONE;
+  GstSample *sample;
+
+  sample = player_get_current_frame (priv);
+  if (sample)
+    {
+      position = frame_get_stream_time (sample);
+      gst_sample_unref (sample);
+    }
+
+  if (!GST_CLOCK_TIME_IS_VALID (position) ||
+      position >= priv->seek_step_target)
+    return FALSE;
+
+  priv->in_seek_step = TRUE;
+
+  return gst_element_send_event (priv->pipeline,
+                                 gst_event_new_step (GST_FORMAT_TIME,
+                                                     priv->seek_step_target -
+                                                     position,
+                                                     1.0, TRUE, FALSE));
+}
+
+static void
+bus_message_async_done_cb (GstBus           *bus,
+                           GstMessage       *message,
+                           ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+
+  /* on the key frame before the frame we are stepping back from */
+  if (priv->in_step_seek)
+    {
+      GstSample *sample;
+
+      priv->in_step_seek = FALSE;
+
+      sample = player_get_current_frame (priv);
+      player_continue_step_back (player, sample);
+      if (sample)
+        gst_sample_unref (sample);
+
+      return;
+    }
+
+  /* on the frame we stepped to */
+  if (priv->in_step_preroll)
+    {
+      player_finish_step (player);
+      return;
+    }
+
+  if (priv->in_seek)
+    {
+      /* the seek is done once we've stepped to the position */
+      if (GST_CLOCK_TIME_IS_VALID (priv->seek_step_target))
+        {
+          if (priv->in_seek_step || player_step_to_seek_target (player))
+            return;
+
+          priv->in_seek_step = FALSE;
+          priv->seek_step_target = GST_CLOCK_TIME_NONE;
+        }
+
+      player_finish_seek (player);
+    }
+}
+
+static void
+bus_message_step_done_cb (GstBus           *bus,
+                          GstMessage       *message,
+                          ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  gboolean eos;
+
+  if (priv->in_seek_step)
+    {
+      priv->in_seek_step = FALSE;
+      priv->seek_step_target = GST_CLOCK_TIME_NONE;
+
+      if (priv->in_seek)
+        player_finish_seek (player);
+
+      return;
+    }
+
+  if (!priv->in_step)
+    return;
+
+  gst_message_parse_step_done (message, NULL, NULL, NULL, NULL, NULL, NULL,
+                               &eos);
+
+  /* the sink won't pre-roll anything at the end of the media */
+  if (eos)
+    player_finish_step (player);
+  else
+    priv->in_step_preroll = TRUE;
+}
+
+/* the video sink tells when its texture gets hidden or shown, souphttpsrc
+ * posts the headers of the HTTP response, we keep them for the media
+ * cache */
+static void
+bus_message_element_cb (GstBus           *bus,
+                        GstMessage       *message,
+                        ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  const GstStructure *structure;
+  GstStructure *headers = NULL;
+  gboolean visible;
+  guint status;
+
+  if (gst_message_has_name (message, "clutter-gst-visibility"))
+    {
+      structure = gst_message_get_structure (message);
+      if (gst_structure_get_boolean (structure, "visible", &visible))
+        player_set_video_hidden (player, !visible);
+      return;
+    }
+
+  if (!priv->use_media_cache || !gst_message_has_name (message, "http-headers"))
+    return;
+
+  structure = gst_message_get_structure (message);
+
+  /* older HTTP sources don't give the status code */
+  if (!gst_structure_get_uint (structure, "http-status-code", &status))
+    status = 0;
+  priv->http_status = status;
+
+  if (!gst_structure_get (structure,
+                          "response-headers", GST_TYPE_STRUCTURE, &headers,
+                          NULL))
+    return;
+
+  if (priv->http_headers)
+    gst_structure_free (priv->http_headers);
+  priv->http_headers = headers;
+}
+
+/* playbin posts stream-start when the pipeline starts playing a new group,
+ * that is when the URI queued from about-to-finish actually starts */
+static void
+bus_message_stream_start_cb (GstBus           *bus,
+                             GstMessage       *message,
+                             ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  GObject *self = G_OBJECT (player);
+  gchar *uri;
+
+  g_mutex_lock (&priv->queue_lock);
+  uri = priv->next_uri;
+  priv->next_uri = NULL;
+  g_mutex_unlock (&priv->queue_lock);
+
+  /* first stream of a set_uri(), nothing to do */
+  if (uri == NULL)
+    return;
+
+  CLUTTER_GST_NOTE (MEDIA, "gapless switch to %s", uri);
+
+  g_free (priv->uri);
+  priv->uri = uri;
+
+  g_free (priv->pending_suburi);
+  priv->pending_suburi = NULL;
+
+  priv->in_eos = FALSE;
+  priv->duration = 0.0;
+  priv->stacked_progress = 0.0;
+  priv->target_progress = 0.0;
+  priv->seek_step_target = GST_CLOCK_TIME_NONE;
+  priv->in_seek_step = FALSE;
+
+  /* the buffered ranges and the download of the previous item don't apply
+   * to the new one */
+  player_clear_download_buffering (player);
+  g_array_set_size (priv->buffered_ranges, 0);
+  priv->buffer_fill = 0.0;
+  priv->buffering_time_left = 0.0;
+
+  player_load_keyframe_index (player);
+
+  query_seeking (player);
+  query_duration (player);
+
+  g_object_notify (self, "uri");
+  g_object_notify (self, "duration");
+  g_object_notify (self, "progress");
+  g_object_notify (self, "buffer-fill");
+  g_object_notify (self, "buffering-time-left");
+}
+
+/* Called from a streaming thread when playbin has finished decoding the
+ * current URI. Giving it the next URI from there lets it preroll the next
+ * item while the end of the current one is still playing, and keeps the
+ * sinks (and thus the renderer and the audio device) across items */
+static void
+on_about_to_finish (GstElement          *pipeline,
+                    ClutterGstPlayerRef *ref)
+{
+  ClutterGstPlayer *player;
+  ClutterGstPlayerPrivate *priv;
+  gchar *uri, *suburi, *play_uri;
+
+  player = player_ref_lock (ref);
+  if (player == NULL)
+    return;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  g_mutex_lock (&priv->queue_lock);
+  uri = g_queue_pop_head (&priv->uri_queue);
+  if (uri)
+    {
+      g_free (priv->next_uri);
+      priv->next_uri = g_strdup (uri);
+    }
+  g_mutex_unlock (&priv->queue_lock);
+
+  if (uri == NULL)
+    {
+      player_ref_unlock (ref);
+      return;
+    }
+
+  CLUTTER_GST_NOTE (MEDIA, "about to finish, next uri: %s", uri);
+
+  /* the directory has been listed by enqueue_uri(), listing it again here
+   * would hold up the streaming thread */
+  suburi = lookup_subtitle (uri);
+  play_uri = player_resolve_uri (priv, uri, TRUE);
+
+  player_ref_unlock (ref);
+
+  g_object_set (pipeline, "uri", play_uri, NULL);
+  pipeline_set_subtitle_uri (pipeline, suburi);
+
+  g_free (play_uri);
+  g_free (suburi);
+  g_free (uri);
+}
+
+static GList *
+get_tags (GstElement  *pipeline,
+          const gchar *property_name,
+          const gchar *action_signal)
+{
+  GList *ret = NULL;
+  gint i, n;
+
+  g_object_get (G_OBJECT (pipeline), property_name, &n, NULL);
+  if (n == 0)
+    return NULL;
+
+  for (i = 0; i < n; i++)
+    {
+      GstTagList *tags = NULL;
+
+      g_signal_emit_by_name (G_OBJECT (pipeline), action_signal, i, &tags);
+
+      ret = g_list_prepend (ret, tags);
+    }
+
+  return g_list_reverse (ret);
+}
+
+static gboolean
+tags_list_equal (GList *a,
+                 GList *b)
+{
+  for (; a && b; a = a->next, b = b->next)
+    {
+      if (a->data == NULL || b->data == NULL)
+        {
+          if (a->data != b->data)
+            return FALSE;
+        }
+      else if (!gst_tag_list_is_equal (a->data, b->data))
+        return FALSE;
+    }
+
+  return a == NULL && b == NULL;
+}
+
+/* Replaces *listp by the tags of the streams currently in the pipeline.
+ * Returns FALSE if they haven't changed */
+static gboolean
+player_update_tags (ClutterGstPlayerPrivate  *priv,
+                    GList                   **listp,
+                    const gchar              *property_name,
+                    const gchar              *action_signal)
+{
+  GList *tags;
+
+  tags = get_tags (priv->pipeline, property_name, action_signal);
+
+  if (tags_list_equal (*listp, tags))
+    {
+      free_tags_list (&tags);
+      return FALSE;
+    }
+
+  free_tags_list (listp);
+  *listp = tags;
+
+  return TRUE;
+}
+
+static gboolean
+player_dispatch_changes (gpointer data)
+{
+  ClutterGstPlayer *player = CLUTTER_GST_PLAYER (data);
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  guint changes;
+
+  if (priv == NULL)
+    return FALSE;
+
+  changes = g_atomic_int_and (&priv->pending_changes, 0);
+
+  g_object_freeze_notify (G_OBJECT (player));
+
+  if (changes & PLAYER_CHANGE_VOLUME)
+    {
+      priv->volume =
+        gst_stream_volume_get_volume (GST_STREAM_VOLUME (priv->pipeline),
+                                      GST_STREAM_VOLUME_FORMAT_CUBIC);
+      player_update_audio_flag (player);
+
+      g_object_notify (G_OBJECT (player), "audio-volume");
+    }
+
+  if ((changes & PLAYER_CHANGE_AUDIO_STREAMS) &&
+      player_update_tags (priv, &priv->audio_streams,
+                          "n-audio", "get-audio-tags"))
+    {
+      CLUTTER_GST_NOTE (AUDIO_STREAM, "audio-streams changed");
+
+      g_object_notify (G_OBJECT (player), "audio-streams");
+    }
+
+  if (changes & PLAYER_CHANGE_AUDIO_STREAM)
+    {
+      CLUTTER_GST_NOTE (AUDIO_STREAM, "audio stream changed");
+
+      g_object_notify (G_OBJECT (player), "audio-stream");
+    }
+
+  if ((changes & PLAYER_CHANGE_SUBTITLE_TRACKS) &&
+      player_update_tags (priv, &priv->subtitle_tracks,
+                          "n-text", "get-text-tags"))
+    {
+      CLUTTER_GST_NOTE (AUDIO_STREAM, "subtitle-tracks changed");
+
+      g_object_notify (G_OBJECT (player), "subtitle-tracks");
+    }
+
+  if (changes & PLAYER_CHANGE_SUBTITLE_TRACK)
+    {
+      CLUTTER_GST_NOTE (AUDIO_STREAM, "text stream changed");
+
+      g_object_notify (G_OBJECT (player), "subtitle-track");
+    }
+
+  g_object_thaw_notify (G_OBJECT (player));
+
+  return FALSE;
+}
+
+/* playbin signals the changes of its streams, and proxies the notifications
+ * of the element having the "volume" property, from the thread that runs
+ * the element, potentially different from the main thread. A stream change
+ * comes as a burst of such signals, they are accumulated in
+ * pending_changes and handled by a single idle */
+static void
+player_queue_change (ClutterGstPlayerRef    *ref,
+                     ClutterGstPlayerChange  change)
+{
+  ClutterGstPlayer *player;
+  ClutterGstPlayerPrivate *priv;
+
+  player = player_ref_lock (ref);
+  if (player == NULL)
+    return;
+
+  priv = PLAYER_GET_PRIVATE (player);
+  if (g_atomic_int_or (&priv->pending_changes, change) == 0)
+    g_idle_add_full (G_PRIORITY_DEFAULT_IDLE,
+                     player_dispatch_changes,
+                     g_object_ref (player),
+                     g_object_unref);
+
+  player_ref_unlock (ref);
+}
+
+static void
+on_volume_changed (GstElement          *pipeline,
+                   GParamSpec          *pspec,
+                   ClutterGstPlayerRef *ref)
+{
+  player_queue_change (ref, PLAYER_CHANGE_VOLUME);
+}
+
+static void
+on_audio_changed (GstElement          *pipeline,
+                  ClutterGstPlayerRef *ref)
+{
+  player_queue_change (ref, PLAYER_CHANGE_AUDIO_STREAMS);
+}
+
+static void
+on_audio_tags_changed (GstElement          *pipeline,
+                       gint                 stream,
+                       ClutterGstPlayerRef *ref)
+{
+  gint current_stream;
+
+  g_object_get (G_OBJECT (pipeline), "current-audio", &current_stream, NULL);
+
+  if (current_stream != stream)
+    return;
+
+  player_queue_change (ref, PLAYER_CHANGE_AUDIO_STREAMS);
+}
+
+static void
+on_current_audio_changed (GstElement          *pipeline,
+                          GParamSpec          *pspec,
+                          ClutterGstPlayerRef *ref)
+{
+  player_queue_change (ref, PLAYER_CHANGE_AUDIO_STREAM);
+}
+
+static void
+on_text_changed (GstElement          *pipeline,
+                 ClutterGstPlayerRef *ref)
+{
+  player_queue_change (ref, PLAYER_CHANGE_SUBTITLE_TRACKS);
+}
+
+static void
+on_text_tags_changed (GstElement          *pipeline,
+                      gint                 stream,
+                      ClutterGstPlayerRef *ref)
+{
+  player_queue_change (ref, PLAYER_CHANGE_SUBTITLE_TRACKS);
+}
+
+static void
+on_current_text_changed (GstElement          *pipeline,
+                         GParamSpec          *pspec,
+                         ClutterGstPlayerRef *ref)
+{
+  player_queue_change (ref, PLAYER_CHANGE_SUBTITLE_TRACK);
+}
+
+/* GObject's magic/madness */
+
+static void
+clutter_gst_player_set_property (GObject      *object,
+                                 guint         property_id,
+                                 const GValue *value,
+                                 GParamSpec   *pspec)
+{
+  ClutterGstPlayer *player = CLUTTER_GST_PLAYER (object);
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  ClutterGstPlayerIfacePrivate *iface_priv;
+  gdouble watermark;
+
+  switch (property_id)
+    {
+    case PROP_URI:
+      set_uri (player, g_value_get_string (value));
+      break;
+
+    case PROP_PLAYING:
+      set_playing (player, g_value_get_boolean (value));
+      break;
+
+    case PROP_PROGRESS:
+      set_progress (player, g_value_get_double (value));
+      break;
+
+    case PROP_SUBTITLE_URI:
+      set_subtitle_uri (player, g_value_get_string (value));
+      break;
+
+    case PROP_SUBTITLE_FONT_NAME:
+      set_subtitle_font_name (player, g_value_get_string (value));
+      break;
+
+    case PROP_AUDIO_VOLUME:
+      set_audio_volume (player, g_value_get_double (value));
+      break;
+
+    case PROP_USER_AGENT:
+      clutter_gst_player_set_user_agent (player,
+                                         g_value_get_string (value));
+      break;
+
+    case PROP_SEEK_FLAGS:
+      clutter_gst_player_set_seek_flags (player,
+                                         g_value_get_flags (value));
+      break;
+
+    case PROP_AUDIO_STREAM:
+      clutter_gst_player_set_audio_stream (player,
+                                           g_value_get_int (value));
+      break;
+
+    case PROP_SUBTITLE_TRACK:
+      clutter_gst_player_set_subtitle_track (player,
+                                             g_value_get_int (value));
+      break;
+
+    case PROP_LOOP:
+      clutter_gst_player_set_loop (player, g_value_get_boolean (value));
+      break;
+
+    case PROP_ASYNC_STATE_CHANGES:
+      clutter_gst_player_set_async_state_changes (player,
+                                                  g_value_get_boolean (value));
+      break;
+
+    case PROP_BUFFERING_TARGET:
+      clutter_gst_player_set_buffering_target (player,
+                                               g_value_get_double (value));
+      break;
+
+    case PROP_BUFFERING_LOW_WATERMARK:
+      /* the high watermark is pushed up if need be */
+      watermark = g_value_get_double (value);
+      clutter_gst_player_set_buffering_watermarks (player, watermark,
+        MAX (watermark, priv->buffering_high_watermark));
+      break;
+
+    case PROP_BUFFERING_HIGH_WATERMARK:
+      watermark = g_value_get_double (value);
+      clutter_gst_player_set_buffering_watermarks (player,
+        MIN (watermark, priv->buffering_low_watermark), watermark);
+      break;
+
+    case PROP_TIMESHIFT_SIZE:
+      clutter_gst_player_set_timeshift_size (player,
+                                             g_value_get_uint64 (value));
+      break;
+
+    case PROP_USE_MEDIA_CACHE:
+      clutter_gst_player_set_use_media_cache (player,
+                                              g_value_get_boolean (value));
+      break;
+
+    case PROP_MEMORY_BUDGET:
+      clutter_gst_player_set_memory_budget (player,
+                                            g_value_get_uint64 (value));
+      break;
+
+    case PROP_SHARED_AUDIO:
+      clutter_gst_player_set_shared_audio (player,
+                                           g_value_get_boolean (value));
+      break;
+
+    case PROP_AUDIO_ENABLED:
+      clutter_gst_player_set_audio_enabled (player,
+                                            g_value_get_boolean (value));
+      break;
+
+    case PROP_FRAME_CACHE_SIZE:
+      clutter_gst_player_set_frame_cache_size (player,
+                                               g_value_get_uint (value));
+      break;
+
+    case PROP_USE_KEYFRAME_INDEX:
+      clutter_gst_player_set_use_keyframe_index (player,
+                                                 g_value_get_boolean (value));
+      break;
+
+    case PROP_NATIVE_VIDEO:
+      clutter_gst_player_set_native_video (player,
+                                           g_value_get_boolean (value));
+      break;
+
+    case PROP_ADAPT_STREAMS_TO_SIZE:
+      clutter_gst_player_set_adapt_streams_to_size (player,
+                                                    g_value_get_boolean (value));
+      break;
+
+    case PROP_THROTTLE_HIDDEN:
+      clutter_gst_player_set_throttle_hidden (player,
+                                              g_value_get_boolean (value));
+      break;
+
+    case PROP_HIDDEN_GRACE_PERIOD:
+      clutter_gst_player_set_hidden_grace_period (player,
+                                                  g_value_get_uint (value));
+      break;
+
+    default:
+      iface_priv = clutter_gst_player_get_class_iface_priv (object);
+      g_assert (iface_priv != NULL);
+      iface_priv->set_property (object, property_id, value, pspec);
+    }
+}
+
+
+static void
+clutter_gst_player_get_property (GObject    *object,
+                                 guint       property_id,
+                                 GValue     *value,
+                                 GParamSpec *pspec)
+{
+  ClutterGstPlayer *player = CLUTTER_GST_PLAYER (object);
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  ClutterGstPlayerIfacePrivate *iface_priv;
+  gchar *str;
+
+  switch (property_id)
+    {
+    case PROP_URI:
+      g_value_set_string (value, priv->uri);
+      break;
+
+    case PROP_PLAYING:
+      g_value_set_boolean (value, get_playing (player));
+      break;
+
+    case PROP_PROGRESS:
+      g_value_set_double (value, get_progress (player));
+      break;
+
+    case PROP_SUBTITLE_URI:
+      g_object_get (priv->pipeline, "suburi", &str, NULL);
+      g_value_take_string (value, str);
+      break;
+
+    case PROP_SUBTITLE_FONT_NAME:
+      g_value_set_string (value, priv->font_name);
+      break;
+
+    case PROP_AUDIO_VOLUME:
+      g_value_set_double (value, get_audio_volume (player));
+      break;
+
+    case PROP_CAN_SEEK:
+      g_value_set_boolean (value, priv->can_seek);
+      break;
+
+    case PROP_BUFFER_FILL:
+      g_value_set_double (value, priv->buffer_fill);
+      break;
+
+    case PROP_DURATION:
+      g_value_set_double (value, priv->duration);
+      break;
+
+    case PROP_IDLE:
+      g_value_set_boolean (value, priv->is_idle);
+      break;
+
+    case PROP_USER_AGENT:
+      {
+        gchar *user_agent;
+
+        user_agent = clutter_gst_player_get_user_agent (player);
+        g_value_take_string (value, user_agent);
+      }
+      break;
+
+    case PROP_SEEK_FLAGS:
+      {
+        ClutterGstSeekFlags seek_flags;
+
+        seek_flags = clutter_gst_player_get_seek_flags (player);
+        g_value_set_flags (value, seek_flags);
+      }
+      break;
+
+    case PROP_AUDIO_STREAMS:
+      g_value_set_pointer (value, priv->audio_streams);
+      break;
+
+    case PROP_AUDIO_STREAM:
+      {
+        gint index_;
+
+        index_ = clutter_gst_player_get_audio_stream (player);
+        g_value_set_int (value, index_);
+      }
+      break;
+
+    case PROP_SUBTITLE_TRACKS:
+      g_value_set_pointer (value, priv->subtitle_tracks);
+      break;
+
+    case PROP_SUBTITLE_TRACK:
+      {
+        gint index_;
+
+        index_ = clutter_gst_player_get_subtitle_track (player);
+        g_value_set_int (value, index_);
+      }
+      break;
+
+    case PROP_IN_SEEK:
+      g_value_set_boolean (value, priv->in_seek);
+      break;
+
+    case PROP_LOOP:
+      g_value_set_boolean (value, priv->loop);
+      break;
+
+    case PROP_ASYNC_STATE_CHANGES:
+      g_value_set_boolean (value, priv->async_state_changes);
+      break;
+
+    case PROP_BUFFERING_TARGET:
+      g_value_set_double (value, priv->buffering_target);
+      break;
+
+    case PROP_BUFFERING_LOW_WATERMARK:
+      g_value_set_double (value, priv->buffering_low_watermark);
+      break;
+
+    case PROP_BUFFERING_HIGH_WATERMARK:
+      g_value_set_double (value, priv->buffering_high_watermark);
+      break;
+
+    case PROP_BUFFERING_TIME_LEFT:
+      g_value_set_double (value, priv->buffering_time_left);
+      break;
+
+    case PROP_TIMESHIFT_SIZE:
+      g_value_set_uint64 (value, priv->timeshift_size);
+      break;
+
+    case PROP_USE_MEDIA_CACHE:
+      g_value_set_boolean (value, priv->use_media_cache);
+      break;
+
+    case PROP_MEMORY_BUDGET:
+      g_value_set_uint64 (value, priv->memory_budget);
+      break;
+
+    case PROP_SHARED_AUDIO:
+      g_value_set_boolean (value, priv->shared_audio);
+      break;
+
+    case PROP_AUDIO_ENABLED:
+      g_value_set_boolean (value, priv->audio_enabled);
+      break;
+
+    case PROP_FRAME_CACHE_SIZE:
+      g_value_set_uint (value, priv->frame_cache_size);
+      break;
+
+    case PROP_USE_KEYFRAME_INDEX:
+      g_value_set_boolean (value, priv->use_keyframe_index);
+      break;
+
+    case PROP_NATIVE_VIDEO:
+      g_value_set_boolean (value, priv->native_video);
+      break;
+
+    case PROP_ADAPT_STREAMS_TO_SIZE:
+      g_value_set_boolean (value, priv->adapt_streams);
+      break;
+
+    case PROP_THROTTLE_HIDDEN:
+      g_value_set_boolean (value, priv->throttle_hidden);
+      break;
+
+    case PROP_HIDDEN_GRACE_PERIOD:
+      g_value_set_uint (value, priv->hidden_grace_period);
+      break;
+
+    default:
+      iface_priv = clutter_gst_player_get_class_iface_priv (object);
+      iface_priv->get_property (object, property_id, value, pspec);
+    }
+}
+
+/**
+ * clutter_gst_player_class_init:
+ * @object_class: a #GObjectClass
+ *
+ * Adds the #ClutterGstPlayer properties to a class and surchages the
+ * set/get_property of #GObjectClass. You should call this
+ * function at the end of the class_init method of the class
+ * implementing #ClutterGstPlayer.
+ *
+ * Since: 1.4
+ */
+void
+clutter_gst_player_class_init (GObjectClass *object_class)
+{
+  ClutterGstPlayerIfacePrivate *priv;
+
+  priv = g_new0 (ClutterGstPlayerIfacePrivate, 1);
+  g_type_set_qdata (G_OBJECT_CLASS_TYPE (object_class),
+                    clutter_gst_player_class_quark,
+                    priv);
+
+  /* Save object's methods we want to override */
+  priv->set_property = object_class->set_property;
+  priv->get_property = object_class->get_property;
+
+  /* Replace by our methods */
+  object_class->set_property = clutter_gst_player_set_property;
+  object_class->get_property = clutter_gst_player_get_property;
+
+  /* Override ClutterMedia's properties */
+  g_object_class_override_property (object_class,
+                                    PROP_URI, "uri");
+  g_object_class_override_property (object_class,
+                                    PROP_PLAYING, "playing");
+  g_object_class_override_property (object_class,
+                                    PROP_PROGRESS, "progress");
+  g_object_class_override_property (object_class,
+                                    PROP_SUBTITLE_URI, "subtitle-uri");
+  g_object_class_override_property (object_class,
+                                    PROP_SUBTITLE_FONT_NAME,
+                                    "subtitle-font-name");
+  g_object_class_override_property (object_class,
+                                    PROP_AUDIO_VOLUME, "audio-volume");
+  g_object_class_override_property (object_class,
+                                    PROP_CAN_SEEK, "can-seek");
+  g_object_class_override_property (object_class,
+                                    PROP_DURATION, "duration");
+  g_object_class_override_property (object_class,
+                                    PROP_BUFFER_FILL, "buffer-fill");
+
+  /* Override ClutterGstPlayer's properties */
+  g_object_class_override_property (object_class,
+                                    PROP_IDLE, "idle");
+  g_object_class_override_property (object_class,
+                                    PROP_USER_AGENT, "user-agent");
+  g_object_class_override_property (object_class,
+                                    PROP_SEEK_FLAGS, "seek-flags");
+
+  g_object_class_override_property (object_class,
+                                    PROP_AUDIO_STREAMS, "audio-streams");
+  g_object_class_override_property (object_class,
+                                    PROP_AUDIO_STREAM, "audio-stream");
+
+  g_object_class_override_property (object_class,
+                                    PROP_SUBTITLE_TRACKS, "subtitle-tracks");
+  g_object_class_override_property (object_class,
+                                    PROP_SUBTITLE_TRACK, "subtitle-track");
+  g_object_class_override_property (object_class,
+                                    PROP_IN_SEEK, "in-seek");
+  g_object_class_override_property (object_class,
+                                    PROP_LOOP, "loop");
+  g_object_class_override_property (object_class,
+                                    PROP_ASYNC_STATE_CHANGES,
+                                    "async-state-changes");
+  g_object_class_override_property (object_class,
+                                    PROP_BUFFERING_TARGET,
+                                    "buffering-target");
+  g_object_class_override_property (object_class,
+                                    PROP_BUFFERING_LOW_WATERMARK,
+                                    "buffering-low-watermark");
+  g_object_class_override_property (object_class,
+                                    PROP_BUFFERING_HIGH_WATERMARK,
+                                    "buffering-high-watermark");
+  g_object_class_override_property (object_class,
+                                    PROP_BUFFERING_TIME_LEFT,
+                                    "buffering-time-left");
+  g_object_class_override_property (object_class,
+                                    PROP_TIMESHIFT_SIZE,
+                                    "timeshift-size");
+  g_object_class_override_property (object_class,
+                                    PROP_USE_MEDIA_CACHE,
+                                    "use-media-cache");
+  g_object_class_override_property (object_class,
+                                    PROP_MEMORY_BUDGET,
+                                    "memory-budget");
+  g_object_class_override_property (object_class,
+                                    PROP_SHARED_AUDIO,
+                                    "shared-audio");
+  g_object_class_override_property (object_class,
+                                    PROP_AUDIO_ENABLED,
+                                    "audio-enabled");
+  g_object_class_override_property (object_class,
+                                    PROP_FRAME_CACHE_SIZE,
+                                    "frame-cache-size");
+  g_object_class_override_property (object_class,
+                                    PROP_USE_KEYFRAME_INDEX,
+                                    "use-keyframe-index");
+  g_object_class_override_property (object_class,
+                                    PROP_NATIVE_VIDEO,
+                                    "native-video");
+  g_object_class_override_property (object_class,
+                                    PROP_ADAPT_STREAMS_TO_SIZE,
+                                    "adapt-streams-to-size");
+  g_object_class_override_property (object_class,
+                                    PROP_THROTTLE_HIDDEN,
+                                    "throttle-hidden");
+  g_object_class_override_property (object_class,
+                                    PROP_HIDDEN_GRACE_PERIOD,
+                                    "hidden-grace-period");
+}
+
+/* The audio sink factory, chosen once for all the players. When it's
+ * autoaudiosink, it is replaced by the factory of the sink autoaudiosink
+ * picks the first time, so that the devices are only probed once */
+G_LOCK_DEFINE_STATIC (audio_sink);
+static GstElementFactory *audio_sink_factory = NULL;
+
+static GstElement *
+create_audio_sink (void)
+{
+  static const gchar *candidates[] = {
+    "gconfaudiosink", "autoaudiosink", "alsasink", "fakesink"
+  };
+  GstElement *audio_sink = NULL;
+  guint i;
+
+  G_LOCK (audio_sink);
+
+  if (audio_sink_factory)
+    {
+      audio_sink = gst_element_factory_create (audio_sink_factory,
+                                               "audio-sink");
+      G_UNLOCK (audio_sink);
+
+      return audio_sink;
+    }
+
+  for (i = 0; i < G_N_ELEMENTS (candidates) && audio_sink == NULL; i++)
+    {
+      if (i == 2)
+        g_warning ("Could not create a GST audio_sink. "
+                   "Audio unavailable.");
+
+      audio_sink = gst_element_factory_make (candidates[i], "audio-sink");
+    }
+
+  if (audio_sink)
+    {
+      audio_sink_factory = gst_element_get_factory (audio_sink);
+      gst_object_ref (audio_sink_factory);
+
+      CLUTTER_GST_NOTE (AUDIO_STREAM, "using %s as audio sink",
+                        gst_plugin_feature_get_name
+                        (GST_PLUGIN_FEATURE (audio_sink_factory)));
+    }
+
+  G_UNLOCK (audio_sink);
+
+  return audio_sink;
+}
+
+/* Called for the sink autoaudiosink creates */
+static void
+cache_auto_audio_sink (GstElement *sink)
+{
+  GstObject *parent = GST_OBJECT_PARENT (sink);
+  GstElementFactory *parent_factory, *factory;
+
+  if (parent == NULL || !GST_IS_ELEMENT (parent))
+    return;
+
+  parent_factory = gst_element_get_factory (GST_ELEMENT (parent));
+  factory = gst_element_get_factory (sink);
+  if (parent_factory == NULL || factory == NULL)
+    return;
+
+  G_LOCK (audio_sink);
+
+  if (audio_sink_factory == parent_factory &&
+      strcmp (gst_plugin_feature_get_name
+              (GST_PLUGIN_FEATURE (parent_factory)), "autoaudiosink") == 0)
+    {
+      CLUTTER_GST_NOTE (AUDIO_STREAM, "autoaudiosink picked %s",
+                        gst_plugin_feature_get_name
+                        (GST_PLUGIN_FEATURE (factory)));
+
+      gst_object_unref (audio_sink_factory);
+      audio_sink_factory = gst_object_ref (factory);
+    }
+
+  G_UNLOCK (audio_sink);
+}
+
+/* The audio sink is only created when a media is about to be played, so
+ * that creating a player stays cheap. It's replaced when the player starts
+ * or stops using the shared audio output */
+/* Whether the audio of @pipeline goes to the shared audio output, which
+ * may not match priv->shared_audio until the next media */
+static gboolean
+pipeline_uses_shared_audio (GstElement *pipeline)
+{
+  GstElement *audio_sink = NULL;
+  gboolean shared;
+
+  g_object_get (pipeline, "audio-sink", &audio_sink, NULL);
+  if (audio_sink == NULL)
+    return FALSE;
+
+  shared = g_object_get_data (G_OBJECT (audio_sink),
+                              "clutter-gst-shared-audio") != NULL;
+  gst_object_unref (audio_sink);
+
+  return shared;
+}
+
+static void
+player_ensure_audio_sink (ClutterGstPlayer *player,
+                          GstElement       *pipeline)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  GstElement *audio_sink = NULL;
+
+  g_object_get (pipeline, "audio-sink", &audio_sink, NULL);
+  if (audio_sink)
+    {
+      gst_object_unref (audio_sink);
+
+      if (pipeline_uses_shared_audio (pipeline) == priv->shared_audio)
+        return;
+    }
+
+  audio_sink = NULL;
+
+  if (priv->shared_audio)
+    {
+      if (!_clutter_gst_audio_mixer_has_output ())
+        _clutter_gst_audio_mixer_set_output (create_audio_sink ());
+
+      audio_sink = _clutter_gst_audio_mixer_create_sink (priv->audio_channel);
+      if (audio_sink)
+        g_object_set_data (G_OBJECT (audio_sink),
+                           "clutter-gst-shared-audio", GINT_TO_POINTER (TRUE));
+    }
+
+  if (audio_sink == NULL)
+    audio_sink = create_audio_sink ();
+
+  if (audio_sink)
+    g_object_set (pipeline, "audio-sink", audio_sink, NULL);
+}
+
+/* Audio isn't decoded at all for disabled players, and for muted players
+ * using the shared audio output */
+static void
+player_update_audio_flag (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  GstPlayFlags flags, new_flags;
+  gboolean enabled;
+
+  enabled = priv->audio_enabled &&
+    !(pipeline_uses_shared_audio (priv->pipeline) && priv->volume <= 0.0);
+
+  g_object_get (priv->pipeline, "flags", &flags, NULL);
+
+  if (enabled)
+    new_flags = flags | GST_PLAY_FLAG_AUDIO;
+  else
+    new_flags = flags & ~GST_PLAY_FLAG_AUDIO;
+
+  if (new_flags == flags)
+    return;
+
+  CLUTTER_GST_NOTE (AUDIO_STREAM, "%s audio decoding",
+                    enabled ? "enabling" : "disabling");
+
+  g_object_set (priv->pipeline, "flags", new_flags, NULL);
+}
+
+/* With native video, playbin doesn't plug videoconvert and videoscale in
+ * front of the sink, the decoders have to output one of the formats the
+ * renderers of the sink take */
+static void
+player_update_native_video_flag (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  GstPlayFlags flags, new_flags;
+  gboolean enabled;
+
+  enabled = priv->native_video && !priv->native_video_failed;
+
+  g_object_get (priv->pipeline, "flags", &flags, NULL);
+
+  if (enabled)
+    new_flags = flags | GST_PLAY_FLAG_NATIVE_VIDEO;
+  else
+    new_flags = flags & ~GST_PLAY_FLAG_NATIVE_VIDEO;
+
+  if (new_flags == flags)
+    return;
+
+  CLUTTER_GST_NOTE (MEDIA, "%s native video",
+                    enabled ? "enabling" : "disabling");
+
+  g_object_set (priv->pipeline, "flags", new_flags, NULL);
+}
+
+static GstElement *
+get_pipeline (void)
+{
+  GstElement *pipeline;
+
+  pipeline = gst_element_factory_make ("playbin", "pipeline");
+  if (!pipeline)
+    {
+      g_critical ("Unable to create playbin element");
+      return NULL;
+    }
+
+  g_object_set (G_OBJECT (pipeline),
+                "subtitle-font-desc", "Sans 16",
+                NULL);
+
+  return pipeline;
+}
+
+/* ClutterGstPlayerIface implementation */
+
+static GstElement *
+clutter_gst_player_get_pipeline_impl (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  return priv->pipeline;
+}
+
+static gchar *
+clutter_gst_player_get_user_agent_impl (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv;
+  GstElement *source;
+  GParamSpec *pspec;
+  gchar *user_agent;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  /* If the user has set a custom user agent, we just return it even if it is
+   * not used by the current source element of the pipeline */
+  if (priv->user_agent)
+    return g_strdup (priv->user_agent);
+
+  /* If not, we try to retrieve the user agent used by the current source */
+  g_object_get (priv->pipeline, "source", &source, NULL);
+  if (source == NULL)
+    return NULL;
+
+  pspec = g_object_class_find_property (G_OBJECT_GET_CLASS (source),
+                                        "user-agent");
+  if (pspec == NULL)
+    return NULL;
+
+  g_object_get (source, "user-agent", &user_agent, NULL);
+
+  return user_agent;
+}
+
+static void
+clutter_gst_player_set_user_agent_impl (ClutterGstPlayer *player,
+                                        const gchar      *user_agent)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  g_free (priv->user_agent);
+  if (user_agent)
+    priv->user_agent = g_strdup (user_agent);
+  else
+    priv->user_agent = NULL;
+
+  player_set_user_agent (player, user_agent);
+}
+
+static ClutterGstSeekFlags
+clutter_gst_player_get_seek_flags_impl (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  if (priv->seek_flags == GST_SEEK_FLAG_ACCURATE)
+    return CLUTTER_GST_SEEK_FLAG_ACCURATE;
+  else
+    return CLUTTER_GST_SEEK_FLAG_NONE;
+}
+
+static void
+clutter_gst_player_set_seek_flags_impl (ClutterGstPlayer    *player,
+                                        ClutterGstSeekFlags  flags)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  if (flags == CLUTTER_GST_SEEK_FLAG_NONE)
+    priv->seek_flags = GST_SEEK_FLAG_KEY_UNIT;
+  else if (flags & CLUTTER_GST_SEEK_FLAG_ACCURATE)
+    priv->seek_flags = GST_SEEK_FLAG_ACCURATE;
+}
+
+static ClutterGstBufferingMode
+clutter_gst_player_get_buffering_mode_impl (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv;
+  GstPlayFlags flags;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  g_object_get (G_OBJECT (priv->pipeline), "flags", &flags, NULL);
+
+  if (flags & GST_PLAY_FLAG_DOWNLOAD)
+    return CLUTTER_GST_BUFFERING_MODE_DOWNLOAD;
+
+  return CLUTTER_GST_BUFFERING_MODE_STREAM;
+}
+
+static void
+clutter_gst_player_set_buffering_mode_impl (ClutterGstPlayer        *player,
+                                            ClutterGstBufferingMode  mode)
+{
+  ClutterGstPlayerPrivate *priv;
+  GstPlayFlags flags;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  g_object_get (G_OBJECT (priv->pipeline), "flags", &flags, NULL);
+
+  switch (mode)
+    {
+    case CLUTTER_GST_BUFFERING_MODE_STREAM:
+      flags &= ~GST_PLAY_FLAG_DOWNLOAD;
+      break;
+
+    case CLUTTER_GST_BUFFERING_MODE_DOWNLOAD:
+      flags |= GST_PLAY_FLAG_DOWNLOAD;
+      break;
+
+    default:
+      g_warning ("Unexpected buffering mode %d", mode);
+      break;
+    }
+
+  g_object_set (G_OBJECT (priv->pipeline), "flags", flags, NULL);
+}
+
+static GList *
+clutter_gst_player_get_audio_streams_impl (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  if (CLUTTER_GST_DEBUG_ENABLED (AUDIO_STREAM))
+    {
+      gchar *streams;
+
+      streams = list_to_string (priv->audio_streams);
+      CLUTTER_GST_NOTE (AUDIO_STREAM, "audio streams: %s", streams);
+      g_free (streams);
+    }
+
+  return priv->audio_streams;
+}
+
+static gint
+clutter_gst_player_get_audio_stream_impl (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv;
+  gint index_ = -1;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  g_object_get (G_OBJECT (priv->pipeline),
+                "current-audio", &index_,
+                NULL);
+
+  CLUTTER_GST_NOTE (AUDIO_STREAM, "audio stream is #%d", index_);
+
+  return index_;
+}
+
+static void
+clutter_gst_player_set_audio_stream_impl (ClutterGstPlayer *player,
+                                          gint              index_)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  g_return_if_fail (index_ >= 0 &&
+                    index_ < (gint) g_list_length (priv->audio_streams));
+
+  CLUTTER_GST_NOTE (AUDIO_STREAM, "set audio audio stream to #%d", index_);
+
+  g_object_set (G_OBJECT (priv->pipeline),
+                "current-audio", index_,
+                NULL);
+}
+
+static GList *
+clutter_gst_player_get_subtitle_tracks_impl (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  if (CLUTTER_GST_DEBUG_ENABLED (SUBTITLES))
+    {
+      gchar *tracks;
+
+      tracks = list_to_string (priv->subtitle_tracks);
+      CLUTTER_GST_NOTE (SUBTITLES, "subtitle tracks: %s", tracks);
+      g_free (tracks);
+    }
+
+  return priv->subtitle_tracks;
+}
+
+static gint
+clutter_gst_player_get_subtitle_track_impl (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv;
+  gint index_ = -1;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  g_object_get (G_OBJECT (priv->pipeline),
+                "current-text", &index_,
+                NULL);
+
+  CLUTTER_GST_NOTE (SUBTITLES, "text track is #%d", index_);
+
+  return index_;
+}
+
+static void
+clutter_gst_player_set_subtitle_track_impl (ClutterGstPlayer *player,
+                                            gint              index_)
+{
+  ClutterGstPlayerPrivate *priv;
+  GstPlayFlags flags;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  g_return_if_fail (index_ >= -1 &&
+                    index_ < (gint) g_list_length (priv->subtitle_tracks));
+
+  CLUTTER_GST_NOTE (SUBTITLES, "set subtitle track to #%d", index_);
+
+  g_object_get (priv->pipeline, "flags", &flags, NULL);
+  flags &= ~GST_PLAY_FLAG_TEXT;
+  g_object_set (priv->pipeline, "flags", flags, NULL);
+
+  if (index_ >= 0)
+    {
+      g_object_set (G_OBJECT (priv->pipeline),
+                    "current-text", index_,
+                    NULL);
+
+      flags |= GST_PLAY_FLAG_TEXT;
+      g_object_set (priv->pipeline, "flags", flags, NULL);
+    }
+}
+
+static gboolean
+clutter_gst_player_get_idle_impl (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  return priv->is_idle;
+}
+
+static gboolean
+clutter_gst_player_get_in_seek_impl (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  return priv->in_seek;
+}
+
+static gboolean
+clutter_gst_player_get_loop_impl (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  return priv->loop;
+}
+
+static void
+clutter_gst_player_set_loop_impl (ClutterGstPlayer *player,
+                                  gboolean          loop)
+{
+  ClutterGstPlayerPrivate *priv;
+  GstState state;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  loop = !!loop;
+  if (priv->loop == loop)
+    return;
+
+  CLUTTER_GST_NOTE (MEDIA, "set loop: %d", loop);
+
+  priv->loop = loop;
+
+  gst_element_get_state (priv->pipeline, &state, NULL, 0);
+  if (priv->uri && state >= GST_STATE_PAUSED && priv->can_seek)
+    {
+      if (loop)
+        {
+          player_start_loop (player);
+        }
+      else if (priv->loop_stop >= 0.0)
+        {
+          gint64 position;
+
+          /* get rid of the B point so we don't stop there */
+          if (gst_element_query_position (priv->pipeline, GST_FORMAT_TIME,
+                                          &position))
+            gst_element_seek (priv->pipeline,
+                              1.0,
+                              GST_FORMAT_TIME,
+                              GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE,
+                              GST_SEEK_TYPE_SET, position,
+                              GST_SEEK_TYPE_SET, GST_CLOCK_TIME_NONE);
+        }
+
+      /* without a B point, the current segment simply ends with a
+       * SEGMENT_DONE message that we'll handle as an EOS */
+    }
+
+  g_object_notify (G_OBJECT (player), "loop");
+}
+
+static void
+clutter_gst_player_get_loop_segment_impl (ClutterGstPlayer *player,
+                                          gdouble          *start,
+                                          gdouble          *stop)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  if (start)
+    *start = priv->loop_start;
+  if (stop)
+    *stop = priv->loop_stop;
+}
+
+static void
+clutter_gst_player_set_loop_segment_impl (ClutterGstPlayer *player,
+                                          gdouble           start,
+                                          gdouble           stop)
+{
+  ClutterGstPlayerPrivate *priv;
+  GstState state;
+
+  g_return_if_fail (start >= 0.0);
+  g_return_if_fail (stop < 0.0 || stop > start);
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  CLUTTER_GST_NOTE (MEDIA, "set loop segment: %.02f - %.02f", start, stop);
+
+  priv->loop_start = start;
+  priv->loop_stop = stop < 0.0 ? -1.0 : stop;
+
+  gst_element_get_state (priv->pipeline, &state, NULL, 0);
+  if (priv->loop && priv->uri && state >= GST_STATE_PAUSED && priv->can_seek)
+    player_start_loop (player);
+}
+
+static void
+clutter_gst_player_enqueue_uri_impl (ClutterGstPlayer *player,
+                                     const gchar      *uri)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  g_return_if_fail (uri != NULL);
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  CLUTTER_GST_NOTE (MEDIA, "enqueuing uri %s", uri);
+
+  g_mutex_lock (&priv->queue_lock);
+  g_queue_push_tail (&priv->uri_queue, g_strdup (uri));
+  g_mutex_unlock (&priv->queue_lock);
+
+  /* fill the subtitle cache now, about-to-finish only looks at the cache */
+  subtitle_scan_start (NULL, uri, NULL);
+}
+
+static void
+clutter_gst_player_clear_queue_impl (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  g_mutex_lock (&priv->queue_lock);
+  g_queue_foreach (&priv->uri_queue, (GFunc) g_free, NULL);
+  g_queue_clear (&priv->uri_queue);
+  g_mutex_unlock (&priv->queue_lock);
+}
+
+static guint
+clutter_gst_player_get_queue_length_impl (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv;
+  guint length;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  g_mutex_lock (&priv->queue_lock);
+  length = g_queue_get_length (&priv->uri_queue);
+  g_mutex_unlock (&priv->queue_lock);
+
+  return length;
+}
+
+static guint
+clutter_gst_player_get_standby_count_impl (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  return priv->max_standby_pipelines;
+}
+
+static void
+clutter_gst_player_set_standby_count_impl (ClutterGstPlayer *player,
+                                           guint             count)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  priv->max_standby_pipelines = count;
+  player_trim_standby (player, count);
+}
+
+static void
+clutter_gst_player_preroll_uri_impl (ClutterGstPlayer *player,
+                                     const gchar      *uri)
+{
+  ClutterGstPlayerPrivate *priv;
+  GList *l;
+
+  g_return_if_fail (uri != NULL);
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  if (priv->max_standby_pipelines == 0)
+    {
+      CLUTTER_GST_NOTE (MEDIA, "not pre-rolling %s, standby count is 0", uri);
+      return;
+    }
+
+  if (g_strcmp0 (uri, priv->uri) == 0)
+    return;
+
+  for (l = priv->standby_pipelines; l; l = g_list_next (l))
+    {
+      ClutterGstStandby *standby = l->data;
+
+      if (g_strcmp0 (standby->uri, uri) != 0)
+        continue;
+
+      priv->standby_pipelines =
+        g_list_delete_link (priv->standby_pipelines, l);
+
+      /* give a failed pipeline another chance */
+      if (standby->failed)
+        {
+          player_standby_free (priv, standby);
+          break;
+        }
+
+      priv->standby_pipelines =
+        g_list_prepend (priv->standby_pipelines, standby);
+      return;
+    }
+
+  player_trim_standby (player, priv->max_standby_pipelines - 1);
+  player_add_standby (player, uri);
+}
+
+static gboolean
+clutter_gst_player_get_async_state_changes_impl (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  return priv->async_state_changes;
+}
+
+static void
+clutter_gst_player_set_async_state_changes_impl (ClutterGstPlayer *player,
+                                                 gboolean          async_state_changes)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  async_state_changes = !!async_state_changes;
+  if (priv->async_state_changes == async_state_changes)
+    return;
+
+  priv->async_state_changes = async_state_changes;
+
+  g_object_notify (G_OBJECT (player), "async-state-changes");
+}
+
+static gdouble
+clutter_gst_player_get_buffering_target_impl (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  return priv->buffering_target;
+}
+
+static void
+clutter_gst_player_set_buffering_target_impl (ClutterGstPlayer *player,
+                                              gdouble           seconds)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  g_return_if_fail (seconds >= 0.0);
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  if (priv->buffering_target == seconds)
+    return;
+
+  priv->buffering_target = seconds;
+
+  if (priv->in_download_buffering)
+    {
+      priv->virtual_stream_buffer_signalled = 0;
+      player_schedule_buffering_update (player);
+    }
+
+  g_object_notify (G_OBJECT (player), "buffering-target");
+}
+
+static guint
+clutter_gst_player_get_n_buffered_ranges_impl (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  return priv->buffered_ranges->len;
+}
+
+static gboolean
+clutter_gst_player_get_buffered_range_impl (ClutterGstPlayer *player,
+                                            guint             index_,
+                                            gdouble          *start,
+                                            gdouble          *stop)
+{
+  ClutterGstPlayerPrivate *priv;
+  ClutterGstBufferedRange *range;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  if (index_ >= priv->buffered_ranges->len)
+    return FALSE;
+
+  range = &g_array_index (priv->buffered_ranges,
+                          ClutterGstBufferedRange, index_);
+  if (start)
+    *start = range->start;
+  if (stop)
+    *stop = range->stop;
+
+  return TRUE;
+}
+
+static void
+clutter_gst_player_get_buffering_watermarks_impl (ClutterGstPlayer *player,
+                                                  gdouble          *low,
+                                                  gdouble          *high)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  if (low)
+    *low = priv->buffering_low_watermark;
+  if (high)
+    *high = priv->buffering_high_watermark;
+}
+
+static void
+clutter_gst_player_set_buffering_watermarks_impl (ClutterGstPlayer *player,
+                                                  gdouble           low,
+                                                  gdouble           high)
+{
+  ClutterGstPlayerPrivate *priv;
+  GObject *self;
+
+  g_return_if_fail (0.0 <= low && low <= high && high <= 1.0);
+
+  priv = PLAYER_GET_PRIVATE (player);
+  self = G_OBJECT (player);
+
+  g_object_freeze_notify (self);
+
+  if (priv->buffering_low_watermark != low)
+    {
+      priv->buffering_low_watermark = low;
+      g_object_notify (self, "buffering-low-watermark");
+    }
+
+  if (priv->buffering_high_watermark != high)
+    {
+      priv->buffering_high_watermark = high;
+      g_object_notify (self, "buffering-high-watermark");
+    }
+
+  g_object_thaw_notify (self);
+}
+
+static gdouble
+clutter_gst_player_get_buffering_time_left_impl (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  return priv->buffering_time_left;
+}
+
+static guint64
+clutter_gst_player_get_timeshift_size_impl (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  return priv->timeshift_size;
+}
+
+static void
+clutter_gst_player_set_timeshift_size_impl (ClutterGstPlayer *player,
+                                            guint64           size)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  if (priv->timeshift_size == size)
+    return;
+
+  priv->timeshift_size = size;
+
+  g_object_set (priv->pipeline, "ring-buffer-max-size", size, NULL);
+
+  g_object_notify (G_OBJECT (player), "timeshift-size");
+}
+
+static gboolean
+clutter_gst_player_get_use_media_cache_impl (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  return priv->use_media_cache;
+}
+
+static void
+clutter_gst_player_set_use_media_cache_impl (ClutterGstPlayer *player,
+                                             gboolean          use_media_cache)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  use_media_cache = !!use_media_cache;
+  if (priv->use_media_cache == use_media_cache)
+    return;
+
+  priv->use_media_cache = use_media_cache;
+
+  g_object_notify (G_OBJECT (player), "use-media-cache");
+}
+
+static guint64
+clutter_gst_player_get_memory_budget_impl (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  return priv->memory_budget;
+}
+
+static void
+clutter_gst_player_set_memory_budget_impl (ClutterGstPlayer *player,
+                                           guint64           budget)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  if (priv->memory_budget == budget)
+    return;
+
+  priv->memory_budget = budget;
+
+  player_update_memory_budget (player);
+
+  g_object_notify (G_OBJECT (player), "memory-budget");
+}
+
+static guint64
+clutter_gst_player_get_queued_bytes_impl (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  return player_get_queued_bytes (priv);
+}
+
+static gboolean
+clutter_gst_player_get_shared_audio_impl (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  return priv->shared_audio;
+}
+
+static void
+clutter_gst_player_set_shared_audio_impl (ClutterGstPlayer *player,
+                                          gboolean          shared_audio)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  shared_audio = !!shared_audio;
+  if (priv->shared_audio == shared_audio)
+    return;
+
+  priv->shared_audio = shared_audio;
+
+  g_object_notify (G_OBJECT (player), "shared-audio");
+}
+
+static gboolean
+clutter_gst_player_get_audio_enabled_impl (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  return priv->audio_enabled;
+}
+
+static void
+clutter_gst_player_set_audio_enabled_impl (ClutterGstPlayer *player,
+                                           gboolean          enabled)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  enabled = !!enabled;
+  if (priv->audio_enabled == enabled)
+    return;
+
+  priv->audio_enabled = enabled;
+
+  player_update_audio_flag (player);
+
+  g_object_notify (G_OBJECT (player), "audio-enabled");
+}
+
+static void
+clutter_gst_player_step_forward_impl (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv;
+  GstSample *sample;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  if (!player_prepare_step (player))
+    return;
+
+  /* back from stepping back */
+  if (priv->shown_frame)
+    {
+      player_show_cached_frame (player, priv->shown_frame->next);
+      return;
+    }
+
+  /* keep the current frame to be able to step back to it */
+  if (priv->frame_cache.length == 0)
+    {
+      sample = player_get_current_frame (priv);
+      if (sample)
+        {
+          player_cache_frame (player, sample);
+          gst_sample_unref (sample);
+        }
+    }
+
+  priv->in_step = TRUE;
+
+  if (!gst_element_send_event (priv->pipeline,
+                               gst_event_new_step (GST_FORMAT_BUFFERS, 1, 1.0,
+                                                   TRUE, FALSE)))
+    priv->in_step = FALSE;
+}
+
+static void
+clutter_gst_player_step_back_impl (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv;
+  GstClockTime target;
+  GstSample *sample;
+  GList *current;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  if (!player_prepare_step (player))
+    return;
+
+  current = priv->shown_frame ? priv->shown_frame : priv->frame_cache.tail;
+  if (current && current->prev)
+    {
+      player_show_cached_frame (player, current->prev);
+      return;
+    }
+
+  sample = current ? gst_sample_ref (current->data)
+                   : player_get_current_frame (priv);
+  if (sample == NULL)
+    return;
+
+  target = frame_get_stream_time (sample);
+  gst_sample_unref (sample);
+
+  if (!GST_CLOCK_TIME_IS_VALID (target) || target == 0)
+    return;
+
+  CLUTTER_GST_NOTE (MEDIA, "stepping back from %" GST_TIME_FORMAT,
+                    GST_TIME_ARGS (target));
+
+  /* decode from the key frame before, up to the frame we're on */
+  player_clear_frame_cache (priv);
+
+  priv->in_step = TRUE;
+  priv->in_step_seek = TRUE;
+  priv->step_back_target = target;
+
+  if (!gst_element_seek (priv->pipeline, 1.0,
+                         GST_FORMAT_TIME,
+                         GST_SEEK_FLAG_FLUSH |
+                         GST_SEEK_FLAG_KEY_UNIT |
+                         GST_SEEK_FLAG_SNAP_BEFORE,
+                         GST_SEEK_TYPE_SET, target - 1,
+                         GST_SEEK_TYPE_NONE, GST_CLOCK_TIME_NONE))
+    player_clear_frame_cache (priv);
+}
+
+static guint
+clutter_gst_player_get_frame_cache_size_impl (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  return priv->frame_cache_size;
+}
+
+static void
+clutter_gst_player_set_frame_cache_size_impl (ClutterGstPlayer *player,
+                                              guint             n_frames)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  g_return_if_fail (n_frames > 0);
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  if (priv->frame_cache_size == n_frames)
+    return;
+
+  priv->frame_cache_size = n_frames;
+
+  player_trim_frame_cache (player);
+
+  g_object_notify (G_OBJECT (player), "frame-cache-size");
+}
+
+static gboolean
+clutter_gst_player_get_use_keyframe_index_impl (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  return priv->use_keyframe_index;
+}
+
+static void
+clutter_gst_player_set_use_keyframe_index_impl (ClutterGstPlayer *player,
+                                                gboolean          use_index)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  use_index = !!use_index;
+  if (priv->use_keyframe_index == use_index)
+    return;
+
+  priv->use_keyframe_index = use_index;
+
+  player_load_keyframe_index (player);
+
+  g_object_notify (G_OBJECT (player), "use-keyframe-index");
+}
+
+static gdouble
+clutter_gst_player_get_seek_cost_impl (ClutterGstPlayer *player,
+                                       gdouble           progress)
+{
+  ClutterGstPlayerPrivate *priv;
+  GstClockTime position, keyframe;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  if (priv->keyframe_index == NULL || priv->duration <= 0.0)
+    return -1.0;
+
+  position = CLAMP (progress, 0.0, 1.0) * priv->duration * GST_SECOND;
+  keyframe = _clutter_gst_keyframe_index_lookup (priv->keyframe_index,
+                                                 position);
+  if (!GST_CLOCK_TIME_IS_VALID (keyframe))
+    return -1.0;
+
+  return (gdouble) (position - keyframe) / GST_SECOND;
+}
+
+static gboolean
+clutter_gst_player_get_native_video_impl (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  return priv->native_video;
+}
+
+static void
+clutter_gst_player_set_native_video_impl (ClutterGstPlayer *player,
+                                          gboolean          native)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  native = !!native;
+  if (priv->native_video == native)
+    return;
+
+  priv->native_video = native;
+
+  /* otherwise set_uri() updates the flag */
+  if (player_media_is_closed (player))
+    player_update_native_video_flag (player);
+
+  g_object_notify (G_OBJECT (player), "native-video");
+}
+
+static gboolean
+clutter_gst_player_get_adapt_streams_to_size_impl (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  return priv->adapt_streams;
+}
+
+static void
+clutter_gst_player_set_adapt_streams_to_size_impl (ClutterGstPlayer *player,
+                                                   gboolean          adapt)
+{
+  ClutterGstPlayerPrivate *priv;
+  guint i;
+  const gchar *size_notifies[] = {
+    "notify::allocation",
+    "notify::scale-x",
+    "notify::scale-y",
+    "notify::mapped"
+  };
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  adapt = !!adapt;
+  if (priv->adapt_streams == adapt)
+    return;
+
+  priv->adapt_streams = adapt;
+
+  if (adapt)
+    {
+      for (i = 0; i < G_N_ELEMENTS (size_notifies); i++)
+        g_signal_connect (player, size_notifies[i],
+                          G_CALLBACK (player_schedule_adaptive_size), NULL);
+    }
+  else
+    {
+      g_signal_handlers_disconnect_by_func (player,
+                                            player_schedule_adaptive_size,
+                                            NULL);
+    }
+
+  if (priv->adaptive_update_id)
+    {
+      g_source_remove (priv->adaptive_update_id);
+      priv->adaptive_update_id = 0;
+    }
+  player_update_adaptive_size (player);
+
+  g_object_notify (G_OBJECT (player), "adapt-streams-to-size");
+}
+
+static gboolean
+clutter_gst_player_get_throttle_hidden_impl (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  return priv->throttle_hidden;
+}
+
+static void
+clutter_gst_player_set_throttle_hidden_impl (ClutterGstPlayer *player,
+                                             gboolean          throttle)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  throttle = !!throttle;
+  if (priv->throttle_hidden == throttle)
+    return;
+
+  priv->throttle_hidden = throttle;
+
+  player_configure_video_sink (player);
+
+  if (throttle)
+    {
+      if (priv->video_hidden)
+        player_schedule_video_disable (player);
+    }
+  else
+    {
+      player_resume_video (player, TRUE);
+    }
+
+  g_object_notify (G_OBJECT (player), "throttle-hidden");
+}
+
+static guint
+clutter_gst_player_get_hidden_grace_period_impl (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  return priv->hidden_grace_period;
+}
+
+static void
+clutter_gst_player_set_hidden_grace_period_impl (ClutterGstPlayer *player,
+                                                 guint             grace_period)
+{
+  ClutterGstPlayerPrivate *priv;
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  if (priv->hidden_grace_period == grace_period)
+    return;
+
+  priv->hidden_grace_period = grace_period;
+
+  /* restart the countdown with the new period */
+  if (priv->video_disable_id)
+    {
+      g_source_remove (priv->video_disable_id);
+      priv->video_disable_id = 0;
+      player_schedule_video_disable (player);
+    }
+
+  g_object_notify (G_OBJECT (player), "hidden-grace-period");
+}
+
+/**/
+
+#if defined (CLUTTER_WINDOWING_X11) && defined (HAVE_HW_DECODER_SUPPORT)
+static GstBusSyncReply
+on_sync_message (GstBus * bus, GstMessage * message, gpointer user_data)
+{
+  Display *display = user_data;
+  GstVideoContext *context;
+  const gchar **types;
+
+  if (gst_video_context_message_parse_prepare (message, &types, &context)) {
+    gint i;
+
+    for (i = 0; types[i]; i++) {
+
+      if (!strcmp(types[i], "x11-display")) {
+        gst_video_context_set_context_pointer (context, "x11-display", display);
+      }
+      else if (!strcmp(types[i], "x11-display-name")) {
+        gst_video_context_set_context_string (context, "x11-display-name",
+            DisplayString (display));
+      } else {
+        continue;
+      }
+
+      gst_message_unref (message);
+      return GST_BUS_DROP;
+    }
+  }
+
+  return GST_BUS_PASS;
+}
+#endif
+
+/* Hands the messages of the bus of a player to the shared bus dispatcher.
+ * The messages the player doesn't handle are dropped right away, as are
+ * the state changes of the elements of the pipeline */
+static GstBusSyncReply
+player_bus_sync_handler (GstBus     *bus,
+                         GstMessage *message,
+                         gpointer    user_data)
+{
+  GstElement *pipeline = user_data;
+
+#if defined (CLUTTER_WINDOWING_X11) && defined (HAVE_HW_DECODER_SUPPORT)
+  if (clutter_check_windowing_backend (CLUTTER_WINDOWING_X11) &&
+      on_sync_message (bus, message, clutter_x11_get_default_display ()) ==
+      GST_BUS_DROP)
+    return GST_BUS_DROP;
+#endif
+
+  if ((GST_MESSAGE_TYPE (message) & PLAYER_BUS_MESSAGES) == 0 ||
+      (GST_MESSAGE_TYPE (message) == GST_MESSAGE_STATE_CHANGED &&
+       GST_MESSAGE_SRC (message) != GST_OBJECT (pipeline)))
+    {
+      gst_message_unref (message);
+      return GST_BUS_DROP;
+    }
+
+  _clutter_gst_bus_dispatcher_post (bus, message);
+
+  return GST_BUS_DROP;
+}
+
+/* Connects the player to the signals and bus messages of priv->pipeline */
+static void
+player_connect_pipeline (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+
+  player_connect_ref (priv->ref, priv->pipeline, "notify::source",
+                      G_CALLBACK (on_source_changed));
+  player_connect_ref (priv->ref, priv->pipeline, "element-added",
+                      G_CALLBACK (on_element_added));
+
+  /* used by uridecodebin in download mode */
+  g_object_set (priv->pipeline,
+                "ring-buffer-max-size", priv->timeshift_size,
+                NULL);
+
+  /* a standby pipeline swapped in already has its queues */
+  player_update_memory_budget (player);
+
+  priv->bus = gst_pipeline_get_bus (GST_PIPELINE (priv->pipeline));
+
+  if (priv->shared_bus)
+    gst_bus_set_sync_handler (priv->bus, player_bus_sync_handler,
+                              priv->pipeline, NULL);
+  else
+    gst_bus_add_signal_watch (priv->bus);
+
+  g_signal_connect_object (priv->bus, "message::error",
+			   G_CALLBACK (bus_message_error_cb),
+			   player, 0);
+  g_signal_connect_object (priv->bus, "message::eos",
+			   G_CALLBACK (bus_message_eos_cb),
+			   player, 0);
+  g_signal_connect_object (priv->bus, "message::buffering",
+			   G_CALLBACK (bus_message_buffering_cb),
+			   player, 0);
+  g_signal_connect_object (priv->bus, "message::duration-changed",
+			   G_CALLBACK (bus_message_duration_changed_cb),
+			   player, 0);
+  g_signal_connect_object (priv->bus, "message::state-changed",
+			   G_CALLBACK (bus_message_state_change_cb),
+			   player, 0);
+  g_signal_connect_object (priv->bus, "message::async-done",
+                           G_CALLBACK (bus_message_async_done_cb),
+                           player, 0);
+  g_signal_connect_object (priv->bus, "message::segment-done",
+                           G_CALLBACK (bus_message_segment_done_cb),
+                           player, 0);
+  g_signal_connect_object (priv->bus, "message::stream-start",
+                           G_CALLBACK (bus_message_stream_start_cb),
+                           player, 0);
+  g_signal_connect_object (priv->bus, "message::step-done",
+                           G_CALLBACK (bus_message_step_done_cb),
+                           player, 0);
+  g_signal_connect_object (priv->bus, "message::element",
+                           G_CALLBACK (bus_message_element_cb),
+                           player, 0);
+  g_signal_connect_object (priv->bus, "message::application",
+                           G_CALLBACK (bus_message_application_cb),
+                           player, 0);
+
+  player_connect_ref (priv->ref, priv->pipeline, "notify::volume",
+                      G_CALLBACK (on_volume_changed));
+
+  player_connect_ref (priv->ref, priv->pipeline, "audio-changed",
+                      G_CALLBACK (on_audio_changed));
+  player_connect_ref (priv->ref, priv->pipeline, "audio-tags-changed",
+                      G_CALLBACK (on_audio_tags_changed));
+  player_connect_ref (priv->ref, priv->pipeline, "notify::current-audio",
+                      G_CALLBACK (on_current_audio_changed));
+
+  player_connect_ref (priv->ref, priv->pipeline, "text-changed",
+                      G_CALLBACK (on_text_changed));
+  player_connect_ref (priv->ref, priv->pipeline, "text-tags-changed",
+                      G_CALLBACK (on_text_tags_changed));
+  player_connect_ref (priv->ref, priv->pipeline, "notify::current-text",
+                      G_CALLBACK (on_current_text_changed));
+
+  player_connect_ref (priv->ref, priv->pipeline, "about-to-finish",
+                      G_CALLBACK (on_about_to_finish));
+
+#if defined(CLUTTER_WINDOWING_X11) && defined (HAVE_HW_DECODER_SUPPORT)
+  if (!priv->shared_bus &&
+      clutter_check_windowing_backend (CLUTTER_WINDOWING_X11))
+    gst_bus_set_sync_handler (priv->bus, on_sync_message,
+                              clutter_x11_get_default_display (), NULL);
+#endif
+
+  gst_object_unref (GST_OBJECT (priv->bus));
+}
+
+static void
+player_disconnect_pipeline (ClutterGstPlayer        *player,
+                            ClutterGstPlayerPrivate *priv,
+                            GstElement              *pipeline)
+{
+  GstIterator *it;
+  GstBus *bus;
+
+  bus = gst_pipeline_get_bus (GST_PIPELINE (pipeline));
+
+  g_signal_handlers_disconnect_by_data (bus, player);
+  if (priv->shared_bus)
+    gst_bus_set_sync_handler (bus, NULL, NULL, NULL);
+  else
+    gst_bus_remove_signal_watch (bus);
+#if defined(CLUTTER_WINDOWING_X11) && defined (HAVE_HW_DECODER_SUPPORT)
+  gst_bus_set_sync_handler (bus, NULL, NULL, NULL);
+#endif
+
+  gst_object_unref (bus);
+
+  g_signal_handlers_disconnect_by_data (pipeline, player);
+  g_signal_handlers_disconnect_by_data (pipeline, priv->ref);
+
+  /* the pipeline may outlive the player, see player_release_pipeline() */
+  it = gst_bin_iterate_recurse (GST_BIN (pipeline));
+  while (gst_iterator_foreach (it, disconnect_element_added, priv->ref) ==
+         GST_ITERATOR_RESYNC)
+    gst_iterator_resync (it);
+  gst_iterator_free (it);
+}
+
+/* Pre-rolled pipelines */
+
+static void
+player_standby_free (ClutterGstPlayerPrivate *priv,
+                     ClutterGstStandby       *standby)
+{
+  if (standby->bus_watch_id)
+    g_source_remove (standby->bus_watch_id);
+
+  if (standby->pipeline)
+    player_release_pipeline (priv, standby->pipeline);
+
+  if (standby->texture)
+    {
+      clutter_actor_destroy (standby->texture);
+      g_object_unref (standby->texture);
+    }
+
+  g_free (standby->uri);
+  g_free (standby->play_uri);
+  g_slice_free (ClutterGstStandby, standby);
+}
+
+/* Nobody listens to the bus of a standby pipeline, we only need to know
+ * whether it failed to pre-roll */
+static gboolean
+standby_bus_watch (GstBus     *bus,
+                   GstMessage *message,
+                   gpointer    data)
+{
+  ClutterGstStandby *standby = data;
+
+  if (GST_MESSAGE_TYPE (message) == GST_MESSAGE_ERROR && !standby->failed)
+    {
+      CLUTTER_GST_NOTE (MEDIA, "standby pipeline for %s failed",
+                        standby->uri);
+      standby->failed = TRUE;
+    }
+
+  return TRUE;
+}
+
+static void
+on_standby_source_setup (GstElement          *pipeline,
+                         GstElement          *source,
+                         ClutterGstPlayerRef *ref)
+{
+  ClutterGstPlayer *player;
+  ClutterGstPlayerPrivate *priv;
+
+  player = player_ref_lock (ref);
+  if (player == NULL)
+    return;
+
+  priv = PLAYER_GET_PRIVATE (player);
+  if (priv->user_agent &&
+      g_object_class_find_property (G_OBJECT_GET_CLASS (source),
+                                    "user-agent"))
+    g_object_set (source, "user-agent", priv->user_agent, NULL);
+
+  player_ref_unlock (ref);
+}
+
+static void
+player_trim_standby (ClutterGstPlayer *player,
+                     guint             max)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+
+  while (g_list_length (priv->standby_pipelines) > max)
+    {
+      GList *last = g_list_last (priv->standby_pipelines);
+
+      CLUTTER_GST_NOTE (MEDIA, "evicting standby pipeline for %s",
+                        ((ClutterGstStandby *) last->data)->uri);
+
+      player_standby_free (priv, last->data);
+      priv->standby_pipelines =
+        g_list_delete_link (priv->standby_pipelines, last);
+    }
+}
+
+static void
+player_add_standby (ClutterGstPlayer *player,
+                    const gchar      *uri)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  ClutterGstStandby *standby;
+  GstElement *pipeline, *video_sink = NULL;
+  GstPlayFlags flags;
+  GstBus *bus;
+
+  pipeline = get_pipeline ();
+  if (pipeline == NULL)
+    return;
+
+  CLUTTER_GST_NOTE (MEDIA, "pre-rolling %s", uri);
+
+  standby = g_slice_new0 (ClutterGstStandby);
+  standby->uri = g_strdup (uri);
+  standby->play_uri = player_resolve_uri (priv, uri, FALSE);
+  standby->pipeline = pipeline;
+
+  g_object_get (priv->pipeline,
+                "flags", &flags,
+                "video-sink", &video_sink,
+                NULL);
+  g_object_set (pipeline,
+                "flags", flags,
+                "mute", TRUE,
+                "uri", standby->play_uri,
+                NULL);
+  if (priv->font_name)
+    g_object_set (pipeline, "subtitle-font-desc", priv->font_name, NULL);
+  player_ensure_audio_sink (player, pipeline);
+
+  /* clone the video sink of the player, a standby sink renders into a
+   * texture of its own until its pipeline is swapped in */
+  if (video_sink)
+    {
+      GstElementFactory *factory;
+      GstElement *sink = NULL;
+
+      factory = gst_element_get_factory (video_sink);
+      if (factory)
+        sink = gst_element_factory_create (factory, NULL);
+
+      if (sink)
+        {
+          if (g_object_class_find_property (G_OBJECT_GET_CLASS (sink),
+                                            "texture"))
+            {
+              standby->texture = g_object_ref_sink (clutter_texture_new ());
+              g_object_set (sink, "texture", standby->texture, NULL);
+            }
+
+          g_object_set (pipeline, "video-sink", sink, NULL);
+        }
+
+      gst_object_unref (video_sink);
+    }
+
+  player_connect_ref (priv->ref, pipeline, "source-setup",
+                      G_CALLBACK (on_standby_source_setup));
+
+  bus = gst_pipeline_get_bus (GST_PIPELINE (pipeline));
+  standby->bus_watch_id = gst_bus_add_watch (bus, standby_bus_watch, standby);
+  gst_object_unref (bus);
+
+  player_set_pipeline_state (priv, pipeline, GST_STATE_PAUSED);
+
+  priv->standby_pipelines = g_list_prepend (priv->standby_pipelines, standby);
+}
+
+static void
+player_update_pixel_aspect_ratio (ClutterGstPlayer *player,
+                                  GstElement       *video_sink)
+{
+  GstVideoInfo info;
+  GstCaps *caps;
+  GstPad *pad;
+
+  if (!g_object_class_find_property (G_OBJECT_GET_CLASS (player),
+                                     "pixel-aspect-ratio"))
+    return;
+
+  pad = gst_element_get_static_pad (video_sink, "sink");
+  if (pad == NULL)
+    return;
+
+  caps = gst_pad_get_current_caps (pad);
+  gst_object_unref (pad);
+  if (caps == NULL)
+    return;
+
+  if (gst_video_info_from_caps (&info, caps))
+    {
+      GValue par = { 0, };
+
+      g_value_init (&par, GST_TYPE_FRACTION);
+      gst_value_set_fraction (&par, info.par_n, info.par_d);
+      g_object_set_property (G_OBJECT (player), "pixel-aspect-ratio", &par);
+      g_value_unset (&par);
+    }
+
+  gst_caps_unref (caps);
+}
+
+/* Replaces the pipeline of the player by the pre-rolled pipeline for @uri,
+ * if any. The player is then in the same state it would be after set_uri()
+ * except that the new pipeline does not have to go through typefinding,
+ * element creation and pre-rolling */
+static gboolean
+player_swap_standby (ClutterGstPlayer *player,
+                     const gchar      *uri)
+{
+  ClutterGstPlayerPrivate *priv = PLAYER_GET_PRIVATE (player);
+  ClutterGstStandby *standby = NULL;
+  GstElement *old_pipeline, *video_sink = NULL;
+  GstStateChangeReturn ret;
+  GstState state, current;
+  GstPlayFlags old_flags, flags;
+  gboolean prerolled, stale;
+  gchar *play_uri;
+  gdouble volume;
+  GList *l;
+
+  for (l = priv->standby_pipelines; l; l = g_list_next (l))
+    {
+      ClutterGstStandby *candidate = l->data;
+
+      if (g_strcmp0 (candidate->uri, uri) == 0)
+        {
+          standby = candidate;
+          break;
+        }
+    }
+
+  if (standby == NULL)
+    return FALSE;
+
+  priv->standby_pipelines = g_list_delete_link (priv->standby_pipelines, l);
+
+  /* the media may have made it to the cache since it was pre-rolled, the
+   * local copy is preferred */
+  play_uri = player_resolve_uri (priv, uri, FALSE);
+  stale = g_strcmp0 (play_uri, standby->play_uri) != 0;
+  g_free (play_uri);
+
+  if (standby->failed || stale)
+    {
+      player_standby_free (priv, standby);
+      return FALSE;
+    }
+
+  CLUTTER_GST_NOTE (MEDIA, "swapping in the standby pipeline for %s", uri);
+
+  g_source_remove (standby->bus_watch_id);
+  standby->bus_watch_id = 0;
+
+  /* get rid of the current pipeline */
+  old_pipeline = priv->pipeline;
+
+  state = player_get_pending_state (player);
+
+  volume = gst_stream_volume_get_volume (GST_STREAM_VOLUME (old_pipeline),
+                                         GST_STREAM_VOLUME_FORMAT_CUBIC);
+  g_object_get (old_pipeline, "flags", &old_flags, NULL);
+
+  player_disconnect_pipeline (player, priv, old_pipeline);
+  priv->bus = NULL;
+
+  player_release_pipeline (priv, old_pipeline);
+
+  /* and adopt the standby one */
+  priv->pipeline = standby->pipeline;
+  standby->pipeline = NULL;
+
+  g_object_get (priv->pipeline, "flags", &flags, NULL);
+  if (flags != old_flags)
+    g_object_set (priv->pipeline, "flags", old_flags, NULL);
+
+  g_object_set (priv->pipeline, "mute", FALSE, NULL);
+  gst_stream_volume_set_volume (GST_STREAM_VOLUME (priv->pipeline),
+                                GST_STREAM_VOLUME_FORMAT_CUBIC,
+                                volume);
+
+  /* make the sink render into the player, starting with the frame it has
+   * pre-rolled */
+  g_object_get (priv->pipeline, "video-sink", &video_sink, NULL);
+  if (video_sink)
+    {
+      if (standby->texture && CLUTTER_IS_TEXTURE (player))
+        {
+          CoglHandle material;
+
+          material =
+            clutter_texture_get_cogl_material (CLUTTER_TEXTURE (standby->texture));
+          if (material)
+            clutter_texture_set_cogl_material (CLUTTER_TEXTURE (player),
+                                               material);
+
+          g_object_set (video_sink, "texture", player, NULL);
+          player_update_pixel_aspect_ratio (player, video_sink);
+        }
+
+      gst_object_unref (video_sink);
+    }
+
+  player_configure_video_sink (player);
+
+  player_standby_free (priv, standby);
+
+  player_connect_pipeline (player);
+
+  ret = gst_element_get_state (priv->pipeline, &current, NULL, 0);
+  prerolled = (ret == GST_STATE_CHANGE_SUCCESS && current == GST_STATE_PAUSED) ||
+              ret == GST_STATE_CHANGE_NO_PREROLL;
+
+  player_set_state (player, MAX (state, GST_STATE_PAUSED));
+
+  if (prerolled)
+    {
+      /* we missed the READY to PAUSED transition */
+      query_seeking (player);
+      query_duration (player);
+
+      priv->is_changing_uri = FALSE;
+
+      if (priv->loop && priv->can_seek)
+        player_start_loop (player);
+    }
+  else
+    {
+      priv->is_changing_uri = TRUE;
+    }
+
+  return TRUE;
+}
+
+/**
+ * clutter_gst_player_init:
+ * @player: a #ClutterGstPlayer
+ *
+ * Initialize a #ClutterGstPlayer instance. You should call this
+ * function at the beginning of the init method of the class
+ * implementing #ClutterGstPlayer.
+ *
+ * When you're finished with the ClutterGstPlayer mixin features (usually in
+ * the dispose or finalize vfuncs), call clutter_gst_player_deinit() to
+ * desallocate the resources created by clutter_gst_player_init().
+ *
+ * Return value: TRUE if the initialization was successfull, FALSE otherwise.
+ *
+ * Since: 1.4
+ */
+gboolean
+clutter_gst_player_init (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv;
+  ClutterGstPlayerIface *iface;
+
+  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player), FALSE);
+
+  priv = PLAYER_GET_PRIVATE (player);
+  if (priv)
+    return TRUE;
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  iface->get_pipeline = clutter_gst_player_get_pipeline_impl;
+  iface->get_user_agent = clutter_gst_player_get_user_agent_impl;
+  iface->set_user_agent = clutter_gst_player_set_user_agent_impl;
+  iface->get_seek_flags = clutter_gst_player_get_seek_flags_impl;
+  iface->set_seek_flags = clutter_gst_player_set_seek_flags_impl;
+  iface->get_buffering_mode = clutter_gst_player_get_buffering_mode_impl;
+  iface->set_buffering_mode = clutter_gst_player_set_buffering_mode_impl;
+  iface->get_audio_streams = clutter_gst_player_get_audio_streams_impl;
+  iface->get_audio_stream = clutter_gst_player_get_audio_stream_impl;
+  iface->set_audio_stream = clutter_gst_player_set_audio_stream_impl;
+  iface->get_subtitle_tracks = clutter_gst_player_get_subtitle_tracks_impl;
+  iface->get_subtitle_track = clutter_gst_player_get_subtitle_track_impl;
+  iface->set_subtitle_track = clutter_gst_player_set_subtitle_track_impl;
+  iface->get_idle = clutter_gst_player_get_idle_impl;
+  iface->get_in_seek = clutter_gst_player_get_in_seek_impl;
+  iface->get_loop = clutter_gst_player_get_loop_impl;
+  iface->set_loop = clutter_gst_player_set_loop_impl;
+  iface->get_loop_segment = clutter_gst_player_get_loop_segment_impl;
+  iface->set_loop_segment = clutter_gst_player_set_loop_segment_impl;
+  iface->enqueue_uri = clutter_gst_player_enqueue_uri_impl;
+  iface->clear_queue = clutter_gst_player_clear_queue_impl;
+  iface->get_queue_length = clutter_gst_player_get_queue_length_impl;
+  iface->get_standby_count = clutter_gst_player_get_standby_count_impl;
+  iface->set_standby_count = clutter_gst_player_set_standby_count_impl;
+  iface->preroll_uri = clutter_gst_player_preroll_uri_impl;
+  iface->get_async_state_changes = clutter_gst_player_get_async_state_changes_impl;
+  iface->set_async_state_changes = clutter_gst_player_set_async_state_changes_impl;
+  iface->get_buffering_target = clutter_gst_player_get_buffering_target_impl;
+  iface->set_buffering_target = clutter_gst_player_set_buffering_target_impl;
+  iface->get_n_buffered_ranges = clutter_gst_player_get_n_buffered_ranges_impl;
+  iface->get_buffered_range = clutter_gst_player_get_buffered_range_impl;
+  iface->get_buffering_watermarks = clutter_gst_player_get_buffering_watermarks_impl;
+  iface->set_buffering_watermarks = clutter_gst_player_set_buffering_watermarks_impl;
+  iface->get_buffering_time_left = clutter_gst_player_get_buffering_time_left_impl;
+  iface->get_timeshift_size = clutter_gst_player_get_timeshift_size_impl;
+  iface->set_timeshift_size = clutter_gst_player_set_timeshift_size_impl;
+  iface->get_use_media_cache = clutter_gst_player_get_use_media_cache_impl;
+  iface->set_use_media_cache = clutter_gst_player_set_use_media_cache_impl;
+  iface->get_memory_budget = clutter_gst_player_get_memory_budget_impl;
+  iface->set_memory_budget = clutter_gst_player_set_memory_budget_impl;
+  iface->get_queued_bytes = clutter_gst_player_get_queued_bytes_impl;
+  iface->get_shared_audio = clutter_gst_player_get_shared_audio_impl;
+  iface->set_shared_audio = clutter_gst_player_set_shared_audio_impl;
+  iface->get_audio_enabled = clutter_gst_player_get_audio_enabled_impl;
+  iface->set_audio_enabled = clutter_gst_player_set_audio_enabled_impl;
+  iface->step_forward = clutter_gst_player_step_forward_impl;
+  iface->step_back = clutter_gst_player_step_back_impl;
+  iface->get_frame_cache_size = clutter_gst_player_get_frame_cache_size_impl;
+  iface->set_frame_cache_size = clutter_gst_player_set_frame_cache_size_impl;
+  iface->get_use_keyframe_index = clutter_gst_player_get_use_keyframe_index_impl;
+  iface->set_use_keyframe_index = clutter_gst_player_set_use_keyframe_index_impl;
+  iface->get_seek_cost = clutter_gst_player_get_seek_cost_impl;
+  iface->get_native_video = clutter_gst_player_get_native_video_impl;
+  iface->set_native_video = clutter_gst_player_set_native_video_impl;
+  iface->get_adapt_streams_to_size = clutter_gst_player_get_adapt_streams_to_size_impl;
+  iface->set_adapt_streams_to_size = clutter_gst_player_set_adapt_streams_to_size_impl;
+  iface->get_throttle_hidden = clutter_gst_player_get_throttle_hidden_impl;
+  iface->set_throttle_hidden = clutter_gst_player_set_throttle_hidden_impl;
+  iface->get_hidden_grace_period = clutter_gst_player_get_hidden_grace_period_impl;
+  iface->set_hidden_grace_period = clutter_gst_player_set_hidden_grace_period_impl;
+
+  priv = g_slice_new0 (ClutterGstPlayerPrivate);
+  PLAYER_SET_PRIVATE (player, priv);
+
+  priv->is_idle = TRUE;
+  priv->in_seek = FALSE;
+  priv->is_changing_uri = FALSE;
+  priv->in_download_buffering = FALSE;
+
+  g_mutex_init (&priv->queue_lock);
+  g_queue_init (&priv->uri_queue);
+
+  priv->ref = player_ref_new (player);
+
+  priv->pipeline = get_pipeline ();
+  if (!priv->pipeline)
+    {
+      g_critical ("Unable to create pipeline");
+      return FALSE;
+    }
+
+  /* We default to not playing until someone calls set_playing(TRUE) */
+  priv->target_state = GST_STATE_PAUSED;
+
+  /* Default to a fast seek, ie. same effect than set_seek_flags (NONE); */
+  priv->seek_flags = GST_SEEK_FLAG_KEY_UNIT;
+
+  /* Loop on the whole media by default */
+  priv->loop_stop = -1.0;
+
+  priv->buffered_ranges = g_array_new (FALSE, TRUE,
+                                       sizeof (ClutterGstBufferedRange));
+  priv->buffering_target = DEFAULT_BUFFERING_TARGET;
+  priv->buffering_low_watermark = DEFAULT_BUFFERING_LOW_WATERMARK;
+  priv->buffering_high_watermark = DEFAULT_BUFFERING_HIGH_WATERMARK;
+  priv->in_stream_buffering = TRUE;
+
+  /* playbin's default volume */
+  priv->volume = 1.0;
+  priv->audio_enabled = TRUE;
+  priv->audio_channel = g_strdup_printf ("clutter-gst-audio-%p", player);
+
+  g_queue_init (&priv->frame_cache);
+  priv->frame_cache_size = DEFAULT_FRAME_CACHE_SIZE;
+  priv->step_back_target = GST_CLOCK_TIME_NONE;
+  priv->seek_step_target = GST_CLOCK_TIME_NONE;
+
+  priv->hidden_grace_period = DEFAULT_HIDDEN_GRACE_PERIOD;
+
+  /* the other players get a smaller share of the global budget */
+  players = g_list_prepend (players, player);
+  g_atomic_int_inc (&n_players);
+  update_global_memory_budget ();
+
+  priv->shared_bus = use_shared_bus_dispatch;
+  if (priv->shared_bus)
+    _clutter_gst_bus_dispatcher_ref ();
+
+  player_connect_pipeline (player);
+
+  return TRUE;
+}
+
+/**
+ * clutter_gst_player_deinit:
+ * @player: a #ClutterGstPlayer
+ *
+ * Frees the resources created by clutter_gst_player_init(). After
+ * clutter_gst_player_deinit() has been called, no other player method can be
+ * called on the instance.
+ *
+ * Since: 1.4
+ */
+void
+clutter_gst_player_deinit (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerPrivate *priv;
+  GList *l;
+
+  g_return_if_fail (CLUTTER_GST_IS_PLAYER (player));
+
+  priv = PLAYER_GET_PRIVATE (player);
+
+  if (priv == NULL)
+    return;
+
+  /* wait for the callbacks running in GStreamer's threads, the next ones
+   * won't see the player */
+  g_rec_mutex_lock (&priv->ref->lock);
+  priv->ref->player = NULL;
+  PLAYER_SET_PRIVATE (player, NULL);
+  g_rec_mutex_unlock (&priv->ref->lock);
+
+  players = g_list_remove (players, player);
+  g_atomic_int_add (&n_players, -1);
+  update_global_memory_budget ();
+
+  if (priv->tick_timeout_id)
+    {
+      g_source_remove (priv->tick_timeout_id);
+      priv->tick_timeout_id = 0;
+    }
+
+  if (priv->buffering_update_id)
+    {
+      g_source_remove (priv->buffering_update_id);
+      priv->buffering_update_id = 0;
+    }
+
+  if (priv->download_buffering_element)
+    {
+      g_object_unref (priv->download_buffering_element);
+      priv->download_buffering_element = NULL;
+    }
+
+  if (priv->bus)
+    {
+      player_disconnect_pipeline (player, priv, priv->pipeline);
+      priv->bus = NULL;
+    }
+
+  if (priv->pipeline)
+    {
+      player_release_pipeline (priv, priv->pipeline);
+      priv->pipeline = NULL;
+    }
+
+  if (priv->shared_bus)
+    _clutter_gst_bus_dispatcher_unref ();
+
+  player_cancel_subtitle_scan (priv);
+  g_free (priv->pending_suburi);
+  player_release_timeshift (priv);
+  player_discard_download (priv);
+  player_set_revalidation (priv, NULL, NULL);
+  player_clear_frame_cache (priv);
+  player_clear_keyframe_index (priv);
+
+  if (priv->adapt_streams)
+    g_signal_handlers_disconnect_by_func (player,
+                                          player_schedule_adaptive_size,
+                                          NULL);
+  if (priv->adaptive_update_id)
+    {
+      g_source_remove (priv->adaptive_update_id);
+      priv->adaptive_update_id = 0;
+    }
+
+  if (priv->video_disable_id)
+    {
+      g_source_remove (priv->video_disable_id);
+      priv->video_disable_id = 0;
+    }
+  if (priv->video_resume_id)
+    {
+      g_source_remove (priv->video_resume_id);
+      priv->video_resume_id = 0;
+    }
+  player_release_hidden_texture (player, priv);
+
+  for (l = priv->standby_pipelines; l; l = g_list_next (l))
+    player_standby_free (priv, l->data);
+  g_list_free (priv->standby_pipelines);
+
+  /* let the worker finish the queued transitions on its own */
+  if (priv->state_worker)
+    {
+      g_thread_pool_free (priv->state_worker, FALSE, FALSE);
+      priv->state_worker = NULL;
+    }
+
+  g_free (priv->uri);
+  g_free (priv->font_name);
+  g_free (priv->user_agent);
+  g_free (priv->audio_channel);
+  free_tags_list (&priv->audio_streams);
+  free_tags_list (&priv->subtitle_tracks);
+  g_array_free (priv->buffered_ranges, TRUE);
+
+  g_queue_foreach (&priv->uri_queue, (GFunc) g_free, NULL);
+  g_queue_clear (&priv->uri_queue);
+  g_free (priv->next_uri);
+  g_mutex_clear (&priv->queue_lock);
+
+  player_ref_unref (priv->ref);
+
+  g_slice_free (ClutterGstPlayerPrivate, priv);
+}
+
+static void
+clutter_gst_player_default_init (ClutterGstPlayerIface *iface)
+{
+  GParamSpec *pspec;
+
+  /**
+   * ClutterGstPlayer:idle:
+   *
+   * Whether the #ClutterGstPlayer is in idle mode.
+   *
+   * Since: 1.4
+   */
+  pspec = g_param_spec_boolean ("idle",
+                                "Idle",
+                                "Idle state of the player's pipeline",
+                                TRUE,
+                                CLUTTER_GST_PARAM_READABLE);
+  g_object_interface_install_property (iface, pspec);
+
+  /**
+   * ClutterGstPlayer:user-agent:
+   *
+   * The User Agent used by #ClutterGstPlayer with network protocols.
+   *
+   * Since: 1.4
+   */
+  pspec = g_param_spec_string ("user-agent",
+                               "User Agent",
+                               "User Agent used with network protocols",
+                               NULL,
+                               CLUTTER_GST_PARAM_READWRITE);
+  g_object_interface_install_property (iface, pspec);
+
+  /**
+   * ClutterGstPlayer:seek-flags:
+   *
+   * Flags to use when seeking.
+   *
+   * Since: 1.4
+   */
+  pspec = g_param_spec_flags ("seek-flags",
+                              "Seek Flags",
+                              "Flags to use when seeking",
+                              CLUTTER_GST_TYPE_SEEK_FLAGS,
+                              CLUTTER_GST_SEEK_FLAG_NONE,
+                              CLUTTER_GST_PARAM_READWRITE);
+  g_object_interface_install_property (iface, pspec);
+
+  /**
+   * ClutterGstPlayer:audio-streams:
+   *
+   * List of audio streams available on the current media.
+   *
+   * Since: 1.4
+   */
+  pspec = g_param_spec_pointer ("audio-streams",
+                                "Audio Streams",
+                                "List of the audio streams of the media",
+                                CLUTTER_GST_PARAM_READABLE);
+  g_object_interface_install_property (iface, pspec);
+
+  /**
+   * ClutterGstPlayer:audio-stream:
+   *
+   * Index of the current audio stream.
+   *
+   * Since: 1.4
+   */
+  pspec = g_param_spec_int ("audio-stream",
+                            "Audio Stream",
+                            "Index of the current audio stream",
+                            -1, G_MAXINT, -1,
+                            CLUTTER_GST_PARAM_READWRITE);
+  g_object_interface_install_property (iface, pspec);
+
+  pspec = g_param_spec_pointer ("subtitle-tracks",
+                                "Subtitles Tracks",
+                                "List of the subtitles tracks of the media",
+                                CLUTTER_GST_PARAM_READABLE);
+  g_object_interface_install_property (iface, pspec);
+
+  pspec = g_param_spec_int ("subtitle-track",
+                            "Subtitles Track",
+                            "Index of the current subtitles track",
+                            -1, G_MAXINT, -1,
+                            CLUTTER_GST_PARAM_READWRITE);
+  g_object_interface_install_property (iface, pspec);
+
+
+  /**
+   * ClutterGstPlayer:in-seek:
+   *
+   * Whether or not the stream is being seeked.
+   *
+   * Since: 1.6
+   */
+  pspec = g_param_spec_boolean ("in-seek",
+                                "In seek mode",
+                                "If currently seeking",
+                                FALSE,
+                                CLUTTER_GST_PARAM_READABLE);
+  g_object_interface_install_property (iface, pspec);
+
+  /**
+   * ClutterGstPlayer:loop:
+   *
+   * Whether the media (or the segment set with
+   * clutter_gst_player_set_loop_segment()) is played in a loop.
+   *
+   * Looping is seamless: the pipeline is never torn down and the
+   * #ClutterMedia::eos signal is not emitted at the end of each loop.
+   *
+   * Since: 2.2
+   */
+  pspec = g_param_spec_boolean ("loop",
+                                "Loop",
+                                "Whether the media is played in a loop",
+                                FALSE,
+                                CLUTTER_GST_PARAM_READWRITE);
+  g_object_interface_install_property (iface, pspec);
+
+  /**
+   * ClutterGstPlayer:async-state-changes:
+   *
+   * Whether URI changes, playback state changes and the disposal of the
+   * pipeline are done from a worker thread instead of blocking the caller.
+   *
+   * Since: 2.2
+   */
+  pspec = g_param_spec_boolean ("async-state-changes",
+                                "Asynchronous state changes",
+                                "Whether to change the state of the pipeline "
+                                "from a worker thread",
+                                FALSE,
+                                CLUTTER_GST_PARAM_READWRITE);
+  g_object_interface_install_property (iface, pspec);
+
+  /**
+   * ClutterGstPlayer:buffering-target:
+   *
+   * With %CLUTTER_GST_BUFFERING_MODE_DOWNLOAD, the amount of media, in
+   * seconds, that has to be downloaded after the playback position before
+   * playing.
+   *
+   * Since: 2.2
+   */
+  pspec = g_param_spec_double ("buffering-target",
+                               "Buffering target",
+                               "Seconds of media to download before playing",
+                               0.0, G_MAXDOUBLE,
+                               DEFAULT_BUFFERING_TARGET,
+                               CLUTTER_GST_PARAM_READWRITE);
+  g_object_interface_install_property (iface, pspec);
+
+  /**
+   * ClutterGstPlayer:buffering-low-watermark:
+   *
+   * With %CLUTTER_GST_BUFFERING_MODE_STREAM, the value of
+   * #ClutterMedia:buffer-fill under which playback is paused to buffer.
+   *
+   * Since: 2.2
+   */
+  pspec = g_param_spec_double ("buffering-low-watermark",
+                               "Buffering low watermark",
+                               "Buffer fill under which playback pauses",
+                               0.0, 1.0,
+                               DEFAULT_BUFFERING_LOW_WATERMARK,
+                               CLUTTER_GST_PARAM_READWRITE);
+  g_object_interface_install_property (iface, pspec);
+
+  /**
+   * ClutterGstPlayer:buffering-high-watermark:
+   *
+   * With %CLUTTER_GST_BUFFERING_MODE_STREAM, the value of
+   * #ClutterMedia:buffer-fill from which playback resumes after buffering.
+   *
+   * Since: 2.2
+   */
+  pspec = g_param_spec_double ("buffering-high-watermark",
+                               "Buffering high watermark",
+                               "Buffer fill from which playback resumes",
+                               0.0, 1.0,
+                               DEFAULT_BUFFERING_HIGH_WATERMARK,
+                               CLUTTER_GST_PARAM_READWRITE);
+  g_object_interface_install_property (iface, pspec);
+
+  /**
+   * ClutterGstPlayer:buffering-time-left:
+   *
+   * The estimated time, in seconds, before playback can resume when
+   * paused to buffer. 0.0 when not buffering, -1.0 if unknown.
+   *
+   * Since: 2.2
+   */
+  pspec = g_param_spec_double ("buffering-time-left",
+                               "Buffering time left",
+                               "Estimated time before playback resumes",
+                               -1.0, G_MAXDOUBLE, 0.0,
+                               CLUTTER_GST_PARAM_READABLE);
+  g_object_interface_install_property (iface, pspec);
+
+  /**
+   * ClutterGstPlayer:timeshift-size:
+   *
+   * The size, in bytes, of the buffer keeping the last data received from
+   * a live stream so that it can be paused and rewound. 0 disables
+   * timeshifting.
+   *
+   * Since: 2.2
+   */
+  pspec = g_param_spec_uint64 ("timeshift-size",
+                               "Timeshift size",
+                               "Size of the timeshift buffer in bytes "
+                               "(0 = disabled)",
+                               0, G_MAXUINT64, 0,
+                               CLUTTER_GST_PARAM_READWRITE);
+  g_object_interface_install_property (iface, pspec);
+
+  /**
+   * ClutterGstPlayer:use-media-cache:
+   *
+   * Whether media downloaded over HTTP are kept in, and played from, the
+   * media cache. See clutter_gst_player_set_use_media_cache().
+   *
+   * Since: 2.2
+   */
+  pspec = g_param_spec_boolean ("use-media-cache",
+                                "Use media cache",
+                                "Whether to keep downloaded media in the "
+                                "media cache",
+                                FALSE,
+                                CLUTTER_GST_PARAM_READWRITE);
+  g_object_interface_install_property (iface, pspec);
+
+  /**
+   * ClutterGstPlayer:memory-budget:
+   *
+   * The number of bytes the queues of the pipeline may hold, 0 for no
+   * limit. See clutter_gst_player_set_memory_budget().
+   *
+   * Since: 2.2
+   */
+  pspec = g_param_spec_uint64 ("memory-budget",
+                               "Memory budget",
+                               "Bytes the queues of the pipeline may hold "
+                               "(0 = no limit)",
+                               0, G_MAXUINT64, 0,
+                               CLUTTER_GST_PARAM_READWRITE);
+  g_object_interface_install_property (iface, pspec);
+
+  /**
+   * ClutterGstPlayer:shared-audio:
+   *
+   * Whether the audio is played through the output shared by all the
+   * players. See clutter_gst_player_set_shared_audio().
+   *
+   * Since: 2.2
+   */
+  pspec = g_param_spec_boolean ("shared-audio",
+                                "Shared audio",
+                                "Whether to use the shared audio output",
+                                FALSE,
+                                CLUTTER_GST_PARAM_READWRITE);
+  g_object_interface_install_property (iface, pspec);
+
+  /**
+   * ClutterGstPlayer:audio-enabled:
+   *
+   * Whether the audio streams are decoded and played.
+   *
+   * Since: 2.2
+   */
+  pspec = g_param_spec_boolean ("audio-enabled",
+                                "Audio enabled",
+                                "Whether the audio streams are played",
+                                TRUE,
+                                CLUTTER_GST_PARAM_READWRITE);
+  g_object_interface_install_property (iface, pspec);
+
+  /**
+   * ClutterGstPlayer:frame-cache-size:
+   *
+   * The number of decoded frames kept to step back through them. See
+   * clutter_gst_player_step_back().
+   *
+   * Since: 2.2
+   */
+  pspec = g_param_spec_uint ("frame-cache-size",
+                             "Frame cache size",
+                             "Decoded frames kept when stepping",
+                             1, G_MAXUINT, DEFAULT_FRAME_CACHE_SIZE,
+                             CLUTTER_GST_PARAM_READWRITE);
+  g_object_interface_install_property (iface, pspec);
+
+  /**
+   * ClutterGstPlayer:use-keyframe-index:
+   *
+   * Whether to index the key frames of local files to speed up accurate
+   * seeks. See clutter_gst_player_set_use_keyframe_index().
+   *
+   * Since: 2.2
+   */
+  pspec = g_param_spec_boolean ("use-keyframe-index",
+                                "Use key frame index",
+                                "Whether to index the key frames of local "
+                                "files",
+                                FALSE,
+                                CLUTTER_GST_PARAM_READWRITE);
+  g_object_interface_install_property (iface, pspec);
+
+  /**
+   * ClutterGstPlayer:native-video:
+   *
+   * Whether the decoders negotiate their output format with the video sink
+   * directly, without converters. Changes apply from the next media set on
+   * the player. See clutter_gst_player_set_native_video().
+   *
+   * Since: 2.2
+   */
+  pspec = g_param_spec_boolean ("native-video",
+                                "Native video",
+                                "Whether to render the output of the video "
+                                "decoders without converting it",
+                                FALSE,
+                                CLUTTER_GST_PARAM_READWRITE);
+  g_object_interface_install_property (iface, pspec);
+
+  /**
+   * ClutterGstPlayer:adapt-streams-to-size:
+   *
+   * Whether the variants of adaptive streams are capped to the size of the
+   * player on the stage. See clutter_gst_player_set_adapt_streams_to_size().
+   *
+   * Since: 2.2
+   */
+  pspec = g_param_spec_boolean ("adapt-streams-to-size",
+                                "Adapt streams to size",
+                                "Whether to cap the variants of adaptive "
+                                "streams to the size of the player",
+                                FALSE,
+                                CLUTTER_GST_PARAM_READWRITE);
+  g_object_interface_install_property (iface, pspec);
+
+  /**
+   * ClutterGstPlayer:throttle-hidden:
+   *
+   * Whether the video is skipped while the video texture is hidden. See
+   * clutter_gst_player_set_throttle_hidden().
+   *
+   * Since: 2.2
+   */
+  pspec = g_param_spec_boolean ("throttle-hidden",
+                                "Throttle hidden",
+                                "Whether to skip the video while the video "
+                                "texture is hidden",
+                                FALSE,
+                                CLUTTER_GST_PARAM_READWRITE);
+  g_object_interface_install_property (iface, pspec);
+
+  /**
+   * ClutterGstPlayer:hidden-grace-period:
+   *
+   * How long, in milliseconds, the video texture has to be hidden before
+   * video decoding is disabled. See clutter_gst_player_set_throttle_hidden().
+   *
+   * Since: 2.2
+   */
+  pspec = g_param_spec_uint ("hidden-grace-period",
+                             "Hidden grace period",
+                             "How long the video texture has to be hidden "
+                             "before video decoding is disabled (in ms)",
+                             0, G_MAXUINT, DEFAULT_HIDDEN_GRACE_PERIOD,
+                             CLUTTER_GST_PARAM_READWRITE);
+  g_object_interface_install_property (iface, pspec);
+
+
+  /* Signals */
+
+  /**
+   * ClutterGstPlayer::download-buffering:
+   * @player: the #ClutterGstPlayer instance that received the signal
+   * @start: start position of the buffering
+   * @stop: start position of the buffering
+   *
+   * The ::download-buffering signal is emitted each time their an
+   * update about the buffering of the current media.
+   *
+   * @start and @stop delimit the downloaded range the playback position is
+   * in. Use clutter_gst_player_get_buffered_range() to get all the
+   * downloaded ranges.
+   *
+   * Since: 1.4
+   */
+  signals[DOWNLOAD_BUFFERING] =
+    g_signal_new ("download-buffering",
+                  CLUTTER_GST_TYPE_PLAYER,
+                  G_SIGNAL_RUN_LAST,
+                  G_STRUCT_OFFSET (ClutterGstPlayerIface,
+                                   download_buffering),
+                  NULL, NULL,
+                  _clutter_gst_marshal_VOID__DOUBLE_DOUBLE,
+                  G_TYPE_NONE, 2, G_TYPE_DOUBLE, G_TYPE_DOUBLE);
+
+  /**
+   * ClutterGstPlayer::uri-loaded:
+   * @player: the #ClutterGstPlayer instance that received the signal
+   * @success: whether the pipeline could be brought to the target state
+   *
+   * The ::uri-loaded signal is emitted when a URI change, done with
+   * #ClutterGstPlayer:async-state-changes enabled, has been applied to the
+   * pipeline.
+   *
+   * Since: 2.2
+   */
+  signals[URI_LOADED] =
+    g_signal_new ("uri-loaded",
+                  CLUTTER_GST_TYPE_PLAYER,
+                  G_SIGNAL_RUN_LAST,
+                  G_STRUCT_OFFSET (ClutterGstPlayerIface,
+                                   uri_loaded),
+                  NULL, NULL,
+                  _clutter_gst_marshal_VOID__BOOLEAN,
+                  G_TYPE_NONE, 1, G_TYPE_BOOLEAN);
+
+  /* Setup a quark for per instance private data */
+  if (!clutter_gst_player_private_quark)
+    {
+      clutter_gst_player_private_quark =
+        g_quark_from_static_string ("clutter-gst-player-private-quark");
+      clutter_gst_player_class_quark =
+        g_quark_from_static_string ("clutter-gst-player-class-quark");
+    }
+}
+
+/* ClutterGstIface */
+
+/**
+ * clutter_gst_player_get_pipeline:
+ * @player: a #ClutterGstPlayer
+ *
+ * Retrieves the #GstPipeline used by the @player, for direct use with
+ * GStreamer API.
+ *
+ * Return value: (transfer none): the #GstPipeline element used by the player
+ *
+ * Since: 1.4
+ */
+GstElement *
+clutter_gst_player_get_pipeline (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player), NULL);
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  return iface->get_pipeline (player);
+}
+
+/**
+ * clutter_gst_player_get_user_agent:
+ * @player: a #ClutterGstPlayer
+ *
+ * Retrieves the user agent used when streaming.
+ *
+ * Return value: the user agent used. The returned string has to be freed with
+ * g_free()
+ *
+ * Since: 1.4
+ */
+gchar *
+clutter_gst_player_get_user_agent (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player), NULL);
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  return iface->get_user_agent (player);
+}
+
+/**
+ * clutter_gst_player_set_user_agent:
+ * @player: a #ClutterGstPlayer
+ * @user_agent: the user agent
+ *
+ * Sets the user agent to use when streaming.
+ *
+ * When streaming content, you might want to set a custom user agent, eg. to
+ * promote your software, make it appear in statistics or because the server
+ * requires a special user agent you want to impersonate.
+ *
+ * Since: 1.4
+ */
+void
+clutter_gst_player_set_user_agent (ClutterGstPlayer *player,
+                                   const gchar      *user_agent)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_if_fail (CLUTTER_GST_IS_PLAYER (player));
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  iface->set_user_agent (player, user_agent);
+}
+
+/**
+ * clutter_gst_player_get_seek_flags:
+ * @player: a #ClutterGstPlayer
+ *
+ * Get the current value of the seek-flags property.
+ *
+ * Return value: a combination of #ClutterGstSeekFlags
+ *
+ * Since: 1.4
+ */
+ClutterGstSeekFlags
+clutter_gst_player_get_seek_flags (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player),
+                        CLUTTER_GST_SEEK_FLAG_NONE);
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  return iface->get_seek_flags (player);
+}
+
+/**
+ * clutter_gst_player_set_seek_flags:
+ * @player: a #ClutterGstPlayer
+ * @flags: a combination of #ClutterGstSeekFlags
+ *
+ * Seeking can be done with several trade-offs. Clutter-gst defaults
+ * to %CLUTTER_GST_SEEK_FLAG_NONE.
+ *
+ * Since: 1.4
+ */
+void
+clutter_gst_player_set_seek_flags (ClutterGstPlayer    *player,
+                                   ClutterGstSeekFlags  flags)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_if_fail (CLUTTER_GST_IS_PLAYER (player));
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  iface->set_seek_flags (player, flags);
+}
+
+/**
+ * clutter_gst_player_get_buffering_mode:
+ * @player: a #ClutterGstPlayer
+ *
+ * Return value: a #ClutterGstBufferingMode
+ *
+ * Since: 1.4
+ */
+ClutterGstBufferingMode
+clutter_gst_player_get_buffering_mode (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player),
+                        CLUTTER_GST_BUFFERING_MODE_STREAM);
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  return iface->get_buffering_mode (player);
+}
+
+/**
+ * clutter_gst_player_set_buffering_mode:
+ * @player: a #ClutterGstPlayer
+ * @mode: a #ClutterGstBufferingMode
+ *
+ * Since: 1.4
+ */
+void
+clutter_gst_player_set_buffering_mode (ClutterGstPlayer        *player,
+                                       ClutterGstBufferingMode  mode)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_if_fail (CLUTTER_GST_IS_PLAYER (player));
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  iface->set_buffering_mode (player, mode);
+}
+
+/**
+ * clutter_gst_player_get_audio_streams:
+ * @player: a #ClutterGstPlayer
+ *
+ * Get the list of audio streams of the current media.
+ *
+ * Return value: (transfer none) (element-type utf8): a list of
+ * strings describing the available audio streams
+ *
+ * Since: 1.4
+ */
+GList *
+clutter_gst_player_get_audio_streams (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player), NULL);
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  return iface->get_audio_streams (player);
+}
+
+/**
+ * clutter_gst_player_get_audio_stream:
+ * @player: a #ClutterGstPlayer
+ *
+ * Get the current audio stream. The number returned in the index of the
+ * audio stream playing in the list returned by
+ * clutter_gst_player_get_audio_streams().
+ *
+ * Return value: the index of the current audio stream, -1 if the media has no
+ * audio stream
+ *
+ * Since: 1.4
+ */
+gint
+clutter_gst_player_get_audio_stream (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player), -1);
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  return iface->get_audio_stream (player);
+}
+
+/**
+ * clutter_gst_player_set_audio_stream:
+ * @player: a #ClutterGstPlayer
+ * @index_: the index of the audio stream
+ *
+ * Set the audio stream to play. @index_ is the index of the stream
+ * in the list returned by clutter_gst_player_get_audio_streams().
+ *
+ * Since: 1.4
+ */
+void
+clutter_gst_player_set_audio_stream (ClutterGstPlayer *player,
+                                     gint              index_)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_if_fail (CLUTTER_GST_IS_PLAYER (player));
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  iface->set_audio_stream (player, index_);
+}
+
+/**
+ * clutter_gst_player_get_subtitle_tracks:
+ * @player: a #ClutterGstPlayer
+ *
+ * Get the list of subtitles tracks of the current media.
+ *
+ * Return value: (transfer none) (element-type utf8): a list of
+ * strings describing the available subtitles tracks
+ *
+ * Since: 1.4
+ */
+GList *
+clutter_gst_player_get_subtitle_tracks (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player), NULL);
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  return iface->get_subtitle_tracks (player);
+}
+
+/**
+ * clutter_gst_player_get_subtitle_track:
+ * @player: a #ClutterGstPlayer
+ *
+ * Get the current subtitles track. The number returned is the index of the
+ * subtiles track in the list returned by
+ * clutter_gst_player_get_subtitle_tracks().
+ *
+ * Return value: the index of the current subtitlest track, -1 if the media has
+ * no subtitles track or if the subtitles have been turned off
+ *
+ * Since: 1.4
+ */
+gint
+clutter_gst_player_get_subtitle_track (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player), -1);
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  return iface->get_subtitle_track (player);
+}
+
+/**
+ * clutter_gst_player_set_subtitle_track:
+ * @player: a #ClutterGstPlayer
+ * @index_: the index of the subtitles track
+ *
+ * Set the subtitles track to play. @index_ is the index of the stream
+ * in the list returned by clutter_gst_player_get_subtitle_tracks().
+ *
+ * If @index_ is -1, the subtitles are turned off.
+ *
+ * Since: 1.4
+ */
+void
+clutter_gst_player_set_subtitle_track (ClutterGstPlayer *player,
+                                       gint              index_)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_if_fail (CLUTTER_GST_IS_PLAYER (player));
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  iface->set_subtitle_track (player, index_);
+}
+
+/**
+ * clutter_gst_player_get_idle:
+ * @player: a #ClutterGstPlayer
+ *
+ * Get the idle state of the pipeline.
+ *
+ * Return value: TRUE if the pipline is in idle mode, FALSE otherwise.
+ *
+ * Since: 1.4
+ */
+gboolean
+clutter_gst_player_get_idle (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player), TRUE);
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  return iface->get_idle (player);
+}
+
+/**
+ * clutter_gst_player_get_in_seek:
+ * @player: a #ClutterGstPlayer
+ *
+ * Whether the player is seeking.
+ *
+ * Return value: TRUE if the player is seeking, FALSE otherwise.
+ *
+ * Since: 1.6
+ */
+gboolean
+clutter_gst_player_get_in_seek (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player), FALSE);
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  return iface->get_in_seek (player);
+}
+
+/**
+ * clutter_gst_player_get_loop:
+ * @player: a #ClutterGstPlayer
+ *
+ * Whether the @player plays its media in a loop.
+ *
+ * Return value: TRUE if looping is enabled, FALSE otherwise.
+ *
+ * Since: 2.2
+ */
+gboolean
+clutter_gst_player_get_loop (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player), FALSE);
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  return iface->get_loop (player);
+}
+
+/**
+ * clutter_gst_player_set_loop:
+ * @player: a #ClutterGstPlayer
+ * @loop: whether to play the media in a loop
+ *
+ * Plays the media (or the segment set with
+ * clutter_gst_player_set_loop_segment()) in a loop. Contrary to restarting
+ * the playback from a #ClutterMedia::eos handler, the pipeline stays in the
+ * PLAYING state and the transition between the end and the start of the
+ * loop is seamless.
+ *
+ * Since: 2.2
+ */
+void
+clutter_gst_player_set_loop (ClutterGstPlayer *player,
+                             gboolean          loop)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_if_fail (CLUTTER_GST_IS_PLAYER (player));
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  iface->set_loop (player, loop);
+}
+
+/**
+ * clutter_gst_player_get_loop_segment:
+ * @player: a #ClutterGstPlayer
+ * @start: (out) (allow-none): return location for the start of the loop
+ * @stop: (out) (allow-none): return location for the end of the loop
+ *
+ * Retrieves the segment played when #ClutterGstPlayer:loop is enabled, in
+ * seconds. @stop is negative when looping until the end of the media.
+ *
+ * Since: 2.2
+ */
+void
+clutter_gst_player_get_loop_segment (ClutterGstPlayer *player,
+                                     gdouble          *start,
+                                     gdouble          *stop)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_if_fail (CLUTTER_GST_IS_PLAYER (player));
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  iface->get_loop_segment (player, start, stop);
+}
+
+/**
+ * clutter_gst_player_set_loop_segment:
+ * @player: a #ClutterGstPlayer
+ * @start: start of the loop, in seconds
+ * @stop: end of the loop, in seconds, or a negative value to loop until the
+ *   end of the media
+ *
+ * Restricts looping to the [@start, @stop] segment of the media (A-B
+ * repeat). The segment is only used when #ClutterGstPlayer:loop is enabled.
+ *
+ * Since: 2.2
+ */
+void
+clutter_gst_player_set_loop_segment (ClutterGstPlayer *player,
+                                     gdouble           start,
+                                     gdouble           stop)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_if_fail (CLUTTER_GST_IS_PLAYER (player));
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  iface->set_loop_segment (player, start, stop);
+}
+
+/**
+ * clutter_gst_player_enqueue_uri:
+ * @player: a #ClutterGstPlayer
+ * @uri: the URI of the media to play after the queued ones
+ *
+ * Appends @uri to the list of media to play after the current one.
+ *
+ * Queued media are played without gap: the next item is given to the
+ * pipeline while the end of the current one is still playing, so it's
+ * ready when the current item ends. The sinks are kept across items. When
+ * the player switches to the next item, the #ClutterMedia:uri property is
+ * updated and notified.
+ *
+ * Queued media are not played while #ClutterGstPlayer:loop is enabled.
+ *
+ * Since: 2.2
+ */
+void
+clutter_gst_player_enqueue_uri (ClutterGstPlayer *player,
+                                const gchar      *uri)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_if_fail (CLUTTER_GST_IS_PLAYER (player));
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  iface->enqueue_uri (player, uri);
+}
+
+/**
+ * clutter_gst_player_clear_queue:
+ * @player: a #ClutterGstPlayer
+ *
+ * Removes all the media queued with clutter_gst_player_enqueue_uri(). The
+ * current media is not affected.
+ *
+ * Since: 2.2
+ */
+void
+clutter_gst_player_clear_queue (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_if_fail (CLUTTER_GST_IS_PLAYER (player));
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  iface->clear_queue (player);
+}
+
+/**
+ * clutter_gst_player_get_queue_length:
+ * @player: a #ClutterGstPlayer
+ *
+ * Retrieves the number of media queued after the current one.
+ *
+ * Return value: the number of queued URIs
+ *
+ * Since: 2.2
+ */
+guint
+clutter_gst_player_get_queue_length (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player), 0);
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  return iface->get_queue_length (player);
+}
+
+/**
+ * clutter_gst_player_get_standby_count:
+ * @player: a #ClutterGstPlayer
+ *
+ * Retrieves the maximum number of pipelines @player keeps pre-rolled.
+ *
+ * Return value: the maximum number of standby pipelines
+ *
+ * Since: 2.2
+ */
+guint
+clutter_gst_player_get_standby_count (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player), 0);
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  return iface->get_standby_count (player);
+}
+
+/**
+ * clutter_gst_player_set_standby_count:
+ * @player: a #ClutterGstPlayer
+ * @count: the maximum number of standby pipelines
+ *
+ * Sets the maximum number of pipelines @player keeps pre-rolled with
+ * clutter_gst_player_preroll_uri(). Each standby pipeline holds its own
+ * decoders and buffers, so this should be kept small. The default, 0,
+ * disables pre-rolling.
+ *
+ * Since: 2.2
+ */
+void
+clutter_gst_player_set_standby_count (ClutterGstPlayer *player,
+                                      guint             count)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_if_fail (CLUTTER_GST_IS_PLAYER (player));
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  iface->set_standby_count (player, count);
+}
+
+/**
+ * clutter_gst_player_preroll_uri:
+ * @player: a #ClutterGstPlayer
+ * @uri: the URI of a media likely to be played next
+ *
+ * Prepares a standby pipeline for @uri and brings it to the PAUSED state,
+ * alongside the pipeline currently playing. If @uri is then given to
+ * clutter_media_set_uri(), the player swaps pipelines instead of
+ * re-creating the elements, typefinding and pre-rolling the media, which
+ * makes switching between a few known URIs (eg. channels) almost instant.
+ *
+ * At most clutter_gst_player_get_standby_count() pipelines are kept, the
+ * least recently pre-rolled ones being dropped first. Note that swapping
+ * pipelines changes the pipeline returned by clutter_gst_player_get_pipeline().
+ *
+ * Since: 2.2
+ */
+void
+clutter_gst_player_preroll_uri (ClutterGstPlayer *player,
+                                const gchar      *uri)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_if_fail (CLUTTER_GST_IS_PLAYER (player));
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  iface->preroll_uri (player, uri);
+}
+
+/**
+ * clutter_gst_player_get_async_state_changes:
+ * @player: a #ClutterGstPlayer
+ *
+ * Whether the state changes of the pipeline are done from a worker thread.
+ *
+ * Return value: TRUE if asynchronous state changes are enabled
+ *
+ * Since: 2.2
+ */
+gboolean
+clutter_gst_player_get_async_state_changes (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player), FALSE);
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  return iface->get_async_state_changes (player);
+}
+
+/**
+ * clutter_gst_player_set_async_state_changes:
+ * @player: a #ClutterGstPlayer
+ * @async_state_changes: whether to change the state of the pipeline
+ *   from a worker thread
+ *
+ * Bringing a pipeline to the NULL state, eg. when changing the URI or
+ * disposing of the player, joins the streaming threads and closes network
+ * connections and devices. This can block the caller, usually the Clutter
+ * thread, for hundreds of milliseconds.
+ *
+ * With asynchronous state changes, URI changes, clutter_media_set_playing()
+ * and the disposal of the pipeline are done, in order, by a worker thread.
+ * #ClutterGstPlayer::uri-loaded is emitted once a new URI has been applied.
+ *
+ * Since: 2.2
+ */
+void
+clutter_gst_player_set_async_state_changes (ClutterGstPlayer *player,
+                                            gboolean          async_state_changes)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_if_fail (CLUTTER_GST_IS_PLAYER (player));
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  iface->set_async_state_changes (player, async_state_changes);
+}
+
+/**
+ * clutter_gst_player_get_buffering_target:
+ * @player: a #ClutterGstPlayer
+ *
+ * Gets the amount of media to download before playing, see
+ * clutter_gst_player_set_buffering_target().
+ *
+ * Return value: the buffering target, in seconds
+ *
+ * Since: 2.2
+ */
+gdouble
+clutter_gst_player_get_buffering_target (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player), 0.0);
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  return iface->get_buffering_target (player);
+}
+
+/**
+ * clutter_gst_player_set_buffering_target:
+ * @player: a #ClutterGstPlayer
+ * @seconds: the amount of media to download before playing, in seconds
+ *
+ * With %CLUTTER_GST_BUFFERING_MODE_DOWNLOAD, the media is paused until
+ * @seconds of media after the playback position have been downloaded, or
+ * until the end of the media is there. #ClutterMedia:buffer-fill tells how
+ * much of that target is available.
+ *
+ * Seeking into a part of the media that's already downloaded resumes
+ * playback right away if the downloaded range goes far enough.
+ *
+ * Since: 2.2
+ */
+void
+clutter_gst_player_set_buffering_target (ClutterGstPlayer *player,
+                                         gdouble           seconds)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_if_fail (CLUTTER_GST_IS_PLAYER (player));
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  iface->set_buffering_target (player, seconds);
+}
+
+/**
+ * clutter_gst_player_get_n_buffered_ranges:
+ * @player: a #ClutterGstPlayer
+ *
+ * Gets the number of ranges of the current media that have been
+ * downloaded, with %CLUTTER_GST_BUFFERING_MODE_DOWNLOAD.
+ * #ClutterGstPlayer::download-buffering is emitted when they change.
+ *
+ * Return value: the number of downloaded ranges
+ *
+ * Since: 2.2
+ */
+guint
+clutter_gst_player_get_n_buffered_ranges (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player), 0);
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  return iface->get_n_buffered_ranges (player);
+}
+
+/**
+ * clutter_gst_player_get_buffered_range:
+ * @player: a #ClutterGstPlayer
+ * @index_: the index of the range, between 0 and the value returned by
+ *   clutter_gst_player_get_n_buffered_ranges()
+ * @start: (out) (allow-none): return location for the start of the range
+ * @stop: (out) (allow-none): return location for the end of the range
+ *
+ * Gets a range of the current media that has been downloaded. @start and
+ * @stop are fractions of the duration of the media, between 0.0 and 1.0.
+ *
+ * Return value: TRUE if @index_ is a valid range
+ *
+ * Since: 2.2
+ */
+gboolean
+clutter_gst_player_get_buffered_range (ClutterGstPlayer *player,
+                                       guint             index_,
+                                       gdouble          *start,
+                                       gdouble          *stop)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player), FALSE);
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  return iface->get_buffered_range (player, index_, start, stop);
+}
+
+/**
+ * clutter_gst_player_get_buffering_watermarks:
+ * @player: a #ClutterGstPlayer
+ * @low: (out) (allow-none): return location for the low watermark
+ * @high: (out) (allow-none): return location for the high watermark
+ *
+ * Gets the thresholds used to pause and resume playback, see
+ * clutter_gst_player_set_buffering_watermarks().
+ *
+ * Since: 2.2
+ */
+void
+clutter_gst_player_get_buffering_watermarks (ClutterGstPlayer *player,
+                                             gdouble          *low,
+                                             gdouble          *high)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_if_fail (CLUTTER_GST_IS_PLAYER (player));
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  iface->get_buffering_watermarks (player, low, high);
+}
+
+/**
+ * clutter_gst_player_set_buffering_watermarks:
+ * @player: a #ClutterGstPlayer
+ * @low: the buffer fill under which playback pauses
+ * @high: the buffer fill from which playback resumes
+ *
+ * With %CLUTTER_GST_BUFFERING_MODE_STREAM, playback is paused when
+ * #ClutterMedia:buffer-fill falls under @low and resumes when it reaches
+ * @high. Playback also resumes from @low when the data comes in faster
+ * than it's played, as measured by GStreamer.
+ *
+ * The gap between the two values keeps a link that's only just fast
+ * enough from pausing and resuming the media all the time.
+ *
+ * Since: 2.2
+ */
+void
+clutter_gst_player_set_buffering_watermarks (ClutterGstPlayer *player,
+                                             gdouble           low,
+                                             gdouble           high)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_if_fail (CLUTTER_GST_IS_PLAYER (player));
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  iface->set_buffering_watermarks (player, low, high);
+}
+
+/**
+ * clutter_gst_player_get_buffering_time_left:
+ * @player: a #ClutterGstPlayer
+ *
+ * Gets the estimated time before playback resumes, when paused to buffer
+ * in %CLUTTER_GST_BUFFERING_MODE_STREAM. The estimation is based on the
+ * rate at which the data currently comes in.
+ *
+ * Return value: the time left in seconds, 0.0 when not buffering or -1.0
+ *   if unknown
+ *
+ * Since: 2.2
+ */
+gdouble
+clutter_gst_player_get_buffering_time_left (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player), 0.0);
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  return iface->get_buffering_time_left (player);
+}
+
+/**
+ * clutter_gst_player_get_timeshift_size:
+ * @player: a #ClutterGstPlayer
+ *
+ * Gets the size of the timeshift buffer, see
+ * clutter_gst_player_set_timeshift_size().
+ *
+ * Return value: the size of the timeshift buffer in bytes, 0 if
+ *   timeshifting is disabled
+ *
+ * Since: 2.2
+ */
+guint64
+clutter_gst_player_get_timeshift_size (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player), 0);
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  return iface->get_timeshift_size (player);
+}
+
+/**
+ * clutter_gst_player_set_timeshift_size:
+ * @player: a #ClutterGstPlayer
+ * @size: the size of the timeshift buffer in bytes, or 0 to disable
+ *   timeshifting
+ *
+ * Keeps up to @size bytes of the data received from a network stream in a
+ * ring buffer, in the queue between the source and the demuxer. Seeking
+ * back within the buffer doesn't need the server.
+ *
+ * When a live stream is paused, its source keeps receiving into the ring
+ * buffer instead of dropping the stream, and playback resumes from where
+ * it was paused. This lasts until the buffer is full.
+ *
+ * The buffer is kept in memory, and its size bounds the memory used
+ * however long the media is paused. The buffering messages of such streams
+ * are handled like in %CLUTTER_GST_BUFFERING_MODE_STREAM.
+ *
+ * The new size is used from the next call to clutter_media_set_uri().
+ *
+ * Since: 2.2
+ */
+void
+clutter_gst_player_set_timeshift_size (ClutterGstPlayer *player,
+                                       guint64           size)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_if_fail (CLUTTER_GST_IS_PLAYER (player));
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  iface->set_timeshift_size (player, size);
+}
+
+/**
+ * clutter_gst_player_get_use_media_cache:
+ * @player: a #ClutterGstPlayer
+ *
+ * Whether @player uses the media cache.
+ *
+ * Return value: TRUE if the media cache is used
+ *
+ * Since: 2.2
+ */
+gboolean
+clutter_gst_player_get_use_media_cache (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player), FALSE);
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  return iface->get_use_media_cache (player);
+}
+
+/**
+ * clutter_gst_player_set_use_media_cache:
+ * @player: a #ClutterGstPlayer
+ * @use_media_cache: whether to use the media cache
+ *
+ * With %CLUTTER_GST_BUFFERING_MODE_DOWNLOAD, media played over HTTP are
+ * downloaded to a file. When the media cache is used, that file is kept
+ * once completely downloaded and the next plays of the same URI, and the
+ * seeks in it, are served from the local copy.
+ *
+ * The cache is kept on disk across runs and shared by all the players of
+ * the process. Media are used without asking the server as long as it
+ * allows (Cache-Control max-age, one day if the server doesn't say), then
+ * only once the server confirms they have not changed. Media the server
+ * marks as no-cache are always confirmed first, and the ones marked as
+ * no-store are not kept. The least recently played media are evicted when
+ * the cache is full, see clutter_gst_player_set_media_cache_size().
+ *
+ * Since: 2.2
+ */
+void
+clutter_gst_player_set_use_media_cache (ClutterGstPlayer *player,
+                                        gboolean          use_media_cache)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_if_fail (CLUTTER_GST_IS_PLAYER (player));
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  iface->set_use_media_cache (player, use_media_cache);
+}
+
+/**
+ * clutter_gst_player_get_media_cache_dir:
+ *
+ * Gets the directory holding the media cache.
+ *
+ * Return value: (transfer full): the directory of the media cache. Use
+ *   g_free() to free the returned string
+ *
+ * Since: 2.2
+ */
+gchar *
+clutter_gst_player_get_media_cache_dir (void)
+{
+  return _clutter_gst_media_cache_get_dir ();
+}
+
+/**
+ * clutter_gst_player_set_media_cache_dir:
+ * @dir: a directory, or NULL to use the default one
+ *
+ * Sets the directory holding the media cache. It defaults to a
+ * clutter-gst/media directory in the user cache directory.
+ *
+ * Since: 2.2
+ */
+void
+clutter_gst_player_set_media_cache_dir (const gchar *dir)
+{
+  _clutter_gst_media_cache_set_dir (dir);
+}
+
+/**
+ * clutter_gst_player_get_media_cache_size:
+ *
+ * Gets the maximum size of the media cache.
+ *
+ * Return value: the maximum size of the media cache in bytes
+ *
+ * Since: 2.2
+ */
+guint64
+clutter_gst_player_get_media_cache_size (void)
+{
+  return _clutter_gst_media_cache_get_max_size ();
+}
+
+/**
+ * clutter_gst_player_set_media_cache_size:
+ * @max_size: the maximum size of the media cache in bytes
+ *
+ * Sets the maximum size of the media cache, shared by all the players of
+ * the process. The least recently played media are evicted to stay under
+ * that size. Defaults to 1 GiB.
+ *
+ * Since: 2.2
+ */
+void
+clutter_gst_player_set_media_cache_size (guint64 max_size)
+{
+  _clutter_gst_media_cache_set_max_size (max_size);
+}
+
+/**
+ * clutter_gst_player_get_memory_budget:
+ * @player: a #ClutterGstPlayer
+ *
+ * Gets the memory budget of @player, see
+ * clutter_gst_player_set_memory_budget().
+ *
+ * Return value: the memory budget of @player in bytes, 0 if there's no
+ *   limit
+ *
+ * Since: 2.2
+ */
+guint64
+clutter_gst_player_get_memory_budget (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player), 0);
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  return iface->get_memory_budget (player);
+}
+
+/**
+ * clutter_gst_player_set_memory_budget:
+ * @player: a #ClutterGstPlayer
+ * @budget: the number of bytes the queues of the pipeline may hold, or 0
+ *   for no limit
+ *
+ * Bounds the data @player keeps queued. Half of @budget is given to the
+ * network buffer, the other half to the queues holding the demuxed
+ * streams. Without a budget, GStreamer's defaults let a single high
+ * definition stream hold tens of megabytes.
+ *
+ * Smaller budgets mean playback is more likely to stall on network hiccups
+ * or on media with poorly interleaved streams. Use
+ * clutter_gst_player_get_queued_bytes() to see what the queues actually
+ * hold.
+ *
+ * The budget is applied to the current media right away. When it's
+ * removed, the default limits come back with the next call to
+ * clutter_media_set_uri().
+ *
+ * Since: 2.2
+ */
+void
+clutter_gst_player_set_memory_budget (ClutterGstPlayer *player,
+                                      guint64           budget)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_if_fail (CLUTTER_GST_IS_PLAYER (player));
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  iface->set_memory_budget (player, budget);
+}
+
+/**
+ * clutter_gst_player_get_global_memory_budget:
+ *
+ * Gets the memory budget shared by all the players, see
+ * clutter_gst_player_set_global_memory_budget().
+ *
+ * Return value: the global memory budget in bytes, 0 if there's no limit
+ *
+ * Since: 2.2
+ */
+guint64
+clutter_gst_player_get_global_memory_budget (void)
+{
+  return global_memory_budget;
+}
+
+/**
+ * clutter_gst_player_set_global_memory_budget:
+ * @budget: the number of bytes the queues of all the players may hold, or
+ *   0 for no limit
+ *
+ * Bounds the data queued by all the players of the process. @budget is
+ * divided evenly among the players, and the share of each player is
+ * updated as players are created and destroyed. A player with a budget of
+ * its own, see clutter_gst_player_set_memory_budget(), uses the smallest
+ * of both.
+ *
+ * Since: 2.2
+ */
+void
+clutter_gst_player_set_global_memory_budget (guint64 budget)
+{
+  global_memory_budget = budget;
+
+  update_global_memory_budget ();
+}
+
+/**
+ * clutter_gst_player_get_queued_bytes:
+ * @player: a #ClutterGstPlayer
+ *
+ * Gets the number of bytes currently held in memory by the queues of the
+ * pipeline of @player. Media downloaded to a file with
+ * %CLUTTER_GST_BUFFERING_MODE_DOWNLOAD don't count.
+ *
+ * Return value: the number of bytes queued
+ *
+ * Since: 2.2
+ */
+guint64
+clutter_gst_player_get_queued_bytes (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player), 0);
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  return iface->get_queued_bytes (player);
+}
+
+/**
+ * clutter_gst_player_get_total_queued_bytes:
+ *
+ * Gets the number of bytes currently held in memory by the queues of all
+ * the players of the process, see clutter_gst_player_get_queued_bytes().
+ *
+ * Return value: the number of bytes queued
+ *
+ * Since: 2.2
+ */
+guint64
+clutter_gst_player_get_total_queued_bytes (void)
+{
+  guint64 total = 0;
+  GList *l;
+
+  for (l = players; l; l = l->next)
+    total += player_get_queued_bytes (PLAYER_GET_PRIVATE (l->data));
+
+  return total;
+}
+
+/**
+ * clutter_gst_player_get_shared_bus_dispatch:
+ *
+ * Whether the players created from now on use the shared bus dispatcher,
+ * see clutter_gst_player_set_shared_bus_dispatch().
+ *
+ * Return value: TRUE if the shared bus dispatcher is used
+ *
+ * Since: 2.2
+ */
+gboolean
+clutter_gst_player_get_shared_bus_dispatch (void)
+{
+  return use_shared_bus_dispatch;
+}
+
+/**
+ * clutter_gst_player_set_shared_bus_dispatch:
+ * @shared: whether to use the shared bus dispatcher
+ *
+ * By default, each player watches the bus of its pipeline with a main loop
+ * source of its own, and the cost of each main loop iteration grows with
+ * the number of players. When @shared is TRUE, the players created from
+ * now on hand the messages of their bus to a single source, shared by all
+ * of them, instead.
+ *
+ * The messages are filtered before they reach the main thread. Only the
+ * messages the player uses are emitted with the #GstBus::message signal,
+ * the others are dropped. Applications relying on other messages of the
+ * bus of clutter_gst_player_get_pipeline() shouldn't enable the shared
+ * dispatcher.
+ *
+ * Players already created keep their own source.
+ *
+ * Since: 2.2
+ */
+void
+clutter_gst_player_set_shared_bus_dispatch (gboolean shared)
+{
+  use_shared_bus_dispatch = !!shared;
+}
+
+/**
+ * clutter_gst_player_get_shared_audio:
+ * @player: a #ClutterGstPlayer
+ *
+ * Whether @player uses the shared audio output.
+ *
+ * Return value: TRUE if the shared audio output is used
+ *
+ * Since: 2.2
+ */
+gboolean
+clutter_gst_player_get_shared_audio (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerIface *iface;
 
+  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player), FALSE);
 
-  /**
-   * ClutterGstPlayer:in-seek:
-   *
-   * Whether or not the stream is being seeked.
-   *
-   * Since: 1.6
-   */
-  pspec = g_param_spec_boolean ("in-seek",
-                                "In seek mode",
-                                "If currently seeking",
-                                FALSE,
-                                CLUTTER_GST_PARAM_READABLE);
-  g_object_interface_install_property (iface, pspec);
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
 
+  return iface->get_shared_audio (player);
+}
 
-  /* Signals */
+/**
+ * clutter_gst_player_set_shared_audio:
+ * @player: a #ClutterGstPlayer
+ * @shared_audio: whether to use the shared audio output
+ *
+ * By default, each player opens an audio output of its own. The players
+ * using the shared audio output are mixed together and played with a
+ * single audio sink instead, see clutter_gst_player_set_shared_audio_sink().
+ *
+ * The audio of a player using the shared output isn't decoded at all while
+ * its #ClutterMedia:audio-volume is 0.
+ *
+ * The change is applied from the next call to clutter_media_set_uri(), the
+ * media already open keeps its audio output until then.
+ *
+ * Since: 2.2
+ */
+void
+clutter_gst_player_set_shared_audio (ClutterGstPlayer *player,
+                                     gboolean          shared_audio)
+{
+  ClutterGstPlayerIface *iface;
 
-  /**
-   * ClutterGstPlayer::download-buffering:
-   * @player: the #ClutterGstPlayer instance that received the signal
-   * @start: start position of the buffering
-   * @stop: start position of the buffering
-   *
-   * The ::download-buffering signal is emitted each time their an
-   * update about the buffering of the current media.
-   *
-   * Since: 1.4
-   */
-  signals[DOWNLOAD_BUFFERING] =
-    g_signal_new ("download-buffering",
-                  CLUTTER_GST_TYPE_PLAYER,
-                  G_SIGNAL_RUN_LAST,
-                  G_STRUCT_OFFSET (ClutterGstPlayerIface,
-                                   download_buffering),
-                  NULL, NULL,
-                  _clutter_gst_marshal_VOID__DOUBLE_DOUBLE,
-                  G_TYPE_NONE, 2, G_TYPE_DOUBLE, G_TYPE_DOUBLE);
+  g_return_if_fail (CLUTTER_GST_IS_PLAYER (player));
 
-  /* Setup a quark for per instance private data */
-  if (!clutter_gst_player_private_quark)
-    {
-      clutter_gst_player_private_quark =
-        g_quark_from_static_string ("clutter-gst-player-private-quark");
-      clutter_gst_player_class_quark =
-        g_quark_from_static_string ("clutter-gst-player-class-quark");
-    }
-}
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
 
-/* ClutterGstIface */
+  iface->set_shared_audio (player, shared_audio);
+}
 
 /**
- * clutter_gst_player_get_pipeline:
+ * clutter_gst_player_get_audio_enabled:
  * @player: a #ClutterGstPlayer
  *
- * Retrieves the #GstPipeline used by the @player, for direct use with
- * GStreamer API.
+ * Whether the audio streams of @player are decoded and played.
  *
- * Return value: (transfer none): the #GstPipeline element used by the player
+ * Return value: TRUE if audio is enabled
  *
- * Since: 1.4
+ * Since: 2.2
  */
-GstElement *
-clutter_gst_player_get_pipeline (ClutterGstPlayer *player)
+gboolean
+clutter_gst_player_get_audio_enabled (ClutterGstPlayer *player)
 {
   ClutterGstPlayerIface *iface;
 
-  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player), NULL);
+  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player), FALSE);
 
   iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
 
-  return iface->get_pipeline (player);
+  return iface->get_audio_enabled (player);
 }
 
 /**
- * clutter_gst_player_get_user_agent:
+ * clutter_gst_player_set_audio_enabled:
  * @player: a #ClutterGstPlayer
+ * @enabled: whether to decode and play the audio streams
  *
- * Retrieves the user agent used when streaming.
+ * Disabling audio is cheaper than muting: the audio streams aren't decoded
+ * at all. Use it for the players that can't be heard, the tiles of a video
+ * wall that don't have the focus for instance.
  *
- * Return value: the user agent used. The returned string has to be freed with
- * g_free()
+ * Since: 2.2
+ */
+void
+clutter_gst_player_set_audio_enabled (ClutterGstPlayer *player,
+                                      gboolean          enabled)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_if_fail (CLUTTER_GST_IS_PLAYER (player));
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  iface->set_audio_enabled (player, enabled);
+}
+
+/**
+ * clutter_gst_player_set_shared_audio_sink:
+ * @sink: (transfer floating) (allow-none): the sink playing the shared
+ *   audio output, or NULL to pick one automatically
  *
- * Since: 1.4
+ * Sets the sink playing the mix of the players using the shared audio
+ * output, see clutter_gst_player_set_shared_audio(). It can only be set
+ * before the first player starts using the shared output.
+ *
+ * Since: 2.2
  */
-gchar *
-clutter_gst_player_get_user_agent (ClutterGstPlayer *player)
+void
+clutter_gst_player_set_shared_audio_sink (GstElement *sink)
+{
+  g_return_if_fail (sink == NULL || GST_IS_ELEMENT (sink));
+
+  _clutter_gst_audio_mixer_set_output (sink);
+}
+
+/**
+ * clutter_gst_player_step_forward:
+ * @player: a #ClutterGstPlayer
+ *
+ * Shows the next frame of the video. If @player is playing, it is paused
+ * on the current frame instead.
+ *
+ * Stepping is asynchronous, #ClutterMedia:progress is notified once the
+ * frame is shown. Steps asked for while the previous one isn't done are
+ * ignored.
+ *
+ * Since: 2.2
+ */
+void
+clutter_gst_player_step_forward (ClutterGstPlayer *player)
 {
   ClutterGstPlayerIface *iface;
 
-  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player), NULL);
+  g_return_if_fail (CLUTTER_GST_IS_PLAYER (player));
 
   iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
 
-  return iface->get_user_agent (player);
+  iface->step_forward (player);
 }
 
 /**
- * clutter_gst_player_set_user_agent:
+ * clutter_gst_player_step_back:
  * @player: a #ClutterGstPlayer
- * @user_agent: the user agent
  *
- * Sets the user agent to use when streaming.
+ * Shows the previous frame of the video. If @player is playing, it is
+ * paused on the current frame instead.
  *
- * When streaming content, you might want to set a custom user agent, eg. to
- * promote your software, make it appear in statistics or because the server
- * requires a special user agent you want to impersonate.
+ * Frames can't be decoded backwards: stepping back decodes again the
+ * frames from the previous key frame, and keeps the last of them, see
+ * clutter_gst_player_set_frame_cache_size(). Stepping back again through
+ * them is then immediate, only one decoding pass is done per group of
+ * pictures as long as the cache is large enough.
  *
- * Since: 1.4
+ * Stepping is asynchronous, #ClutterMedia:progress is notified once the
+ * frame is shown. Steps asked for while the previous one isn't done are
+ * ignored.
+ *
+ * Since: 2.2
  */
 void
-clutter_gst_player_set_user_agent (ClutterGstPlayer *player,
-                                   const gchar      *user_agent)
+clutter_gst_player_step_back (ClutterGstPlayer *player)
 {
   ClutterGstPlayerIface *iface;
 
@@ -2366,45 +8821,46 @@ clutter_gst_player_set_user_agent (ClutterGstPlayer *player,
 
   iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
 
-  iface->set_user_agent (player, user_agent);
+  iface->step_back (player);
 }
 
 /**
- * clutter_gst_player_get_seek_flags:
+ * clutter_gst_player_get_frame_cache_size:
  * @player: a #ClutterGstPlayer
  *
- * Get the current value of the seek-flags property.
+ * Gets the number of decoded frames kept to step back through them.
  *
- * Return value: a combination of #ClutterGstSeekFlags
+ * Return value: the number of frames
  *
- * Since: 1.4
+ * Since: 2.2
  */
-ClutterGstSeekFlags
-clutter_gst_player_get_seek_flags (ClutterGstPlayer *player)
+guint
+clutter_gst_player_get_frame_cache_size (ClutterGstPlayer *player)
 {
   ClutterGstPlayerIface *iface;
 
-  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player),
-                        CLUTTER_GST_SEEK_FLAG_NONE);
+  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player), 0);
 
   iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
 
-  return iface->get_seek_flags (player);
+  return iface->get_frame_cache_size (player);
 }
 
 /**
- * clutter_gst_player_set_seek_flags:
+ * clutter_gst_player_set_frame_cache_size:
  * @player: a #ClutterGstPlayer
- * @flags: a combination of #ClutterGstSeekFlags
+ * @n_frames: the number of frames
  *
- * Seeking can be done with several trade-offs. Clutter-gst defaults
- * to %CLUTTER_GST_SEEK_FLAG_NONE.
+ * Sets the number of decoded frames kept to step back through them. It
+ * should be as large as the groups of pictures of the media for stepping
+ * back to decode them only once, but every frame is kept uncompressed: 16
+ * 1080p frames already take about 50 MB. Defaults to 16.
  *
- * Since: 1.4
+ * Since: 2.2
  */
 void
-clutter_gst_player_set_seek_flags (ClutterGstPlayer    *player,
-                                   ClutterGstSeekFlags  flags)
+clutter_gst_player_set_frame_cache_size (ClutterGstPlayer *player,
+                                         guint             n_frames)
 {
   ClutterGstPlayerIface *iface;
 
@@ -2412,40 +8868,51 @@ clutter_gst_player_set_seek_flags (ClutterGstPlayer    *player,
 
   iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
 
-  iface->set_seek_flags (player, flags);
+  iface->set_frame_cache_size (player, n_frames);
 }
 
 /**
- * clutter_gst_player_get_buffering_mode:
+ * clutter_gst_player_get_use_keyframe_index:
  * @player: a #ClutterGstPlayer
  *
- * Return value: a #ClutterGstBufferingMode
+ * Whether @player indexes the key frames of local files.
  *
- * Since: 1.4
+ * Return value: TRUE if key frames are indexed
+ *
+ * Since: 2.2
  */
-ClutterGstBufferingMode
-clutter_gst_player_get_buffering_mode (ClutterGstPlayer *player)
+gboolean
+clutter_gst_player_get_use_keyframe_index (ClutterGstPlayer *player)
 {
   ClutterGstPlayerIface *iface;
 
-  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player),
-                        CLUTTER_GST_BUFFERING_MODE_STREAM);
+  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player), FALSE);
 
   iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
 
-  return iface->get_buffering_mode (player);
+  return iface->get_use_keyframe_index (player);
 }
 
 /**
- * clutter_gst_player_set_buffering_mode:
+ * clutter_gst_player_set_use_keyframe_index:
  * @player: a #ClutterGstPlayer
- * @mode: a #ClutterGstBufferingMode
+ * @use_index: whether to index the key frames of local files
  *
- * Since: 1.4
+ * How fast accurate seeks are depends on the index of the container of
+ * the media, some demuxers scan the file to find the position. With
+ * @use_index, the key frames of local files are indexed in the background
+ * the first time they're played, and the index is kept in the user cache
+ * directory.
+ *
+ * Once the index is there, an accurate seek while paused goes to the key
+ * frame before the position and decodes forward from there, and
+ * clutter_gst_player_get_seek_cost() tells how much decoding a seek takes.
+ *
+ * Since: 2.2
  */
 void
-clutter_gst_player_set_buffering_mode (ClutterGstPlayer        *player,
-                                       ClutterGstBufferingMode  mode)
+clutter_gst_player_set_use_keyframe_index (ClutterGstPlayer *player,
+                                           gboolean          use_index)
 {
   ClutterGstPlayerIface *iface;
 
@@ -2453,70 +8920,84 @@ clutter_gst_player_set_buffering_mode (ClutterGstPlayer        *player,
 
   iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
 
-  iface->set_buffering_mode (player, mode);
+  iface->set_use_keyframe_index (player, use_index);
 }
 
 /**
- * clutter_gst_player_get_audio_streams:
+ * clutter_gst_player_get_seek_cost:
  * @player: a #ClutterGstPlayer
+ * @progress: a position in the media, as a fraction of its duration
  *
- * Get the list of audio streams of the current media.
+ * Tells how much media an accurate seek to @progress decodes before
+ * showing the frame, that is the distance from the previous key frame. It's
+ * only known once the key frames of the media are indexed, see
+ * clutter_gst_player_set_use_keyframe_index().
  *
- * Return value: (transfer none) (element-type utf8): a list of
- * strings describing the available audio streams
+ * Return value: the cost of the seek in seconds of media, or -1.0 if it's
+ *   not known
  *
- * Since: 1.4
+ * Since: 2.2
  */
-GList *
-clutter_gst_player_get_audio_streams (ClutterGstPlayer *player)
+gdouble
+clutter_gst_player_get_seek_cost (ClutterGstPlayer *player,
+                                  gdouble           progress)
 {
   ClutterGstPlayerIface *iface;
 
-  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player), NULL);
+  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player), -1.0);
 
   iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
 
-  return iface->get_audio_streams (player);
+  return iface->get_seek_cost (player, progress);
 }
 
 /**
- * clutter_gst_player_get_audio_stream:
+ * clutter_gst_player_get_native_video:
  * @player: a #ClutterGstPlayer
  *
- * Get the current audio stream. The number returned in the index of the
- * audio stream playing in the list returned by
- * clutter_gst_player_get_audio_streams().
+ * Whether @player renders the output of the video decoders without
+ * converting it.
  *
- * Return value: the index of the current audio stream, -1 if the media has no
- * audio stream
+ * Return value: TRUE if the native video mode is enabled
  *
- * Since: 1.4
+ * Since: 2.2
  */
-gint
-clutter_gst_player_get_audio_stream (ClutterGstPlayer *player)
+gboolean
+clutter_gst_player_get_native_video (ClutterGstPlayer *player)
 {
   ClutterGstPlayerIface *iface;
 
-  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player), -1);
+  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player), FALSE);
 
   iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
 
-  return iface->get_audio_stream (player);
+  return iface->get_native_video (player);
 }
 
 /**
- * clutter_gst_player_set_audio_stream:
+ * clutter_gst_player_set_native_video:
  * @player: a #ClutterGstPlayer
- * @index_: the index of the audio stream
+ * @native: whether to render the output of the video decoders without
+ *   converting it
  *
- * Set the audio stream to play. @index_ is the index of the stream
- * in the list returned by clutter_gst_player_get_audio_streams().
+ * By default, a color space converter and a scaler sit between the video
+ * decoder and the sink. Even when they have nothing to do, the frames go
+ * through them. In native video mode, the decoders negotiate one of the
+ * formats the renderers of the sink take, and the frames go straight to
+ * the sink.
  *
- * Since: 1.4
+ * When the renderers don't cover what the decoder outputs, the media is
+ * reopened with the converters, at the position it was, without an error
+ * being emitted. The next media tries the native mode again.
+ *
+ * The mode applies from the next media set on @player, the media already
+ * open keeps the decoders it negotiated with.
+ *
+ * Since: 2.2
  */
 void
-clutter_gst_player_set_audio_stream (ClutterGstPlayer *player,
-                                     gint              index_)
+clutter_gst_player_set_native_video (ClutterGstPlayer *player,
+                                     gboolean          native)
 {
   ClutterGstPlayerIface *iface;
 
@@ -2524,72 +9005,108 @@ clutter_gst_player_set_audio_stream (ClutterGstPlayer *player,
 
   iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
 
-  iface->set_audio_stream (player, index_);
+  iface->set_native_video (player, native);
 }
 
 /**
- * clutter_gst_player_get_subtitle_tracks:
+ * clutter_gst_player_get_adapt_streams_to_size:
  * @player: a #ClutterGstPlayer
  *
- * Get the list of subtitles tracks of the current media.
+ * Whether the variants of the adaptive streams played by @player are capped
+ * to its size on the stage.
  *
- * Return value: (transfer none) (element-type utf8): a list of
- * strings describing the available subtitles tracks
+ * Return value: TRUE if the variants are capped
  *
- * Since: 1.4
+ * Since: 2.2
  */
-GList *
-clutter_gst_player_get_subtitle_tracks (ClutterGstPlayer *player)
+gboolean
+clutter_gst_player_get_adapt_streams_to_size (ClutterGstPlayer *player)
 {
   ClutterGstPlayerIface *iface;
 
-  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player), NULL);
+  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player), FALSE);
 
   iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
 
-  return iface->get_subtitle_tracks (player);
+  return iface->get_adapt_streams_to_size (player);
 }
 
 /**
- * clutter_gst_player_get_subtitle_track:
+ * clutter_gst_player_set_adapt_streams_to_size:
  * @player: a #ClutterGstPlayer
+ * @adapt: whether to cap the variants of adaptive streams to the size of
+ *   @player
  *
- * Get the current subtitles track. The number returned is the index of the
- * subtiles track in the list returned by
- * clutter_gst_player_get_subtitle_tracks().
+ * The demuxers of adaptive streams, HLS or DASH, pick the variant they
+ * download from the available bandwidth only. With @adapt, they're told
+ * the size @player has on the stage, and don't pick variants larger than
+ * that. Demuxers that can't cap the resolution of the variants keep
+ * picking them from the bandwidth only. The cap follows the size of @player, once it has been
+ * stable for a little while, and is kept while @player is hidden.
  *
- * Return value: the index of the current subtitlest track, -1 if the media has
- * no subtitles track or if the subtitles have been turned off
+ * Only the players that are #ClutterActor<!-- -->s, like
+ * #ClutterGstVideoTexture, have a size on the stage.
  *
- * Since: 1.4
+ * Since: 2.2
  */
-gint
-clutter_gst_player_get_subtitle_track (ClutterGstPlayer *player)
+void
+clutter_gst_player_set_adapt_streams_to_size (ClutterGstPlayer *player,
+                                              gboolean          adapt)
 {
   ClutterGstPlayerIface *iface;
 
-  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player), -1);
+  g_return_if_fail (CLUTTER_GST_IS_PLAYER (player));
 
   iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
 
-  return iface->get_subtitle_track (player);
+  iface->set_adapt_streams_to_size (player, adapt);
 }
 
 /**
- * clutter_gst_player_set_subtitle_track:
+ * clutter_gst_player_get_throttle_hidden:
  * @player: a #ClutterGstPlayer
- * @index_: the index of the subtitles track
  *
- * Set the subtitles track to play. @index_ is the index of the stream
- * in the list returned by clutter_gst_player_get_subtitle_tracks().
+ * Whether @player skips the video while its video texture is hidden.
  *
- * If @index_ is -1, the subtitles are turned off.
+ * Return value: TRUE if the video is skipped while hidden
  *
- * Since: 1.4
+ * Since: 2.2
+ */
+gboolean
+clutter_gst_player_get_throttle_hidden (ClutterGstPlayer *player)
+{
+  ClutterGstPlayerIface *iface;
+
+  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player), FALSE);
+
+  iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
+
+  return iface->get_throttle_hidden (player);
+}
+
+/**
+ * clutter_gst_player_set_throttle_hidden:
+ * @player: a #ClutterGstPlayer
+ * @throttle: whether to skip the video while the video texture is hidden
+ *
+ * With @throttle, the video sink stops uploading frames when the video
+ * texture is hidden: not mapped, fully transparent, or not painted because
+ * it's out of the stage, culled, or the stage itself isn't painted. Soon
+ * after, upstream is asked for one frame per second only. Once the texture
+ * has been hidden for #ClutterGstPlayer:hidden-grace-period milliseconds,
+ * the video isn't decoded at all anymore. The audio keeps playing, and the
+ * video is decoded again, from the current position, when the texture is
+ * painted.
+ *
+ * Only the video sinks of Clutter-Gst can tell whether their texture is
+ * hidden. An actor covered by opaque actors is still painted by Clutter,
+ * so it's not considered hidden.
+ *
+ * Since: 2.2
  */
 void
-clutter_gst_player_set_subtitle_track (ClutterGstPlayer *player,
-                                       gint              index_)
+clutter_gst_player_set_throttle_hidden (ClutterGstPlayer *player,
+                                        gboolean          throttle)
 {
   ClutterGstPlayerIface *iface;
 
@@ -2597,49 +9114,54 @@ clutter_gst_player_set_subtitle_track (ClutterGstPlayer *player,
 
   iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
 
-  iface->set_subtitle_track (player, index_);
+  iface->set_throttle_hidden (player, throttle);
 }
 
 /**
- * clutter_gst_player_get_idle:
+ * clutter_gst_player_get_hidden_grace_period:
  * @player: a #ClutterGstPlayer
  *
- * Get the idle state of the pipeline.
+ * Retrieves how long the video texture of @player has to be hidden before
+ * video decoding is disabled.
  *
- * Return value: TRUE if the pipline is in idle mode, FALSE otherwise.
+ * Return value: the grace period, in milliseconds
  *
- * Since: 1.4
+ * Since: 2.2
  */
-gboolean
-clutter_gst_player_get_idle (ClutterGstPlayer *player)
+guint
+clutter_gst_player_get_hidden_grace_period (ClutterGstPlayer *player)
 {
   ClutterGstPlayerIface *iface;
 
-  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player), TRUE);
+  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player),
+                        DEFAULT_HIDDEN_GRACE_PERIOD);
 
   iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
 
-  return iface->get_idle (player);
+  return iface->get_hidden_grace_period (player);
 }
 
 /**
- * clutter_gst_player_get_in_seek:
+ * clutter_gst_player_set_hidden_grace_period:
  * @player: a #ClutterGstPlayer
+ * @grace_period: a duration, in milliseconds
  *
- * Whether the player is seeking.
- *
- * Return value: TRUE if the player is seeking, FALSE otherwise.
+ * Sets how long the video texture of @player has to be hidden before video
+ * decoding is disabled, when #ClutterGstPlayer:throttle-hidden is set.
+ * Decoding the video again means seeking, a longer grace period avoids it
+ * for textures that are hidden for a short while only.
  *
- * Since: 1.6
+ * Since: 2.2
  */
-gboolean
-clutter_gst_player_get_in_seek (ClutterGstPlayer *player)
+void
+clutter_gst_player_set_hidden_grace_period (ClutterGstPlayer *player,
+                                            guint             grace_period)
 {
   ClutterGstPlayerIface *iface;
 
-  g_return_val_if_fail (CLUTTER_GST_IS_PLAYER (player), FALSE);
+  g_return_if_fail (CLUTTER_GST_IS_PLAYER (player));
 
   iface = CLUTTER_GST_PLAYER_GET_INTERFACE (player);
 
-  return iface->get_in_seek (player);
+  iface->set_hidden_grace_period (player, grace_period);
 }
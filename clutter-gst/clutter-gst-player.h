@@ -69,6 +69,7 @@ typedef struct _ClutterGstPlayerIfacePrivate ClutterGstPlayerIfacePrivate;
  * ClutterGstPlayerIface:
  * @download_buffering: handler for the #ClutterGstPlayer::download-buffering
  * signal
+ * @uri_loaded: handler for the #ClutterGstPlayer::uri-loaded signal
  *
  * Interface vtable for #ClutterGstPlayer implementations
  *
@@ -135,7 +136,8 @@ struct _ClutterGstPlayerIface
   void (* download_buffering)  (ClutterGstPlayer *player,
                                 gdouble           start,
                                 gdouble           stop);
-  void (* _clutter_reserved2)  (void);
+  void (* uri_loaded)          (ClutterGstPlayer *player,
+                                gboolean          success);
   void (* _clutter_reserved3)  (void);
   void (* _clutter_reserved4)  (void);
   void (* _clutter_reserved5)  (void);
@@ -144,6 +146,94 @@ struct _ClutterGstPlayerIface
   void (* _clutter_reserved8)  (void);
   void (* _clutter_reserved9)  (void);
   void (* _clutter_reserved10) (void);
+
+  gboolean (* get_loop)         (ClutterGstPlayer *player);
+  void     (* set_loop)         (ClutterGstPlayer *player,
+                                 gboolean          loop);
+  void     (* get_loop_segment) (ClutterGstPlayer *player,
+                                 gdouble          *start,
+                                 gdouble          *stop);
+  void     (* set_loop_segment) (ClutterGstPlayer *player,
+                                 gdouble           start,
+                                 gdouble           stop);
+
+  void  (* enqueue_uri)      (ClutterGstPlayer *player,
+                              const gchar      *uri);
+  void  (* clear_queue)      (ClutterGstPlayer *player);
+  guint (* get_queue_length) (ClutterGstPlayer *player);
+
+  guint (* get_standby_count) (ClutterGstPlayer *player);
+  void  (* set_standby_count) (ClutterGstPlayer *player,
+                               guint             count);
+  void  (* preroll_uri)       (ClutterGstPlayer *player,
+                               const gchar      *uri);
+
+  gboolean (* get_async_state_changes) (ClutterGstPlayer *player);
+  void     (* set_async_state_changes) (ClutterGstPlayer *player,
+                                        gboolean          async_state_changes);
+
+  gdouble  (* get_buffering_target)     (ClutterGstPlayer *player);
+  void     (* set_buffering_target)     (ClutterGstPlayer *player,
+                                         gdouble           seconds);
+  guint    (* get_n_buffered_ranges)    (ClutterGstPlayer *player);
+  gboolean (* get_buffered_range)       (ClutterGstPlayer *player,
+                                         guint             index_,
+                                         gdouble          *start,
+                                         gdouble          *stop);
+  void     (* get_buffering_watermarks) (ClutterGstPlayer *player,
+                                         gdouble          *low,
+                                         gdouble          *high);
+  void     (* set_buffering_watermarks) (ClutterGstPlayer *player,
+                                         gdouble           low,
+                                         gdouble           high);
+  gdouble  (* get_buffering_time_left)  (ClutterGstPlayer *player);
+
+  guint64 (* get_timeshift_size) (ClutterGstPlayer *player);
+  void    (* set_timeshift_size) (ClutterGstPlayer *player,
+                                  guint64           size);
+
+  gboolean (* get_use_media_cache) (ClutterGstPlayer *player);
+  void     (* set_use_media_cache) (ClutterGstPlayer *player,
+                                    gboolean          use_media_cache);
+
+  guint64 (* get_memory_budget) (ClutterGstPlayer *player);
+  void    (* set_memory_budget) (ClutterGstPlayer *player,
+                                 guint64           budget);
+  guint64 (* get_queued_bytes)  (ClutterGstPlayer *player);
+
+  gboolean (* get_shared_audio)  (ClutterGstPlayer *player);
+  void     (* set_shared_audio)  (ClutterGstPlayer *player,
+                                  gboolean          shared_audio);
+  gboolean (* get_audio_enabled) (ClutterGstPlayer *player);
+  void     (* set_audio_enabled) (ClutterGstPlayer *player,
+                                  gboolean          enabled);
+
+  void  (* step_forward)         (ClutterGstPlayer *player);
+  void  (* step_back)            (ClutterGstPlayer *player);
+  guint (* get_frame_cache_size) (ClutterGstPlayer *player);
+  void  (* set_frame_cache_size) (ClutterGstPlayer *player,
+                                  guint             n_frames);
+
+  gboolean (* get_use_keyframe_index) (ClutterGstPlayer *player);
+  void     (* set_use_keyframe_index) (ClutterGstPlayer *player,
+                                       gboolean          use_index);
+  gdouble  (* get_seek_cost)          (ClutterGstPlayer *player,
+                                       gdouble           progress);
+
+  gboolean (* get_native_video) (ClutterGstPlayer *player);
+  void     (* set_native_video) (ClutterGstPlayer *player,
+                                 gboolean          native);
+
+  gboolean (* get_adapt_streams_to_size) (ClutterGstPlayer *player);
+  void     (* set_adapt_streams_to_size) (ClutterGstPlayer *player,
+                                          gboolean          adapt);
+
+  gboolean (* get_throttle_hidden)     (ClutterGstPlayer *player);
+  void     (* set_throttle_hidden)     (ClutterGstPlayer *player,
+                                        gboolean          throttle);
+  guint    (* get_hidden_grace_period) (ClutterGstPlayer *player);
+  void     (* set_hidden_grace_period) (ClutterGstPlayer *player,
+                                        guint             grace_period);
 };
 
 GType clutter_gst_player_get_type (void) G_GNUC_CONST;
@@ -181,6 +271,105 @@ gboolean                  clutter_gst_player_get_idle            (ClutterGstPlay
 
 gboolean                  clutter_gst_player_get_in_seek         (ClutterGstPlayer        *player);
 
+gboolean                  clutter_gst_player_get_loop            (ClutterGstPlayer        *player);
+void                      clutter_gst_player_set_loop            (ClutterGstPlayer        *player,
+                                                                  gboolean                 loop);
+void                      clutter_gst_player_get_loop_segment    (ClutterGstPlayer        *player,
+                                                                  gdouble                 *start,
+                                                                  gdouble                 *stop);
+void                      clutter_gst_player_set_loop_segment    (ClutterGstPlayer        *player,
+                                                                  gdouble                  start,
+                                                                  gdouble                  stop);
+
+void                      clutter_gst_player_enqueue_uri         (ClutterGstPlayer        *player,
+                                                                  const gchar             *uri);
+void                      clutter_gst_player_clear_queue         (ClutterGstPlayer        *player);
+guint                     clutter_gst_player_get_queue_length    (ClutterGstPlayer        *player);
+
+guint                     clutter_gst_player_get_standby_count   (ClutterGstPlayer        *player);
+void                      clutter_gst_player_set_standby_count   (ClutterGstPlayer        *player,
+                                                                  guint                    count);
+void                      clutter_gst_player_preroll_uri         (ClutterGstPlayer        *player,
+                                                                  const gchar             *uri);
+
+gboolean                  clutter_gst_player_get_async_state_changes (ClutterGstPlayer    *player);
+void                      clutter_gst_player_set_async_state_changes (ClutterGstPlayer    *player,
+                                                                      gboolean             async_state_changes);
+
+gdouble                   clutter_gst_player_get_buffering_target (ClutterGstPlayer   *player);
+void                      clutter_gst_player_set_buffering_target (ClutterGstPlayer   *player,
+                                                                   gdouble             seconds);
+guint                     clutter_gst_player_get_n_buffered_ranges (ClutterGstPlayer  *player);
+gboolean                  clutter_gst_player_get_buffered_range  (ClutterGstPlayer        *player,
+                                                                  guint                    index_,
+                                                                  gdouble                 *start,
+                                                                  gdouble                 *stop);
+void                      clutter_gst_player_get_buffering_watermarks (ClutterGstPlayer *player,
+                                                                       gdouble          *low,
+                                                                       gdouble          *high);
+void                      clutter_gst_player_set_buffering_watermarks (ClutterGstPlayer *player,
+                                                                       gdouble           low,
+                                                                       gdouble           high);
+gdouble                   clutter_gst_player_get_buffering_time_left (ClutterGstPlayer  *player);
+
+guint64                   clutter_gst_player_get_timeshift_size  (ClutterGstPlayer        *player);
+void                      clutter_gst_player_set_timeshift_size  (ClutterGstPlayer        *player,
+                                                                  guint64                  size);
+
+gboolean                  clutter_gst_player_get_use_media_cache (ClutterGstPlayer        *player);
+void                      clutter_gst_player_set_use_media_cache (ClutterGstPlayer        *player,
+                                                                  gboolean                 use_media_cache);
+gchar *                   clutter_gst_player_get_media_cache_dir  (void);
+void                      clutter_gst_player_set_media_cache_dir  (const gchar            *dir);
+guint64                   clutter_gst_player_get_media_cache_size (void);
+void                      clutter_gst_player_set_media_cache_size (guint64                 max_size);
+
+guint64                   clutter_gst_player_get_memory_budget   (ClutterGstPlayer        *player);
+void                      clutter_gst_player_set_memory_budget   (ClutterGstPlayer        *player,
+                                                                  guint64                  budget);
+guint64                   clutter_gst_player_get_global_memory_budget (void);
+void                      clutter_gst_player_set_global_memory_budget (guint64            budget);
+guint64                   clutter_gst_player_get_queued_bytes    (ClutterGstPlayer        *player);
+guint64                   clutter_gst_player_get_total_queued_bytes (void);
+
+gboolean                  clutter_gst_player_get_shared_bus_dispatch (void);
+void                      clutter_gst_player_set_shared_bus_dispatch (gboolean        shared);
+
+gboolean                  clutter_gst_player_get_shared_audio    (ClutterGstPlayer        *player);
+void                      clutter_gst_player_set_shared_audio    (ClutterGstPlayer        *player,
+                                                                  gboolean                 shared_audio);
+gboolean                  clutter_gst_player_get_audio_enabled   (ClutterGstPlayer        *player);
+void                      clutter_gst_player_set_audio_enabled   (ClutterGstPlayer        *player,
+                                                                  gboolean                 enabled);
+void                      clutter_gst_player_set_shared_audio_sink (GstElement            *sink);
+
+void                      clutter_gst_player_step_forward        (ClutterGstPlayer        *player);
+void                      clutter_gst_player_step_back           (ClutterGstPlayer        *player);
+guint                     clutter_gst_player_get_frame_cache_size (ClutterGstPlayer       *player);
+void                      clutter_gst_player_set_frame_cache_size (ClutterGstPlayer       *player,
+                                                                   guint                   n_frames);
+
+gboolean                  clutter_gst_player_get_use_keyframe_index (ClutterGstPlayer     *player);
+void                      clutter_gst_player_set_use_keyframe_index (ClutterGstPlayer     *player,
+                                                                     gboolean              use_index);
+gdouble                   clutter_gst_player_get_seek_cost        (ClutterGstPlayer       *player,
+                                                                   gdouble                 progress);
+
+gboolean                  clutter_gst_player_get_native_video     (ClutterGstPlayer       *player);
+void                      clutter_gst_player_set_native_video     (ClutterGstPlayer       *player,
+                                                                   gboolean                native);
+
+gboolean                  clutter_gst_player_get_adapt_streams_to_size (ClutterGstPlayer  *player);
+void                      clutter_gst_player_set_adapt_streams_to_size (ClutterGstPlayer  *player,
+                                                                        gboolean           adapt);
+
+gboolean                  clutter_gst_player_get_throttle_hidden  (ClutterGstPlayer       *player);
+void                      clutter_gst_player_set_throttle_hidden  (ClutterGstPlayer       *player,
+                                                                   gboolean                throttle);
+guint                     clutter_gst_player_get_hidden_grace_period (ClutterGstPlayer    *player);
+void                      clutter_gst_player_set_hidden_grace_period (ClutterGstPlayer    *player,
+                                                                      guint                grace_period);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_GST_PLAYER_H__ */
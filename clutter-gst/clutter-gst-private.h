@@ -47,6 +47,10 @@ G_BEGIN_DECLS
 gboolean
 _internal_plugin_init (GstPlugin *plugin);
 
+void
+_clutter_gst_video_sink_show_buffer (GstElement *sink,
+                                     GstBuffer  *buffer);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_GST_PRIVATE_H__ */
@@ -0,0 +1,985 @@
+/*
+ * Clutter-GStreamer.
+ *
+ * GStreamer integration library for Clutter.
+ *
+ * clutter-gst-thumbnailer.c - Thumbnails and sprite sheets of media.
+ *
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * SECTION:clutter-gst-thumbnailer
+ * @short_description: Thumbnails and sprite sheets of media
+ *
+ * The thumbnailer extracts small frames of a video at given timestamps,
+ * to show previews along a seek bar for instance, without creating a
+ * #ClutterGstPlayer for each media.
+ *
+ * Thumbnails are decoded by a pool of worker threads, see
+ * clutter_gst_thumbnailer_set_max_workers(), each media being handled by a
+ * video only pipeline that is never played: it seeks to the key frame
+ * nearest to each timestamp so that only one frame is decoded per
+ * thumbnail, and the frames are scaled down right after the decoder, before
+ * any color conversion.
+ *
+ * Thumbnails are kept in a cache on disk, so that asking again for the
+ * thumbnails of a media doesn't decode anything. The thumbnails of the
+ * least recently used media are evicted when the cache is full, see
+ * clutter_gst_thumbnailer_set_cache_size().
+ */
+
+/*
+ * The cache is a directory per media, named after the SHA1 of the URI of
+ * the media, holding a directory named after the modification time of the
+ * media, for local files, 0 otherwise. Each thumbnail is a file named
+ * "<width>-<timestamp>" holding a header, the timestamp of the frame and its
+ * caps as a string, followed by a NUL byte and the pixels.
+ *
+ * The modification time of the directory of a media is the last time its
+ * thumbnails were used, the least recently used media being evicted first.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include <glib/gstdio.h>
+#include <gst/video/video.h>
+
+#include "clutter-gst-debug.h"
+#include "clutter-gst-thumbnailer.h"
+
+/* how long extracting one thumbnail can take (in ns) */
+#define THUMBNAIL_TIMEOUT       (10 * GST_SECOND)
+#define DEFAULT_MAX_WORKERS     2
+/* 64 MiB */
+#define DEFAULT_CACHE_SIZE      (G_GUINT64_CONSTANT (64) << 20)
+
+typedef struct
+{
+  gchar *uri;
+  GstClockTime *timestamps;
+  guint n_timestamps;
+  gint width;
+} ThumbnailJob;
+
+G_LOCK_DEFINE_STATIC (workers);
+static GThreadPool *workers = NULL;
+static guint max_workers = DEFAULT_MAX_WORKERS;
+
+/* held while the cache is written to */
+G_LOCK_DEFINE_STATIC (thumbnail_cache);
+static guint64 cache_max_size = DEFAULT_CACHE_SIZE;
+
+static void
+thumbnail_job_free (ThumbnailJob *job)
+{
+  g_free (job->uri);
+  g_free (job->timestamps);
+  g_slice_free (ThumbnailJob, job);
+}
+
+static void
+free_sample (gpointer data)
+{
+  if (data)
+    gst_sample_unref (data);
+}
+
+/* Cache */
+
+static gchar *
+thumbnail_cache_get_root (void)
+{
+  return g_build_filename (g_get_user_cache_dir (),
+                           "clutter-gst", "thumbnails", NULL);
+}
+
+/* Only the thumbnails of local files are updated when the file changes,
+ * the thumbnails of other media are kept for as long as the cache is */
+static gchar *
+thumbnail_cache_get_dir (const gchar *uri)
+{
+  GFileInfo *file_info;
+  GFile *file;
+  guint64 mtime = 0;
+  gchar *root, *key, *name, *dir;
+
+  if (g_str_has_prefix (uri, "file:"))
+    {
+      file = g_file_new_for_uri (uri);
+      file_info = g_file_query_info (file, G_FILE_ATTRIBUTE_TIME_MODIFIED,
+                                     G_FILE_QUERY_INFO_NONE, NULL, NULL);
+      if (file_info)
+        {
+          mtime = g_file_info_get_attribute_uint64
+            (file_info, G_FILE_ATTRIBUTE_TIME_MODIFIED);
+          g_object_unref (file_info);
+        }
+      g_object_unref (file);
+    }
+
+  root = thumbnail_cache_get_root ();
+  key = g_compute_checksum_for_string (G_CHECKSUM_SHA1, uri, -1);
+  name = g_strdup_printf ("%" G_GUINT64_FORMAT, mtime);
+
+  dir = g_build_filename (root, key, name, NULL);
+
+  g_free (name);
+  g_free (key);
+  g_free (root);
+
+  return dir;
+}
+
+/* Removes @path, and what it holds when it's a directory. Returns the
+ * number of bytes freed */
+static guint64
+thumbnail_cache_remove (const gchar *path)
+{
+  const gchar *name;
+  guint64 size = 0;
+  GStatBuf st;
+  GDir *dir;
+
+  dir = g_dir_open (path, 0, NULL);
+  if (dir == NULL)
+    {
+      if (g_stat (path, &st) == 0)
+        size = st.st_size;
+      g_unlink (path);
+
+      return size;
+    }
+
+  while ((name = g_dir_read_name (dir)))
+    {
+      gchar *child = g_build_filename (path, name, NULL);
+
+      size += thumbnail_cache_remove (child);
+      g_free (child);
+    }
+
+  g_dir_close (dir);
+  g_rmdir (path);
+
+  return size;
+}
+
+/* Sums the size of the files under @path */
+static guint64
+thumbnail_cache_get_size (const gchar *path)
+{
+  const gchar *name;
+  guint64 size = 0;
+  GStatBuf st;
+  GDir *dir;
+
+  dir = g_dir_open (path, 0, NULL);
+  if (dir == NULL)
+    return g_stat (path, &st) == 0 ? st.st_size : 0;
+
+  while ((name = g_dir_read_name (dir)))
+    {
+      gchar *child = g_build_filename (path, name, NULL);
+
+      size += thumbnail_cache_get_size (child);
+      g_free (child);
+    }
+
+  g_dir_close (dir);
+
+  return size;
+}
+
+/* Marks the media of @dir as just used. The thumbnails of its previous
+ * versions, for local files that changed, are removed */
+static void
+thumbnail_cache_touch (const gchar *dir)
+{
+  gchar *media_dir, *version;
+  const gchar *name;
+  GDir *versions;
+
+  media_dir = g_path_get_dirname (dir);
+  version = g_path_get_basename (dir);
+
+  G_LOCK (thumbnail_cache);
+
+  versions = g_dir_open (media_dir, 0, NULL);
+  if (versions)
+    {
+      while ((name = g_dir_read_name (versions)))
+        {
+          gchar *path;
+
+          if (strcmp (name, version) == 0)
+            continue;
+
+          CLUTTER_GST_NOTE (MEDIA, "removing outdated thumbnails %s", name);
+
+          path = g_build_filename (media_dir, name, NULL);
+          thumbnail_cache_remove (path);
+          g_free (path);
+        }
+
+      g_dir_close (versions);
+    }
+
+  g_utime (media_dir, NULL);
+
+  G_UNLOCK (thumbnail_cache);
+
+  g_free (version);
+  g_free (media_dir);
+}
+
+/* Evicts the thumbnails of the least recently used media until the cache
+ * fits in cache_max_size */
+static void
+thumbnail_cache_evict (void)
+{
+  GPtrArray *names;
+  GArray *sizes, *times;
+  const gchar *name;
+  guint64 total = 0;
+  gchar *root;
+  GDir *dir;
+  guint i;
+
+  root = thumbnail_cache_get_root ();
+
+  G_LOCK (thumbnail_cache);
+
+  dir = g_dir_open (root, 0, NULL);
+  if (dir == NULL)
+    {
+      G_UNLOCK (thumbnail_cache);
+      g_free (root);
+      return;
+    }
+
+  names = g_ptr_array_new_with_free_func (g_free);
+  sizes = g_array_new (FALSE, FALSE, sizeof (guint64));
+  times = g_array_new (FALSE, FALSE, sizeof (gint64));
+
+  while ((name = g_dir_read_name (dir)))
+    {
+      gchar *path = g_build_filename (root, name, NULL);
+      GStatBuf st;
+      guint64 size;
+      gint64 mtime;
+
+      if (g_stat (path, &st) != 0)
+        {
+          g_free (path);
+          continue;
+        }
+
+      size = thumbnail_cache_get_size (path);
+      mtime = st.st_mtime;
+
+      g_ptr_array_add (names, path);
+      g_array_append_val (sizes, size);
+      g_array_append_val (times, mtime);
+
+      total += size;
+    }
+
+  g_dir_close (dir);
+
+  while (total > cache_max_size)
+    {
+      gint64 oldest_time = G_MAXINT64;
+      guint oldest = names->len;
+
+      for (i = 0; i < names->len; i++)
+        {
+          if (g_ptr_array_index (names, i) == NULL)
+            continue;
+
+          if (g_array_index (times, gint64, i) < oldest_time)
+            {
+              oldest_time = g_array_index (times, gint64, i);
+              oldest = i;
+            }
+        }
+
+      if (oldest == names->len)
+        break;
+
+      CLUTTER_GST_NOTE (MEDIA, "evicting thumbnails %s",
+                        (gchar *) g_ptr_array_index (names, oldest));
+
+      thumbnail_cache_remove (g_ptr_array_index (names, oldest));
+      total -= g_array_index (sizes, guint64, oldest);
+
+      g_free (g_ptr_array_index (names, oldest));
+      g_ptr_array_index (names, oldest) = NULL;
+    }
+
+  G_UNLOCK (thumbnail_cache);
+
+  g_ptr_array_unref (names);
+  g_array_unref (sizes);
+  g_array_unref (times);
+  g_free (root);
+}
+
+static gchar *
+thumbnail_cache_get_path (const gchar  *dir,
+                          gint          width,
+                          GstClockTime  timestamp)
+{
+  gchar *name, *path;
+
+  name = g_strdup_printf ("%d-%" G_GUINT64_FORMAT, width, timestamp);
+  path = g_build_filename (dir, name, NULL);
+  g_free (name);
+
+  return path;
+}
+
+static GstSample *
+thumbnail_cache_load (const gchar  *dir,
+                      gint          width,
+                      GstClockTime  timestamp)
+{
+  GstSample *sample = NULL;
+  GstBuffer *buffer;
+  GstVideoInfo info;
+  GstCaps *caps;
+  gchar *path, *contents, *caps_string, *end;
+  guint64 pts;
+  gsize length, offset;
+
+  path = thumbnail_cache_get_path (dir, width, timestamp);
+  if (!g_file_get_contents (path, &contents, &length, NULL))
+    {
+      g_free (path);
+      return NULL;
+    }
+  g_free (path);
+
+  end = memchr (contents, '\0', length);
+  if (end == NULL)
+    goto out;
+  offset = end - contents + 1;
+
+  pts = g_ascii_strtoull (contents, &caps_string, 10);
+  if (*caps_string != ' ')
+    goto out;
+
+  caps = gst_caps_from_string (caps_string + 1);
+  if (caps == NULL)
+    goto out;
+
+  if (!gst_video_info_from_caps (&info, caps) || length - offset < info.size)
+    {
+      gst_caps_unref (caps);
+      goto out;
+    }
+
+  buffer = gst_buffer_new_wrapped_full (0, contents, length,
+                                        offset, length - offset,
+                                        contents, g_free);
+  GST_BUFFER_PTS (buffer) = pts;
+  contents = NULL;
+
+  sample = gst_sample_new (buffer, caps, NULL, NULL);
+  gst_buffer_unref (buffer);
+  gst_caps_unref (caps);
+
+ out:
+  g_free (contents);
+
+  return sample;
+}
+
+static void
+thumbnail_cache_store (const gchar  *dir,
+                       gint          width,
+                       GstClockTime  timestamp,
+                       GstSample    *sample)
+{
+  GError *error = NULL;
+  GString *contents;
+  GstBuffer *buffer;
+  GstMapInfo map;
+  gchar *path, *caps_string;
+
+  buffer = gst_sample_get_buffer (sample);
+  if (!gst_buffer_map (buffer, &map, GST_MAP_READ))
+    return;
+
+  caps_string = gst_caps_to_string (gst_sample_get_caps (sample));
+
+  contents = g_string_sized_new (strlen (caps_string) + map.size + 32);
+  g_string_printf (contents, "%" G_GUINT64_FORMAT " %s",
+                   (guint64) GST_BUFFER_PTS (buffer), caps_string);
+  g_string_append_len (contents, "", 1);
+  g_string_append_len (contents, (const gchar *) map.data, map.size);
+
+  gst_buffer_unmap (buffer, &map);
+  g_free (caps_string);
+
+  G_LOCK (thumbnail_cache);
+
+  g_mkdir_with_parents (dir, 0700);
+  path = thumbnail_cache_get_path (dir, width, timestamp);
+
+  if (!g_file_set_contents (path, contents->str, contents->len, &error))
+    {
+      g_warning ("Could not save a thumbnail: %s", error->message);
+      g_error_free (error);
+    }
+
+  G_UNLOCK (thumbnail_cache);
+
+  g_free (path);
+  g_string_free (contents, TRUE);
+}
+
+/* Extraction */
+
+/*
+ * playbin with only the video enabled, and a video sink that scales the
+ * decoded frames down before converting them to RGBA, the scaling being by
+ * far the cheaper of the two on full size frames. The sink keeps the last
+ * frame it got, the one pre-rolled after each seek.
+ */
+static GstElement *
+thumbnail_pipeline_new (const gchar *uri,
+                        gint         width)
+{
+  GstElement *pipeline, *bin, *scale, *convert, *filter, *sink;
+  GstCaps *caps;
+  GstPad *pad;
+
+  pipeline = gst_element_factory_make ("playbin", NULL);
+  bin = gst_bin_new (NULL);
+  scale = gst_element_factory_make ("videoscale", NULL);
+  convert = gst_element_factory_make ("videoconvert", NULL);
+  filter = gst_element_factory_make ("capsfilter", NULL);
+  sink = gst_element_factory_make ("fakesink", "sink");
+
+  if (!pipeline || !scale || !convert || !filter || !sink)
+    {
+      g_clear_object (&pipeline);
+      g_clear_object (&scale);
+      g_clear_object (&convert);
+      g_clear_object (&filter);
+      g_clear_object (&sink);
+      gst_object_unref (bin);
+
+      return NULL;
+    }
+
+  caps = gst_caps_new_simple ("video/x-raw",
+                              "format", G_TYPE_STRING, "RGBA",
+                              "width", G_TYPE_INT, width,
+                              "pixel-aspect-ratio", GST_TYPE_FRACTION, 1, 1,
+                              NULL);
+  g_object_set (filter, "caps", caps, NULL);
+  gst_caps_unref (caps);
+
+  g_object_set (sink,
+                "sync", FALSE,
+                "enable-last-sample", TRUE,
+                NULL);
+
+  gst_bin_add_many (GST_BIN (bin), scale, convert, filter, sink, NULL);
+  gst_element_link_many (scale, convert, filter, sink, NULL);
+
+  pad = gst_element_get_static_pad (scale, "sink");
+  gst_element_add_pad (bin, gst_ghost_pad_new ("sink", pad));
+  gst_object_unref (pad);
+
+  g_object_set (pipeline,
+                "uri", uri,
+                "video-sink", bin,
+                NULL);
+  gst_util_set_object_arg (G_OBJECT (pipeline), "flags", "video");
+
+  return pipeline;
+}
+
+/* Waits for the pipeline to pre-roll */
+static gboolean
+thumbnail_pipeline_wait (GstElement  *pipeline,
+                         GError     **error)
+{
+  GstMessage *message;
+  GstBus *bus;
+  gboolean prerolled = FALSE;
+
+  bus = gst_element_get_bus (pipeline);
+  message = gst_bus_timed_pop_filtered (bus, THUMBNAIL_TIMEOUT,
+                                        GST_MESSAGE_ASYNC_DONE |
+                                        GST_MESSAGE_ERROR);
+  gst_object_unref (bus);
+
+  if (message == NULL)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_TIMED_OUT,
+                   "Timed out while extracting a thumbnail");
+    }
+  else if (GST_MESSAGE_TYPE (message) == GST_MESSAGE_ERROR)
+    {
+      gst_message_parse_error (message, error, NULL);
+    }
+  else
+    {
+      prerolled = TRUE;
+    }
+
+  if (message)
+    gst_message_unref (message);
+
+  return prerolled;
+}
+
+/* Fills the empty slots of @thumbnails */
+static gboolean
+thumbnail_extract (ThumbnailJob  *job,
+                   GPtrArray     *thumbnails,
+                   GCancellable  *cancellable,
+                   GError       **error)
+{
+  GstStateChangeReturn ret;
+  GstElement *pipeline, *sink;
+  gboolean success = FALSE;
+  guint i;
+
+  pipeline = thumbnail_pipeline_new (job->uri, job->width);
+  if (pipeline == NULL)
+    {
+      g_set_error (error, GST_CORE_ERROR, GST_CORE_ERROR_MISSING_PLUGIN,
+                   "Could not create the thumbnail pipeline");
+      return FALSE;
+    }
+
+  CLUTTER_GST_NOTE (MEDIA, "extracting thumbnails of %s", job->uri);
+
+  ret = gst_element_set_state (pipeline, GST_STATE_PAUSED);
+  if (ret == GST_STATE_CHANGE_FAILURE)
+    {
+      /* the error is on the bus */
+      thumbnail_pipeline_wait (pipeline, error);
+      goto out;
+    }
+  else if (ret == GST_STATE_CHANGE_NO_PREROLL)
+    {
+      g_set_error (error, GST_STREAM_ERROR, GST_STREAM_ERROR_FAILED,
+                   "Can't extract thumbnails of live streams");
+      goto out;
+    }
+  else if (ret == GST_STATE_CHANGE_ASYNC &&
+           !thumbnail_pipeline_wait (pipeline, error))
+    {
+      goto out;
+    }
+
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+
+  for (i = 0; i < job->n_timestamps; i++)
+    {
+      GstSample *sample = NULL;
+
+      if (g_ptr_array_index (thumbnails, i))
+        continue;
+
+      if (g_cancellable_set_error_if_cancelled (cancellable, error))
+        break;
+
+      if (!gst_element_seek_simple (pipeline, GST_FORMAT_TIME,
+                                    GST_SEEK_FLAG_FLUSH |
+                                    GST_SEEK_FLAG_KEY_UNIT |
+                                    GST_SEEK_FLAG_SNAP_NEAREST,
+                                    job->timestamps[i]))
+        {
+          g_set_error (error, GST_CORE_ERROR, GST_CORE_ERROR_SEEK,
+                       "Could not seek to %" GST_TIME_FORMAT,
+                       GST_TIME_ARGS (job->timestamps[i]));
+          break;
+        }
+
+      if (!thumbnail_pipeline_wait (pipeline, error))
+        break;
+
+      g_object_get (sink, "last-sample", &sample, NULL);
+      if (sample == NULL)
+        {
+          g_set_error (error, GST_STREAM_ERROR, GST_STREAM_ERROR_FAILED,
+                       "No frame at %" GST_TIME_FORMAT,
+                       GST_TIME_ARGS (job->timestamps[i]));
+          break;
+        }
+
+      g_ptr_array_index (thumbnails, i) = sample;
+    }
+
+  success = i == job->n_timestamps;
+
+  gst_object_unref (sink);
+
+ out:
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  return success;
+}
+
+static void
+thumbnail_worker (gpointer data,
+                  gpointer user_data)
+{
+  GTask *task = data;
+  ThumbnailJob *job = g_task_get_task_data (task);
+  GPtrArray *thumbnails;
+  GError *error = NULL;
+  gboolean cached = TRUE;
+  gchar *dir;
+  guint i;
+
+  if (g_task_return_error_if_cancelled (task))
+    {
+      g_object_unref (task);
+      return;
+    }
+
+  dir = thumbnail_cache_get_dir (job->uri);
+
+  thumbnails = g_ptr_array_new_with_free_func (free_sample);
+  g_ptr_array_set_size (thumbnails, job->n_timestamps);
+
+  for (i = 0; i < job->n_timestamps; i++)
+    {
+      GstSample *sample;
+
+      sample = thumbnail_cache_load (dir, job->width, job->timestamps[i]);
+      g_ptr_array_index (thumbnails, i) = sample;
+
+      if (sample == NULL)
+        cached = FALSE;
+    }
+
+  if (cached)
+    {
+      CLUTTER_GST_NOTE (MEDIA, "thumbnails of %s are in the cache", job->uri);
+
+      thumbnail_cache_touch (dir);
+    }
+  else
+    {
+      GPtrArray *missing;
+
+      /* remember which ones weren't in the cache */
+      missing = g_ptr_array_new ();
+      for (i = 0; i < job->n_timestamps; i++)
+        if (g_ptr_array_index (thumbnails, i) == NULL)
+          g_ptr_array_add (missing, GUINT_TO_POINTER (i));
+
+      if (thumbnail_extract (job, thumbnails,
+                             g_task_get_cancellable (task), &error))
+        {
+          for (i = 0; i < missing->len; i++)
+            {
+              guint n = GPOINTER_TO_UINT (g_ptr_array_index (missing, i));
+
+              thumbnail_cache_store (dir, job->width, job->timestamps[n],
+                                     g_ptr_array_index (thumbnails, n));
+            }
+
+          thumbnail_cache_touch (dir);
+          thumbnail_cache_evict ();
+        }
+      else
+        {
+          g_ptr_array_unref (thumbnails);
+          thumbnails = NULL;
+        }
+
+      g_ptr_array_unref (missing);
+    }
+
+  if (thumbnails)
+    g_task_return_pointer (task, thumbnails,
+                           (GDestroyNotify) g_ptr_array_unref);
+  else
+    g_task_return_error (task, error);
+
+  g_free (dir);
+  g_object_unref (task);
+}
+
+/**
+ * clutter_gst_thumbnailer_get_thumbnails_async:
+ * @uri: the URI of a media
+ * @timestamps: (array length=n_timestamps): the positions of the
+ *   thumbnails in the media
+ * @n_timestamps: the number of thumbnails
+ * @width: the width of the thumbnails, in pixels. Their height follows the
+ *   aspect ratio of the video
+ * @cancellable: (allow-none): a #GCancellable, or NULL
+ * @callback: a #GAsyncReadyCallback to call when the thumbnails are ready
+ * @user_data: the data to pass to @callback
+ *
+ * Extracts the thumbnails of the media at @uri in a worker thread, or gets
+ * them from the cache. A thumbnail is the key frame nearest to its
+ * timestamp, which can be seconds away in media with few key frames.
+ *
+ * @callback is called in the thread-default main context of the caller.
+ * Call clutter_gst_thumbnailer_get_thumbnails_finish() from it to get the
+ * thumbnails.
+ *
+ * Since: 2.2
+ */
+void
+clutter_gst_thumbnailer_get_thumbnails_async (const gchar         *uri,
+                                              const GstClockTime  *timestamps,
+                                              guint                n_timestamps,
+                                              gint                 width,
+                                              GCancellable        *cancellable,
+                                              GAsyncReadyCallback  callback,
+                                              gpointer             user_data)
+{
+  ThumbnailJob *job;
+  GTask *task;
+
+  g_return_if_fail (uri != NULL);
+  g_return_if_fail (timestamps != NULL || n_timestamps == 0);
+  g_return_if_fail (width > 0);
+
+  job = g_slice_new (ThumbnailJob);
+  job->uri = g_strdup (uri);
+  job->timestamps = g_memdup (timestamps, n_timestamps * sizeof (GstClockTime));
+  job->n_timestamps = n_timestamps;
+  job->width = width;
+
+  task = g_task_new (NULL, cancellable, callback, user_data);
+  g_task_set_task_data (task, job, (GDestroyNotify) thumbnail_job_free);
+
+  G_LOCK (workers);
+
+  if (workers == NULL)
+    workers = g_thread_pool_new (thumbnail_worker, NULL, max_workers,
+                                 FALSE, NULL);
+
+  g_thread_pool_push (workers, task, NULL);
+
+  G_UNLOCK (workers);
+}
+
+/**
+ * clutter_gst_thumbnailer_get_thumbnails_finish:
+ * @result: the #GAsyncResult given to the callback of
+ *   clutter_gst_thumbnailer_get_thumbnails_async()
+ * @error: return location for a #GError, or NULL
+ *
+ * Finishes the extraction of thumbnails started with
+ * clutter_gst_thumbnailer_get_thumbnails_async().
+ *
+ * Return value: (transfer full) (element-type GstSample): an array of
+ *   #GstSample holding RGBA frames, one per timestamp in the order of the
+ *   timestamps, or NULL on error. Use g_ptr_array_unref() when you're done
+ *   with it
+ *
+ * Since: 2.2
+ */
+GPtrArray *
+clutter_gst_thumbnailer_get_thumbnails_finish (GAsyncResult  *result,
+                                               GError       **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, NULL), NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
+/**
+ * clutter_gst_thumbnailer_create_sprite_sheet:
+ * @thumbnails: (element-type GstSample): thumbnails as returned by
+ *   clutter_gst_thumbnailer_get_thumbnails_finish()
+ * @columns: the number of thumbnails per row, or 0 to put all the
+ *   thumbnails on one row
+ *
+ * Creates a texture holding all the @thumbnails, laid out in rows of
+ * @columns thumbnails from left to right and top to bottom. All the cells
+ * have the size of the first thumbnail.
+ *
+ * Drawing a seek bar preview from a single texture, using texture
+ * coordinates to pick a thumbnail, is much cheaper than having a texture
+ * per thumbnail.
+ *
+ * Return value: (transfer full): a #CoglTexture, or %COGL_INVALID_HANDLE
+ *   if it couldn't be created
+ *
+ * Since: 2.2
+ */
+CoglHandle
+clutter_gst_thumbnailer_create_sprite_sheet (GPtrArray *thumbnails,
+                                             guint      columns)
+{
+  GstVideoInfo info;
+  CoglHandle texture;
+  guchar *data;
+  guint i, rows;
+  gint cell_width, cell_height, stride;
+
+  g_return_val_if_fail (thumbnails != NULL && thumbnails->len > 0,
+                        COGL_INVALID_HANDLE);
+
+  if (!gst_video_info_from_caps
+      (&info, gst_sample_get_caps (g_ptr_array_index (thumbnails, 0))))
+    return COGL_INVALID_HANDLE;
+
+  if (columns == 0 || columns > thumbnails->len)
+    columns = thumbnails->len;
+  rows = (thumbnails->len + columns - 1) / columns;
+
+  cell_width = GST_VIDEO_INFO_WIDTH (&info);
+  cell_height = GST_VIDEO_INFO_HEIGHT (&info);
+  stride = columns * cell_width * 4;
+
+  data = g_malloc0 (stride * rows * cell_height);
+
+  for (i = 0; i < thumbnails->len; i++)
+    {
+      GstSample *sample = g_ptr_array_index (thumbnails, i);
+      GstVideoFrame frame;
+      guchar *dest;
+      gint y, width, height;
+
+      /* the size of the video can change in the middle of a media */
+      if (!gst_video_info_from_caps (&info, gst_sample_get_caps (sample)) ||
+          GST_VIDEO_INFO_FORMAT (&info) != GST_VIDEO_FORMAT_RGBA ||
+          !gst_video_frame_map (&frame, &info, gst_sample_get_buffer (sample),
+                                GST_MAP_READ))
+        continue;
+
+      width = MIN (cell_width, GST_VIDEO_FRAME_WIDTH (&frame));
+      height = MIN (cell_height, GST_VIDEO_FRAME_HEIGHT (&frame));
+
+      dest = data + (i / columns) * cell_height * stride +
+        (i % columns) * cell_width * 4;
+
+      for (y = 0; y < height; y++)
+        memcpy (dest + y * stride,
+                (guchar *) GST_VIDEO_FRAME_PLANE_DATA (&frame, 0) +
+                y * GST_VIDEO_FRAME_PLANE_STRIDE (&frame, 0),
+                width * 4);
+
+      gst_video_frame_unmap (&frame);
+    }
+
+  texture = cogl_texture_new_from_data (columns * cell_width,
+                                        rows * cell_height,
+                                        COGL_TEXTURE_NONE,
+                                        COGL_PIXEL_FORMAT_RGBA_8888,
+                                        COGL_PIXEL_FORMAT_ANY,
+                                        stride,
+                                        data);
+  g_free (data);
+
+  return texture;
+}
+
+/**
+ * clutter_gst_thumbnailer_get_max_workers:
+ *
+ * Gets the maximum number of media whose thumbnails are extracted at the
+ * same time.
+ *
+ * Return value: the maximum number of worker threads
+ *
+ * Since: 2.2
+ */
+guint
+clutter_gst_thumbnailer_get_max_workers (void)
+{
+  return max_workers;
+}
+
+/**
+ * clutter_gst_thumbnailer_set_max_workers:
+ * @max_workers: the maximum number of worker threads
+ *
+ * Sets the maximum number of media whose thumbnails are extracted at the
+ * same time, each in a worker thread of its own. Defaults to 2, as
+ * decoding is a lot more expensive than discovering media.
+ *
+ * Since: 2.2
+ */
+void
+clutter_gst_thumbnailer_set_max_workers (guint max_workers_)
+{
+  g_return_if_fail (max_workers_ > 0);
+
+  G_LOCK (workers);
+
+  max_workers = max_workers_;
+  if (workers)
+    g_thread_pool_set_max_threads (workers, max_workers, NULL);
+
+  G_UNLOCK (workers);
+}
+
+/**
+ * clutter_gst_thumbnailer_get_cache_size:
+ *
+ * Gets the maximum size of the thumbnail cache, see
+ * clutter_gst_thumbnailer_set_cache_size().
+ *
+ * Return value: the maximum size of the cache, in bytes
+ *
+ * Since: 2.2
+ */
+guint64
+clutter_gst_thumbnailer_get_cache_size (void)
+{
+  guint64 max_size;
+
+  G_LOCK (thumbnail_cache);
+  max_size = cache_max_size;
+  G_UNLOCK (thumbnail_cache);
+
+  return max_size;
+}
+
+/**
+ * clutter_gst_thumbnailer_set_cache_size:
+ * @max_size: the maximum size of the cache, in bytes
+ *
+ * Sets the maximum size of the thumbnail cache on disk. When it's full,
+ * the thumbnails of the least recently used media are evicted. Defaults to
+ * 64 MiB.
+ *
+ * Since: 2.2
+ */
+void
+clutter_gst_thumbnailer_set_cache_size (guint64 max_size)
+{
+  G_LOCK (thumbnail_cache);
+  cache_max_size = max_size;
+  G_UNLOCK (thumbnail_cache);
+
+  thumbnail_cache_evict ();
+}
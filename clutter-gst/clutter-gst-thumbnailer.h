@@ -0,0 +1,60 @@
+/*
+ * Clutter-GStreamer.
+ *
+ * GStreamer integration library for Clutter.
+ *
+ * clutter-gst-thumbnailer.h - Thumbnails and sprite sheets of media.
+ *
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#if !defined(__CLUTTER_GST_H_INSIDE__) && !defined(CLUTTER_GST_COMPILATION)
+#error "Only <clutter-gst/clutter-gst.h> can be included directly."
+#endif
+
+#ifndef __CLUTTER_GST_THUMBNAILER_H__
+#define __CLUTTER_GST_THUMBNAILER_H__
+
+#include <gio/gio.h>
+#include <clutter/clutter.h>
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+void         clutter_gst_thumbnailer_get_thumbnails_async  (const gchar         *uri,
+                                                            const GstClockTime  *timestamps,
+                                                            guint                n_timestamps,
+                                                            gint                 width,
+                                                            GCancellable        *cancellable,
+                                                            GAsyncReadyCallback  callback,
+                                                            gpointer             user_data);
+GPtrArray *  clutter_gst_thumbnailer_get_thumbnails_finish (GAsyncResult        *result,
+                                                            GError             **error);
+
+CoglHandle   clutter_gst_thumbnailer_create_sprite_sheet   (GPtrArray           *thumbnails,
+                                                            guint                columns);
+
+guint        clutter_gst_thumbnailer_get_max_workers       (void);
+void         clutter_gst_thumbnailer_set_max_workers       (guint                max_workers);
+
+guint64      clutter_gst_thumbnailer_get_cache_size        (void);
+void         clutter_gst_thumbnailer_set_cache_size        (guint64              max_size);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_GST_THUMBNAILER_H__ */
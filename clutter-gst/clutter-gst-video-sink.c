@@ -168,7 +168,12 @@ enum
 {
   PROP_0,
   PROP_TEXTURE,
-  PROP_UPDATE_PRIORITY
+  PROP_UPDATE_PRIORITY,
+  PROP_ADAPT_TO_ALLOCATION,
+  PROP_THROTTLE_HIDDEN,
+  PROP_MAX_FPS,
+  PROP_LAZY_UPLOAD,
+  PROP_BATCH_UPLOAD
 };
 
 typedef enum
@@ -200,6 +205,19 @@ typedef enum _ClutterGstFeatures
 
 #define CLUTTER_GST_DEFAULT_PRIORITY    (G_PRIORITY_HIGH_IDLE)
 
+/* how long the size of the texture has to be stable before upstream is
+ * asked for frames of that size (in ms), and the granularity of that size
+ * (in pixels). Both avoid renegotiating all along a resize animation */
+#define CLUTTER_GST_ADAPT_DELAY         200
+#define CLUTTER_GST_ADAPT_ROUNDING      64
+
+/* how often the visibility of the texture is checked (in ms), how long it
+ * has to stay hidden before upstream is throttled (in ms), and the interval
+ * between the frames upstream then sends */
+#define CLUTTER_GST_VISIBILITY_INTERVAL 250
+#define CLUTTER_GST_THROTTLE_DELAY      1000
+#define CLUTTER_GST_THROTTLE_TIME       GST_SECOND
+
 typedef struct _ClutterGstSource
 {
   GSource source;
@@ -224,6 +242,7 @@ typedef struct _ClutterGstRenderer
   const char *name;             /* user friendly name */
   ClutterGstVideoFormat format; /* the format handled by this renderer */
   int flags;                    /* ClutterGstFeatures ORed flags */
+  int cost;                     /* bits per pixel copied to the GPU */
   GstStaticCaps caps;           /* caps handled by the renderer */
   gpointer context;             /* rendering context if any */
 
@@ -254,6 +273,39 @@ struct _ClutterGstVideoSinkPrivate
 
   GArray *signal_handler_ids;
 
+  /* the largest frames asked to upstream, 0 when not restricted. Protected
+   * by the object lock */
+  gboolean adapt_to_allocation;
+  guint adapt_id;
+  gint max_width;
+  gint max_height;
+
+  /* the highest frame rate rendered, 0 when not limited. Protected by the
+   * object lock */
+  gdouble max_fps;
+
+  /* visibility of the texture, only used from the Clutter thread */
+  gboolean throttle_hidden;
+  guint visibility_id;
+  guint visibility_idle_id;
+  gboolean hidden;
+  gint64 hidden_since;
+  gboolean hidden_throttled;
+  gboolean painted;
+  gboolean uploaded;
+  guint unpainted_checks;
+  GstBuffer *hidden_buffer;
+
+  /* with lazy-upload or batch-upload, the last frame waits in
+   * deferred_buffer until the stage is about to be painted. With
+   * lazy-upload, it's only uploaded if the texture was painted since the
+   * previous upload. Only used from the Clutter thread */
+  gboolean lazy_upload;
+  gboolean batch_upload;
+  GstBuffer *deferred_buffer;
+  gboolean deferred;
+  gboolean lazy_painted;
+
   GstVideoCropMeta crop_meta;
   gboolean has_crop_meta;
   gboolean crop_meta_has_changed;
@@ -519,6 +571,141 @@ on_stage_allocation_changed (ClutterStage * stage,
   clutter_actor_set_size (CLUTTER_ACTOR (priv->texture), width, height);
 }
 
+/*
+ * Deferred uploads
+ *
+ * Uploading a frame is wasted when the texture isn't painted afterwards:
+ * the stage is minimized or the texture is culled. With lazy-upload,
+ * dispatching a frame only keeps it and queues a redraw of the texture. The
+ * frame is uploaded right before the stage is painted, if the texture was
+ * painted with the previous frame. Otherwise it waits for the texture to be
+ * painted, once more with the previous frame.
+ *
+ * With batch-upload, frames are also uploaded right before the stage is
+ * painted, whether the texture was painted or not. The sinks of the process
+ * share a single pre-paint function, so the frames of all the streams are
+ * uploaded together and the stage is painted once per frame for all of
+ * them, instead of each sink uploading whenever its frames come in.
+ */
+
+/* the sinks with a deferred frame, only used from the Clutter thread */
+static GList *deferred_sinks = NULL;
+static guint deferred_upload_id = 0;
+
+/* Returns whether the frame of @sink still has to wait */
+static gboolean
+clutter_gst_video_sink_upload_deferred (ClutterGstVideoSink * sink)
+{
+  ClutterGstVideoSinkPrivate *priv = sink->priv;
+  GstBuffer *buffer;
+
+  if (priv->deferred_buffer == NULL || priv->texture == NULL)
+    return FALSE;
+
+  if (priv->lazy_upload && (!priv->lazy_painted ||
+          !CLUTTER_ACTOR_IS_MAPPED (CLUTTER_ACTOR (priv->texture))))
+    return TRUE;
+
+  buffer = priv->deferred_buffer;
+  priv->deferred_buffer = NULL;
+  priv->lazy_painted = FALSE;
+
+  GST_LOG_OBJECT (sink, "uploading buffer %p before paint", buffer);
+
+  if (!priv->renderer->upload (sink, buffer)) {
+    GST_WARNING_OBJECT (sink, "Failed to upload buffer");
+    priv->flow_ret = GST_FLOW_ERROR;
+  }
+  gst_buffer_unref (buffer);
+  priv->uploaded = TRUE;
+
+  return FALSE;
+}
+
+static gboolean
+clutter_gst_upload_deferred_frames (gpointer data)
+{
+  GList *l, *next;
+
+  for (l = deferred_sinks; l; l = next) {
+    ClutterGstVideoSink *sink = l->data;
+
+    next = g_list_next (l);
+
+    if (!clutter_gst_video_sink_upload_deferred (sink)) {
+      sink->priv->deferred = FALSE;
+      deferred_sinks = g_list_delete_link (deferred_sinks, l);
+    }
+  }
+
+  if (deferred_sinks)
+    return TRUE;
+
+  deferred_upload_id = 0;
+  return FALSE;
+}
+
+static void
+clutter_gst_video_sink_defer_upload (ClutterGstVideoSink * sink,
+    GstBuffer * buffer)
+{
+  ClutterGstVideoSinkPrivate *priv = sink->priv;
+
+  gst_buffer_replace (&priv->deferred_buffer, buffer);
+
+  if (!priv->deferred) {
+    priv->deferred = TRUE;
+    deferred_sinks = g_list_prepend (deferred_sinks, sink);
+  }
+
+  if (deferred_upload_id == 0)
+    deferred_upload_id =
+        clutter_threads_add_repaint_func_full (CLUTTER_REPAINT_FLAGS_PRE_PAINT,
+        clutter_gst_upload_deferred_frames, NULL, NULL);
+
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (priv->texture));
+}
+
+static void
+clutter_gst_video_sink_clear_deferred_upload (ClutterGstVideoSink * sink)
+{
+  ClutterGstVideoSinkPrivate *priv = sink->priv;
+
+  if (priv->deferred) {
+    priv->deferred = FALSE;
+    deferred_sinks = g_list_remove (deferred_sinks, sink);
+
+    if (deferred_sinks == NULL && deferred_upload_id) {
+      clutter_threads_remove_repaint_func (deferred_upload_id);
+      deferred_upload_id = 0;
+    }
+  }
+
+  gst_buffer_replace (&priv->deferred_buffer, NULL);
+}
+
+/* shows the deferred frame right away, when neither lazy-upload nor
+ * batch-upload are set anymore */
+static void
+clutter_gst_video_sink_flush_deferred_upload (ClutterGstVideoSink * sink)
+{
+  ClutterGstVideoSinkPrivate *priv = sink->priv;
+  GstBuffer *buffer;
+
+  if (priv->lazy_upload || priv->batch_upload)
+    return;
+
+  buffer = priv->deferred_buffer;
+  priv->deferred_buffer = NULL;
+  clutter_gst_video_sink_clear_deferred_upload (sink);
+
+  if (buffer) {
+    if (priv->renderer && priv->texture)
+      priv->renderer->upload (sink, buffer);
+    gst_buffer_unref (buffer);
+  }
+}
+
 static gboolean
 clutter_gst_source_dispatch (GSource * source,
     GSourceFunc callback, gpointer user_data)
@@ -528,6 +715,7 @@ clutter_gst_source_dispatch (GSource * source,
   ClutterGstSource *gst_source = (ClutterGstSource *) source;
   ClutterGstVideoSinkPrivate *priv = gst_source->sink->priv;
   GstBuffer *buffer;
+  gboolean new_caps = FALSE;
 
   GST_DEBUG ("In dispatch");
 
@@ -618,6 +806,10 @@ clutter_gst_source_dispatch (GSource * source,
 
     priv->renderer->init (gst_source->sink);
     gst_source->has_new_caps = FALSE;
+    new_caps = TRUE;
+
+    /* the frame waiting for the texture to be painted is out of date */
+    clutter_gst_video_sink_clear_deferred_upload (gst_source->sink);
 
     ensure_texture_pixel_aspect_ratio (gst_source->sink);
   }
@@ -629,10 +821,23 @@ clutter_gst_source_dispatch (GSource * source,
 
   g_mutex_unlock (&gst_source->buffer_lock);
 
-  if (buffer) {
+  if (buffer && priv->hidden) {
+    /* nobody would see it, keep it for when the texture is shown again */
+    GST_LOG_OBJECT (gst_source->sink, "texture hidden, not uploading");
+    gst_buffer_replace (&priv->hidden_buffer, buffer);
+    gst_buffer_unref (buffer);
+  } else if (buffer && (priv->lazy_upload || priv->batch_upload) &&
+      !new_caps) {
+    /* the first frame with new caps gives the texture its size, it can't
+     * wait for the texture to be painted */
+    GST_LOG_OBJECT (gst_source->sink, "deferring the upload");
+    clutter_gst_video_sink_defer_upload (gst_source->sink, buffer);
+    gst_buffer_unref (buffer);
+  } else if (buffer) {
     if (!priv->renderer->upload (gst_source->sink, buffer))
       goto fail_upload;
     gst_buffer_unref (buffer);
+    priv->uploaded = TRUE;
   } else
     GST_WARNING_OBJECT (gst_source->sink, "No buffers available for display");
 
@@ -921,6 +1126,7 @@ static ClutterGstRenderer rgb24_renderer = {
   "RGB 24",
   CLUTTER_GST_RGB24,
   0,
+  24,
   GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE ("{ RGB, BGR }")),
   NULL,
   clutter_gst_rgb_init,
@@ -974,6 +1180,7 @@ static ClutterGstRenderer rgb32_renderer = {
   "RGB 32",
   CLUTTER_GST_RGB32,
   0,
+  32,
   GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE ("{ RGBA, BGRA }")),
   NULL,
   clutter_gst_rgb_init,
@@ -1034,6 +1241,7 @@ static ClutterGstRenderer yv12_glsl_renderer = {
   "YV12 glsl",
   CLUTTER_GST_YV12,
   CLUTTER_GST_GLSL | CLUTTER_GST_MULTI_TEXTURE,
+  12,
   GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE ("YV12")),
   NULL,
   clutter_gst_yv12_glsl_init,
@@ -1112,6 +1320,7 @@ static ClutterGstRenderer nv12_glsl_renderer = {
   "NV12 glsl",
   CLUTTER_GST_NV12,
   CLUTTER_GST_GLSL | CLUTTER_GST_MULTI_TEXTURE,
+  12,
   GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE ("NV12")),
   NULL,
   clutter_gst_nv12_glsl_init,
@@ -1141,6 +1350,7 @@ static ClutterGstRenderer yv12_fp_renderer = {
   "YV12 fp",
   CLUTTER_GST_YV12,
   CLUTTER_GST_FP | CLUTTER_GST_MULTI_TEXTURE,
+  12,
   GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE ("YV12")),
   NULL,
   clutter_gst_yv12_fp_init,
@@ -1166,6 +1376,7 @@ static ClutterGstRenderer i420_glsl_renderer = {
   "I420 glsl",
   CLUTTER_GST_I420,
   CLUTTER_GST_GLSL | CLUTTER_GST_MULTI_TEXTURE,
+  12,
   GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE ("I420")),
   NULL,
   clutter_gst_i420_glsl_init,
@@ -1196,6 +1407,7 @@ static ClutterGstRenderer i420_fp_renderer = {
   "I420 fp",
   CLUTTER_GST_I420,
   CLUTTER_GST_FP | CLUTTER_GST_MULTI_TEXTURE,
+  12,
   GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE ("I420")),
   NULL,
   clutter_gst_i420_fp_init,
@@ -1255,6 +1467,7 @@ static ClutterGstRenderer ayuv_glsl_renderer = {
   "AYUV glsl",
   CLUTTER_GST_AYUV,
   CLUTTER_GST_GLSL,
+  32,
   GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE ("AYUV")),
   NULL,
   clutter_gst_ayuv_glsl_init,
@@ -1417,6 +1630,7 @@ static ClutterGstRenderer hw_renderer = {
   "HW surface",
   CLUTTER_GST_SURFACE,
   0,
+  0,
   GST_STATIC_CAPS ("video/x-surface, opengl=true"),
   NULL,
   clutter_gst_hw_init,
@@ -1558,6 +1772,7 @@ static ClutterGstRenderer gl_texture_upload_renderer = {
     "GL Texture upload renderer",
     CLUTTER_GST_GL_TEXTURE_UPLOAD,
     0,
+    0,
     GST_STATIC_CAPS (GL_SINK_CAPS),
     NULL,
     clutter_gst_gl_texture_upload_init,
@@ -1566,6 +1781,13 @@ static ClutterGstRenderer gl_texture_upload_renderer = {
 };
 #endif
 
+static gint
+compare_renderer_cost (const ClutterGstRenderer * a,
+    const ClutterGstRenderer * b)
+{
+  return a->cost - b->cost;
+}
+
 static GSList *
 clutter_gst_build_renderers_list (void)
 {
@@ -1575,7 +1797,8 @@ clutter_gst_build_renderers_list (void)
   /* The order of the list of renderers is important. They will be prepended
    * to a GSList and we'll iterate over that list to choose the first matching
    * renderer. Thus if you want to use the fp renderer over the glsl one, the
-   * fp renderer has to be put after the glsl one in this array */
+   * fp renderer has to be put after the glsl one in this array. The list is
+   * then sorted by cost, renderers of the same cost keep that order */
   ClutterGstRenderer *renderers[] = {
     &rgb24_renderer,
     &rgb32_renderer,
@@ -1618,7 +1841,9 @@ clutter_gst_build_renderers_list (void)
       list = g_slist_prepend (list, renderers[i]);
   }
 
-  return list;
+  /* the caps of the sink follow the order of the list, so that upstream
+   * picks the cheapest format to render first */
+  return g_slist_sort (list, (GCompareFunc) compare_renderer_cost);
 }
 
 static void
@@ -1775,9 +2000,30 @@ static GstCaps *
 clutter_gst_video_sink_get_caps (GstBaseSink * bsink, GstCaps * filter)
 {
   ClutterGstVideoSink *sink;
+  ClutterGstVideoSinkPrivate *priv;
+  gint max_width, max_height;
+  GstCaps *caps;
 
   sink = CLUTTER_GST_VIDEO_SINK (bsink);
-  return gst_caps_ref (sink->priv->caps);
+  priv = sink->priv;
+
+  GST_OBJECT_LOCK (sink);
+  max_width = priv->max_width;
+  max_height = priv->max_height;
+  GST_OBJECT_UNLOCK (sink);
+
+  if (max_width == 0 || max_height == 0)
+    return gst_caps_ref (priv->caps);
+
+  /* frames no larger than the texture first, the upstream elements that
+   * can't scale still get to negotiate their size */
+  caps = gst_caps_copy (priv->caps);
+  gst_caps_set_simple (caps,
+      "width", GST_TYPE_INT_RANGE, 1, max_width,
+      "height", GST_TYPE_INT_RANGE, 1, max_height, NULL);
+  gst_caps_append (caps, gst_caps_copy (priv->caps));
+
+  return caps;
 }
 
 static gboolean
@@ -1800,6 +2046,347 @@ clutter_gst_video_sink_set_caps (GstBaseSink * bsink, GstCaps * caps)
 }
 
 
+/*
+ * When shown smaller than the frames, the texture doesn't need that many
+ * pixels. The caps of the sink are restricted to the size the texture has
+ * on the stage and upstream is asked to renegotiate, so that a scaler, or
+ * a decoder that can scale, makes smaller frames. Less is uploaded to the
+ * GPU, and less memory is used by the frames in flight.
+ *
+ * When the size of the texture follows the size of the frames, that would
+ * shrink the texture, so the texture needs a size of its own.
+ */
+static gboolean
+clutter_gst_video_sink_texture_has_own_size (ClutterTexture * texture)
+{
+  gboolean width_set, height_set;
+
+  if (!clutter_texture_get_sync_size (texture))
+    return TRUE;
+
+  g_object_get (texture,
+      "natural-width-set", &width_set,
+      "natural-height-set", &height_set, NULL);
+
+  return width_set && height_set;
+}
+
+static gboolean
+clutter_gst_video_sink_adapt (gpointer data)
+{
+  ClutterGstVideoSink *sink = CLUTTER_GST_VIDEO_SINK (data);
+  ClutterGstVideoSinkPrivate *priv = sink->priv;
+  gint max_width = 0, max_height = 0;
+  gboolean changed;
+
+  priv->adapt_id = 0;
+
+  /* nothing to learn from a texture that isn't on the stage */
+  if (priv->texture && priv->adapt_to_allocation &&
+      !CLUTTER_ACTOR_IS_MAPPED (priv->texture))
+    return FALSE;
+
+  if (priv->texture && priv->adapt_to_allocation &&
+      clutter_gst_video_sink_texture_has_own_size (priv->texture)) {
+    gfloat width, height;
+
+    clutter_actor_get_transformed_size (CLUTTER_ACTOR (priv->texture),
+        &width, &height);
+
+    if (width >= 1.0 && height >= 1.0) {
+      max_width = ((gint) width + CLUTTER_GST_ADAPT_ROUNDING - 1) /
+          CLUTTER_GST_ADAPT_ROUNDING * CLUTTER_GST_ADAPT_ROUNDING;
+      max_height = ((gint) height + CLUTTER_GST_ADAPT_ROUNDING - 1) /
+          CLUTTER_GST_ADAPT_ROUNDING * CLUTTER_GST_ADAPT_ROUNDING;
+    }
+  }
+
+  GST_OBJECT_LOCK (sink);
+  changed = priv->max_width != max_width || priv->max_height != max_height;
+  priv->max_width = max_width;
+  priv->max_height = max_height;
+  GST_OBJECT_UNLOCK (sink);
+
+  if (changed) {
+    GST_DEBUG_OBJECT (sink, "asking upstream for frames up to %dx%d",
+        max_width, max_height);
+    gst_pad_push_event (GST_BASE_SINK_PAD (sink), gst_event_new_reconfigure ());
+  }
+
+  return FALSE;
+}
+
+static void
+clutter_gst_video_sink_schedule_adapt (ClutterGstVideoSink * sink)
+{
+  ClutterGstVideoSinkPrivate *priv = sink->priv;
+
+  if (priv->adapt_id)
+    g_source_remove (priv->adapt_id);
+
+  priv->adapt_id = g_timeout_add (CLUTTER_GST_ADAPT_DELAY,
+      clutter_gst_video_sink_adapt, sink);
+}
+
+static void
+clutter_gst_video_sink_set_adapt_to_allocation (ClutterGstVideoSink * sink,
+    gboolean adapt)
+{
+  ClutterGstVideoSinkPrivate *priv = sink->priv;
+
+  if (priv->adapt_to_allocation == adapt)
+    return;
+
+  priv->adapt_to_allocation = adapt;
+
+  if (priv->adapt_id) {
+    g_source_remove (priv->adapt_id);
+    priv->adapt_id = 0;
+  }
+
+  clutter_gst_video_sink_adapt (sink);
+}
+
+/*
+ * A texture nobody sees doesn't need its frames. It's hidden when it's not
+ * mapped or fully transparent, or when frames are uploaded into it but it
+ * isn't painted: it's culled by Clutter, out of the stage or of the clip of
+ * its parents, or the stage itself isn't painted. While hidden, frames
+ * aren't uploaded. After a while, upstream is throttled so that decoders
+ * skip frames. The player learns about it through an element message, and
+ * can go further and stop decoding the video.
+ */
+static void
+clutter_gst_video_sink_update_throttle_time (ClutterGstVideoSink * sink)
+{
+  ClutterGstVideoSinkPrivate *priv = sink->priv;
+  guint64 throttle_time = 0;
+
+  GST_OBJECT_LOCK (sink);
+  if (priv->max_fps > 0.0)
+    throttle_time = GST_SECOND / priv->max_fps;
+  GST_OBJECT_UNLOCK (sink);
+
+  if (priv->hidden_throttled)
+    throttle_time = MAX (throttle_time, CLUTTER_GST_THROTTLE_TIME);
+
+  /* basesink drops the frames that come too early, and sends a throttle
+   * QoS event upstream so that they're not decoded in the first place */
+  gst_base_sink_set_throttle_time (GST_BASE_SINK (sink), throttle_time);
+}
+
+static void
+clutter_gst_video_sink_set_hidden (ClutterGstVideoSink * sink,
+    gboolean hidden)
+{
+  ClutterGstVideoSinkPrivate *priv = sink->priv;
+  GstStructure *structure;
+  GstBuffer *buffer;
+
+  if (priv->hidden == hidden)
+    return;
+
+  GST_DEBUG_OBJECT (sink, "texture %s", hidden ? "hidden" : "shown");
+
+  priv->hidden = hidden;
+  priv->hidden_since = g_get_monotonic_time ();
+  priv->unpainted_checks = 0;
+
+  if (!hidden) {
+    if (priv->hidden_throttled) {
+      priv->hidden_throttled = FALSE;
+      clutter_gst_video_sink_update_throttle_time (sink);
+    }
+
+    /* catch up with the last frame we got */
+    buffer = priv->hidden_buffer;
+    priv->hidden_buffer = NULL;
+    if (buffer) {
+      if (priv->renderer && priv->texture)
+        priv->renderer->upload (sink, buffer);
+      gst_buffer_unref (buffer);
+    }
+  }
+
+  structure = gst_structure_new ("clutter-gst-visibility",
+      "visible", G_TYPE_BOOLEAN, !hidden, NULL);
+  gst_element_post_message (GST_ELEMENT (sink),
+      gst_message_new_element (GST_OBJECT (sink), structure));
+}
+
+static void
+clutter_gst_video_sink_check_visibility (ClutterGstVideoSink * sink)
+{
+  ClutterGstVideoSinkPrivate *priv = sink->priv;
+  ClutterActor *actor;
+  gboolean hidden;
+
+  if (priv->texture == NULL)
+    return;
+
+  actor = CLUTTER_ACTOR (priv->texture);
+
+  if (!CLUTTER_ACTOR_IS_MAPPED (actor) ||
+      clutter_actor_get_paint_opacity (actor) == 0) {
+    hidden = TRUE;
+  } else if (priv->painted) {
+    hidden = FALSE;
+    priv->unpainted_checks = 0;
+  } else {
+    /* a frame uploaded at the end of a check is painted during the next
+     * one, wait for a second check without a paint */
+    if (priv->uploaded)
+      priv->unpainted_checks++;
+    hidden = priv->hidden || priv->unpainted_checks >= 2;
+  }
+
+  priv->painted = FALSE;
+  priv->uploaded = FALSE;
+
+  clutter_gst_video_sink_set_hidden (sink, hidden);
+
+  if (priv->hidden && !priv->hidden_throttled &&
+      g_get_monotonic_time () - priv->hidden_since >=
+      CLUTTER_GST_THROTTLE_DELAY * 1000) {
+    GST_DEBUG_OBJECT (sink, "throttling upstream");
+    priv->hidden_throttled = TRUE;
+    clutter_gst_video_sink_update_throttle_time (sink);
+  }
+}
+
+static gboolean
+clutter_gst_video_sink_visibility_timeout (gpointer data)
+{
+  clutter_gst_video_sink_check_visibility (CLUTTER_GST_VIDEO_SINK (data));
+
+  return TRUE;
+}
+
+static gboolean
+clutter_gst_video_sink_visibility_idle (gpointer data)
+{
+  ClutterGstVideoSink *sink = CLUTTER_GST_VIDEO_SINK (data);
+
+  sink->priv->visibility_idle_id = 0;
+  clutter_gst_video_sink_check_visibility (sink);
+
+  return FALSE;
+}
+
+/* a hidden texture that gets painted or mapped is shown right away */
+static void
+clutter_gst_video_sink_texture_painted (ClutterGstVideoSink * sink)
+{
+  ClutterGstVideoSinkPrivate *priv = sink->priv;
+
+  priv->painted = TRUE;
+  priv->lazy_painted = TRUE;
+
+  if (priv->hidden && priv->throttle_hidden && priv->visibility_idle_id == 0)
+    priv->visibility_idle_id =
+        g_idle_add (clutter_gst_video_sink_visibility_idle, sink);
+
+  /* painted with an old frame, upload the new one before the next paint */
+  if (priv->deferred_buffer)
+    clutter_actor_queue_redraw (CLUTTER_ACTOR (priv->texture));
+}
+
+static void
+clutter_gst_video_sink_texture_mapped (ClutterGstVideoSink * sink)
+{
+  ClutterGstVideoSinkPrivate *priv = sink->priv;
+
+  if (priv->throttle_hidden && priv->visibility_idle_id == 0)
+    priv->visibility_idle_id =
+        g_idle_add (clutter_gst_video_sink_visibility_idle, sink);
+}
+
+static void
+clutter_gst_video_sink_update_visibility_check (ClutterGstVideoSink * sink)
+{
+  ClutterGstVideoSinkPrivate *priv = sink->priv;
+
+  if (priv->throttle_hidden && priv->texture) {
+    if (priv->visibility_id == 0)
+      priv->visibility_id = g_timeout_add (CLUTTER_GST_VISIBILITY_INTERVAL,
+          clutter_gst_video_sink_visibility_timeout, sink);
+    return;
+  }
+
+  if (priv->visibility_id) {
+    g_source_remove (priv->visibility_id);
+    priv->visibility_id = 0;
+  }
+
+  if (priv->visibility_idle_id) {
+    g_source_remove (priv->visibility_idle_id);
+    priv->visibility_idle_id = 0;
+  }
+
+  clutter_gst_video_sink_set_hidden (sink, FALSE);
+}
+
+static void
+clutter_gst_video_sink_set_max_fps (ClutterGstVideoSink * sink,
+    gdouble max_fps)
+{
+  ClutterGstVideoSinkPrivate *priv = sink->priv;
+
+  GST_OBJECT_LOCK (sink);
+  if (priv->max_fps == max_fps) {
+    GST_OBJECT_UNLOCK (sink);
+    return;
+  }
+  priv->max_fps = max_fps;
+  GST_OBJECT_UNLOCK (sink);
+
+  GST_DEBUG_OBJECT (sink, "rendering at most %f frames per second", max_fps);
+
+  clutter_gst_video_sink_update_throttle_time (sink);
+}
+
+static void
+clutter_gst_video_sink_set_lazy_upload (ClutterGstVideoSink * sink,
+    gboolean lazy)
+{
+  ClutterGstVideoSinkPrivate *priv = sink->priv;
+
+  if (priv->lazy_upload == lazy)
+    return;
+
+  priv->lazy_upload = lazy;
+
+  clutter_gst_video_sink_flush_deferred_upload (sink);
+}
+
+static void
+clutter_gst_video_sink_set_batch_upload (ClutterGstVideoSink * sink,
+    gboolean batch)
+{
+  ClutterGstVideoSinkPrivate *priv = sink->priv;
+
+  if (priv->batch_upload == batch)
+    return;
+
+  priv->batch_upload = batch;
+
+  clutter_gst_video_sink_flush_deferred_upload (sink);
+}
+
+static void
+clutter_gst_video_sink_set_throttle_hidden (ClutterGstVideoSink * sink,
+    gboolean throttle)
+{
+  ClutterGstVideoSinkPrivate *priv = sink->priv;
+
+  if (priv->throttle_hidden == throttle)
+    return;
+
+  priv->throttle_hidden = throttle;
+
+  clutter_gst_video_sink_update_visibility_check (sink);
+}
+
 static void
 clutter_gst_video_sink_dispose (GObject * object)
 {
@@ -1822,6 +2409,24 @@ clutter_gst_video_sink_dispose (GObject * object)
   if (priv->texture)
     clutter_gst_video_sink_set_texture (self, NULL);
 
+  if (priv->adapt_id) {
+    g_source_remove (priv->adapt_id);
+    priv->adapt_id = 0;
+  }
+
+  if (priv->visibility_id) {
+    g_source_remove (priv->visibility_id);
+    priv->visibility_id = 0;
+  }
+
+  if (priv->visibility_idle_id) {
+    g_source_remove (priv->visibility_idle_id);
+    priv->visibility_idle_id = 0;
+  }
+
+  gst_buffer_replace (&priv->hidden_buffer, NULL);
+  clutter_gst_video_sink_clear_deferred_upload (self);
+
   if (priv->caps) {
     gst_caps_unref (priv->caps);
     priv->caps = NULL;
@@ -1857,6 +2462,13 @@ clutter_gst_video_sink_set_texture (ClutterGstVideoSink * sink,
     "button-release-event",
     "motion-event"
   };
+  /* what changes the size of the texture on the stage */
+  const char const *size_notifies[] = {
+    "notify::allocation",
+    "notify::scale-x",
+    "notify::scale-y",
+    "notify::mapped"
+  };
   ClutterGstVideoSinkPrivate *priv = sink->priv;
   guint i;
 
@@ -1872,8 +2484,10 @@ clutter_gst_video_sink_set_texture (ClutterGstVideoSink * sink,
   }
 
   priv->texture = texture;
-  if (priv->texture == NULL)
+  if (priv->texture == NULL) {
+    clutter_gst_video_sink_update_visibility_check (sink);
     return;
+  }
 
   clutter_actor_set_reactive (CLUTTER_ACTOR (priv->texture), TRUE);
   g_object_add_weak_pointer (G_OBJECT (priv->texture),
@@ -1885,6 +2499,28 @@ clutter_gst_video_sink_set_texture (ClutterGstVideoSink * sink,
         G_CALLBACK (navigation_event), sink);
     g_array_append_val (priv->signal_handler_ids, id);
   }
+
+  for (i = 0; i < G_N_ELEMENTS (size_notifies); i++) {
+    gulong id;
+    id = g_signal_connect_swapped (priv->texture, size_notifies[i],
+        G_CALLBACK (clutter_gst_video_sink_schedule_adapt), sink);
+    g_array_append_val (priv->signal_handler_ids, id);
+  }
+
+  {
+    gulong id;
+    id = g_signal_connect_swapped (priv->texture, "paint",
+        G_CALLBACK (clutter_gst_video_sink_texture_painted), sink);
+    g_array_append_val (priv->signal_handler_ids, id);
+    id = g_signal_connect_swapped (priv->texture, "notify::mapped",
+        G_CALLBACK (clutter_gst_video_sink_texture_mapped), sink);
+    g_array_append_val (priv->signal_handler_ids, id);
+  }
+
+  if (priv->adapt_to_allocation)
+    clutter_gst_video_sink_schedule_adapt (sink);
+
+  clutter_gst_video_sink_update_visibility_check (sink);
 }
 
 static void
@@ -1900,6 +2536,25 @@ clutter_gst_video_sink_set_property (GObject * object,
     case PROP_UPDATE_PRIORITY:
       clutter_gst_video_sink_set_priority (sink, g_value_get_int (value));
       break;
+    case PROP_ADAPT_TO_ALLOCATION:
+      clutter_gst_video_sink_set_adapt_to_allocation (sink,
+          g_value_get_boolean (value));
+      break;
+    case PROP_THROTTLE_HIDDEN:
+      clutter_gst_video_sink_set_throttle_hidden (sink,
+          g_value_get_boolean (value));
+      break;
+    case PROP_MAX_FPS:
+      clutter_gst_video_sink_set_max_fps (sink, g_value_get_double (value));
+      break;
+    case PROP_LAZY_UPLOAD:
+      clutter_gst_video_sink_set_lazy_upload (sink,
+          g_value_get_boolean (value));
+      break;
+    case PROP_BATCH_UPLOAD:
+      clutter_gst_video_sink_set_batch_upload (sink,
+          g_value_get_boolean (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1920,6 +2575,23 @@ clutter_gst_video_sink_get_property (GObject * object,
     case PROP_UPDATE_PRIORITY:
       g_value_set_int (value, priv->priority);
       break;
+    case PROP_ADAPT_TO_ALLOCATION:
+      g_value_set_boolean (value, priv->adapt_to_allocation);
+      break;
+    case PROP_THROTTLE_HIDDEN:
+      g_value_set_boolean (value, priv->throttle_hidden);
+      break;
+    case PROP_MAX_FPS:
+      GST_OBJECT_LOCK (sink);
+      g_value_set_double (value, priv->max_fps);
+      GST_OBJECT_UNLOCK (sink);
+      break;
+    case PROP_LAZY_UPLOAD:
+      g_value_set_boolean (value, priv->lazy_upload);
+      break;
+    case PROP_BATCH_UPLOAD:
+      g_value_set_boolean (value, priv->batch_upload);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1960,6 +2632,33 @@ clutter_gst_video_sink_stop (GstBaseSink * base_sink)
   return TRUE;
 }
 
+/*
+ * Shows @buffer as if it had just been rendered. The player uses that to
+ * show decoded frames it keeps around, @buffer must match the current caps
+ * of the sink.
+ */
+void
+_clutter_gst_video_sink_show_buffer (GstElement * element, GstBuffer * buffer)
+{
+  ClutterGstVideoSink *sink = CLUTTER_GST_VIDEO_SINK (element);
+  ClutterGstVideoSinkPrivate *priv = sink->priv;
+  ClutterGstSource *gst_source = priv->source;
+
+  if (gst_source == NULL)
+    return;
+
+  g_mutex_lock (&gst_source->buffer_lock);
+
+  if (gst_source->buffer)
+    gst_buffer_unref (gst_source->buffer);
+  GST_DEBUG_OBJECT (sink, "Showing buffer %p", buffer);
+  gst_source->buffer = gst_buffer_ref (buffer);
+
+  g_mutex_unlock (&gst_source->buffer_lock);
+
+  g_main_context_wakeup (priv->clutter_main_context);
+}
+
 static inline CoglRenderer *
 _clutter_gst_get_cogl_renderer (ClutterGstVideoSink *sink)
 {
@@ -2166,6 +2865,92 @@ clutter_gst_video_sink_class_init (ClutterGstVideoSinkClass * klass)
       -G_MAXINT, G_MAXINT,
       CLUTTER_GST_DEFAULT_PRIORITY, CLUTTER_GST_PARAM_READWRITE);
   g_object_class_install_property (gobject_class, PROP_UPDATE_PRIORITY, pspec);
+
+  /**
+   * ClutterGstVideoSink:adapt-to-allocation:
+   *
+   * Whether to ask upstream for frames no larger than the size the texture
+   * has on the stage, once that size has settled. Only the elements that
+   * can scale, videoscale or some decoders, make smaller frames, the
+   * others keep negotiating their size. The texture needs a size of its
+   * own, that is a size set on it or #ClutterTexture:sync-size set to
+   * %FALSE, otherwise it'd shrink with the frames.
+   *
+   * Since: 2.2
+   */
+  pspec = g_param_spec_boolean ("adapt-to-allocation",
+      "Adapt to allocation",
+      "Whether to ask for frames no larger than the texture on the stage",
+      FALSE, CLUTTER_GST_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class, PROP_ADAPT_TO_ALLOCATION,
+      pspec);
+
+  /**
+   * ClutterGstVideoSink:throttle-hidden:
+   *
+   * Whether to stop uploading frames while the texture is hidden, that is
+   * not mapped, fully transparent, or not painted by Clutter. When it stays
+   * hidden, upstream is throttled to one frame per second. The sink posts
+   * a "clutter-gst-visibility" element message, with a "visible" boolean
+   * field, when the texture gets hidden or shown.
+   *
+   * Since: 2.2
+   */
+  pspec = g_param_spec_boolean ("throttle-hidden",
+      "Throttle hidden",
+      "Whether to skip frames while the texture is hidden",
+      FALSE, CLUTTER_GST_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class, PROP_THROTTLE_HIDDEN,
+      pspec);
+
+  /**
+   * ClutterGstVideoSink:max-fps:
+   *
+   * The highest number of frames per second to render, 0 to render them
+   * all. The other frames are dropped before they're mapped and uploaded,
+   * and upstream is sent throttle QoS events so that decoders can skip
+   * them too.
+   *
+   * Since: 2.2
+   */
+  pspec = g_param_spec_double ("max-fps",
+      "Maximum frame rate",
+      "The highest number of frames per second to render (0 = unlimited)",
+      0.0, G_MAXDOUBLE, 0.0, CLUTTER_GST_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class, PROP_MAX_FPS, pspec);
+
+  /**
+   * ClutterGstVideoSink:lazy-upload:
+   *
+   * Whether to upload frames right before the stage is painted, and only
+   * when the texture was painted with the previous frame, instead of as
+   * soon as they're rendered. Frames of a texture that isn't painted are
+   * never uploaded.
+   *
+   * Since: 2.2
+   */
+  pspec = g_param_spec_boolean ("lazy-upload",
+      "Lazy upload",
+      "Whether to upload frames only when the texture is painted",
+      FALSE, CLUTTER_GST_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class, PROP_LAZY_UPLOAD, pspec);
+
+  /**
+   * ClutterGstVideoSink:batch-upload:
+   *
+   * Whether to upload frames right before the stage is painted, together
+   * with the frames of the other sinks doing so, instead of as soon as
+   * they're rendered. With many streams playing, the stage is then painted
+   * once per frame for all of them.
+   *
+   * Since: 2.2
+   */
+  pspec = g_param_spec_boolean ("batch-upload",
+      "Batch upload",
+      "Whether to upload frames together with the other sinks, right "
+      "before the stage is painted",
+      FALSE, CLUTTER_GST_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class, PROP_BATCH_UPLOAD, pspec);
 }
 
 static void
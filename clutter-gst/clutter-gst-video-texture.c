@@ -73,7 +73,7 @@ struct _ClutterGstVideoTexturePrivate
 };
 
 enum {
-  PROP_0 = 32,  /* Avoid overlap with player properties */
+  PROP_0 = 64,  /* Avoid overlap with player properties */
 
   PROP_IDLE_MATERIAL,
   PROP_PAR
@@ -37,5 +37,7 @@
 #include "clutter-gst-util.h"
 #include "clutter-gst-version.h"
 #include "clutter-gst-player.h"
+#include "clutter-gst-media-info.h"
+#include "clutter-gst-thumbnailer.h"
 
 #endif /* __CLUTTER_GST_H__ */
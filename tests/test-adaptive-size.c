@@ -0,0 +1,270 @@
+/*
+ * Clutter-GStreamer.
+ *
+ * GStreamer integration library for Clutter.
+ *
+ * test-adaptive-size.c - Serve a HLS stream with a 1080p and a 180p variant
+ *                        from a local HTTP server, play it in a small
+ *                        player then in a large one, and check which
+ *                        variant gets downloaded. The HLS demuxer has to
+ *                        take the max-video-width and max-video-height
+ *                        properties.
+ *
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <gio/gio.h>
+#include <clutter/clutter.h>
+#include <clutter-gst/clutter-gst.h>
+
+#include "test-http-server.h"
+
+/* number of fragments of each variant */
+#define N_FRAGMENTS       10
+/* the player is made large once that many fragments have been fetched */
+#define N_SMALL_FRAGMENTS 3
+
+static GMappedFile *segment;
+static gint fragment_duration = 2;
+
+static ClutterActor *video;
+
+/* fragments of each variant fetched while the player is small and large,
+ * only touched with atomic operations, the server runs in its own threads */
+static volatile gint small_high, small_low;
+static volatile gint large_high, large_low;
+static volatile gint is_large;
+
+static gchar *
+make_master_playlist (void)
+{
+  /* the high variant comes first, it's the one picked without a cap */
+  return g_strdup ("#EXTM3U\n"
+                   "#EXT-X-STREAM-INF:PROGRAM-ID=1,BANDWIDTH=5000000,"
+                   "RESOLUTION=1920x1080\n"
+                   "high.m3u8\n"
+                   "#EXT-X-STREAM-INF:PROGRAM-ID=1,BANDWIDTH=200000,"
+                   "RESOLUTION=320x180\n"
+                   "low.m3u8\n");
+}
+
+static gchar *
+make_media_playlist (const gchar *variant)
+{
+  GString *playlist;
+  gint i;
+
+  playlist = g_string_new ("#EXTM3U\n");
+  g_string_append_printf (playlist,
+                          "#EXT-X-TARGETDURATION:%d\n"
+                          "#EXT-X-MEDIA-SEQUENCE:0\n",
+                          fragment_duration);
+
+  /* every fragment is the same file, their timestamps start over */
+  for (i = 0; i < N_FRAGMENTS; i++)
+    {
+      if (i > 0)
+        g_string_append (playlist, "#EXT-X-DISCONTINUITY\n");
+      g_string_append_printf (playlist, "#EXTINF:%d,\n%s/%d.ts\n",
+                              fragment_duration, variant, i);
+    }
+
+  g_string_append (playlist, "#EXT-X-ENDLIST\n");
+
+  return g_string_free (playlist, FALSE);
+}
+
+static void
+count_fragment (const gchar *path)
+{
+  gboolean high = g_str_has_prefix (path, "/high/");
+
+  if (g_atomic_int_get (&is_large))
+    g_atomic_int_inc (high ? &large_high : &large_low);
+  else
+    g_atomic_int_inc (high ? &small_high : &small_low);
+}
+
+static void
+handle_request (TestHttpRequest *request,
+                GOutputStream   *out,
+                gpointer         user_data)
+{
+  const gchar *data = NULL, *content_type;
+  gchar *headers, *body = NULL;
+  gsize size = 0;
+
+  g_print ("server: %s %s\n", request->method, request->path);
+
+  content_type = "application/vnd.apple.mpegurl";
+  if (strcmp (request->path, "/master.m3u8") == 0)
+    body = make_master_playlist ();
+  else if (strcmp (request->path, "/high.m3u8") == 0)
+    body = make_media_playlist ("high");
+  else if (strcmp (request->path, "/low.m3u8") == 0)
+    body = make_media_playlist ("low");
+  else if (g_str_has_prefix (request->path, "/high/") ||
+           g_str_has_prefix (request->path, "/low/"))
+    {
+      count_fragment (request->path);
+
+      content_type = "video/mp2t";
+      data = g_mapped_file_get_contents (segment);
+      size = g_mapped_file_get_length (segment);
+    }
+
+  if (body)
+    {
+      data = body;
+      size = strlen (body);
+    }
+
+  if (data == NULL)
+    {
+      test_http_respond (request, out, "404 Not Found", NULL, NULL, 0);
+      return;
+    }
+
+  headers = g_strdup_printf ("Content-Type: %s\r\n", content_type);
+  test_http_respond (request, out, "200 OK", headers, data, size);
+
+  g_free (headers);
+  g_free (body);
+}
+
+static gboolean
+check_size (gpointer user_data)
+{
+  gint fetched;
+
+  fetched = g_atomic_int_get (&small_high) + g_atomic_int_get (&small_low);
+  if (fetched < N_SMALL_FRAGMENTS)
+    return TRUE;
+
+  g_print ("making the player large\n");
+
+  g_atomic_int_set (&is_large, TRUE);
+  clutter_actor_set_size (video, 1920, 1080);
+
+  return FALSE;
+}
+
+static void
+on_eos (ClutterMedia *media,
+        gpointer      user_data)
+{
+  g_print ("small player: %d high and %d low fragments\n",
+           g_atomic_int_get (&small_high), g_atomic_int_get (&small_low));
+  g_print ("large player: %d high and %d low fragments\n",
+           g_atomic_int_get (&large_high), g_atomic_int_get (&large_low));
+
+  if (g_atomic_int_get (&small_high) > 0)
+    {
+      g_print ("FAIL: the small player fetched the high variant\n");
+      exit (EXIT_FAILURE);
+    }
+
+  if (g_atomic_int_get (&large_high) == 0)
+    {
+      g_print ("FAIL: the large player didn't switch to the high variant\n");
+      exit (EXIT_FAILURE);
+    }
+
+  g_print ("PASS\n");
+  clutter_main_quit ();
+}
+
+static void
+on_error (ClutterMedia *media,
+          GError       *error,
+          gpointer      user_data)
+{
+  g_print ("error: %s\n", error->message);
+  exit (EXIT_FAILURE);
+}
+
+int
+main (int argc, char *argv[])
+{
+  ClutterInitError init_error;
+  ClutterActor *stage;
+  GError *error = NULL;
+  gchar *uri;
+  guint16 port;
+
+  if (argc < 2)
+    {
+      g_print ("%s mpeg-ts-file [fragment-duration]\n", argv[0]);
+      exit (1);
+    }
+
+  init_error = clutter_gst_init (&argc, &argv);
+  g_assert (init_error == CLUTTER_INIT_SUCCESS);
+
+  segment = g_mapped_file_new (argv[1], FALSE, &error);
+  if (segment == NULL)
+    {
+      g_print ("%s\n", error->message);
+      exit (1);
+    }
+
+  if (argc > 2)
+    fragment_duration = MAX (atoi (argv[2]), 1);
+
+  port = test_http_server_start (handle_request, NULL, &error);
+  if (port == 0)
+    {
+      g_print ("%s\n", error->message);
+      exit (1);
+    }
+
+  uri = g_strdup_printf ("http://127.0.0.1:%u/master.m3u8", port);
+  g_print ("serving %s as %s\n", argv[1], uri);
+
+  stage = clutter_stage_new ();
+
+  video = clutter_gst_video_texture_new ();
+  g_assert (CLUTTER_GST_IS_VIDEO_TEXTURE (video));
+  clutter_actor_set_size (video, 320, 180);
+
+  g_signal_connect (video, "eos", G_CALLBACK (on_eos), NULL);
+  g_signal_connect (video, "error", G_CALLBACK (on_error), NULL);
+
+  clutter_actor_add_child (stage, video);
+  clutter_actor_show (stage);
+
+  /* the player is on the stage, the cap is known before the stream is
+   * opened */
+  clutter_gst_player_set_adapt_streams_to_size (CLUTTER_GST_PLAYER (video),
+                                                TRUE);
+
+  clutter_media_set_uri (CLUTTER_MEDIA (video), uri);
+  clutter_media_set_playing (CLUTTER_MEDIA (video), TRUE);
+
+  g_timeout_add (100, check_size, NULL);
+
+  clutter_main ();
+
+  g_free (uri);
+  g_mapped_file_unref (segment);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,122 @@
+/*
+ * Clutter-GStreamer.
+ *
+ * GStreamer integration library for Clutter.
+ *
+ * test-bus-dispatch.c - Measure the cost of a main loop iteration against
+ *                       the number of players, with a bus source per player
+ *                       and with the shared bus dispatcher.
+ *
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <stdlib.h>
+
+#include <clutter/clutter.h>
+#include <clutter-gst/clutter-gst.h>
+
+/* main loop iterations measured for each number of players */
+#define N_ITERATIONS  10000
+
+static const guint n_players[] = { 1, 16, 64, 256 };
+
+static gboolean
+keep_busy (gpointer data)
+{
+  /* makes g_main_context_iteration() return right away */
+  return TRUE;
+}
+
+static gdouble
+measure (guint        count,
+         const gchar *uri)
+{
+  ClutterActor **players;
+  GTimer *timer;
+  gdouble elapsed;
+  guint i, idle_id;
+
+  players = g_new0 (ClutterActor *, count);
+
+  for (i = 0; i < count; i++)
+    {
+      players[i] = g_object_ref_sink (clutter_gst_video_texture_new ());
+
+      if (uri)
+        {
+          clutter_media_set_audio_volume (CLUTTER_MEDIA (players[i]), 0.0);
+          clutter_media_set_uri (CLUTTER_MEDIA (players[i]), uri);
+          clutter_media_set_playing (CLUTTER_MEDIA (players[i]), TRUE);
+        }
+    }
+
+  idle_id = g_idle_add (keep_busy, NULL);
+
+  /* let the pipelines settle */
+  for (i = 0; i < N_ITERATIONS / 10; i++)
+    g_main_context_iteration (NULL, FALSE);
+
+  timer = g_timer_new ();
+  for (i = 0; i < N_ITERATIONS; i++)
+    g_main_context_iteration (NULL, FALSE);
+  elapsed = g_timer_elapsed (timer, NULL);
+  g_timer_destroy (timer);
+
+  g_source_remove (idle_id);
+
+  for (i = 0; i < count; i++)
+    {
+      clutter_actor_destroy (players[i]);
+      g_object_unref (players[i]);
+    }
+  g_free (players);
+
+  /* in us per iteration */
+  return elapsed * G_USEC_PER_SEC / N_ITERATIONS;
+}
+
+int
+main (int argc, char *argv[])
+{
+  ClutterInitError error;
+  const gchar *uri = NULL;
+  gdouble own, shared;
+  guint i;
+
+  error = clutter_gst_init (&argc, &argv);
+  g_assert (error == CLUTTER_INIT_SUCCESS);
+
+  /* without a media, only the cost of watching the buses is measured */
+  if (argc > 1)
+    uri = argv[1];
+
+  g_print ("%8s %16s %16s\n", "players", "own source", "shared source");
+
+  for (i = 0; i < G_N_ELEMENTS (n_players); i++)
+    {
+      clutter_gst_player_set_shared_bus_dispatch (FALSE);
+      own = measure (n_players[i], uri);
+
+      clutter_gst_player_set_shared_bus_dispatch (TRUE);
+      shared = measure (n_players[i], uri);
+
+      g_print ("%8u %13.2fus %13.2fus\n", n_players[i], own, shared);
+    }
+
+  return EXIT_SUCCESS;
+}
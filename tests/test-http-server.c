@@ -0,0 +1,161 @@
+/*
+ * Clutter-GStreamer.
+ *
+ * GStreamer integration library for Clutter.
+ *
+ * test-http-server.c - A minimal HTTP/1.1 server for the tests playing
+ *                      media over HTTP.
+ *
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * One connection per request, listening on 127.0.0.1 on a port picked by
+ * the system. It parses the request line, "Range: bytes=start-[end]" and
+ * If-None-Match, the test answers the rest with test_http_respond().
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "test-http-server.h"
+
+typedef struct
+{
+  TestHttpHandler handler;
+  gpointer user_data;
+} TestHttpServer;
+
+static gboolean
+handle_connection (GThreadedSocketService *service,
+                   GSocketConnection      *connection,
+                   GObject                *source_object,
+                   gpointer                user_data)
+{
+  TestHttpServer *server = user_data;
+  TestHttpRequest request = { { 0, }, { 0, }, FALSE, 0, G_MAXUINT64, NULL };
+  GDataInputStream *in;
+  gchar *line;
+
+  in = g_data_input_stream_new (g_io_stream_get_input_stream
+                                (G_IO_STREAM (connection)));
+
+  /* request line */
+  line = g_data_input_stream_read_line (in, NULL, NULL, NULL);
+  if (line == NULL)
+    goto out;
+  sscanf (line, "%7s %255s", request.method, request.path);
+  g_free (line);
+
+  /* headers */
+  while ((line = g_data_input_stream_read_line (in, NULL, NULL, NULL)))
+    {
+      g_strchomp (line);
+
+      if (*line == '\0')
+        {
+          g_free (line);
+          break;
+        }
+
+      if (g_ascii_strncasecmp (line, "Range: bytes=", 13) == 0)
+        {
+          gchar *dash;
+
+          request.has_range = TRUE;
+          request.range_start = g_ascii_strtoull (line + 13, &dash, 10);
+          if (*dash == '-' && g_ascii_isdigit (dash[1]))
+            request.range_end = g_ascii_strtoull (dash + 1, NULL, 10);
+        }
+      else if (g_ascii_strncasecmp (line, "If-None-Match: ", 15) == 0)
+        {
+          g_free (request.if_none_match);
+          request.if_none_match = g_strdup (line + 15);
+        }
+
+      g_free (line);
+    }
+
+  server->handler (&request,
+                   g_io_stream_get_output_stream (G_IO_STREAM (connection)),
+                   server->user_data);
+
+ out:
+  g_free (request.if_none_match);
+  g_object_unref (in);
+
+  return TRUE;
+}
+
+/* Returns the port the server listens on, 0 on error */
+guint16
+test_http_server_start (TestHttpHandler   handler,
+                        gpointer          user_data,
+                        GError          **error)
+{
+  GSocketService *service;
+  TestHttpServer *server;
+  guint16 port;
+
+  service = g_threaded_socket_service_new (4);
+  port = g_socket_listener_add_any_inet_port (G_SOCKET_LISTENER (service),
+                                              NULL, error);
+  if (port == 0)
+    {
+      g_object_unref (service);
+      return 0;
+    }
+
+  /* both live as long as the test */
+  server = g_new0 (TestHttpServer, 1);
+  server->handler = handler;
+  server->user_data = user_data;
+
+  g_signal_connect (service, "run", G_CALLBACK (handle_connection), server);
+  g_socket_service_start (service);
+
+  return port;
+}
+
+/* Sends a response with @size bytes of @data as the body, left out for
+ * HEAD requests. @headers are extra header lines, each ending with "\r\n".
+ * The client closes the connection when it seeks, write errors are
+ * ignored */
+void
+test_http_respond (TestHttpRequest *request,
+                   GOutputStream   *out,
+                   const gchar     *status,
+                   const gchar     *headers,
+                   gconstpointer    data,
+                   gsize            size)
+{
+  gchar *header;
+
+  header = g_strdup_printf ("HTTP/1.1 %s\r\n"
+                            "Content-Length: %" G_GSIZE_FORMAT "\r\n"
+                            "%s"
+                            "Connection: close\r\n\r\n",
+                            status, size, headers ? headers : "");
+
+  if (g_output_stream_write_all (out, header, strlen (header),
+                                 NULL, NULL, NULL) &&
+      data && size > 0 && strcmp (request->method, "GET") == 0)
+    g_output_stream_write_all (out, data, size, NULL, NULL, NULL);
+
+  g_free (header);
+}
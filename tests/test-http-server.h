@@ -0,0 +1,64 @@
+/*
+ * Clutter-GStreamer.
+ *
+ * GStreamer integration library for Clutter.
+ *
+ * test-http-server.h - A minimal HTTP/1.1 server for the tests playing
+ *                      media over HTTP.
+ *
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __TEST_HTTP_SERVER_H__
+#define __TEST_HTTP_SERVER_H__
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+/* The parts of a request the tests look at. range_end is G_MAXUINT64 for
+ * "Range: bytes=start-" */
+typedef struct
+{
+  gchar method[8];
+  gchar path[256];
+  gboolean has_range;
+  guint64 range_start;
+  guint64 range_end;
+  gchar *if_none_match;
+} TestHttpRequest;
+
+/* Called from the threads of the server, once per connection */
+typedef void (* TestHttpHandler) (TestHttpRequest *request,
+                                  GOutputStream   *out,
+                                  gpointer         user_data);
+
+guint16  test_http_server_start (TestHttpHandler   handler,
+                                 gpointer          user_data,
+                                 GError          **error);
+
+void     test_http_respond      (TestHttpRequest  *request,
+                                 GOutputStream    *out,
+                                 const gchar      *status,
+                                 const gchar      *headers,
+                                 gconstpointer     data,
+                                 gsize             size);
+
+G_END_DECLS
+
+#endif /* __TEST_HTTP_SERVER_H__ */
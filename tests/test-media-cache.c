@@ -0,0 +1,290 @@
+/*
+ * Clutter-GStreamer.
+ *
+ * GStreamer integration library for Clutter.
+ *
+ * test-media-cache.c - Serve a media file from a local HTTP server, play it
+ *                      twice with the media cache enabled and check that the
+ *                      second play doesn't hit the server. With --revalidate,
+ *                      the server marks the media as no-cache and the
+ *                      second play must only ask whether it changed.
+ *
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib/gstdio.h>
+#include <gio/gio.h>
+#include <clutter/clutter.h>
+#include <clutter-gst/clutter-gst.h>
+
+#include "test-http-server.h"
+
+/* number of times the media is played */
+#define N_PLAYS   2
+
+static GMappedFile *media;
+static volatile gint n_requests;
+static volatile gint n_downloads;
+static gboolean revalidate;
+
+static gint plays;
+static gint requests_first_play;
+static gint downloads_first_play;
+static gchar *media_uri;
+static gchar *cache_dir;
+
+/*
+ * The responses come with validators and a Cache-Control header, like
+ * those of a regular web server, and "Range: bytes=start-[end]" requests
+ * are honoured so that seeking works.
+ */
+
+static void
+handle_request (TestHttpRequest *request,
+                GOutputStream   *out,
+                gpointer         user_data)
+{
+  gchar *headers, *etag, *content_range;
+  guint64 size, start = 0, end;
+  const gchar *cache_control;
+
+  size = g_mapped_file_get_length (media);
+  end = size - 1;
+  etag = g_strdup_printf ("\"%" G_GUINT64_FORMAT "\"", size);
+  cache_control = revalidate ? "no-cache" : "max-age=3600";
+
+  if (request->has_range)
+    {
+      start = request->range_start;
+      end = MIN (request->range_end, size - 1);
+    }
+
+  if (strcmp (request->method, "GET") == 0)
+    g_atomic_int_inc (&n_requests);
+
+  g_print ("server: %s bytes %" G_GUINT64_FORMAT "-%" G_GUINT64_FORMAT "\n",
+           request->method, start, end);
+
+  if (g_strcmp0 (request->if_none_match, etag) == 0)
+    {
+      headers = g_strdup_printf ("ETag: %s\r\n"
+                                 "Cache-Control: %s\r\n",
+                                 etag, cache_control);
+      test_http_respond (request, out, "304 Not Modified", headers, NULL, 0);
+      g_free (headers);
+      g_free (etag);
+      return;
+    }
+
+  if (start > end)
+    {
+      test_http_respond (request, out, "416 Requested Range Not Satisfiable",
+                         NULL, NULL, 0);
+      g_free (etag);
+      return;
+    }
+
+  if (request->has_range)
+    content_range = g_strdup_printf ("Content-Range: bytes %" G_GUINT64_FORMAT
+                                     "-%" G_GUINT64_FORMAT
+                                     "/%" G_GUINT64_FORMAT "\r\n",
+                                     start, end, size);
+  else
+    content_range = g_strdup ("");
+
+  headers = g_strdup_printf ("Content-Type: application/octet-stream\r\n"
+                             "%s"
+                             "Accept-Ranges: bytes\r\n"
+                             "ETag: %s\r\n"
+                             "Last-Modified: Mon, 06 Jan 2014 10:00:00 GMT\r\n"
+                             "Cache-Control: %s\r\n",
+                             content_range, etag, cache_control);
+
+  if (strcmp (request->method, "GET") == 0)
+    g_atomic_int_inc (&n_downloads);
+
+  test_http_respond (request, out,
+                     request->has_range ? "206 Partial Content" : "200 OK",
+                     headers,
+                     g_mapped_file_get_contents (media) + start,
+                     end - start + 1);
+
+  g_free (headers);
+  g_free (content_range);
+  g_free (etag);
+}
+
+/* the cache is a flat directory: the media files and the index */
+static void
+remove_cache_dir (void)
+{
+  const gchar *name;
+  GDir *dir;
+
+  if (cache_dir == NULL)
+    return;
+
+  dir = g_dir_open (cache_dir, 0, NULL);
+  if (dir)
+    {
+      while ((name = g_dir_read_name (dir)))
+        {
+          gchar *path = g_build_filename (cache_dir, name, NULL);
+
+          g_unlink (path);
+          g_free (path);
+        }
+      g_dir_close (dir);
+    }
+
+  g_rmdir (cache_dir);
+}
+
+static void
+on_eos (ClutterMedia *media,
+        gpointer      user_data)
+{
+  gint requests, downloads;
+
+  plays++;
+  requests = g_atomic_int_get (&n_requests);
+  downloads = g_atomic_int_get (&n_downloads);
+
+  if (plays == 1)
+    {
+      requests_first_play = requests;
+      downloads_first_play = downloads;
+      g_print ("play 1: %d requests\n", requests);
+    }
+  else
+    {
+      g_print ("play %d: %d requests, %d downloads\n", plays,
+               requests - requests_first_play,
+               downloads - downloads_first_play);
+    }
+
+  /* the first play has put the media in the cache */
+  if (plays < N_PLAYS)
+    {
+      clutter_media_set_uri (media, media_uri);
+      clutter_media_set_playing (media, TRUE);
+      return;
+    }
+
+  if (downloads != downloads_first_play ||
+      (!revalidate && requests != requests_first_play))
+    {
+      g_print ("FAIL: the media was not served from the cache\n");
+      exit (EXIT_FAILURE);
+    }
+
+  /* a no-cache media is never used without asking */
+  if (revalidate && requests == requests_first_play)
+    {
+      g_print ("FAIL: the media was not revalidated\n");
+      exit (EXIT_FAILURE);
+    }
+
+  g_print ("PASS\n");
+  clutter_main_quit ();
+}
+
+static void
+on_error (ClutterMedia *media,
+          GError       *error,
+          gpointer      user_data)
+{
+  g_print ("error: %s\n", error->message);
+  exit (EXIT_FAILURE);
+}
+
+int
+main (int argc, char *argv[])
+{
+  ClutterInitError init_error;
+  ClutterActor *stage, *video;
+  GError *error = NULL;
+  guint16 port;
+
+  if (argc > 1 && strcmp (argv[1], "--revalidate") == 0)
+    {
+      revalidate = TRUE;
+      argv[1] = argv[0];
+      argc--;
+      argv++;
+    }
+
+  if (argc < 2)
+    {
+      g_print ("%s [--revalidate] media-file\n", argv[0]);
+      exit (1);
+    }
+
+  init_error = clutter_gst_init (&argc, &argv);
+  g_assert (init_error == CLUTTER_INIT_SUCCESS);
+
+  media = g_mapped_file_new (argv[1], FALSE, &error);
+  if (media == NULL)
+    {
+      g_print ("%s\n", error->message);
+      exit (1);
+    }
+
+  port = test_http_server_start (handle_request, NULL, &error);
+  if (port == 0)
+    {
+      g_print ("%s\n", error->message);
+      exit (1);
+    }
+
+  media_uri = g_strdup_printf ("http://127.0.0.1:%u/media", port);
+  g_print ("serving %s as %s\n", argv[1], media_uri);
+
+  /* start from an empty cache, removed however the test ends */
+  cache_dir = g_dir_make_tmp ("test-media-cache-XXXXXX", NULL);
+  clutter_gst_player_set_media_cache_dir (cache_dir);
+  atexit (remove_cache_dir);
+
+  stage = clutter_stage_new ();
+
+  video = clutter_gst_video_texture_new ();
+  g_assert (CLUTTER_GST_IS_VIDEO_TEXTURE (video));
+
+  clutter_gst_player_set_buffering_mode (CLUTTER_GST_PLAYER (video),
+                                         CLUTTER_GST_BUFFERING_MODE_DOWNLOAD);
+  clutter_gst_player_set_use_media_cache (CLUTTER_GST_PLAYER (video), TRUE);
+
+  g_signal_connect (video, "eos", G_CALLBACK (on_eos), NULL);
+  g_signal_connect (video, "error", G_CALLBACK (on_error), NULL);
+
+  clutter_actor_add_child (stage, video);
+  clutter_actor_show (stage);
+
+  clutter_media_set_uri (CLUTTER_MEDIA (video), media_uri);
+  clutter_media_set_playing (CLUTTER_MEDIA (video), TRUE);
+
+  clutter_main ();
+
+  g_free (media_uri);
+  g_mapped_file_unref (media);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,147 @@
+/*
+ * Clutter-GStreamer.
+ *
+ * GStreamer integration library for Clutter.
+ *
+ * test-shared-audio.c - Play a media in several players mixed into a
+ *                       single shared audio output, a fakesink here, and
+ *                       check that the mix reaches it.
+ *
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <clutter/clutter.h>
+#include <clutter-gst/clutter-gst.h>
+
+#define N_PLAYERS 4
+/* time the players play before the output is checked (in ms) */
+#define DURATION  3000
+
+static ClutterActor *players[N_PLAYERS];
+static volatile gint n_buffers;
+
+static void
+on_handoff (GstElement *sink,
+            GstBuffer  *buffer,
+            GstPad     *pad,
+            gpointer    user_data)
+{
+  g_atomic_int_inc (&n_buffers);
+}
+
+static gboolean
+check_output (gpointer data)
+{
+  gint i, n_audio_sinks = 0;
+
+  for (i = 0; i < N_PLAYERS; i++)
+    {
+      GstElement *pipeline, *audio_sink = NULL;
+      GstElementFactory *factory;
+
+      pipeline =
+        clutter_gst_player_get_pipeline (CLUTTER_GST_PLAYER (players[i]));
+      g_object_get (pipeline, "audio-sink", &audio_sink, NULL);
+      if (audio_sink == NULL)
+        continue;
+
+      factory = gst_element_get_factory (audio_sink);
+      if (factory == NULL ||
+          strcmp (gst_plugin_feature_get_name (GST_PLUGIN_FEATURE (factory)),
+                  "interaudiosink") != 0)
+        n_audio_sinks++;
+
+      gst_object_unref (audio_sink);
+    }
+
+  g_print ("%d buffers mixed, %d players with an audio sink of their own\n",
+           g_atomic_int_get (&n_buffers), n_audio_sinks);
+
+  if (g_atomic_int_get (&n_buffers) == 0 || n_audio_sinks > 0)
+    {
+      g_print ("FAIL\n");
+      exit (EXIT_FAILURE);
+    }
+
+  g_print ("PASS\n");
+  clutter_main_quit ();
+
+  return FALSE;
+}
+
+static void
+on_error (ClutterMedia *media,
+          GError       *error,
+          gpointer      user_data)
+{
+  g_print ("error: %s\n", error->message);
+  exit (EXIT_FAILURE);
+}
+
+int
+main (int argc, char *argv[])
+{
+  ClutterInitError error;
+  ClutterActor *stage;
+  GstElement *output;
+  gint i;
+
+  if (argc < 2)
+    {
+      g_print ("%s uri\n", argv[0]);
+      exit (1);
+    }
+
+  error = clutter_gst_init (&argc, &argv);
+  g_assert (error == CLUTTER_INIT_SUCCESS);
+
+  output = gst_element_factory_make ("fakesink", NULL);
+  g_object_set (output, "signal-handoffs", TRUE, "sync", TRUE, NULL);
+  g_signal_connect (output, "handoff", G_CALLBACK (on_handoff), NULL);
+  clutter_gst_player_set_shared_audio_sink (output);
+
+  stage = clutter_stage_new ();
+
+  for (i = 0; i < N_PLAYERS; i++)
+    {
+      players[i] = clutter_gst_video_texture_new ();
+      g_assert (CLUTTER_GST_IS_VIDEO_TEXTURE (players[i]));
+
+      clutter_gst_player_set_shared_audio (CLUTTER_GST_PLAYER (players[i]),
+                                           TRUE);
+      g_signal_connect (players[i], "error", G_CALLBACK (on_error), NULL);
+
+      clutter_actor_set_size (players[i], 160, 90);
+      clutter_actor_set_x (players[i], i * 160);
+      clutter_actor_add_child (stage, players[i]);
+
+      clutter_media_set_uri (CLUTTER_MEDIA (players[i]), argv[1]);
+      clutter_media_set_playing (CLUTTER_MEDIA (players[i]), TRUE);
+    }
+
+  clutter_actor_show (stage);
+
+  g_timeout_add (DURATION, check_output, NULL);
+
+  clutter_main ();
+
+  return EXIT_SUCCESS;
+}
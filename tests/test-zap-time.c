@@ -0,0 +1,174 @@
+/*
+ * Clutter-GStreamer.
+ *
+ * GStreamer integration library for Clutter.
+ *
+ * test-zap-time.c - Measure the time it takes to switch between media, with
+ *                   and without pre-rolled standby pipelines.
+ *
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <stdlib.h>
+
+#include <clutter/clutter.h>
+#include <clutter-gst/clutter-gst.h>
+
+/* number of switches measured for each mode */
+#define N_ZAPS    10
+/* time spent on a media before switching to the next one (in ms) */
+#define DWELL     2000
+
+typedef struct
+{
+  ClutterGstPlayer *player;
+  gchar **uris;
+  gint n_uris;
+
+  gboolean standby;
+  gboolean waiting;
+  gint current;
+  gint zaps;
+
+  GTimer *timer;
+  gdouble total;
+} ZapTest;
+
+static gboolean
+zap (gpointer data)
+{
+  ZapTest *test = data;
+  const gchar *uri = test->uris[test->current % test->n_uris];
+
+  test->waiting = TRUE;
+  g_timer_start (test->timer);
+
+  clutter_media_set_uri (CLUTTER_MEDIA (test->player), uri);
+  clutter_media_set_playing (CLUTTER_MEDIA (test->player), TRUE);
+
+  return FALSE;
+}
+
+static void
+on_idle_changed (ClutterGstPlayer *player,
+                 GParamSpec       *pspec,
+                 ZapTest          *test)
+{
+  gdouble elapsed;
+
+  if (!test->waiting || clutter_gst_player_get_idle (player))
+    return;
+
+  elapsed = g_timer_elapsed (test->timer, NULL);
+  test->waiting = FALSE;
+  test->total += elapsed;
+  test->zaps++;
+  test->current++;
+
+  g_print ("%s: switched to %s in %.3fs\n",
+           test->standby ? "standby" : "cold",
+           clutter_media_get_uri (CLUTTER_MEDIA (player)),
+           elapsed);
+
+  if (test->standby)
+    clutter_gst_player_preroll_uri (player,
+                                    test->uris[test->current % test->n_uris]);
+
+  if (test->zaps < N_ZAPS)
+    {
+      g_timeout_add (DWELL, zap, test);
+      return;
+    }
+
+  g_print ("%s: average switch time %.3fs\n",
+           test->standby ? "standby" : "cold",
+           test->total / test->zaps);
+
+  if (test->standby)
+    {
+      clutter_main_quit ();
+      return;
+    }
+
+  /* now do the same with pre-rolled pipelines */
+  test->standby = TRUE;
+  test->zaps = 0;
+  test->total = 0.0;
+
+  clutter_gst_player_set_standby_count (player, test->n_uris - 1);
+  clutter_gst_player_preroll_uri (player,
+                                  test->uris[test->current % test->n_uris]);
+
+  g_timeout_add (DWELL, zap, test);
+}
+
+static void
+on_error (ClutterMedia *media,
+          GError       *error,
+          gpointer      user_data)
+{
+  g_print ("error: %s\n", error->message);
+  clutter_main_quit ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  ClutterInitError error;
+  ClutterActor *stage, *video;
+  ZapTest test = { 0, };
+  gint i;
+
+  if (argc < 3)
+    {
+      g_print ("%s uri1 uri2 [uri3...]\n", argv[0]);
+      exit (1);
+    }
+
+  error = clutter_gst_init (&argc, &argv);
+  g_assert (error == CLUTTER_INIT_SUCCESS);
+
+  test.n_uris = argc - 1;
+  test.uris = g_new0 (gchar *, test.n_uris + 1);
+  for (i = 0; i < test.n_uris; i++)
+    test.uris[i] = g_strdup (argv[i + 1]);
+  test.timer = g_timer_new ();
+
+  stage = clutter_stage_new ();
+
+  video = clutter_gst_video_texture_new ();
+  g_assert (CLUTTER_GST_IS_VIDEO_TEXTURE (video));
+  test.player = CLUTTER_GST_PLAYER (video);
+
+  g_signal_connect (video, "notify::idle",
+                    G_CALLBACK (on_idle_changed), &test);
+  g_signal_connect (video, "error",
+                    G_CALLBACK (on_error), NULL);
+
+  clutter_actor_add_child (stage, video);
+  clutter_actor_show (stage);
+
+  zap (&test);
+
+  clutter_main ();
+
+  g_timer_destroy (test.timer);
+  g_strfreev (test.uris);
+
+  return EXIT_SUCCESS;
+}